@@ -336,7 +336,7 @@ struct ViewVDBBoundingBox : zeno::INode {
         int idx = 0;
         auto& clrs = prim->add_attr<zeno::vec3f>("clr");
         for(TreeType::NodeIter iter = grid->tree().beginNode();iter;++iter)
-            add_bounding_colored_box(grid,iter.getBoundingBox(),idx++,level_clrs[iter.getDepth()],segs.values,verts.values,clrs);
+            add_bounding_colored_box(grid,iter.getBoundingBox(),idx++,level_clrs[iter.getDepth()],segs.values.mut(),verts.values.mut(),clrs);
 
 
 
@@ -428,7 +428,7 @@ struct ViewLeafNodeBoundingBox : zeno::INode {
         for(TreeType::LeafCIter iter = grid->tree().cbeginLeaf();iter;++iter) {
             const LeafType& leaf = *iter;
             auto aabb = leaf.getNodeBoundingBox();
-            add_bounding_colored_box(grid,aabb,idx++,zeno::vec3f{1.0},segs.values,verts.values,clrs);
+            add_bounding_colored_box(grid,aabb,idx++,zeno::vec3f{1.0},segs.values.mut(),verts.values.mut(),clrs);
         }
 
         set_output("prim",std::move(prim));
@@ -529,8 +529,8 @@ struct ViewVDBPoints : zeno::INode {
         zeno::PrimitiveObject& prim) const {
             int voffset = id * 8;
             int toffset = id * 12;
-            auto& lines = prim.lines.values;
-            auto& verts = prim.verts.values;
+            auto& lines = prim.lines.values.mut();
+            auto& verts = prim.verts.values.mut();
             auto& clrs = prim.attr<zeno::vec3f>("clr");
 
             std::cout << "add : " << wmin << "\t" << wmax << std::endl;
@@ -666,8 +666,8 @@ void add_colored_aabb(const openvdb::Vec3f& wmin,
         zeno::PrimitiveObject& prim) const {
             int voffset = id * 8;
             int toffset = id * 12;
-            auto& lines = prim.lines.values;
-            auto& verts = prim.verts.values;
+            auto& lines = prim.lines.values.mut();
+            auto& verts = prim.verts.values.mut();
             auto& clrs = prim.attr<zeno::vec3f>("clr");
 
             std::cout << "add : " << wmin << "\t" << wmax << std::endl;
@@ -902,8 +902,8 @@ struct TestDilation : zeno::INode {
         zeno::PrimitiveObject& prim) const {
             int voffset = id * 8;
             int toffset = id * 12;
-            auto& lines = prim.lines.values;
-            auto& verts = prim.verts.values;
+            auto& lines = prim.lines.values.mut();
+            auto& verts = prim.verts.values.mut();
             auto& clrs = prim.attr<zeno::vec3f>("clr");
 
             // std::cout << "add : " << wmin << "\t" << wmax << std::endl;
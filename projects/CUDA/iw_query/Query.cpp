@@ -45,7 +45,7 @@ struct QueryNearestPoints : INode {
         auto &dists = points->add_attr<float>(distTag);
         auto &cps = points->add_attr<zeno::vec3f>(cpTag);
 
-        auto &vertices = prim->verts.values;
+        auto &vertices = prim->verts.values.mut();
 
 #if 0
         std::vector<v3i> vertIndex(prim->size());
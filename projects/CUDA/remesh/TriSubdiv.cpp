@@ -55,7 +55,7 @@ struct TrianglePrimSubdiv : INode {
         for (int i = 0; i != niters; ++i) {
             bht<int, 2, int> tab{3 * tris.size() * 2};
             tab.reset(pol, true);
-            pol(tris.values, [tab = proxy<space>(tab)](auto tri) mutable {
+            pol(tris.values.mut(), [tab = proxy<space>(tab)](auto tri) mutable {
                 int u = tri[2];
                 for (int d = 0; d != 3; ++d) {
                     int v = tri[d];
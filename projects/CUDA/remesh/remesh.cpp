@@ -295,7 +295,7 @@ struct UniformRemeshing : INode {
         std::set<std::pair<int, int>> marked_lines{};
 #if 1
         if (has_input("marked_lines")) {
-            const auto &markedLines = get_input<PrimitiveObject>("marked_lines")->lines.values;
+            const auto &markedLines = get_input<PrimitiveObject>("marked_lines")->lines.values.get();
             for (vec2i line : markedLines) {
                 marked_lines.insert(std::make_pair(line[0], line[1]));
             }
@@ -310,7 +310,7 @@ struct UniformRemeshing : INode {
         auto pol = omp_exec();
         bht<int, 2, int> tab{prim->tris.size()};
         tab.reset(pol, true);
-        pol(prim->tris.values, [tab = proxy<space>(tab)](auto tri) mutable {
+        pol(prim->tris.values.mut(), [tab = proxy<space>(tab)](auto tri) mutable {
             for (int d = 0; d != 3; ++d) {
                 auto a = tri[d];
                 auto b = tri[(d + 1) % 3];
@@ -449,7 +449,7 @@ struct AdaptiveRemeshing : INode {
         std::set<std::pair<int, int>> marked_lines{};
 #if 1
         if (has_input("marked_lines")) {
-            const auto &markedLines = get_input<PrimitiveObject>("marked_lines")->lines.values;
+            const auto &markedLines = get_input<PrimitiveObject>("marked_lines")->lines.values.get();
             for (vec2i line : markedLines) {
                 marked_lines.insert(std::make_pair(line[0], line[1]));
             }
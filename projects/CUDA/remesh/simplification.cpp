@@ -19,13 +19,13 @@ struct PolyReduceLite : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        auto &pos = verts.values;
+        auto &pos = verts.values.mut();
         std::vector<int> vertDiscard(pos.size());
         std::vector<std::set<int>> vertTris(pos.size());                              /// neighboring tris
         std::vector<std::set<int>> vertVerts(pos.size());                             /// neighboring verts
         std::vector<std::pair<float, std::pair<int, int>>> vertEdgeCosts(pos.size()); /// neighboring verts
 
-        auto &tris = prim->tris.values;
+        auto &tris = prim->tris.values.mut();
         std::vector<int> triDiscard(tris.size());
         std::vector<zeno::vec3f> triNorms(tris.size());
 
@@ -66,7 +66,7 @@ struct SpawnGuidelines : INode {
                 return openvdb::tools::BoxSampler::sample(gridGrad->getConstUnsafeAccessor(),
                                                           gridGrad->worldToIndex(p));
             };
-            pol(enumerate(prim->polys.values),
+            pol(enumerate(prim->polys.values.mut()),
                 /// @note cap [sep_dist] in case repel points outside the narrowband where grad is invalid
                 [&getSdf, &getGrad, dx, sep_dist = std::min(sep_dist, grid->background()), maxIters, &roots, &nrm, &pos,
                  numSegments, segLength = length / numSegments](int polyi, vec2i &tup) {
@@ -119,7 +119,7 @@ struct SpawnGuidelines : INode {
                     }
                 });
         } else {
-            pol(enumerate(prim->polys.values),
+            pol(enumerate(prim->polys.values.mut()),
                 [&roots, &nrm, &pos, numSegments, segLength = length / numSegments](int polyi, vec2i &tup) {
                     auto offset = polyi * (numSegments + 1);
                     tup[0] = offset;
@@ -134,7 +134,7 @@ struct SpawnGuidelines : INode {
                     }
                 });
         }
-        pol(enumerate(prim->loops.values), [](int vi, int &loopid) { loopid = vi; });
+        pol(enumerate(prim->loops.values.mut()), [](int vi, int &loopid) { loopid = vi; });
         // copy point attrs to polys attrs
         for (auto &[key, srcArr] : points->verts.attrs) {
             auto const &k = key;
@@ -206,7 +206,7 @@ struct StepGuidelines : INode {
             auto &ids = gls->attr<float>(idTag); // ref: pnbvhw.cpp
             const auto boundaryPrim = get_input<PrimitiveObject>("boundary_prim");
             const auto &boundaryPos = boundaryPrim->attr<vec3f>("pos");
-            const auto &boundaryTris = boundaryPrim->tris.values;
+            const auto &boundaryTris = boundaryPrim->tris.values.get();
             /// move guideline roots
             pol(polys, [&](vec2i poly) {
                 auto ptNo = loops[poly[0]];
@@ -269,7 +269,7 @@ struct StepGuidelines : INode {
                 constexpr auto space = RM_CVREF_T(space_c)::value;
 
                 /// @note cap [sep_dist] in case repel points outside the narrowband where grad is invalid
-                pol(loops.values, [&getSdf, &getGrad, dx, sep_dist = std::min(sep_dist, grid->background()), maxIters,
+                pol(loops.values.mut(), [&getSdf, &getGrad, dx, sep_dist = std::min(sep_dist, grid->background()), maxIters,
                                    vtemp = proxy<space>(vtemp), xnOffset = vtemp.getPropertyOffset("xn"),
                                    gradOffset = vtemp.getPropertyOffset("grad"), mass](int ptNo) {
                     auto p_ = vtemp.pack(dim_c<3>, xnOffset, ptNo);
@@ -608,8 +608,8 @@ struct GenerateHairs : INode {
         bvh_t bvh;
         {
             zs::Vector<bv_t> bvs{guideLines->polys.size()};
-            pol(range(guideLines->polys.size()), [&verts = guideLines->verts.values, &polys = guideLines->polys.values,
-                                                  &loops = guideLines->loops.values, &bvs](int polyI) {
+            pol(range(guideLines->polys.size()), [&verts = guideLines->verts.values.mut(), &polys = guideLines->polys.values.mut(),
+                                                  &loops = guideLines->loops.values.mut(), &bvs](int polyI) {
                 auto p = vec_to_other<zs::vec<float, 3>>(verts[loops[polys[polyI][0]]]);
                 bvs[polyI] = bv_t{p, p};
             });
@@ -618,8 +618,8 @@ struct GenerateHairs : INode {
         auto numHairs = points->verts.size();
         std::vector<int> gid(numHairs);
         std::vector<int> numPoints(numHairs), hairPolyOffsets(numHairs);
-        pol(range(numHairs), [&gid, &points, &verts = guideLines->verts.values, &polys = guideLines->polys.values,
-                              &loops = guideLines->loops.values, &numPoints, lbvhv = proxy<space>(bvh)](int vi) {
+        pol(range(numHairs), [&gid, &points, &verts = guideLines->verts.values.mut(), &polys = guideLines->polys.values.mut(),
+                              &loops = guideLines->loops.values.mut(), &numPoints, lbvhv = proxy<space>(bvh)](int vi) {
             using vec3 = zs::vec<float, 3>;
             auto pi = vec3::from_array(points->verts.values[vi]);
             auto [id, _] = lbvhv.find_nearest(
@@ -646,10 +646,10 @@ struct GenerateHairs : INode {
         prim->loops.resize(numTotalPoints);
         prim->polys.resize(numHairs);
 
-        pol(enumerate(prim->polys.values),
+        pol(enumerate(prim->polys.values.mut()),
             [&numPoints, &hairPolyOffsets, &gid, &pos = prim->attr<vec3f>("pos"), &points,
-             &glPos = guideLines->attr<vec3f>("pos"), &polys = guideLines->polys.values,
-             &loops = guideLines->loops.values](int hairId, vec2i &tup) {
+             &glPos = guideLines->attr<vec3f>("pos"), &polys = guideLines->polys.values.mut(),
+             &loops = guideLines->loops.values.mut()](int hairId, vec2i &tup) {
                 auto offset = hairPolyOffsets[hairId];
                 auto numPts = numPoints[hairId];
                 tup[0] = offset;
@@ -670,7 +670,7 @@ struct GenerateHairs : INode {
                     lastGlVert = curGlVert;
                 }
             });
-        pol(enumerate(prim->loops.values), [](int vi, int &loopid) { loopid = vi; });
+        pol(enumerate(prim->loops.values.mut()), [](int vi, int &loopid) { loopid = vi; });
 
         /// @note override guideline attribs to hairs
         if (get_input2<bool>("interpAttrs")) {
@@ -76,9 +76,9 @@ struct PrimitiveConnectedComponents : INode {
         constexpr auto space = execspace_e::openmp;
         auto pol = omp_exec();
         auto &pos = prim->attr<zeno::vec3f>("pos");
-        const auto &lines = prim->lines.values;
-        const auto &tris = prim->tris.values;
-        const auto &quads = prim->quads.values;
+        const auto &lines = prim->lines.values.get();
+        const auto &tris = prim->tris.values.get();
+        const auto &quads = prim->quads.values.get();
 
         using IV = zs::vec<int, 2>;
         zs::bcht<IV, int, true, zs::universal_hash<IV>, 16> tab{lines.size() * 2 + tris.size() * 3 + quads.size() * 4};
@@ -205,9 +205,9 @@ struct PrimitiveConnectedComponents : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        const auto &pos = verts.values;
+        const auto &pos = verts.values.get();
 
-        const auto &tris = prim->tris.values;
+        const auto &tris = prim->tris.values.get();
         const bool hasTris = tris.size() > 0;
         // const bool hasTriUV = tris.has_attr<vec3f>("uv0") && tris.has_attr<vec3f>("uv1") && tris.has_attr<vec3f>("uv2");
         // const auto &uvs = prim->uvs;
@@ -427,7 +427,7 @@ struct PrimitiveConnectedComponents : INode {
                 primIsland->uvs = prim->uvs; // BEWARE: does not remove redundant uvs here
 
                 // write poly.values
-                pol(zip(polyI.values, preservedPolyOffsets, preservedPolySizes), [](vec2i &poly, int offset, int size) {
+                pol(zip(polyI.values.mut(), preservedPolyOffsets, preservedPolySizes), [](vec2i &poly, int offset, int size) {
                     poly[0] = offset;
                     poly[1] = size;
                 });
@@ -577,7 +577,7 @@ struct PrimitiveMarkIslands : INode {
         });
         if (get_input2<bool>("mark_face")) {
             auto &faceids = polys.add_attr<int>(islandTag);
-            pol(zip(polys.values, faceids), [&](const auto &poly, int &fid) {
+            pol(zip(polys.values.mut(), faceids), [&](const auto &poly, int &fid) {
                 auto offset = poly[0];
                 auto vi = loops[offset];
                 auto vIslandId = setids[vi];
@@ -620,9 +620,9 @@ struct PrimitiveReorder : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        const auto &pos = verts.values;
+        const auto &pos = verts.values.get();
 
-        auto &tris = prim->tris.values;
+        auto &tris = prim->tris.values.mut();
 
         /// @note bv
         constexpr auto defaultBv =
@@ -813,7 +813,7 @@ struct PrimitiveFuse : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        const auto &pos = verts.values;
+        const auto &pos = verts.values.get();
         auto preservedAttribs_ = get_input2<std::string>("preserved_vert_attribs");
         std::set<std::string> preservedAttribs = separate_string_by(preservedAttribs_, " :;,.");
         std::set<std::string> promotedAttribs;
@@ -929,7 +929,7 @@ struct PrimitiveFuse : INode {
         });
 
         /// @brief map element indices
-        auto &tris = prim->tris.values;
+        auto &tris = prim->tris.values.mut();
         const bool hasTris = tris.size() > 0;
 
         auto &loops = prim->loops;
@@ -952,7 +952,7 @@ struct PrimitiveFuse : INode {
                     match([&](const auto &arr) { promoteVertAttribToTri(attribTag, arr); })(verts.attr(attribTag));
             }
 
-            pol(enumerate(eles.values), [&fas, &verts, &eles, &promotedAttribs](int ei, auto &tri) mutable {
+            pol(enumerate(eles.values.mut()), [&fas, &verts, &eles, &promotedAttribs](int ei, auto &tri) mutable {
                 for (const auto &attribTag : promotedAttribs) {
                     if (verts.has_attr(attribTag))
                         match(
@@ -1000,7 +1000,7 @@ struct PrimitiveFuse : INode {
                                 if (!uv_exist) {
                                     auto &loopUV = loops.attr<int>("uvs");
                                     loopUV[loopI] = loopI;
-                                    auto &uvs = prim->uvs.values;
+                                    auto &uvs = prim->uvs.values.mut();
                                     const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
                                     auto vertUV = srcVertUV[ptNo];
                                     uvs[loopI] = vec2f(vertUV[0], vertUV[1]);
@@ -1066,7 +1066,7 @@ struct PrimitiveFuse2 : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        const auto &pos = verts.values;
+        const auto &pos = verts.values.get();
         auto preservedAttribs_ = get_input2<std::string>("preserved_vert_attribs");
         std::set<std::string> preservedAttribs = separate_string_by(preservedAttribs_, " :;,.");
         std::set<std::string> promotedAttribs;
@@ -1190,7 +1190,7 @@ struct PrimitiveFuse2 : INode {
         });
 
         /// @brief map element indices
-        auto &tris = prim->tris.values;
+        auto &tris = prim->tris.values.mut();
         const bool hasTris = tris.size() > 0;
 
         auto &loops = prim->loops;
@@ -1214,7 +1214,7 @@ struct PrimitiveFuse2 : INode {
                     match([&](const auto &arr) { promoteVertAttribToTri(attribTag, arr); })(verts.attr(attribTag));
             }
 
-            pol(enumerate(eles.values), [&fas, &verts, &eles, &promotedAttribs](int ei, auto &tri) mutable {
+            pol(enumerate(eles.values.mut()), [&fas, &verts, &eles, &promotedAttribs](int ei, auto &tri) mutable {
                 for (const auto &attribTag : promotedAttribs) {
                     if (verts.has_attr(attribTag))
                         match(
@@ -1321,7 +1321,7 @@ struct PointFuse : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        const auto &pos = verts.values;
+        const auto &pos = verts.values.get();
         auto sumAttribs_ = get_input2<std::string>("sum_vert_attribs");
         auto minAttribs_ = get_input2<std::string>("min_vert_attribs");
         auto maxAttribs_ = get_input2<std::string>("max_vert_attribs");
@@ -1579,7 +1579,7 @@ struct PrimitiveFuse : INode {
         auto pol = omp_exec();
 
         auto &verts = prim->verts;
-        const auto &pos = verts.values;
+        const auto &pos = verts.values.get();
         auto preservedAttribs_ = get_input2<std::string>("preserved_vert_attribs");
         std::set<std::string> preservedAttribs = separate_string_by(preservedAttribs_, " :;,.");
 
@@ -1670,7 +1670,7 @@ struct PrimitiveFuse : INode {
         pol(zip(newPos, cnts), [](zeno::vec3f &p, int sz) { p /= (float)sz; });
 
         /// @brief map element indices
-        auto &tris = prim->tris.values;
+        auto &tris = prim->tris.values.mut();
         const bool hasTris = tris.size() > 0;
 
         auto &loops = prim->loops;
@@ -1696,7 +1696,7 @@ struct PrimitiveFuse : INode {
             } else {
                 verts.foreach_attr<AttrAcceptAll>(promoteVertAttribToTri);
             }
-            pol(enumerate(eles.values), [&fas, &verts, &eles, &preservedAttribs](int ei, auto &tri) mutable {
+            pol(enumerate(eles.values.mut()), [&fas, &verts, &eles, &preservedAttribs](int ei, auto &tri) mutable {
                 if (preservedAttribs.size() > 0) {
                     for (const auto &attribTag : preservedAttribs) {
                         if (verts.has_attr(attribTag))
@@ -1765,7 +1765,7 @@ struct PrimitiveFuse : INode {
                                     if (!uv_exist) {
                                         auto &loopUV = loops.attr<int>("uvs");
                                         loopUV[loopI] = loopI;
-                                        auto &uvs = prim->uvs.values;
+                                        auto &uvs = prim->uvs.values.mut();
                                         const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
                                         auto vertUV = srcVertUV[ptNo];
                                         uvs[loopI] = vec2f(vertUV[0], vertUV[1]);
@@ -1790,7 +1790,7 @@ struct PrimitiveFuse : INode {
                                 if (!uv_exist) {
                                     auto &loopUV = loops.attr<int>("uvs");
                                     loopUV[loopI] = loopI;
-                                    auto &uvs = prim->uvs.values;
+                                    auto &uvs = prim->uvs.values.mut();
                                     const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
                                     auto vertUV = srcVertUV[ptNo];
                                     uvs[loopI] = vec2f(vertUV[0], vertUV[1]);
@@ -2233,7 +2233,7 @@ struct PrimAttributePromote : INode {
                     }
                 });
                 /// promote
-                pol(enumerate(tris.values), [&verts, &tris, &promoteAttribs](int ei, const auto &tri) mutable {
+                pol(enumerate(tris.values.mut()), [&verts, &tris, &promoteAttribs](int ei, const auto &tri) mutable {
                     for (const auto &attribTag : promoteAttribs) {
                         if (verts.has_attr(attribTag))
                             match(
@@ -2292,7 +2292,7 @@ struct PrimAttributePromote : INode {
 
                 if (mergeOp == 0) {
                     std::vector<int> vCnts(verts.size());
-                    pol(enumerate(tris.values), [&, tag = wrapv<space>{}](int triNo, zeno::vec3i tri) {
+                    pol(enumerate(tris.values.mut()), [&, tag = wrapv<space>{}](int triNo, zeno::vec3i tri) {
                         atomic_add(tag, &vCnts[tri[0]], 1);
                         atomic_add(tag, &vCnts[tri[1]], 1);
                         atomic_add(tag, &vCnts[tri[2]], 1);
@@ -2346,7 +2346,7 @@ struct PrimAttributePromote : INode {
                                     verts.attr(attribTag));
                     });
                 } else if (mergeOp == 1 || mergeOp == 2) {
-                    pol(enumerate(tris.values), [&, tag = wrapv<space>{}](int triNo, zeno::vec3i tri) {
+                    pol(enumerate(tris.values.mut()), [&, tag = wrapv<space>{}](int triNo, zeno::vec3i tri) {
                         for (const auto &attribTag : promoteAttribs) {
                             if (verts.has_attr(attribTag))
                                 match([&, &attribTag = attribTag](auto &vertAttrib) {
@@ -2454,10 +2454,10 @@ static std::shared_ptr<PrimitiveObject> unfuse_primitive(std::shared_ptr<Primiti
     auto pol = omp_exec();
 
     auto &verts = prim->verts;
-    const auto &pos = verts.values;
+    const auto &pos = verts.values.get();
 
     auto &tris = prim->tris;
-    const auto &triIds = tris.values;
+    const auto &triIds = tris.values.get();
     const bool hasTris = tris.size() > 0;
 
     auto &polys = prim->polys;
@@ -2486,7 +2486,7 @@ static std::shared_ptr<PrimitiveObject> unfuse_primitive(std::shared_ptr<Primiti
     } else {
         const auto &polyGroups = polys.attr<int>(tag);
         std::vector<Mutex> mtxs(pos.size());
-        pol(zip(polys.values, polyGroups), [&mtxs, &groupsPerVertex, &loops](zeno::vec2i poly, int groupNo) {
+        pol(zip(polys.values.mut(), polyGroups), [&mtxs, &groupsPerVertex, &loops](zeno::vec2i poly, int groupNo) {
             auto st = poly[0];
             auto ed = st + poly[1];
             for (; st != ed; ++st) {
@@ -2520,7 +2520,7 @@ static std::shared_ptr<PrimitiveObject> unfuse_primitive(std::shared_ptr<Primiti
 
     resPrim->verts.resize(numEntries);
     auto &resVerts = resPrim->verts;
-    auto &resPos = resVerts.values;
+    auto &resPos = resVerts.values.mut();
     verts.foreach_attr<AttrAcceptAll>([&](const auto &key, const auto &arr) {
         using T = std::decay_t<decltype(arr[0])>;
         resVerts.add_attr<T>(key);
@@ -2542,7 +2542,7 @@ static std::shared_ptr<PrimitiveObject> unfuse_primitive(std::shared_ptr<Primiti
 
         resPrim->tris.resize(tris.size());
         auto &resTris = resPrim->tris;
-        auto &resTriIds = resTris.values;
+        auto &resTriIds = resTris.values.mut();
         tris.foreach_attr<AttrAcceptAll>([&](const auto &key, const auto &arr) {
             using T = std::decay_t<decltype(arr[0])>;
             resTris.add_attr<T>(key) = arr;
@@ -2568,7 +2568,7 @@ static std::shared_ptr<PrimitiveObject> unfuse_primitive(std::shared_ptr<Primiti
         auto &resPolys = resPrim->polys;
         auto &resLoops = resPrim->loops;
 
-        resPolys.values = polys.values;
+        resPolys.values = polys.values.get();
         polys.foreach_attr<AttrAcceptAll>([&](const auto &key, const auto &arr) {
             using T = std::decay_t<decltype(arr[0])>;
             resPolys.add_attr<T>(key) = arr;
@@ -2579,7 +2579,7 @@ static std::shared_ptr<PrimitiveObject> unfuse_primitive(std::shared_ptr<Primiti
             resLoops.add_attr<T>(key) = arr;
         });
         // resLoops.values = loops.values;
-        pol(zip(polys.values, polyGroups), [&](zeno::vec2i poly, int groupNo) {
+        pol(zip(polys.values.mut(), polyGroups), [&](zeno::vec2i poly, int groupNo) {
             auto st = poly[0];
             auto ed = st + poly[1];
             for (; st != ed; ++st) {
@@ -2603,7 +2603,7 @@ static void assign_group_tag_to_verts(std::shared_ptr<PrimitiveObject> prim, std
     auto pol = omp_exec();
 
     auto &verts = prim->verts;
-    const auto &pos = verts.values;
+    const auto &pos = verts.values.get();
 
     auto &tris = prim->tris;
     const bool hasTris = tris.size() > 0;
@@ -2614,7 +2614,7 @@ static void assign_group_tag_to_verts(std::shared_ptr<PrimitiveObject> prim, std
     auto &vertGroups = prim->verts.add_attr<int>(tag);
 
     if (hasTris) {
-        const auto &triIds = tris.values;
+        const auto &triIds = tris.values.get();
         const auto &triGroups = tris.attr<int>(tag);
 
         pol(zs::zip(triIds, triGroups), [&vertGroups](auto tri, int groupNo) {
@@ -2624,10 +2624,10 @@ static void assign_group_tag_to_verts(std::shared_ptr<PrimitiveObject> prim, std
             }
         });
     } else {
-        const auto &loops = prim->loops.values;
+        const auto &loops = prim->loops.values.get();
         const auto &polyGroups = polys.attr<int>(tag);
 
-        pol(zs::zip(polys.values, polyGroups), [&vertGroups, &loops](zeno::vec2i poly, int groupNo) {
+        pol(zs::zip(polys.values.mut(), polyGroups), [&vertGroups, &loops](zeno::vec2i poly, int groupNo) {
             auto st = poly[0];
             auto ed = st + poly[1];
             for (; st != ed; ++st) {
@@ -2753,7 +2753,7 @@ struct MarkSelectedVerts : INode {
         auto pol = omp_exec();
 
         std::fill(std::begin(tags), std::end(tags), 0.f);
-        const auto &lines = markedLines->lines.values;
+        const auto &lines = markedLines->lines.values.get();
         pol(range(lines), [&tags](auto line) {
             tags[line[0]] = 1.f;
             tags[line[1]] = 1.f;
@@ -2925,7 +2925,7 @@ struct SurfacePointsInterpolation : INode {
         const auto refPrim = get_input<PrimitiveObject>("ref_prim");
         auto refAttrTag = get_input2<std::string>("refAttrTag");
 
-        const auto &refTris = refPrim->tris.values;
+        const auto &refTris = refPrim->tris.values.get();
         auto doWork = [&](const auto &srcAttr)
             -> std::enable_if_t<variant_contains<RM_CVREF_T(srcAttr[0]), AttrAcceptAll>::value> {
             using T = RM_CVREF_T(srcAttr[0]);
@@ -3309,16 +3309,16 @@ struct CollapseClusters : INode {
             auto pol = omp_exec();
             const auto &clusterIds = clusters->verts.attr<float>(clusterTag);
 
-            pol(pars->verts.values, [](auto &v) { v = zeno::vec3f(0, 0, 0); });
-            pol(zip(clusters->verts.values, clusterIds),
-                [&dstPos = pars->verts.values, &sizes](const auto &p, int clusterId) {
+            pol(pars->verts.values.mut(), [](auto &v) { v = zeno::vec3f(0, 0, 0); });
+            pol(zip(clusters->verts.values.mut(), clusterIds),
+                [&dstPos = pars->verts.values.mut(), &sizes](const auto &p, int clusterId) {
                     auto &dst = dstPos[clusterId];
                     for (int d = 0; d != 3; ++d)
                         atomic_add(exec_omp, &dst[d], p[d]);
                     atomic_add(exec_omp, &sizes[clusterId], 1);
                 });
 
-            pol(zip(pars->verts.values, sizes), [](auto &p, int sz) {
+            pol(zip(pars->verts.values.mut(), sizes), [](auto &p, int sz) {
                 if (sz > 0)
                     p /= (float)sz;
                 else
@@ -3347,9 +3347,9 @@ struct PrimitiveBFS : INode {
         constexpr auto space = execspace_e::openmp;
         auto pol = omp_exec();
         auto &pos = prim->attr<zeno::vec3f>("pos");
-        const auto &lines = prim->lines.values;
-        const auto &tris = prim->tris.values;
-        const auto &quads = prim->quads.values;
+        const auto &lines = prim->lines.values.get();
+        const auto &tris = prim->tris.values.get();
+        const auto &quads = prim->quads.values.get();
 
         using IV = zs::vec<int, 2>;
         zs::bht<int, 2, int, 16> tab{lines.size() * 2 + tris.size() * 3 + quads.size() * 4};
@@ -3458,9 +3458,9 @@ struct PrimitiveColoring : INode {
         constexpr auto space = execspace_e::openmp;
         auto pol = omp_exec();
         auto &pos = prim->attr<zeno::vec3f>("pos");
-        const auto &lines = prim->lines.values;
-        const auto &tris = prim->tris.values;
-        const auto &quads = prim->quads.values;
+        const auto &lines = prim->lines.values.get();
+        const auto &tris = prim->tris.values.get();
+        const auto &quads = prim->quads.values.get();
 
         using IV = zs::vec<int, 2>;
         zs::bht<int, 2, int, 16> tab{lines.size() * 2 + tris.size() * 3 + quads.size() * 4};
@@ -3659,7 +3659,7 @@ struct PrimitiveProject : INode {
         auto pol = omp_exec();
         auto &pos = prim->attr<zeno::vec3f>("pos");
         const auto &targetPos = targetPrim->attr<zeno::vec3f>("pos");
-        const auto &tris = targetPrim->tris.values;
+        const auto &tris = targetPrim->tris.values.get();
 
         bvh_t targetBvh;
         auto tBvs = retrieve_bounding_volumes(pol, targetPos, tris, 0.f);
@@ -3947,7 +3947,7 @@ struct FollowUpReferencePrimitive : INode {
         auto &ws = prim->attr<zeno::vec3f>(wsTag);
         auto refPrim = get_input2<PrimitiveObject>("ref_surf_prim");
         auto &refPos = refPrim->attr<vec3f>("pos");
-        auto &refTris = refPrim->tris.values;
+        auto &refTris = refPrim->tris.values.mut();
         auto pol = zs::omp_exec();
         pol(zs::range(prim->size()), [&](int i) {
             int triNo = ids[i];
@@ -4670,7 +4670,7 @@ struct PrimAssignRefAttrib : INode {
         };
 
         if (tag == "pos") {
-            assignAttrib(points->verts.values, prim->verts.values);
+            assignAttrib(points->verts.values.mut(), prim->verts.values.get());
         } else {
             zs::match([&verts = points->verts, &tag](const auto &src) {
                 verts.add_attr<RM_CVREF_T(src[0])>(tag);
@@ -4738,7 +4738,7 @@ struct ShuffleParticles : INode {
         auto prim = get_input2<PrimitiveObject>("prim");
         auto n = prim->size();
 
-        auto &pos = prim->verts.values;
+        auto &pos = prim->verts.values.mut();
         size_t m = std::max((int)n / 3, 1);
         zs::u64 sd = 1;
         for (int iter = 0; iter != m; ++iter) {
@@ -4791,13 +4791,13 @@ struct EmbedPrimitiveBvh : zeno::INode {
             bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), thickness);
             et = ZenoLinearBvh::point;
         } else if (primType == "line") {
-            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->lines.values, thickness);
+            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->lines.values.mut(), thickness);
             et = ZenoLinearBvh::curve;
         } else if (primType == "tri") {
-            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->tris.values, thickness);
+            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->tris.values.mut(), thickness);
             et = ZenoLinearBvh::surface;
         } else if (primType == "quad") {
-            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->quads.values, thickness);
+            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->quads.values.mut(), thickness);
             et = ZenoLinearBvh::tet;
         }
         if (!userData.has(bvhTag)) { // build
@@ -4848,13 +4848,13 @@ struct EmbedPrimitiveSpatialHash : zeno::INode {
             bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), thickness);
             et = ZenoSpatialHash::point;
         } else if (primType == "line") {
-            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->lines.values, thickness);
+            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->lines.values.mut(), thickness);
             et = ZenoSpatialHash::curve;
         } else if (primType == "tri") {
-            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->tris.values, thickness);
+            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->tris.values.mut(), thickness);
             et = ZenoSpatialHash::surface;
         } else if (primType == "quad") {
-            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->quads.values, thickness);
+            bvs = retrieve_bounding_volumes(pol, prim->attr<vec3f>("pos"), prim->quads.values.mut(), thickness);
             et = ZenoSpatialHash::tet;
         }
         if (!userData.has(shTag)) { // build
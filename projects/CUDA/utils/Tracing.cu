@@ -203,8 +203,8 @@ struct ComputeVertexAO : INode {
         // zs::AABBBox<3, float>
 
         auto allocator = get_temporary_memory_source(pol);
-        const auto &sceneTris = scene->tris.values;
-        const auto &scenePos = scene->verts.values;
+        const auto &sceneTris = scene->tris.values.get();
+        const auto &scenePos = scene->verts.values.get();
         zs::Vector<v3> pos{allocator, scenePos.size()};
         zs::Vector<i3> indices{allocator, sceneTris.size()};
         zs::copy(mem_device, (void *)pos.data(), (void *)scenePos.data(), sizeof(v3) * pos.size());
@@ -232,7 +232,7 @@ struct ComputeVertexAO : INode {
         auto zsbvh = sceneData.get<ZenoLinearBvh>(zs_bvh_tag); // std::shared_ptr<>
         auto &bvh = zsbvh->bvh;
 
-        const auto &hpos = prim->verts.values;
+        const auto &hpos = prim->verts.values.get();
         const auto &hnrms = prim->attr<vec3f>(nrmTag);
         zs::Vector<v3> xs{allocator, hpos.size()}, nrms{allocator, hpos.size()};
         zs::copy(mem_device, (void *)xs.data(), (void *)hpos.data(), sizeof(v3) * xs.size());
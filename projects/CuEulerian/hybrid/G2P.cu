@@ -215,7 +215,7 @@ struct ZSSparseGridAsParticles : INode {
         prim->resize(centers.size());
         std::memcpy(prim->verts.values.data(), centers.data(), sizeof(zeno::vec3f) * centers.size());
 #if 0
-        pol(zip(prim->verts.values, centers), [](auto &dst, const auto& src) {
+        pol(zip(prim->verts.values.mut(), centers), [](auto &dst, const auto& src) {
             dst = zeno::vec3f{src[0], src[1], src[2]};
         });
 #endif
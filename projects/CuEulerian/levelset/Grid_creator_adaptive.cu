@@ -272,7 +272,7 @@ struct ValidateAdaptiveGrid : INode {
       throw std::runtime_error("no sdf input detected.");
 
     auto points = get_input<PrimitiveObject>("points");
-    const auto &pos = points->verts.values;
+    const auto &pos = points->verts.values.get();
 
     auto pol = omp_exec();
     auto zsag = convert_floatgrid_to_adaptive_grid(
@@ -779,7 +779,7 @@ struct OceanCuCompute : zeno::INode {
                              });
 
         auto grid = std::make_shared<zeno::PrimitiveObject>(*ingrid);
-        auto &inpos = ingrid->verts.values;
+        auto &inpos = ingrid->verts.values.mut();
         auto &pos = grid->attr<vec3f>("pos");
         auto &fftpos = grid->add_attr<vec3f>("fftpos");
         auto &vel = grid->add_attr<vec3f>("vel");
@@ -146,9 +146,9 @@ struct PrimitiveToZSLevelSet : INode {
         const auto &pos = inParticles->attr<vec3f>("pos");
 
         std::size_t numEles = 0;
-        const auto &quads = inParticles->quads.values;
-        const auto &tris = inParticles->tris.values;
-        const auto &lines = inParticles->lines.values;
+        const auto &quads = inParticles->quads.values.get();
+        const auto &tris = inParticles->tris.values.get();
+        const auto &lines = inParticles->lines.values.get();
         if (quads.size())
             numEles = quads.size();
         else if (tris.size())
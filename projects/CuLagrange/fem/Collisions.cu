@@ -293,9 +293,9 @@ struct VisualizeBvh : INode {
 #endif
 
       prim->resize(8 * numExtractedBvs);
-      auto &pos = prim->verts.values;
+      auto &pos = prim->verts.values.mut();
       prim->lines.resize(12 * numExtractedBvs);
-      auto &lines = prim->lines.values;
+      auto &lines = prim->lines.values.mut();
 
       static_assert(sizeof(zeno::vec3f) == sizeof(zs::vec<float, 3>) &&
                         sizeof(zeno::vec2i) == sizeof(zs::vec<int, 2>),
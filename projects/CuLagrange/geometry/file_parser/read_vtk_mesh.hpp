@@ -104,7 +104,7 @@ namespace zeno {
         char buffer[INPUTLINESIZE];
 
         pos.resize(numberofpoints);
-        auto& verts = pos.values;
+        auto& verts = pos.values.mut();
         int nm_points_read = 0;
         bufferp = readline(buffer,fp,&line_count);
         if(bufferp == NULL){
@@ -201,7 +201,7 @@ namespace zeno {
         bool has_tris = prim->tris.size() > 0;
         if(has_quads){
             printf("OUTPUT QUADS TOPO\n");
-            bool success = write_cells_topology<4>(fp,prim->quads.values);
+            bool success = write_cells_topology<4>(fp,prim->quads.values.get());
             if(!success){
                 printf("Failed writing quad topos to %s\n",outfilename);
                 return return_and_close_file(fp,false);
@@ -213,7 +213,7 @@ namespace zeno {
             }
         }else if(has_tris){
             printf("OUTPUT TRIS TOPO\n");
-            bool success = write_cells_topology<3>(fp,prim->tris.values);
+            bool success = write_cells_topology<3>(fp,prim->tris.values.get());
             if(!success){
                 printf("Failed writing tris topos %s\n",outfilename);
                 return return_and_close_file(fp,false);
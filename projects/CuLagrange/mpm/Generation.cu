@@ -153,7 +153,7 @@ struct ToTrackerParticles : INode {
             outParticles->elements = typename ZenoParticles::particles_t{tags, eleSize, memsrc_e::host};
             auto &eles = outParticles->getQuadraturePoints();
 
-            auto &tris = inParticles->tris.values;
+            auto &tris = inParticles->tris.values.mut();
             ompExec(zs::range(eleSize),
                     [eles = proxy<execspace_e::host>({}, eles), &obj, &tris, velsPtr](size_t ei) mutable {
                         using vec3 = zs::vec<float, 3>;
@@ -1797,7 +1797,7 @@ struct ZSParticlesToPrimitiveObject : INode {
                 });
 
                 prim->lines.resize(numEle);
-                auto &lines = prim->lines.values;
+                auto &lines = prim->lines.values.mut();
                 copy(zs::mem_device, lines.data(), dst.data(), sizeof(zeno::vec2i) * numEle);
             } break;
             case ZenoParticles::surface: {
@@ -1808,7 +1808,7 @@ struct ZSParticlesToPrimitiveObject : INode {
                 });
 
                 prim->tris.resize(numEle);
-                auto &tris = prim->tris.values;
+                auto &tris = prim->tris.values.mut();
                 copy(zs::mem_device, tris.data(), dst.data(), sizeof(zeno::vec3i) * numEle);
             } break;
             case ZenoParticles::tet: {
@@ -1819,7 +1819,7 @@ struct ZSParticlesToPrimitiveObject : INode {
                 });
 
                 prim->quads.resize(numEle);
-                auto &quads = prim->quads.values;
+                auto &quads = prim->quads.values.mut();
                 copy(zs::mem_device, quads.data(), dst.data(), sizeof(zeno::vec4i) * numEle);
             } break;
             default: break;
@@ -115,6 +115,13 @@ struct FEMIntegrator : zeno::IObject {
     std::vector<double> _elmCharacteristicNorm;
 
     SpMat _connMatrix;
+    // the Hessian keeps the sparsity of _connMatrix, so its symbolic factorization
+    // (fill-reducing ordering and elimination tree) is done once per mesh
+    Eigen::SimplicialLDLT<SpMat> _LDLTSolver;
+    bool _LDLTAnalyzed = false;
+    // Newton directions of the iterative solver in the previous frame, one per
+    // Newton iteration, used as the initial guesses of the current frame
+    std::vector<VecXd> _cgWarmStarts;
 
     size_t _stepID;
 
@@ -153,6 +160,8 @@ struct FEMIntegrator : zeno::IObject {
         _connMatrix = SpMat(prim->size() * 3,prim->size() * 3);
         _connMatrix.setFromTriplets(connTriplets.begin(),connTriplets.end());
         _connMatrix.makeCompressed();
+        _LDLTAnalyzed = false;
+        _cgWarmStarts.clear();
 
         // _elmVolume.resize(nm_elms);
         _elmdFdx.resize(nm_elms);
@@ -475,7 +484,7 @@ struct FEMIntegrator : zeno::IObject {
 
             timer.tick();
 
-            AssembleElmVectors(shape->quads.values,derivBuffer,deriv);
+            AssembleElmVectors(shape->quads.values.get(),derivBuffer,deriv);
 
             // timer.tock("AssembleDeriv");
 
@@ -388,9 +388,6 @@ ZENDEFNODE(SolveFEMFast,{
 struct SolveFEM : zeno::INode {
     virtual void apply() override {
         // std::cout << "BEGIN SOLVER " << std::endl;
-        Eigen::SparseLU<SpMat> _LUSolver;
-        Eigen::SimplicialLDLT<SpMat> _LDLTSolver;
-
         auto integrator = get_input<FEMIntegrator>("integrator");
         auto shape = get_input<PrimitiveObject>("shape");
         auto elmView = get_input<PrimitiveObject>("elmView");
@@ -409,6 +406,9 @@ struct SolveFEM : zeno::INode {
         auto c2 = get_input2<float>("CurvatureCoeff");
         auto beta = get_input2<float>("BTL_shrinkingRate");
         auto epsilon = get_input2<float>("epsilon");
+        auto linear_solver = get_input2<std::string>("linearSolver");
+        auto max_cg_iters = get_input2<int>("maxCGIters");
+        auto cg_tol = get_input2<float>("cgTolerance");
 
         std::vector<Vec2d> wolfeBuffer;
         wolfeBuffer.resize(max_linesearch);
@@ -515,8 +515,31 @@ struct SolveFEM : zeno::INode {
             r *= -1;
 
             clock_t begin_solve = clock();
-            _LDLTSolver.compute(MatHelper::MapHMatrix(shape->size(),integrator->_connMatrix,HBuffer.data()));
-            dp = _LDLTSolver.solve(r);
+            auto H = MatHelper::MapHMatrix(shape->size(),integrator->_connMatrix,HBuffer.data());
+            if(linear_solver == "PCG"){
+                auto& warm_starts = integrator->_cgWarmStarts;
+                if(warm_starts.size() <= iter_idx)
+                    warm_starts.resize(iter_idx + 1);
+                auto& warm_start = warm_starts[iter_idx];
+                if(warm_start.size() == r.size())
+                    dp = warm_start;
+                else
+                    dp.setZero();
+                SolvePCG(H,r,dp,max_cg_iters,cg_tol);
+                // a stale guess may end in an ascent direction, start over from zero then
+                if(dp.dot(r) <= 0){
+                    dp.setZero();
+                    SolvePCG(H,r,dp,max_cg_iters,cg_tol);
+                }
+                warm_start = dp;
+            }else{
+                if(!integrator->_LDLTAnalyzed){
+                    integrator->_LDLTSolver.analyzePattern(integrator->_connMatrix);
+                    integrator->_LDLTAnalyzed = true;
+                }
+                integrator->_LDLTSolver.factorize(H);
+                dp = integrator->_LDLTSolver.solve(r);
+            }
             clock_t end_solve = clock();
 
             // std::cout << "INTERNAL SIZE : " << r.norm() << "\t" << dp.norm() << HBuffer.norm() << std::endl;
@@ -575,6 +598,79 @@ struct SolveFEM : zeno::INode {
 
     }
 
+    // conjugate gradient on the assembled Hessian H x = b, starting from the given x and
+    // preconditioned by the inverses of the 3x3 diagonal blocks of H. H is stored in
+    // full and symmetric, so column i doubles as row i and the product runs per row.
+    // stops when the residual drops below rel_tol * |b| or on non-positive curvature
+    static int SolvePCG(const Eigen::Map<const SpMat>& H,const VecXd& b,VecXd& x,int max_iters,FEM_Scaler rel_tol){
+        size_t nm_verts = b.size() / 3;
+
+        std::vector<Mat3x3d> blockInv(nm_verts);
+        #pragma omp parallel for
+        for(intptr_t v = 0;v < nm_verts;++v){
+            Mat3x3d block = Mat3x3d::Zero();
+            for(size_t k = 0;k < 3;++k)
+                for(Eigen::Map<const SpMat>::InnerIterator it(H,v * 3 + k);it;++it)
+                    if(it.row() / 3 == v)
+                        block(it.row() % 3,k) = it.value();
+            bool invertible = false;
+            block.computeInverseWithCheck(blockInv[v],invertible);
+            if(!invertible){
+                blockInv[v].setZero();
+                for(size_t k = 0;k < 3;++k)
+                    blockInv[v](k,k) = block(k,k) > 0 ? 1 / block(k,k) : 1;
+            }
+        }
+
+        auto multiply = [&](const VecXd& in,VecXd& out){
+            #pragma omp parallel for
+            for(intptr_t i = 0;i < in.size();++i){
+                FEM_Scaler sum = 0;
+                for(Eigen::Map<const SpMat>::InnerIterator it(H,i);it;++it)
+                    sum += it.value() * in[it.row()];
+                out[i] = sum;
+            }
+        };
+        auto precondition = [&](const VecXd& in,VecXd& out){
+            #pragma omp parallel for
+            for(intptr_t v = 0;v < nm_verts;++v)
+                out.segment<3>(v * 3) = blockInv[v] * in.segment<3>(v * 3);
+        };
+
+        VecXd res(b.size()),z(b.size()),p(b.size()),Hp(b.size());
+        multiply(x,Hp);
+        res = b - Hp;
+        FEM_Scaler b_norm = b.norm();
+        // a warm start further from the solution than zero is dropped
+        if(res.norm() > b_norm){
+            x.setZero();
+            res = b;
+        }
+        FEM_Scaler threshold = rel_tol * b_norm;
+        precondition(res,z);
+        p = z;
+        FEM_Scaler rz = res.dot(z);
+
+        int iter = 0;
+        for(;iter < max_iters && res.norm() > threshold;++iter){
+            multiply(p,Hp);
+            FEM_Scaler pHp = p.dot(Hp);
+            if(pHp <= 0){
+                if(iter == 0)
+                    x += z;
+                break;
+            }
+            FEM_Scaler alpha = rz / pHp;
+            x += alpha * p;
+            res -= alpha * Hp;
+            precondition(res,z);
+            FEM_Scaler rz_new = res.dot(z);
+            p = z + (rz_new / rz) * p;
+            rz = rz_new;
+        }
+        return iter;
+    }
+
     static void UpdateCurrentShape(std::shared_ptr<PrimitiveObject> prim,const VecXd& dp,double alpha){
         auto& cpos = prim->attr<zeno::vec3f>("curPos");
         for(size_t i = 0;i < prim->size();++i)
@@ -585,7 +681,7 @@ struct SolveFEM : zeno::INode {
 ZENDEFNODE(SolveFEM,{
     {"integrator","shape","elmView","skin",{"int","maxNRIters","10"},{"int","maxBTLs","10"},{"float","ArmijoCoeff","0.01"},
         {"float","CurvatureCoeff","0.9"},{"float","BTL_shrinkingRate","0.5"},
-        {"float","epsilon","1e-8"}
+        {"float","epsilon","1e-8"},{"enum LDLT PCG","linearSolver","LDLT"},{"int","maxCGIters","1000"},{"float","cgTolerance","1e-4"}
     },
     {"shape"},
     {},
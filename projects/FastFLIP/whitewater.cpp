@@ -31,7 +31,7 @@ struct WhitewaterSource : INode {
         auto &Solid_sdf = get_input<VDBFloatGrid>("SolidSDF")->m_grid;
         auto &Velocity = get_input<VDBFloat3Grid>("Velocity")->m_grid;
 
-        auto &par_pos = pars->verts.values;
+        auto &par_pos = pars->verts.values.mut();
         auto &par_vel = pars->add_attr<vec3f>("vel");
         auto &par_life = pars->add_attr<float>("life");
         // pars->verts.values.push_back(vec3f{});
@@ -219,7 +219,7 @@ struct WhitewaterSolver : INode {
 
         float dx = static_cast<float>(Liquid_sdf->voxelSize()[0]);
 
-        auto &par_pos = pars->verts.values;
+        auto &par_pos = pars->verts.values.mut();
         auto &par_vel = pars->attr<vec3f>("vel");
         auto &par_life = pars->attr<float>("life");
         auto &par_tarVel = pars->attr<vec3f>(TargetVelAttr);
@@ -83,7 +83,7 @@ struct ZGL_VboFromBuff : INode {
         vbo->create();
 
         auto buff = get_input<PrimitiveObject>("buff");
-        auto &arr = buff->verts.values;
+        auto &arr = buff->verts.values.mut();
         CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vbo->handle()));
         CHECK_GL(glBufferData(GL_ARRAY_BUFFER, arr.size() * sizeof(arr[0]), arr.data(), GL_STATIC_DRAW));
         CHECK_GL(glEnableVertexAttribArray(0));
@@ -33,7 +33,7 @@ struct QuadMesh : INode {
 
         std::set<std::pair<int, int>> marked_lines{};
         if (has_input("marked_lines")) {
-            const auto &markedLines = get_input<PrimitiveObject>("marked_lines")->lines.values;
+            const auto &markedLines = get_input<PrimitiveObject>("marked_lines")->lines.values.get();
             for (vec2i line : markedLines) {
                 marked_lines.insert(std::make_pair(line[0], line[1]));
             }
@@ -12,6 +12,11 @@
 #include <cmath>
 #include <zeno/utils/log.h>
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <sstream>
+#include <memory>
+#include <vector>
+#include <string>
 
 namespace zeno {
 
@@ -203,6 +208,142 @@ static void HSVtoRGB(float h, float s, float v, float &r, float &g, float &b)
 }
 
 
+// wraps the pixels of an image prim as a cv::Mat header, without copying;
+// OpenCV writes through it straight into verts
+static cv::Mat imageMat(PrimitiveObject *image) {
+    static_assert(sizeof(vec3f) == 3 * sizeof(float));
+    auto &ud = image->userData();
+    int w = ud.get2<int>("w");
+    int h = ud.get2<int>("h");
+    if (image->verts.size() != (size_t)w * h)
+        throw makeError("image has " + std::to_string(image->verts.size()) + " pixels, expect w * h");
+    return cv::Mat(h, w, CV_32FC3, image->verts.data());
+}
+
+// per-pixel operations on a run of pixels; alpha is null when the image has none
+struct PixelOp {
+    virtual void apply(vec3f *rgb, float *alpha, size_t n) const = 0;
+    virtual ~PixelOp() = default;
+};
+
+using PixelOpList = std::vector<std::unique_ptr<PixelOp>>;
+
+// runs all ops on one tile before moving to the next, so a chain of them
+// reads and writes each pixel once while it stays in cache
+static void applyPixelOps(PrimitiveObject *image, PixelOpList const &ops) {
+    constexpr size_t kTile = 4096;
+    size_t n = image->verts.size();
+    vec3f *rgb = image->verts.data();
+    float *alpha = image->has_attr("alpha") ? image->verts.attr<float>("alpha").data() : nullptr;
+    int ntiles = (n + kTile - 1) / kTile;
+#pragma omp parallel for
+    for (int t = 0; t < ntiles; t++) {
+        size_t b = t * kTile, e = std::min(n, b + kTile);
+        for (auto const &op: ops) {
+            op->apply(rgb + b, alpha ? alpha + b : nullptr, e - b);
+        }
+    }
+}
+
+static void applyPixelOp(PrimitiveObject *image, std::unique_ptr<PixelOp> op) {
+    PixelOpList ops;
+    ops.push_back(std::move(op));
+    applyPixelOps(image, ops);
+}
+
+struct LevelsOp : PixelOp {
+    std::string channel = "All";
+    float inputMin = 0, inputRange = 1, gammaCorrection = 1;
+    float outputMin = 0, outputRange = 1;
+    bool clamp = true;
+
+    float level(float v) const {
+        v = (v < inputMin) ? inputMin : v;
+        v = (v - inputMin) / inputRange;
+        v = std::pow(v, gammaCorrection) * outputRange + outputMin;
+        return clamp ? zeno::clamp(v, 0, 1) : v;
+    }
+
+    void apply(vec3f *rgb, float *alpha, size_t n) const override {
+        if (channel == "All") {
+            for (size_t i = 0; i < n; i++) {
+                rgb[i] = {level(rgb[i][0]), level(rgb[i][1]), level(rgb[i][2])};
+            }
+        } else if (channel != "A") {
+            int c = channel == "R" ? 0 : channel == "G" ? 1 : 2;
+            for (size_t i = 0; i < n; i++) {
+                rgb[i][c] = level(rgb[i][c]);
+            }
+        }
+        if (alpha && (channel == "All" || channel == "A")) {
+            for (size_t i = 0; i < n; i++) {
+                alpha[i] = level(alpha[i]);
+            }
+        }
+    }
+};
+
+struct EditHSVOp : PixelOp {
+    float H = 0, S = 1, V = 1;
+
+    void apply(vec3f *rgb, float *, size_t n) const override {
+        for (size_t i = 0; i < n; i++) {
+            float h = 0, s = 0, v = 0;
+            zeno::RGBtoHSV(rgb[i][0], rgb[i][1], rgb[i][2], h, s, v);
+            h = fmod(h + H, 360.0);
+            s = s * S;
+            v = v * V;
+            zeno::HSVtoRGB(h, s, v, rgb[i][0], rgb[i][1], rgb[i][2]);
+        }
+    }
+};
+
+struct ContrastOp : PixelOp {
+    float ratio = 1, center = 0.5f;
+
+    void apply(vec3f *rgb, float *, size_t n) const override {
+        for (size_t i = 0; i < n; i++) {
+            rgb[i] = rgb[i] + (rgb[i] - center) * (ratio - 1);
+        }
+    }
+};
+
+struct ClampOp : PixelOp {
+    std::string mode = "LimitValue";
+    float low = 0, up = 1;
+
+    void apply(vec3f *rgb, float *, size_t n) const override {
+        if (mode == "LimitValue") {
+            for (size_t i = 0; i < n; i++) {
+                rgb[i] = zeno::clamp(rgb[i], low, up);
+            }
+        } else {
+            float fill = mode == "White" ? 1 : 0;
+            for (size_t i = 0; i < n; i++) {
+                for (int j = 0; j < 3; j++) {
+                    if ((rgb[i][j] < low) || (rgb[i][j] > up))
+                        rgb[i][j] = fill;
+                }
+            }
+        }
+    }
+};
+
+struct InvertOp : PixelOp {
+    void apply(vec3f *rgb, float *, size_t n) const override {
+        for (size_t i = 0; i < n; i++) {
+            rgb[i] = 1 - rgb[i];
+        }
+    }
+};
+
+struct ColorOp : PixelOp {
+    vec3f color{1, 1, 1};
+
+    void apply(vec3f *rgb, float *, size_t n) const override {
+        std::fill(rgb, rgb + n, color);
+    }
+};
 /*struct ImageResize: INode {//TODO::FIX BUG
     void apply() override {
         std::shared_ptr<PrimitiveObject> image = get_input<PrimitiveObject>("image");
@@ -462,27 +603,11 @@ ZENDEFNODE(ImageHSV2RGB, {
 struct ImageEditHSV : INode {//TODO::FIX BUG
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        float H = 0, S = 0, V = 0;
-        float Hi = get_input2<float>("H");
-        float Si = get_input2<float>("S");
-        float Vi = get_input2<float>("V");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            float R = image->verts[i][0];
-            float G = image->verts[i][1];
-            float B = image->verts[i][2];
-            zeno::RGBtoHSV(R, G, B, H, S, V);
-            //S = S + (S - 0.5)*(Si-1);
-            //V = V + (V - 0.5)*(Vi-1);
-            //S = S + (Si - 1) * (S < 0.5 ? S : 1.0 - S);
-            //V = V + (Vi - 1) * (V < 0.5 ? V : 1.0 - V);
-            H = fmod(H + Hi, 360.0);
-            S = S * Si;
-            V = V * Vi;
-            zeno::HSVtoRGB(H, S, V, R, G, B);
-            image->verts[i][0] = R;
-            image->verts[i][1] = G;
-            image->verts[i][2] = B;
-        }
+        auto op = std::make_unique<EditHSVOp>();
+        op->H = get_input2<float>("H");
+        op->S = get_input2<float>("S");
+        op->V = get_input2<float>("V");
+        applyPixelOp(image.get(), std::move(op));
         set_output("image", image);
     }
 };
@@ -660,14 +785,8 @@ struct ImageBlur : INode {
             gaussBlur(image->verts, img_out->verts, w, h, sigmaX, 3);
         }
         else{//CV BLUR
-            cv::Mat imagecvin(h, w, CV_32FC3);
-            cv::Mat imagecvout(h, w, CV_32FC3);
-            for (auto a = 0; a < image->verts.size(); a++){
-                int i = a / w;
-                int j = a % w;
-                vec3f rgb = image->verts[i * w + j];
-                imagecvin.at<cv::Vec3f>(i, j) = {rgb[0], rgb[1], rgb[2]};
-            }
+            cv::Mat imagecvin = imageMat(image.get());
+            cv::Mat imagecvout = imageMat(img_out.get());
             if(kernelSize%2==0){
                 kernelSize += 1;
             }
@@ -691,12 +810,6 @@ struct ImageBlur : INode {
             else{
                 zeno::log_error("ImageBlur: Blur type does not exist");
             }
-            for (auto a = 0; a < image->verts.size(); a++){
-                int i = a / w;
-                int j = a % w;
-                cv::Vec3f rgb = imagecvout.at<cv::Vec3f>(i, j);
-                img_out->verts[i * w + j] = {rgb[0], rgb[1], rgb[2]};
-            }
         }
         set_output("image", img_out);
     }
@@ -721,14 +834,10 @@ ZENDEFNODE(ImageBlur, {
 struct ImageEditContrast : INode {
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        float ContrastRatio = get_input2<float>("ContrastRatio");
-        float ContrastCenter = get_input2<float>("ContrastCenter");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            image->verts[i] = image->verts[i] + (image->verts[i]-ContrastCenter) * (ContrastRatio-1);
-        }
+        auto op = std::make_unique<ContrastOp>();
+        op->ratio = get_input2<float>("ContrastRatio");
+        op->center = get_input2<float>("ContrastCenter");
+        applyPixelOp(image.get(), std::move(op));
         set_output("image", image);
     }
 };
@@ -748,9 +857,7 @@ ZENDEFNODE(ImageEditContrast, {
 struct ImageEditInvert : INode{
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            image->verts[i] = 1 - image->verts[i];
-        }
+        applyPixelOp(image.get(), std::make_unique<InvertOp>());
         set_output("image", image);
     }
 };
@@ -1029,25 +1136,9 @@ struct ImageDilate: INode {
         int strength = get_input2<int>("strength");
         int kheight = get_input2<int>("kernel_height");
         int kwidth = get_input2<int>("kernel_width");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
-        cv::Mat imagecvin(h, w, CV_32FC3);
-        cv::Mat imagecvout(h, w, CV_32FC3);
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                vec3f rgb = image->verts[i * w + j];
-                imagecvin.at<cv::Vec3f>(i, j) = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
-        const int kernelSize = 3;
-        dilateImage(imagecvin, imagecvout, kheight, kwidth, strength);
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                cv::Vec3f rgb = imagecvout.at<cv::Vec3f>(i, j);
-                image->verts[i * w + j] = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
+        // morphology filters run in place on the wrapped pixels
+        cv::Mat imagecv = imageMat(image.get());
+        dilateImage(imagecv, imagecv, kheight, kwidth, strength);
         set_output("image", image);
     }
 };
@@ -1109,27 +1200,9 @@ struct ImageErode: INode {
         int strength = get_input2<int>("strength");
         int kheight = get_input2<int>("kernel_height");
         int kwidth = get_input2<int>("kernel_width");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
-        cv::Mat imagecvin(h, w, CV_32FC3);
-        cv::Mat imagecvout(h, w, CV_32FC3);
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                vec3f rgb = image->verts[i * w + j];
-                imagecvin.at<cv::Vec3f>(i, j) = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
-
+        cv::Mat imagecv = imageMat(image.get());
         cv::Mat kernel = getStructuringElement(cv::MORPH_RECT, cv::Size(kheight, kwidth));
-        cv::erode(imagecvin, imagecvout, kernel,cv::Point(-1, -1), strength);
-
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                cv::Vec3f rgb = imagecvout.at<cv::Vec3f>(i, j);
-                image->verts[i * w + j] = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
+        cv::erode(imagecv, imagecv, kernel,cv::Point(-1, -1), strength);
         set_output("image", image);
     }
 };
@@ -1234,37 +1307,11 @@ ZENDEFNODE(ImageColor2, {
 struct ImageClamp: INode {//Add Unpremultiplied Space Option?
     void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        auto background = get_input2<std::string>("ClampedValue");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
-        auto up = get_input2<float>("Max");
-        auto low = get_input2<float>("Min");
-        if(background == "LimitValue"){
-        for (auto i = 0; i < image->verts.size(); i++) {
-            image->verts[i] = zeno::clamp(image->verts[i], low, up);
-            }
-        }
-        else if(background == "Black"){
-            for (auto i = 0; i < image->verts.size(); i++) {
-                vec3f &v = image->verts[i];
-                for(int j = 0; j < 3; j++){
-                    if((v[j]<low) || (v[j]>up)){
-                        v[j] = 0;
-                    }
-                }
-            }
-        }
-        else if(background == "White"){
-            for (auto i = 0; i < image->verts.size(); i++) {
-                vec3f &v = image->verts[i];
-                for(int j = 0; j < 3; j++){
-                    if((v[j]<low) || (v[j]>up)){
-                        v[j] = 1;
-                    }
-                }
-            }
-        }
+        auto op = std::make_unique<ClampOp>();
+        op->mode = get_input2<std::string>("ClampedValue");
+        op->up = get_input2<float>("Max");
+        op->low = get_input2<float>("Min");
+        applyPixelOp(image.get(), std::move(op));
 
         set_output("image", image);
     }
@@ -1585,75 +1632,19 @@ struct ImageLevels: INode {
                 v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
             }
         }
-        else if (channel == "All") {
-#pragma omp parallel for
-            for (int i = 0; i < w * h; i++) {
-                vec3f &v = image->verts[i];
-                v[0] = (v[0] < inputMin) ? inputMin : v[0];
-                v[1] = (v[1] < inputMin) ? inputMin : v[1];
-                v[2] = (v[2] < inputMin) ? inputMin : v[2];
-                v = (v - inputMin) / inputRange; 
-                v = pow(v, gammaCorrection);
-                v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
-            if(image->has_attr("alpha")){
-                auto &alphaAttr = image->verts.attr<float>("alpha");
-#pragma omp parallel for
-                for (int i = 0; i < w * h; i++) {
-                    alphaAttr[i] = (alphaAttr[i] < inputMin) ? inputMin : alphaAttr[i];
-                    alphaAttr[i] = (alphaAttr[i] - inputMin) / inputRange;
-                    alphaAttr[i] = pow(alphaAttr[i], gammaCorrection) * outputRange + outputMin;
-                    alphaAttr[i] = clamp ? zeno::clamp(alphaAttr[i], 0, 1) : alphaAttr[i];
-                }
-            }
+        else if (channel == "A" && !image->has_attr("alpha")) {
+            zeno::log_error("no alpha channel");
         }
-        else if (channel == "R") {
-#pragma omp parallel for
-        for (int i = 0; i < w * h; i++) {
-                float &v = image->verts[i][0];
-                if (v < inputMin) v = inputMin;
-                v = (v - inputMin) / inputRange;
-                v = pow(v, gammaCorrection);
-                v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
-        }
-
-        else if (channel == "G") {
-#pragma omp parallel for
-        for (int i = 0; i < w * h; i++) {
-                float &v = image->verts[i][1];
-                if (v < inputMin) v = inputMin;
-                v = (v - inputMin) / inputRange;
-                v = pow(v, gammaCorrection);
-                v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
-        }
-        
-        else if (channel == "B") {
-#pragma omp parallel for
-        for (int i = 0; i < w * h; i++) {
-                float &v = image->verts[i][2];
-                if (v < inputMin) v = inputMin;
-                v = (v - inputMin) / inputRange;
-                v = pow(v, gammaCorrection);
-                v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
-        }
-        
-        else if (channel == "A") {
-        if(image->has_attr("alpha")){
-            auto &alphaAttr = image->verts.attr<float>("alpha");
-#pragma omp parallel for
-            for (int i = 0; i < w * h; i++) {
-                alphaAttr[i] = (alphaAttr[i] < inputMin) ? inputMin : alphaAttr[i];
-                alphaAttr[i] = (alphaAttr[i] - inputMin) / inputRange;
-                alphaAttr[i] = pow(alphaAttr[i], gammaCorrection) * outputRange + outputMin;
-                alphaAttr[i] = clamp ? zeno::clamp(alphaAttr[i], 0, 1) : alphaAttr[i];
-                }
-            }
-            else{
-                zeno::log_error("no alpha channel");
-            }
+        else {
+            auto op = std::make_unique<LevelsOp>();
+            op->channel = channel;
+            op->inputMin = inputMin;
+            op->inputRange = inputRange;
+            op->gammaCorrection = gammaCorrection;
+            op->outputMin = outputMin;
+            op->outputRange = outputRange;
+            op->clamp = clamp;
+            applyPixelOp(image.get(), std::move(op));
         }
 
         set_output("image", image);
@@ -1676,6 +1667,84 @@ ZENDEFNODE(ImageLevels, {
     {"image"},
 });
 
+// a chain of per-pixel edits in a single pass over the image, one op per line:
+//   levels <in min> <in max> <gamma> <out min> <out max> [All|R|G|B|A] [clamp 0/1]
+//   hsv <hue shift> <saturation scale> <value scale>
+//   contrast <ratio> <center>
+//   clamp <min> <max> [LimitValue|Black|White]
+//   invert
+//   color <r> <g> <b>
+struct ImagePixelOps: INode {
+    static std::unique_ptr<PixelOp> parseOp(std::istringstream &ss, std::string const &name) {
+        auto expect = [&] (auto &val) {
+            if (!(ss >> val))
+                throw makeError("missing or bad argument for " + name);
+        };
+        if (name == "levels") {
+            auto op = std::make_unique<LevelsOp>();
+            float inMax, gamma, outMax;
+            expect(op->inputMin), expect(inMax), expect(gamma), expect(op->outputMin), expect(outMax);
+            op->inputRange = inMax - op->inputMin;
+            op->outputRange = outMax - op->outputMin;
+            op->gammaCorrection = 1.0f / gamma;
+            if (ss >> op->channel)
+                ss >> op->clamp;
+            if (op->channel != "All" && op->channel != "R" && op->channel != "G" && op->channel != "B" && op->channel != "A")
+                throw makeError("bad channel for levels: " + op->channel);
+            return op;
+        } else if (name == "hsv") {
+            auto op = std::make_unique<EditHSVOp>();
+            expect(op->H), expect(op->S), expect(op->V);
+            return op;
+        } else if (name == "contrast") {
+            auto op = std::make_unique<ContrastOp>();
+            expect(op->ratio), expect(op->center);
+            return op;
+        } else if (name == "clamp") {
+            auto op = std::make_unique<ClampOp>();
+            expect(op->low), expect(op->up);
+            ss >> op->mode;
+            if (op->mode != "LimitValue" && op->mode != "Black" && op->mode != "White")
+                throw makeError("bad mode for clamp: " + op->mode);
+            return op;
+        } else if (name == "invert") {
+            return std::make_unique<InvertOp>();
+        } else if (name == "color") {
+            auto op = std::make_unique<ColorOp>();
+            expect(op->color[0]), expect(op->color[1]), expect(op->color[2]);
+            return op;
+        }
+        throw makeError("unknown image op: " + name);
+    }
+
+    void apply() override {
+        auto image = get_input<PrimitiveObject>("image");
+        std::istringstream lines(get_input2<std::string>("ops"));
+        PixelOpList ops;
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream ss(line);
+            std::string name;
+            if (!(ss >> name) || name[0] == '#')
+                continue;
+            ops.push_back(parseOp(ss, name));
+        }
+        applyPixelOps(image.get(), ops);
+        set_output("image", image);
+    }
+};
+ZENDEFNODE(ImagePixelOps, {
+    {
+        {"image"},
+        {"multiline_string", "ops", "levels 0 1 1 0 1\nclamp 0 1"},
+    },
+    {
+        {"image"},
+    },
+    {},
+    {"image"},
+});
+
 struct ImageQuantization: INode {
     void apply() override {
         std::shared_ptr<PrimitiveObject> image = get_input<PrimitiveObject>("image");
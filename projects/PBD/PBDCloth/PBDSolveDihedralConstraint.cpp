@@ -1,6 +1,7 @@
 #include <zeno/zeno.h>
 #include <zeno/types/PrimitiveObject.h>
 #include "../Utils/myPrint.h"
+#include "../Utils/constraintColoring.h"
 #include <zeno/types/UserData.h>
 
 using namespace zeno;
@@ -36,7 +37,10 @@ struct PBDSolveDihedralConstraint : zeno::INode {
     }
 
     /**
-     * @brief 对所有的点求解二面角约束
+     * @brief 对所有的点求解二面角约束。每个三角面的每条边对应一个约束（若有邻接面）。
+     * Gauss-Seidel方式下，并行时按图着色的批次求解，同一批次的约束不共享顶点；
+     * 不并行时按三角面的编号串行求解。
+     * Jacobi方式下，所有约束用同一份位置求修正值，累加到dpos，每个点取其修正值的平均。
      * 
      * @param prim 所传入的所有数据
      */
@@ -52,38 +56,71 @@ struct PBDSolveDihedralConstraint : zeno::INode {
         auto &invMass = prim->verts.attr<float>("invMass");
         float dihedralCompliance = prim->userData().getLiterial<float>("dihedralCompliance");
         float dt = prim->userData().getLiterial<float>("dt");
-        float isGaussSidel = prim->userData().getLiterial<bool>("isGaussSidel");
+        bool isGaussSidel = prim->userData().getLiterial<bool>("isGaussSidel");
+        bool parallel = prim->userData().getLiterial<bool>("parallel");
+
+        //约束c对应第c/3个三角面的第c%3条边。注意顺序要按照Muller2006论文中的Fig4。1-2是共享边。3是自己的点，4是对方的点。
+        auto constraintIds = [&] (int c) {
+            int i = c / 3;
+            return vec4i{tris[i][0], tris[i][1], tris[i][2], adj4th[i][c % 3]};
+        };
+        //这里只传入需要的四个点的数据，求解得到4个dpos
+        auto correction = [&] (int c, vec4i const &id, std::array<vec3f,4> & dpos4p) {
+            vec4f invMass4p{invMass[id[0]],invMass[id[1]],invMass[id[2]],invMass[id[3]]}; //4个点的invMass
+            float restAng4p{restAng[c / 3][c % 3]}; // 四个点的原角度
+            std::array<vec3f,4>  pos4p{pos[id[0]],pos[id[1]],pos[id[2]],pos[id[3]]}; 
+            dpos4p = {vec3f{0.0,0.0,0.0},vec3f{0.0,0.0,0.0},vec3f{0.0,0.0,0.0},vec3f{0.0,0.0,0.0}}; //四个点的dpos，也就是待求解的对pos的修正值。
+            dihedralConstraint(pos4p, invMass4p, restAng4p, dihedralCompliance, dt,  dpos4p);
+        };
+        //高斯赛德尔法在原地修正pos
+        auto solveGaussSidel = [&] (int c) {
+            auto id = constraintIds(c);
+            std::array<vec3f,4> dpos4p;
+            correction(c, id, dpos4p);
+            for (size_t j = 0; j < 4; j++)
+            {
+                dpos[id[j]] = dpos4p[j];
+                pos[id[j]] += dpos4p[j];
+            }
+        };
 
-        for (int i = 0; i < tris.size(); i++) //对所有三角面
+        int ncons = tris.size() * 3;
+        if (isGaussSidel && !parallel)
         {
-            for(int k=0; k<3; k++) //三个边，对应着三个邻接面
+            for (int c = 0; c < ncons; c++) //对所有三角面的三个边
+                if (adj4th[c / 3][c % 3] != -1) //如果编号为-1，证明没有这个邻接面
+                    solveGaussSidel(c);
+            return;
+        }
+
+        int nverts = pos.size();
+        auto coloring = cachedColoring(prim, "dihedralColoring", constraintStamp(nverts, tris.values.get(), adj4th), [&] {
+            return colorConstraints(nverts, ncons, constraintIds);
+        });
+
+        if (isGaussSidel)
+        {
+            coloring->forEachColor(solveGaussSidel);
+            return;
+        }
+
+        //Jacobi：同一批次的约束不共享顶点，累加修正值时无需原子操作
+        std::vector<int> cnt(nverts, 0);
+        std::fill(dpos.begin(), dpos.end(), vec3f{0.0,0.0,0.0});
+        coloring->forEachColor([&] (int c) {
+            auto id = constraintIds(c);
+            std::array<vec3f,4> dpos4p;
+            correction(c, id, dpos4p);
+            for (size_t j = 0; j < 4; j++)
             {
-                int id4 = adj4th[i][k]; //取出第四个点编号
-                if (id4 == -1) //如果编号为-1，证明没有这个邻接面
-                    continue;
-
-                //对四个点进行求解。注意顺序要按照Muller2006论文中的Fig4。1-2是共享边。3是自己的点，4是对方的点。
-                int id1 = tris[i][0];
-                int id2 = tris[i][1];
-                int id3 = tris[i][2];
-                vec4i id{id1,id2,id3,id4};
-
-                vec4f invMass4p{invMass[id[0]],invMass[id[1]],invMass[id[2]],invMass[id[3]]}; //4个点的invMass
-                float restAng4p{restAng[i][k]}; // 四个点的原角度
-                std::array<vec3f,4>  pos4p{pos[id[0]],pos[id[1]],pos[id[2]],pos[id[3]]}; 
-                std::array<vec3f,4>  dpos4p{vec3f{0.0,0.0,0.0},vec3f{0.0,0.0,0.0},vec3f{0.0,0.0,0.0},vec3f{0.0,0.0,0.0}}; //四个点的dpos，也就是待求解的对pos的修正值。
-
-                //这里只传入需要的四个点的数据，求解得到4个dpos
-                dihedralConstraint(pos4p, invMass4p, restAng4p, dihedralCompliance, dt,  dpos4p);
-
-                for (size_t j = 0; j < 4; j++)
-                    dpos[id[j]] = dpos4p[j];
-
-                if (isGaussSidel) //高斯赛德尔法在原地修正pos
-                    for (size_t j = 0; j < 4; j++)
-                        pos[id[j]] += dpos[j];
+                dpos[id[j]] += dpos4p[j];
+                cnt[id[j]]++;
             }
-        }
+        });
+        parallel_for(nverts, [&] (int v) {
+            if (cnt[v])
+                pos[v] += dpos[v] / (float)cnt[v];
+        });
     }
 
 
@@ -155,6 +192,8 @@ public:
         auto dihedralCompliance = get_input<zeno::NumericObject>("dihedralCompliance")->get<float>();
         auto isGaussSidel = get_input<zeno::NumericObject>("isGaussSidel")->get<bool>();
         prim->userData().set("isGaussSidel", std::make_shared<NumericObject>((bool)isGaussSidel));
+        auto parallel = get_input2<bool>("parallel");
+        prim->userData().set("parallel", std::make_shared<NumericObject>((bool)parallel));
         prim->userData().set("dihedralCompliance", std::make_shared<NumericObject>((float)dihedralCompliance));
         
         auto dt = prim->userData().getLiterial<float>("dt");
@@ -172,6 +211,7 @@ ZENDEFNODE(PBDSolveDihedralConstraint, {// inputs:
                     {"PrimitiveObject", "prim"},
                     {"float", "dihedralCompliance", "0.0"},
                     {"bool", "isGaussSidel", "1"},
+                    {"bool", "parallel", "1"},
                 },
                  // outputs:
                  {"outPrim"},
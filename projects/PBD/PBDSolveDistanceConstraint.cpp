@@ -1,20 +1,60 @@
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/zeno.h>
 #include <zeno/types/UserData.h>
+#include "Utils/constraintColoring.h"
 #include <iostream>
 
 namespace zeno {
 struct PBDSolveDistanceConstraint : zeno::INode {
 private:
     /**
-     * @brief 求解PBD所有边约束（也叫距离约束）。目前采用Gauss-Seidel方式（难以并行）。
+     * @brief 求解一条边约束，得到两个端点的位置修正值。
      * 
      * @param pos 点位置
+     * @param id0 端点0
+     * @param id1 端点1
+     * @param invMass 点质量的倒数
+     * @param restLen 边的原长
+     * @param alpha 柔度除以dt平方
+     * @param dpos0 端点0的修正值，是返回值
+     * @param dpos1 端点1的修正值，是返回值
+     */
+    void edgeCorrection(
+        const zeno::AttrVector<zeno::vec3f> &pos,
+        int id0, int id1,
+        const std::vector<float> & invMass,
+        float restLen,
+        float alpha,
+        zeno::vec3f &dpos0,
+        zeno::vec3f &dpos1
+        )
+    {
+        zeno::vec3f grad = pos[id0] - pos[id1];
+        float Len = length(grad);
+        grad /= Len;
+        float C = Len - restLen;
+        float w = invMass[id0] + invMass[id1];
+        float s = -C / (w + alpha);
+
+        dpos0 = grad *   s * invMass[id0];
+        dpos1 = grad * (-s * invMass[id1]);
+    }
+
+    /**
+     * @brief 求解PBD所有边约束（也叫距离约束）。
+     * Gauss-Seidel方式下，并行时按图着色的批次求解，同一批次的边不共享顶点；
+     * 不并行时按边的编号串行求解。
+     * Jacobi方式下，所有边用同一份位置求修正值，每个点取其修正值的平均。
+     * 
+     * @param prim 物体，用于缓存边的着色
+     * @param pos 点位置
      * @param edge 边连接关系
      * @param invMass 点质量的倒数
      * @param restLen 边的原长
      * @param disntanceCompliance 柔度（越小约束越强，最小为0）
      * @param dt 时间步长
+     * @param isGaussSidel 是否使用Gauss-Seidel方式，否则使用Jacobi方式
+     * @param parallel Gauss-Seidel方式下是否按着色并行
      */
     void solveDistanceConstraint( 
         PrimitiveObject * prim,
@@ -23,26 +63,51 @@ private:
         const std::vector<float> & invMass,
         const std::vector<float> & restLen,
         const float disntanceCompliance,
-        const float dt
+        const float dt,
+        const bool isGaussSidel,
+        const bool parallel
         )
     {
         float alpha = disntanceCompliance / dt / dt;
-        zeno::vec3f grad{0, 0, 0};
-        for (int i = 0; i < edge.size(); i++) 
-        {
+        auto solveEdge = [&] (int i) {
             int id0 = edge[i][0];
             int id1 = edge[i][1];
+            zeno::vec3f dpos0, dpos1;
+            edgeCorrection(pos, id0, id1, invMass, restLen[i], alpha, dpos0, dpos1);
+            pos[id0] += dpos0;
+            pos[id1] += dpos1;
+        };
+        if (isGaussSidel && !parallel) {
+            for (int i = 0; i < edge.size(); i++) 
+                solveEdge(i);
+            return;
+        }
 
-            grad = pos[id0] - pos[id1];
-            float Len = length(grad);
-            grad /= Len;
-            float C = Len - restLen[i];
-            float w = invMass[id0] + invMass[id1];
-            float s = -C / (w + alpha);
+        int nverts = pos.size();
+        auto coloring = cachedColoring(prim, "edgeColoring", constraintStamp(nverts, edge.values.get()), [&] {
+            return colorConstraints(nverts, edge.size(), [&] (int i) { return edge[i]; });
+        });
 
-            pos[id0] += grad *   s * invMass[id0];
-            pos[id1] += grad * (-s * invMass[id1]);
+        if (isGaussSidel) {
+            coloring->forEachColor(solveEdge);
+            return;
         }
+
+        // Jacobi：同一批次的边不共享顶点，累加修正值时无需原子操作
+        std::vector<zeno::vec3f> dpos(nverts, zeno::vec3f(0, 0, 0));
+        std::vector<int> cnt(nverts, 0);
+        coloring->forEachColor([&] (int i) {
+            int id0 = edge[i][0];
+            int id1 = edge[i][1];
+            zeno::vec3f dpos0, dpos1;
+            edgeCorrection(pos, id0, id1, invMass, restLen[i], alpha, dpos0, dpos1);
+            dpos[id0] += dpos0, cnt[id0]++;
+            dpos[id1] += dpos1, cnt[id1]++;
+        });
+        parallel_for(nverts, [&] (int v) {
+            if (cnt[v])
+                pos[v] += dpos[v] / (float)cnt[v];
+        });
     }
 
 
@@ -52,6 +117,8 @@ public:
         auto prim = get_input<PrimitiveObject>("prim");
 
         auto disntanceCompliance = get_input<zeno::NumericObject>("disntanceCompliance")->get<float>();
+        auto isGaussSidel = get_input2<bool>("isGaussSidel");
+        auto parallel = get_input2<bool>("parallel");
 
         float dt = prim->userData().getLiterial<float>("dt");
 
@@ -61,7 +128,7 @@ public:
         auto &invMass = prim->verts.attr<float>("invMass");
 
         //solve distance constraint
-        solveDistanceConstraint(prim.get(), pos, edge, invMass, restLen, disntanceCompliance, dt);
+        solveDistanceConstraint(prim.get(), pos, edge, invMass, restLen, disntanceCompliance, dt, isGaussSidel, parallel);
 
         //output
         set_output("outPrim", std::move(prim));
@@ -71,7 +138,9 @@ public:
 ZENDEFNODE(PBDSolveDistanceConstraint, {// inputs:
                  {
                     {"PrimitiveObject", "prim"},
-                    {"float", "disntanceCompliance", "100.0"}
+                    {"float", "disntanceCompliance", "100.0"},
+                    {"bool", "isGaussSidel", "1"},
+                    {"bool", "parallel", "1"},
                 },
                  // outputs:
                  {"outPrim"},
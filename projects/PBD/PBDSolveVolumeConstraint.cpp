@@ -1,55 +1,121 @@
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/zeno.h>
 #include <zeno/types/UserData.h>
+#include "Utils/constraintColoring.h"
 
 namespace zeno {
 struct PBDSolveVolumeConstraint : zeno::INode {
 private:
     /**
-     * @brief 求解PBD所有体积约束。目前采用Gauss-Seidel方式（难以并行）。
+     * @brief 求解一个四面体的体积约束，得到四个顶点的位置修正值。
      * 
      * @param pos 点位置
      * @param tet 四面体的四个顶点连接关系
+     * @param i 四面体编号
+     * @param alphaVol 柔度除以dt平方
+     * @param restVol 原体积
+     * @param invMass 点质量的倒数
+     * @param dpos 四个顶点的修正值，是返回值
+     */
+    void tetCorrection(
+        const zeno::AttrVector<zeno::vec3f> &pos,
+        const zeno::AttrVector<zeno::vec4i> &tet,
+        int i,
+        const float alphaVol,
+        const std::vector<float> & restVol,
+        const std::vector<float> & invMass,
+        vec3f dpos[4]
+                    )
+    {
+        vec3f grad[4] = {vec3f(0,0,0), vec3f(0,0,0), vec3f(0,0,0), vec3f(0,0,0)};
+        vec4i id{-1,-1,-1,-1};
+
+        for (int j = 0; j < 4; j++)
+            id[j] = tet[i][j];
+        
+        grad[0] = cross((pos[id[3]] - pos[id[1]]), (pos[id[2]] - pos[id[1]]));
+        grad[1] = cross((pos[id[2]] - pos[id[0]]), (pos[id[3]] - pos[id[0]]));
+        grad[2] = cross((pos[id[3]] - pos[id[0]]), (pos[id[1]] - pos[id[0]]));
+        grad[3] = cross((pos[id[1]] - pos[id[0]]), (pos[id[2]] - pos[id[0]]));
+
+        float w = 0.0;
+        for (int j = 0; j < 4; j++)
+            w += invMass[id[j]] * (length(grad[j])) * (length(grad[j])) ;
+
+        float vol = tetVolume(pos, tet, i);
+        float C = (vol - restVol[i]) * 6.0;
+        float s = -C /(w + alphaVol);
+        
+        for (int j = 0; j < 4; j++)
+            dpos[j] = grad[j] * s * invMass[id[j]];
+    }
+
+    /**
+     * @brief 求解PBD所有体积约束。
+     * Gauss-Seidel方式下，并行时按图着色的批次求解，同一批次的四面体不共享顶点；
+     * 不并行时按四面体的编号串行求解。
+     * Jacobi方式下，所有四面体用同一份位置求修正值，每个点取其修正值的平均。
+     * 
+     * @param prim 物体，用于缓存四面体的着色
+     * @param pos 点位置
+     * @param tet 四面体的四个顶点连接关系
      * @param volumeCompliance 柔度（越小约束越强，最小为0）
      * @param dt 时间步长
      * @param restVol 原体积
      * @param invMass 点质量的倒数
+     * @param isGaussSidel 是否使用Gauss-Seidel方式，否则使用Jacobi方式
+     * @param parallel Gauss-Seidel方式下是否按着色并行
      */
     void solveVolumeConstraint(
+        PrimitiveObject * prim,
         zeno::AttrVector<zeno::vec3f> &pos,
         const zeno::AttrVector<zeno::vec4i> &tet,
         const float volumeCompliance,
         const float dt,
         const std::vector<float> & restVol,
-        const std::vector<float> & invMass
+        const std::vector<float> & invMass,
+        const bool isGaussSidel,
+        const bool parallel
                     )
     {
         float alphaVol = volumeCompliance / dt / dt;
-        vec3f grad[4] = {vec3f(0,0,0), vec3f(0,0,0), vec3f(0,0,0), vec3f(0,0,0)};
-
-        for (int i = 0; i < tet.size(); i++)
-        {
-            vec4i id{-1,-1,-1,-1};
-
+        auto solveTet = [&] (int i) {
+            vec3f dpos[4];
+            tetCorrection(pos, tet, i, alphaVol, restVol, invMass, dpos);
             for (int j = 0; j < 4; j++)
-                id[j] = tet[i][j];
-            
-            grad[0] = cross((pos[id[3]] - pos[id[1]]), (pos[id[2]] - pos[id[1]]));
-            grad[1] = cross((pos[id[2]] - pos[id[0]]), (pos[id[3]] - pos[id[0]]));
-            grad[2] = cross((pos[id[3]] - pos[id[0]]), (pos[id[1]] - pos[id[0]]));
-            grad[3] = cross((pos[id[1]] - pos[id[0]]), (pos[id[2]] - pos[id[0]]));
-
-            float w = 0.0;
-            for (int j = 0; j < 4; j++)
-                w += invMass[id[j]] * (length(grad[j])) * (length(grad[j])) ;
+                pos[tet[i][j]] += dpos[j];
+        };
+        if (isGaussSidel && !parallel) {
+            for (int i = 0; i < tet.size(); i++)
+                solveTet(i);
+            return;
+        }
 
-            float vol = tetVolume(pos, tet, i);
-            float C = (vol - restVol[i]) * 6.0;
-            float s = -C /(w + alphaVol);
-            
-            for (int j = 0; j < 4; j++)
-                pos[id[j]] += grad[j] * s * invMass[id[j]];
+        int nverts = pos.size();
+        auto coloring = cachedColoring(prim, "tetColoring", constraintStamp(nverts, tet.values.get()), [&] {
+            return colorConstraints(nverts, tet.size(), [&] (int i) { return tet[i]; });
+        });
+
+        if (isGaussSidel) {
+            coloring->forEachColor(solveTet);
+            return;
         }
+
+        // Jacobi：同一批次的四面体不共享顶点，累加修正值时无需原子操作
+        std::vector<vec3f> dposSum(nverts, vec3f(0, 0, 0));
+        std::vector<int> cnt(nverts, 0);
+        coloring->forEachColor([&] (int i) {
+            vec3f dpos[4];
+            tetCorrection(pos, tet, i, alphaVol, restVol, invMass, dpos);
+            for (int j = 0; j < 4; j++) {
+                dposSum[tet[i][j]] += dpos[j];
+                cnt[tet[i][j]]++;
+            }
+        });
+        parallel_for(nverts, [&] (int v) {
+            if (cnt[v])
+                pos[v] += dposSum[v] / (float)cnt[v];
+        });
     }
 
     /**
@@ -60,7 +126,7 @@ private:
      * @param i 四面体编号
      * @return float 四面体体积
      */
-    float tetVolume(zeno::AttrVector<zeno::vec3f> &pos,
+    float tetVolume(const zeno::AttrVector<zeno::vec3f> &pos,
                     const zeno::AttrVector<zeno::vec4i> &tet,
                     int i)
     {
@@ -80,6 +146,8 @@ public:
         auto prim = get_input<PrimitiveObject>("prim");
 
         auto volumeCompliance = get_input<zeno::NumericObject>("volumeCompliance")->get<float>();
+        auto isGaussSidel = get_input2<bool>("isGaussSidel");
+        auto parallel = get_input2<bool>("parallel");
         float dt = prim->userData().getLiterial<float>("dt");
 
         auto &pos = prim->verts;
@@ -88,7 +156,7 @@ public:
         auto &invMass = prim->verts.attr<float>("invMass");
 
         // solve
-        solveVolumeConstraint(pos, tet, volumeCompliance, dt, restVol, invMass);
+        solveVolumeConstraint(prim.get(), pos, tet, volumeCompliance, dt, restVol, invMass, isGaussSidel, parallel);
 
         // output
         set_output("outPos", std::move(prim));
@@ -98,7 +166,9 @@ public:
 ZENDEFNODE(PBDSolveVolumeConstraint, {// inputs:
                  {
                     {"PrimitiveObject", "prim"},
-                    {"float", "volumeCompliance", "0.0"}
+                    {"float", "volumeCompliance", "0.0"},
+                    {"bool", "isGaussSidel", "1"},
+                    {"bool", "parallel", "1"},
                 },
                  // outputs:
                  {"outPos"},
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/para/parallel_for.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+/**
+ * @brief 约束的图着色结果。同一颜色内的约束两两不共享顶点，因此可以并行求解。
+ * 颜色c的约束编号为 order[colorStart[c]] 到 order[colorStart[c + 1] - 1]，按编号升序。
+ */
+struct ConstraintColoring {
+    std::uint64_t stamp = 0; // 着色所依据的约束拓扑的哈希，见constraintStamp
+    std::vector<int> colorStart;
+    std::vector<int> order;
+
+    int numColors() const {
+        return colorStart.empty() ? 0 : (int)colorStart.size() - 1;
+    }
+
+    /**
+     * @brief 按颜色依次求解：每种颜色内部并行调用 f(约束编号)，颜色之间串行。
+     */
+    template <class F>
+    void forEachColor(F const &f) const {
+        for (int c = 0; c < numColors(); c++) {
+            parallel_for(colorStart[c], colorStart[c + 1], [&] (int i) {
+                f(order[i]);
+            });
+        }
+    }
+};
+
+/**
+ * @brief 约束拓扑的哈希（含顶点数），用来判断缓存的着色是否过期。
+ *
+ * @param nverts 顶点数
+ * @param arrs 约束的顶点编号数组，如lines、quads
+ */
+template <class ...Ts>
+std::uint64_t constraintStamp(int nverts, std::vector<Ts> const &...arrs) {
+    std::uint64_t h = (std::uint64_t)nverts;
+    auto combine = [&] (auto const &arr) {
+        constexpr int kBlock = 1 << 16;
+        auto words = reinterpret_cast<std::uint32_t const *>(arr.data());
+        std::size_t n = arr.size() * sizeof(arr[0]) / sizeof(std::uint32_t);
+        std::vector<std::uint64_t> blockHash((n + kBlock - 1) / kBlock);
+        parallel_for(blockHash.size(), [&] (std::size_t b) {
+            std::uint64_t bh = 0xcbf29ce484222325ull;
+            for (std::size_t i = b * kBlock, ie = std::min(n, i + kBlock); i < ie; i++)
+                bh = (bh ^ words[i]) * 0x100000001b3ull;
+            blockHash[b] = bh;
+        }, 1);
+        h ^= n + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        for (auto bh: blockHash)
+            h ^= bh + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    };
+    (combine(arrs), ...);
+    return h;
+}
+
+/**
+ * @brief 贪心着色：按编号顺序给每个约束分配其顶点上尚未用过的最小颜色。
+ * 每轮用64位掩码处理64种颜色，本轮分不到颜色的约束留到下一轮。
+ *
+ * @param nverts 顶点数
+ * @param ncons 约束数
+ * @param getIds getIds(i)返回约束i的顶点编号（定长数组），编号为-1的约束不参与求解
+ */
+template <class GetIds>
+std::shared_ptr<ConstraintColoring> colorConstraints(int nverts, int ncons, GetIds const &getIds) {
+    auto coloring = std::make_shared<ConstraintColoring>();
+    std::vector<int> pending;
+    pending.reserve(ncons);
+    for (int i = 0; i < ncons; i++) {
+        auto ids = getIds(i);
+        if (std::find(std::begin(ids), std::end(ids), -1) == std::end(ids))
+            pending.push_back(i);
+    }
+
+    std::vector<std::uint64_t> used(nverts);
+    std::vector<int> color(ncons, -1);
+    std::vector<int> count;
+    for (int round = 0; !pending.empty(); round++) {
+        std::fill(used.begin(), used.end(), 0);
+        count.resize(count.size() + 64);
+        std::vector<int> deferred;
+        for (int i: pending) {
+            auto ids = getIds(i);
+            std::uint64_t mask = 0;
+            for (int v: ids)
+                mask |= used[v];
+            if (!~mask) {
+                deferred.push_back(i);
+                continue;
+            }
+            int bit = 0;
+            while (mask >> bit & 1)
+                bit++;
+            for (int v: ids)
+                used[v] |= std::uint64_t(1) << bit;
+            color[i] = round * 64 + bit;
+            count[color[i]]++;
+        }
+        pending.swap(deferred);
+    }
+    while (!count.empty() && !count.back())
+        count.pop_back();
+
+    auto &colorStart = coloring->colorStart;
+    colorStart.assign(count.size() + 1, 0);
+    for (std::size_t c = 0; c < count.size(); c++)
+        colorStart[c + 1] = colorStart[c] + count[c];
+    coloring->order.resize(colorStart.back());
+    auto fill = colorStart;
+    for (int i = 0; i < ncons; i++) {
+        if (color[i] != -1)
+            coloring->order[fill[color[i]]++] = i;
+    }
+    return coloring;
+}
+
+/**
+ * @brief 取缓存在prim->coloringCache中的着色，约束拓扑变化（stamp不同）时重新着色。
+ * 缓存随shared_clone和拷贝共享，不经过userData，因此不会被复制到别的物体上。
+ *
+ * @param prim 物体
+ * @param key 缓存名，不同种类的约束用不同的名字
+ * @param stamp 当前约束拓扑的哈希，见constraintStamp
+ * @param build 重新着色的函数，返回std::shared_ptr<ConstraintColoring>
+ */
+template <class Build>
+std::shared_ptr<ConstraintColoring const> cachedColoring(PrimitiveObject const *prim, std::string const &key, std::uint64_t stamp, Build const &build) {
+    auto cache = std::atomic_load(&prim->coloringCache);
+    if (cache) {
+        if (auto it = cache->find(key); it != cache->end() && it->second->stamp == stamp)
+            return it->second;
+    }
+    std::shared_ptr<ConstraintColoring> coloring = build();
+    coloring->stamp = stamp;
+    // 缓存的表不原地修改，换成新表后再发布，与并发的读者和shared_clone互不干扰
+    using Cache = std::map<std::string, std::shared_ptr<ConstraintColoring const>>;
+    auto next = cache ? std::make_shared<Cache>(*cache) : std::make_shared<Cache>();
+    (*next)[key] = coloring;
+    std::atomic_store(&prim->coloringCache, std::shared_ptr<Cache const>(std::move(next)));
+    return coloring;
+}
+
+}
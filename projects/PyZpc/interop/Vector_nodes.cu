@@ -159,7 +159,7 @@ struct CopyZsVectorTo : INode {
               }
             };
             if (attr == "pos")
-              process(prim->verts.values);
+              process(prim->verts.values.mut());
             else
               std::visit(process, prim->attr(attr));
 
@@ -199,7 +199,7 @@ struct CopyZsVectorTo : INode {
             };
 
             if (attr == "pos")
-              process(prim->verts.values);
+              process(prim->verts.values.mut());
             else
               std::visit(process, prim->attr(attr));
           }
@@ -267,7 +267,7 @@ struct CopyZsVectorFrom : INode {
             };
 
             if (attr == "pos")
-              process(prim->verts.values);
+              process(prim->verts.values.mut());
             else
               std::visit(process, prim->attr(attr));
 
@@ -298,7 +298,7 @@ struct CopyZsVectorFrom : INode {
             };
 
             if (attr == "pos")
-              process(prim->verts.values);
+              process(prim->verts.values.mut());
             else
               std::visit(process, prim->attr(attr));
           }
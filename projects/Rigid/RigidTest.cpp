@@ -1,4 +1,5 @@
 #include <memory>
+#include <utility>
 #include <vector>
 
 // zeno basics
@@ -991,6 +992,103 @@ ZENDEFNODE(BulletExtractTransform, {
     {"Bullet"},
 });
 
+// transforms of every object in the list, one point each: pos is the origin,
+// "rot" the rotation quaternion (x, y, z, w) read by BulletApplyPieceTransforms,
+// and "nrm" / "tang" the body's x / y axes. with onbType ZYX these two rebuild the
+// rotation, e.g. PrimDuplicate with dirAttr nrm and tanAttr tang; XYZ would take
+// nrm as the z axis and mirror the x axis
+struct BulletGetTransforms : zeno::INode {
+    virtual void apply() override {
+        auto objs = get_input<zeno::ListObject>("objectList")->get<BulletObject>();
+        std::vector<BulletObject *> bodies(objs.size());
+        for (std::size_t i = 0; i < objs.size(); i++)
+            bodies[i] = objs[i].get();
+        auto prim = std::make_shared<zeno::PrimitiveObject>();
+        prim->verts.resize(bodies.size());
+        auto &rot = prim->verts.add_attr<zeno::vec4f>("rot");
+        auto &nrm = prim->verts.add_attr<zeno::vec3f>("nrm");
+        auto &tang = prim->verts.add_attr<zeno::vec3f>("tang");
+        bulletGetTransforms(bodies, prim->verts.data(), rot.data(), nrm.data(), tang.data());
+        prim->userData().setLiterial("onbType", std::string("ZYX"));
+        set_output("transforms", std::move(prim));
+    }
+};
+
+ZENDEFNODE(BulletGetTransforms, {
+    {"objectList"},
+    {"transforms"},
+    {},
+    {"Bullet"},
+});
+
+// moves the pieces of a merged primitive with their bodies in one pass, body
+// i being point i of transforms. pieces are in their bodies' local frames, or
+// in world space at restTransforms (e.g. the transforms of the first frame)
+struct BulletApplyPieceTransforms : zeno::INode {
+    virtual void apply() override {
+        auto prim = get_input<zeno::PrimitiveObject>("prim");
+        auto xforms = get_input<zeno::PrimitiveObject>("transforms");
+        auto pieceAttr = get_input2<std::string>("pieceAttr");
+        std::shared_ptr<zeno::PrimitiveObject> rest;
+        if (has_input("restTransforms")) {
+            rest = get_input<zeno::PrimitiveObject>("restTransforms");
+            if (rest->verts.size() != xforms->verts.size())
+                throw zeno::makeError("restTransforms and transforms differ in body count");
+        }
+
+        auto toBt = [] (zeno::PrimitiveObject const *xf) {
+            auto const &rot = xf->verts.attr<zeno::vec4f>("rot");
+            return [&origin = xf->verts.values.get(), &rot] (int i) {
+                auto o = origin[i];
+                auto q = rot[i];
+                return btTransform(btQuaternion(q[0], q[1], q[2], q[3]), btVector3(o[0], o[1], o[2]));
+            };
+        };
+        int nbodies = xforms->verts.size();
+        std::vector<btTransform> mats(nbodies);
+        auto cur = toBt(xforms.get());
+        if (rest) {
+            auto init = toBt(rest.get());
+            zeno::parallel_for(nbodies, [&] (int b) {
+                mats[b] = cur(b) * init(b).inverse();
+            });
+        } else {
+            zeno::parallel_for(nbodies, [&] (int b) {
+                mats[b] = cur(b);
+            });
+        }
+
+        // shares every array with prim, pos and nrm are copied on their first write below
+        auto out = std::static_pointer_cast<zeno::PrimitiveObject>(prim->shared_clone());
+        auto const &piece = std::as_const(prim->verts).attr<int>(pieceAttr);
+        auto const &pos = std::as_const(prim->verts).values.get();
+        auto &outPos = out->verts.values.mut();
+        std::vector<zeno::vec3f> const *nrm = nullptr;
+        std::vector<zeno::vec3f> *outNrm = nullptr;
+        if (prim->verts.attr_is<zeno::vec3f>("nrm")) {
+            nrm = &std::as_const(prim->verts).attr<zeno::vec3f>("nrm");
+            outNrm = &out->verts.attr<zeno::vec3f>("nrm");
+        }
+        zeno::parallel_for(prim->verts.size(), [&] (std::size_t i) {
+            int b = piece[i];
+            if (b < 0 || b >= nbodies)
+                return;
+            auto const &m = mats[b];
+            outPos[i] = zeno::other_to_vec<3>(m(zeno::vec_to_other<btVector3>(pos[i])));
+            if (nrm)
+                (*outNrm)[i] = zeno::other_to_vec<3>(m.getBasis() * zeno::vec_to_other<btVector3>((*nrm)[i]));
+        });
+        set_output("prim", std::move(out));
+    }
+};
+
+ZENDEFNODE(BulletApplyPieceTransforms, {
+    {"prim", "transforms", "restTransforms", {"string", "pieceAttr", "pieceId"}},
+    {"prim"},
+    {},
+    {"Bullet"},
+});
+
 /*static class btTaskSchedulerManager {
 	btAlignedObjectArray<btITaskScheduler*> m_taskSchedulers;
 	btAlignedObjectArray<btITaskScheduler*> m_allocatedTaskSchedulers;
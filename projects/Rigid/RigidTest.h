@@ -28,6 +28,7 @@
 #include <BulletDynamics/Featherstone/btMultiBodySphericalJointLimit.h>
 #include <BulletDynamics/Featherstone/btMultiBodySphericalJointMotor.h>
 
+#include <zeno/para/parallel_for.h>
 #include <iostream>
 
 #ifndef ZENO_RIGIDTEST_H
@@ -260,6 +261,20 @@ struct BulletGlueCompoundShape : IObject {
     }
 };
 
+// world transforms of many bodies at once, in parallel and in list order:
+// origins and rotation quaternions (x, y, z, w) as BulletExtractTransform gives them,
+// plus the world x and y axes of each body
+inline void bulletGetTransforms(std::vector<BulletObject *> const &objs, zeno::vec3f *origins, zeno::vec4f *rotations,
+                                zeno::vec3f *xAxes, zeno::vec3f *yAxes) {
+    zeno::parallel_for(objs.size(), [&] (std::size_t i) {
+        btTransform trans = objs[i]->getWorldTransform();
+        origins[i] = zeno::vec3f(zeno::other_to_vec<3>(trans.getOrigin()));
+        rotations[i] = zeno::vec4f(zeno::other_to_vec<4>(trans.getRotation()));
+        xAxes[i] = zeno::vec3f(zeno::other_to_vec<3>(trans.getBasis().getColumn(0)));
+        yAxes[i] = zeno::vec3f(zeno::other_to_vec<3>(trans.getBasis().getColumn(1)));
+    });
+}
+
 struct BulletConstraintRelationship : zeno::IObject {
     std::string constraintName{}; // "Glue", "Hard", "Soft"...
     std::string constraintType{}; // "position", "rotation", "all"
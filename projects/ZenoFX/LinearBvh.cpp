@@ -1,7 +1,9 @@
 #include "LinearBvh.h"
 #include "SpatialUtils.hpp"
+#include <zeno/para/parallel_sort.h>
+#include <zeno/utils/morton.h>
 #include <algorithm>
-#include <atomic>
+#include <array>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
@@ -12,98 +14,231 @@
 
 namespace zeno {
 
-typename LBvh::BvFunc
-LBvh::getBvFunc(const std::shared_ptr<PrimitiveObject> &prim) const {
+namespace {
+
+using Ti = LBvh::Ti;
+using TV = LBvh::TV;
+using element_e = LBvh::element_e;
+
+template <element_e et>
+TV element_center(const PrimitiveObject &prim, const vec3f *refpos, Ti i) {
+  if constexpr (et == element_e::tet) {
+    auto quad = prim.quads[i];
+    return (refpos[quad[0]] + refpos[quad[1]] + refpos[quad[2]] +
+            refpos[quad[3]]) /
+           4;
+  } else if constexpr (et == element_e::tri) {
+    auto tri = prim.tris[i];
+    return (refpos[tri[0]] + refpos[tri[1]] + refpos[tri[2]]) / 3;
+  } else if constexpr (et == element_e::line) {
+    auto line = prim.lines[i];
+    return (refpos[line[0]] + refpos[line[1]]) / 2;
+  } else {
+    return refpos[prim.points[i]];
+  }
+}
+
+template <element_e et>
+void element_box(const PrimitiveObject &prim, const vec3f *refpos,
+                 const float *radius, float thickness, Ti i, float lo[3],
+                 float hi[3]) {
+  auto expand = [&](const vec3f &p, float r) {
+    for (int d = 0; d != 3; ++d) {
+      lo[d] = std::min(lo[d], p[d] - r);
+      hi[d] = std::max(hi[d], p[d] + r);
+    }
+  };
+  for (int d = 0; d != 3; ++d) {
+    lo[d] = std::numeric_limits<float>::max();
+    hi[d] = std::numeric_limits<float>::lowest();
+  }
+  if constexpr (et == element_e::tet) {
+    auto quad = prim.quads[i];
+    for (int j = 0; j != 4; ++j)
+      expand(refpos[quad[j]], thickness);
+  } else if constexpr (et == element_e::tri) {
+    auto tri = prim.tris[i];
+    for (int j = 0; j != 3; ++j)
+      expand(refpos[tri[j]], thickness);
+  } else if constexpr (et == element_e::line) {
+    auto line = prim.lines[i];
+    for (int j = 0; j != 2; ++j)
+      expand(refpos[line[j]], thickness);
+  } else {
+    expand(refpos[prim.points[i]], radius ? thickness + radius[i] : thickness);
+  }
+}
+
+template <element_e et>
+float element_dist(const PrimitiveObject &prim, const vec3f *refpos, Ti eid,
+                   const TV &pos, TV &ws) {
+  float d = std::numeric_limits<float>::max();
+  if constexpr (et == element_e::point)
+    d = dist_pp(refpos[prim.points[eid]], pos, ws);
+  else if constexpr (et == element_e::line) {
+    auto line = prim.lines[eid];
+    d = dist_pe(pos, refpos[line[0]], refpos[line[1]], ws);
+  } else if constexpr (et == element_e::tri) {
+    auto tri = prim.tris[eid];
+    d = dist_pt(pos, refpos[tri[0]], refpos[tri[1]], refpos[tri[2]], ws);
+  } else if constexpr (et == element_e::tet) {
+    auto tet = prim.quads[eid];
+    if (auto dd = dist_pt(pos, refpos[tet[0]], refpos[tet[1]],
+                          refpos[tet[2]], ws);
+        dd < d)
+      d = dd;
+    if (auto dd = dist_pt(pos, refpos[tet[1]], refpos[tet[3]],
+                          refpos[tet[2]], ws);
+        dd < d)
+      d = dd;
+    if (auto dd = dist_pt(pos, refpos[tet[0]], refpos[tet[3]],
+                          refpos[tet[2]], ws);
+        dd < d)
+      d = dd;
+    if (auto dd = dist_pt(pos, refpos[tet[0]], refpos[tet[2]],
+                          refpos[tet[3]], ws);
+        dd < d)
+      d = dd;
+  }
+  return d;
+}
+
+// sorts ids by the 63-bit morton code of their points within the bounding box
+std::vector<std::pair<uint64_t, Ti>> morton_order(const TV *ps, Ti n) {
+  constexpr int dim = 3;
   constexpr auto ma = std::numeric_limits<float>::max();
   constexpr auto mi = std::numeric_limits<float>::lowest();
-  const Box defaultBox{TV{ma, ma, ma}, TV{mi, mi, mi}};
+  TV minVec = {ma, ma, ma};
+  TV maxVec = {mi, mi, mi};
+  // ref: https://www.openmp.org/spec-html/5.0/openmpsu107.html
+  for (int d = 0; d != dim; ++d) {
+    float &lo = minVec[d];
+    float &hi = maxVec[d];
+#ifndef _MSC_VER
+#if defined(_OPENMP)
+#pragma omp parallel for reduction(min : lo) reduction(max : hi)
+#endif
+#endif
+    for (Ti i = 0; i < n; ++i) {
+      if (ps[i][d] < lo)
+        lo = ps[i][d];
+      if (ps[i][d] > hi)
+        hi = ps[i][d];
+    }
+  }
+  // same scale on every axis, so that flat inputs don't spend their top
+  // splits on the thin axis
+  float extent = 0.f;
+  for (int d = 0; d != dim; ++d)
+    extent = std::max(extent, maxVec[d] - minVec[d]);
+  const float scale = extent > 0.f ? 2097151.f / extent : 0.f;
+
+  std::vector<std::pair<uint64_t, Ti>> records(n);
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+  for (Ti i = 0; i < n; ++i) {
+    uint64_t code = 0;
+    for (int d = 0; d != dim; ++d) {
+      float q = std::clamp((ps[i][d] - minVec[d]) * scale, 0.f, 2097151.f);
+      code |= morton3d::encode1((uint64_t)q) << d;
+    }
+    records[i] = std::make_pair(code, i);
+  }
+  parallel_sort(records.begin(), records.end(), std::less<>{});
+  return records;
+}
 
-  std::function<Box(typename LBvh::Ti)> getBv;
-  if (eleCategory == element_e::tet)
-    getBv = [&quads = prim->quads, &refpos = prim->attr<vec3f>("pos"),
-             defaultBox, this](Ti i) -> Box {
-      auto quad = quads[i];
-      Box bv = defaultBox;
-      for (int j = 0; j != 4; ++j) {
-        const auto &p = refpos[quad[j]];
-        for (int d = 0; d != 3; ++d) {
-          if (p[d] - thickness < bv.first[d])
-            bv.first[d] = p[d] - thickness;
-          if (p[d] + thickness > bv.second[d])
-            bv.second[d] = p[d] + thickness;
+template <element_e et>
+void refit_nodes(LBvh &bvh, const PrimitiveObject &prim) {
+  const vec3f *refpos = prim.attr<vec3f>("pos").data();
+  const float *radius = nullptr;
+  if constexpr (et == element_e::point)
+    if (!bvh.radiusAttr.empty())
+      radius = prim.verts.attr<float>(bvh.radiusAttr).data();
+
+  // children always live on deeper levels, so go bottom up
+  for (int l = (int)bvh.levelOffsets.size() - 2; l >= 0; --l) {
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+    for (Ti i = bvh.levelOffsets[l]; i < bvh.levelOffsets[l + 1]; ++i) {
+      auto &n = bvh.nodes[i];
+      for (int k = 0; k != 4; ++k) {
+        Ti c = n.child[k];
+        if (c == LBvh::emptyChild)
+          continue;
+        float lo[3], hi[3];
+        if (c < 0) {
+          element_box<et>(prim, refpos, radius, bvh.thickness, ~c, lo, hi);
+        } else {
+          const auto &cn = bvh.nodes[c];
+          for (int d = 0; d != 3; ++d) {
+            lo[d] = std::min(std::min(cn.lower[d][0], cn.lower[d][1]),
+                             std::min(cn.lower[d][2], cn.lower[d][3]));
+            hi[d] = std::max(std::max(cn.upper[d][0], cn.upper[d][1]),
+                             std::max(cn.upper[d][2], cn.upper[d][3]));
+          }
         }
-      }
-      return bv;
-    };
-  else if (eleCategory == element_e::tri)
-    getBv = [&tris = prim->tris, &refpos = prim->attr<vec3f>("pos"), defaultBox,
-             this](Ti i) -> Box {
-      auto tri = tris[i];
-      Box bv = defaultBox;
-      for (int j = 0; j != 3; ++j) {
-        const auto &p = refpos[tri[j]];
         for (int d = 0; d != 3; ++d) {
-          if (p[d] - thickness < bv.first[d])
-            bv.first[d] = p[d] - thickness;
-          if (p[d] + thickness > bv.second[d])
-            bv.second[d] = p[d] + thickness;
+          n.lower[d][k] = lo[d];
+          n.upper[d][k] = hi[d];
         }
       }
-      return bv;
-    };
-  else if (eleCategory == element_e::line)
-    getBv = [&lines = prim->lines, &refpos = prim->attr<vec3f>("pos"),
-             defaultBox, this](Ti i) -> Box {
-      auto line = lines[i];
-      Box bv = defaultBox;
-      for (int j = 0; j != 2; ++j) {
-        const auto &p = refpos[line[j]];
-        for (int d = 0; d != 3; ++d) {
-          if (p[d] - thickness < bv.first[d])
-            bv.first[d] = p[d] - thickness;
-          if (p[d] + thickness > bv.second[d])
-            bv.second[d] = p[d] + thickness;
+    }
+  }
+}
+
+template <element_e et>
+void nearest_batch(const LBvh &bvh, const PrimitiveObject &prim, const TV *pos,
+                   std::size_t n, Ti *ids, float *dists, TV *ws) {
+  const vec3f *refpos = prim.attr<vec3f>("pos").data();
+  auto records = morton_order(pos, (Ti)n);
+
+  constexpr std::size_t chunk = 64;
+  const std::ptrdiff_t numChunks = (n + chunk - 1) / chunk;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (std::ptrdiff_t c = 0; c < numChunks; ++c) {
+    Ti last = -1;
+    const std::size_t end = std::min(n, (c + 1) * chunk);
+    for (std::size_t j = c * chunk; j < end; ++j) {
+      const Ti q = records[j].second;
+      const TV &p = pos[q];
+      Ti id = -1;
+      float dist = std::numeric_limits<float>::max();
+      TV w{0.f, 0.f, 0.f}, wTmp{0.f, 0.f, 0.f};
+      if (last != -1) {
+        // the neighbor's answer is an upper bound of ours
+        float d = element_dist<et>(prim, refpos, last, p, wTmp);
+        if (d <= dist) {
+          id = last;
+          dist = d;
+          w = wTmp;
         }
       }
-      return bv;
-    };
-  else if (eleCategory == element_e::point)
-      if (radiusAttr.empty()) {
-        getBv = [&points = prim->points, &refpos = prim->attr<vec3f>("pos"),  
-             defaultBox, this](Ti i) -> Box {
-        auto point = points[i];
-        Box bv = defaultBox;
-        const auto &p = refpos[point];
-        for (int d = 0; d != 3; ++d) {
-          if (p[d] - thickness < bv.first[d])
-            bv.first[d] = p[d] - thickness ;
-          if (p[d] + thickness > bv.second[d])
-            bv.second[d] = p[d] + thickness;
-          }
-      return bv;
-        };
-      } 
-      else if(!radiusAttr.empty()) {
-        getBv = [&points = prim->points, &refpos = prim->attr<vec3f>("pos"), 
-        &radius = prim->verts.attr<float>(radiusAttr),
-             defaultBox, this](Ti i) -> Box {
-        auto point = points[i];
-        Box bv = defaultBox;
-        const auto &p = refpos[point];
-        for (int d = 0; d != 3; ++d) {
-          if (p[d] - thickness - radius[i] < bv.first[d])
-            bv.first[d] = p[d] - thickness - radius[i];
-          if (p[d] + thickness + radius[i]  > bv.second[d])
-            bv.second[d] = p[d] + thickness + radius[i];
-          }
-      return bv;
-      };
+      bvh.iter_nearest(p, [&] { return dist; }, [&](Ti eid) {
+        float d = element_dist<et>(prim, refpos, eid, p, wTmp);
+        if (d < dist) {
+          id = eid;
+          dist = d;
+          w = wTmp;
+        }
+      });
+      last = id;
+      if (ids)
+        ids[q] = id;
+      if (dists)
+        dists[q] = dist;
+      if (ws)
+        ws[q] = w;
     }
-  else if (eleCategory == element_e::unknown)
-    getBv = [defaultBox](Ti) -> Box { return defaultBox; };
-  return getBv;
+  }
 }
 
+} // namespace
+
 template <LBvh::element_e et>
 void LBvh::build(const std::shared_ptr<PrimitiveObject> &prim, float thickness, std::string radiusAttr,
                  element_t<et>) {
@@ -142,329 +277,115 @@ void LBvh::build(const std::shared_ptr<PrimitiveObject> &prim, float thickness,
       numLeaves = 0;
     }
   }
-
-  const auto &refpos = prim->attr<vec3f>("pos");
-  const Ti numNodes = numLeaves > 2 ? numLeaves + numLeaves - 1 : numLeaves;
-  sortedBvs.resize(numNodes);
-  auxIndices.resize(numNodes);
-  levels.resize(numNodes);
-  parents.resize(numNodes);
-  leafIndices.resize(numLeaves);
-
-  this->getBv = getBvFunc(prim);
-
-  if (numLeaves <= 2) { // edge cases where not enough primitives to form a tree
-    for (Ti i = 0; i != numLeaves; ++i) {
-      sortedBvs[i] = getBv(i);
-      leafIndices[i] = i;
-      levels[i] = 0;
-      auxIndices[i] = i;
-      parents[i] = -1;
-    }
+  this->numLeaves = numLeaves;
+  nodes.clear();
+  levelOffsets.assign(1, 0);
+  if (numLeaves == 0)
     return;
-  }
-
-  constexpr int dim = 3;
-  constexpr auto ma = std::numeric_limits<float>::max();
-  constexpr auto mi = std::numeric_limits<float>::lowest();
-  Box wholeBox{TV{ma, ma, ma}, TV{mi, mi, mi}};
-
-  // fmt::print("wholebox before[{}, {}, {}] - [{}, {}, {}]\n",
-  // wholeBox.first[0], wholeBox.first[1], wholeBox.first[2],
-  // wholeBox.second[0], wholeBox.second[1], wholeBox.second[2]);
-  /// whole box
-  TV minVec = {ma, ma, ma};
-  TV maxVec = {mi, mi, mi};
 
-  // ref: https://www.openmp.org/spec-html/5.0/openmpsu107.html
-  for (int d = 0; d != dim; ++d) {
-    float &v = minVec[d];
-#ifndef _MSC_VER
-#if defined(_OPENMP)
-#pragma omp parallel for reduction(min : v)
-#endif
-#endif
-    for (Ti i = 0; i < refpos.size(); ++i) {
-      const auto &p = refpos[i];
-      if (p[d] < v)
-        v = p[d];
-    }
-  }
-  for (int d = 0; d != dim; ++d) {
-    float &v = maxVec[d];
-#ifndef _MSC_VER
-#if defined(_OPENMP)
-#pragma omp parallel for reduction(max : v)
-#endif
-#endif
-    for (Ti i = 0; i < refpos.size(); ++i) {
-      const auto &p = refpos[i];
-      if (p[d] > v)
-        v = p[d];
-    }
-  }
-  wholeBox.first = minVec;
-  wholeBox.second = maxVec;
-
-  // fmt::print("wholebox after[{}, {}, {}] - [{}, {}, {}]\n",
-  // wholeBox.first[0], wholeBox.first[1], wholeBox.first[2],
-  // wholeBox.second[0], wholeBox.second[1], wholeBox.second[2]); printf("lbvh
-  // bounding box: %f, %f, %f - %f, %f, %f\n", wholeBox.first[0],
-  // wholeBox.first[1], wholeBox.first[2], wholeBox.second[0],
-  // wholeBox.second[1], wholeBox.second[2]);
-
-  std::vector<std::pair<Tu, Ti>> records(numLeaves); // <mc, id>
-  /// morton codes
-  auto getMortonCode = [](const TV &p) -> Tu {
-    auto expand_bits = [](Tu v) -> Tu { // expands lower 10-bits to 30 bits
-      v = (v * 0x00010001u) & 0xFF0000FFu;
-      v = (v * 0x00000101u) & 0x0F00F00Fu;
-      v = (v * 0x00000011u) & 0xC30C30C3u;
-      v = (v * 0x00000005u) & 0x49249249u;
-      return v;
-    };
-    return (expand_bits((Tu)(p[0] * 1024.f)) << (Tu)2) |
-           (expand_bits((Tu)(p[1] * 1024.f)) << (Tu)1) |
-           expand_bits((Tu)(p[2] * 1024.f));
-  };
+  std::vector<uint64_t> codes(numLeaves);
+  std::vector<Ti> order(numLeaves);
   {
-    const auto lengths = wholeBox.second - wholeBox.first;
-    auto getUniformCoord = [&wholeBox, &lengths](const TV &p) {
-      // https://newbedev.com/constexpr-variable-captured-inside-lambda-loses-its-constexpr-ness
-      constexpr int dim = 3;
-      auto offsets = p - wholeBox.first;
-      for (int d = 0; d != dim; ++d)
-        offsets[d] = std::clamp(offsets[d], (float)0, lengths[d]) / lengths[d];
-      return offsets;
-    };
-    if constexpr (et == element_e::tet) {
+    const vec3f *refpos = prim->attr<vec3f>("pos").data();
+    std::vector<TV> centers(numLeaves);
 #if defined(_OPENMP)
 #pragma omp parallel for
 #endif
-      for (Ti i = 0; i < numLeaves; ++i) {
-        auto quad = prim->quads[i];
-        auto uc = getUniformCoord((refpos[quad[0]] + refpos[quad[1]] +
-                                   refpos[quad[2]] + refpos[quad[3]]) /
-                                  4);
-        records[i] = std::make_pair(getMortonCode(uc), i);
-      }
-    } else if constexpr (et == element_e::tri) {
+    for (Ti i = 0; i < numLeaves; ++i)
+      centers[i] = element_center<et>(*prim, refpos, i);
+    auto records = morton_order(centers.data(), numLeaves);
 #if defined(_OPENMP)
 #pragma omp parallel for
 #endif
-      for (Ti i = 0; i < numLeaves; ++i) {
-        auto tri = prim->tris[i];
-        auto uc = getUniformCoord(
-            (refpos[tri[0]] + refpos[tri[1]] + refpos[tri[2]]) / 3);
-        records[i] = std::make_pair(getMortonCode(uc), i);
-      }
-    } else if constexpr (et == element_e::line) {
-#if defined(_OPENMP)
-#pragma omp parallel for
-#endif
-      for (Ti i = 0; i < numLeaves; ++i) {
-        auto line = prim->lines[i];
-        auto uc = getUniformCoord((refpos[line[0]] + refpos[line[1]]) / 2);
-        records[i] = std::make_pair(getMortonCode(uc), i);
-      }
-    } else if constexpr (et == element_e::point) {
-#if defined(_OPENMP)
-#pragma omp parallel for
-#endif
-      for (Ti i = 0; i < numLeaves; ++i) {
-        auto pi = prim->points[i];
-        auto uc = getUniformCoord(refpos[pi]);
-        records[i] = std::make_pair(getMortonCode(uc), i);
-      }
+    for (Ti i = 0; i < numLeaves; ++i) {
+      codes[i] = records[i].first;
+      order[i] = records[i].second;
     }
   }
-  std::sort(std::begin(records), std::end(records));
-
-  std::vector<Tu> splits(numLeaves);
-  ///
-  constexpr auto numTotalBits = sizeof(Tu) * 8;
-  auto clz = [](Tu x) -> Tu {
-    static_assert(std::is_same_v<Tu, unsigned int>,
-                  "Tu should be unsigned int");
-#if defined(_MSC_VER) || (defined(_WIN32) && defined(__INTEL_COMPILER))
-    return __lzcnt((unsigned int)x);
-#elif defined(__clang__) || defined(__GNUC__)
-    return __builtin_clz((unsigned int)x);
-#endif
+
+  // split where the highest differing code bit flips, or halve runs of equal codes
+  auto split = [&codes](Ti b, Ti e) -> Ti {
+    uint64_t diff = codes[b] ^ codes[e - 1];
+    if (!diff)
+      return b + (e - b) / 2;
+    int hb = 63;
+    while (!(diff >> hb))
+      --hb;
+    const uint64_t bit = (uint64_t)1 << hb;
+    return std::partition_point(codes.begin() + b, codes.begin() + e,
+                                [bit](uint64_t c) { return !(c & bit); }) -
+           codes.begin();
   };
+
+  // top down, one level at a time: every range becomes a node whose (up to) four
+  // children are its two halves split once more, ranges of one element are leaves
+  using Range = std::pair<Ti, Ti>;
+  std::vector<Range> ranges{{0, numLeaves}}, next;
+  while (!ranges.empty()) {
+    const Ti base = nodes.size();
+    const Ti count = ranges.size();
+    nodes.resize(base + count);
+    std::vector<std::array<Range, 4>> parts(count);
+    std::vector<int> numParts(count);
+    std::vector<Ti> offsets(count + 1, 0);
 #if defined(_OPENMP)
 #pragma omp parallel for
 #endif
-  for (Ti i = 0; i < numLeaves; ++i) {
-    if (i != numLeaves - 1)
-      splits[i] = numTotalBits - clz(records[i].first ^ records[i + 1].first);
-    else
-      splits[i] = numTotalBits + 1;
-  }
-  ///
-  std::vector<Box> leafBvs(numLeaves);
-  std::vector<Box> trunkBvs(numLeaves - 1);
-  std::vector<Ti> leafLca(numLeaves);
-  std::vector<Ti> leafDepths(numLeaves);
-  std::vector<Ti> trunkR(numLeaves - 1);
-  std::vector<Ti> trunkLc(numLeaves - 1);
-
-  std::vector<std::atomic<Tu>> trunkTopoMarks(numLeaves - 1);
-  std::vector<std::atomic<Ti>> trunkBuildFlags(numLeaves - 1);
-#if 0
-        // already zero-initialized during default ctor
-        // https://en.cppreference.com/w/cpp/atomic/atomic/atomic
-        // courtesy of pyb
-#pragma omp parallel for
-        for (Ti i = 0; i < numLeaves - 1; ++i) {
-            trunkTopoMarks[i] = 0;
-            trunkBuildFlags[i] = 0;
+    for (Ti i = 0; i < count; ++i) {
+      auto [b, e] = ranges[i];
+      auto &ps = parts[i];
+      int np = 0;
+      if (e - b == 1) {
+        ps[np++] = {b, e};
+      } else {
+        Ti m = split(b, e);
+        for (Range h : {Range{b, m}, Range{m, e}}) {
+          if (h.second - h.first > 1) {
+            Ti hm = split(h.first, h.second);
+            ps[np++] = {h.first, hm};
+            ps[np++] = {hm, h.second};
+          } else
+            ps[np++] = h;
         }
-#endif
+      }
+      numParts[i] = np;
+      Ti numInner = 0;
+      for (int k = 0; k != np; ++k)
+        numInner += ps[k].second - ps[k].first > 1;
+      offsets[i + 1] = numInner;
+    }
+    for (Ti i = 0; i < count; ++i)
+      offsets[i + 1] += offsets[i];
 
-  {
-    std::vector<Ti> trunkL(numLeaves - 1);
-    std::vector<Ti> trunkRc(numLeaves - 1);
+    next.resize(offsets[count]);
 #if defined(_OPENMP)
 #pragma omp parallel for
 #endif
-    for (Ti idx = 0; idx < numLeaves; ++idx) {
-      leafBvs[idx] = getBv(records[idx].second);
-
-      leafLca[idx] = -1, leafDepths[idx] = 1;
-      Ti l = idx - 1, r = idx; ///< (l, r]
-      bool mark{false};
-
-      if (l >= 0)
-        mark =
-            splits[l] < splits[r]; ///< true when right child, false otherwise
-
-      int cur = mark ? l : r;
-      if (mark)
-        trunkRc[cur] = idx, trunkR[cur] = idx,
-        trunkTopoMarks[cur].fetch_or((Tu)0x00000002u);
-      else
-        trunkLc[cur] = idx, trunkL[cur] = idx,
-        trunkTopoMarks[cur].fetch_or((Tu)0x00000001u);
-
-      while (trunkBuildFlags[cur].fetch_add(1) == 1) {
-        { // refit
-          int lc = trunkLc[cur], rc = trunkRc[cur];
-          const auto childMask = trunkTopoMarks[cur] & (Tu)3;
-          const auto &leftBox = (childMask & 1) ? leafBvs[lc] : trunkBvs[lc];
-          const auto &rightBox = (childMask & 2) ? leafBvs[rc] : trunkBvs[rc];
-          Box bv{};
-          for (int d = 0; d != dim; ++d) {
-            bv.first[d] = leftBox.first[d] < rightBox.first[d]
-                              ? leftBox.first[d]
-                              : rightBox.first[d];
-            bv.second[d] = leftBox.second[d] > rightBox.second[d]
-                               ? leftBox.second[d]
-                               : rightBox.second[d];
-          }
-          trunkBvs[cur] = bv;
-        }
-        trunkTopoMarks[cur] &= 0x00000007;
-
-        l = trunkL[cur] - 1, r = trunkR[cur];
-        leafLca[l + 1] = cur, leafDepths[l + 1]++;
-        atomic_thread_fence(std::memory_order_acquire);
-
-        if (l >= 0)
-          mark =
-              splits[l] < splits[r]; ///< true when right child, false otherwise
-        else
-          mark = false;
-
-        if (l + 1 == 0 && r == numLeaves - 1) {
-          // trunkPar(cur) = -1;
-          trunkTopoMarks[cur] &= 0xFFFFFFFB;
-          break;
+    for (Ti i = 0; i < count; ++i) {
+      auto &n = nodes[base + i];
+      Ti dst = offsets[i];
+      for (int k = 0; k != 4; ++k) {
+        for (int d = 0; d != 3; ++d) {
+          n.lower[d][k] = std::numeric_limits<float>::infinity();
+          n.upper[d][k] = -std::numeric_limits<float>::infinity();
         }
-
-        int par = mark ? l : r;
-        // trunkPar(cur) = par;
-        if (mark) {
-          trunkRc[par] = cur, trunkR[par] = r;
-          trunkTopoMarks[par].fetch_and(0xFFFFFFFD);
-          trunkTopoMarks[cur] |= 0x00000004;
+        n.child[k] = emptyChild;
+        if (k >= numParts[i])
+          continue;
+        auto [b, e] = parts[i][k];
+        if (e - b == 1) {
+          n.child[k] = ~order[b];
         } else {
-          trunkLc[par] = cur, trunkL[par] = l + 1;
-          trunkTopoMarks[par].fetch_and(0xFFFFFFFE);
-          trunkTopoMarks[cur] &= 0xFFFFFFFB;
+          n.child[k] = base + count + dst;
+          next[dst++] = {b, e};
         }
-        cur = par;
       }
     }
+    levelOffsets.push_back(base + count);
+    ranges.swap(next);
   }
 
-  std::vector<Ti> leafOffsets(numLeaves + 1);
-  leafOffsets[0] = 0;
-  for (Ti i = 1; i <= numLeaves; ++i)
-    leafOffsets[i] = leafOffsets[i - 1] + leafDepths[i - 1];
-  std::vector<Ti> trunkDst(numLeaves - 1);
-  /// compute trunk order
-  // [levels], [parents], [trunkDst]
-#if defined(_OPENMP)
-#pragma omp parallel for
-#endif
-  for (Ti i = 0; i < numLeaves; ++i) {
-    auto offset = leafOffsets[i];
-    parents[offset] = -1;
-    for (Ti node = leafLca[i], level = leafDepths[i]; --level;
-         node = trunkLc[node]) {
-      levels[offset] = level;
-      parents[offset + 1] = offset;
-      trunkDst[node] = offset++;
-    }
-  }
-  // only left-branch-node's parents are set so far
-  // levels store the number of node within the left-child-branch from bottom
-  // up starting from 0
-
-  /// reorder trunk
-  // [sortedBvs], [auxIndices], [parents]
-  // auxIndices here is escapeIndex (for trunk nodes)
-#if defined(_OPENMP)
-#pragma omp parallel for
-#endif
-  for (Ti i = 0; i < numLeaves - 1; ++i) {
-    const auto dst = trunkDst[i];
-    const auto &bv = trunkBvs[i];
-    // auto l = trunkL[i];
-    auto r = trunkR[i];
-    sortedBvs[dst] = bv;
-    const auto rb = r + 1;
-    if (rb < numLeaves) {
-      auto lca = leafLca[rb]; // rb must be in left-branch
-      auto brother = (lca != -1 ? trunkDst[lca] : leafOffsets[rb]);
-      auxIndices[dst] = brother;
-      if (parents[dst] == dst - 1)
-        parents[brother] = dst - 1; // setup right-branch brother's parent
-    } else
-      auxIndices[dst] = -1;
-  }
-
-  /// reorder leaf
-  // [sortedBvs], [auxIndices], [levels], [parents], [leafIndices]
-  // auxIndices here is primitiveIndex (for leaf nodes)
-#if defined(_OPENMP)
-#pragma omp parallel for
-#endif
-  for (Ti i = 0; i < numLeaves; ++i) {
-    const auto &bv = leafBvs[i];
-    // const auto leafDepth = leafDepths[i];
-
-    auto dst = leafOffsets[i + 1] - 1;
-    leafIndices[i] = dst;
-    sortedBvs[dst] = bv;
-    auxIndices[dst] = records[i].second;
-    levels[dst] = 0;
-    if (parents[dst] == dst - 1)
-      parents[dst + 1] = dst - 1; // setup right-branch brother's parent
-    // if (leafDepth > 1) parents[dst + 1] = dst - 1;  // setup right-branch
-    // brother's parent
-  }
+  refit_nodes<et>(*this, *prim);
 }
 
 template void
@@ -500,62 +421,14 @@ void LBvh::refit() {
   if (!prim)
     throw std::runtime_error(
         "the primitive object referenced by lbvh not available anymore");
-  const auto &refpos = prim->attr<vec3f>("pos");
-
-  const auto numLeaves = getNumLeaves();
-  if (numLeaves <= 2) {
-    for (Ti i = 0; i != numLeaves; ++i) {
-      sortedBvs[i] = getBv(i);
-      leafIndices[i] = i;
-      levels[i] = 0;
-      auxIndices[i] = i;
-      parents[i] = -1;
-    }
-    return;
-  }
-  const auto numNodes = numLeaves * 2 - 1;
-  std::vector<std::atomic<Ti>> refitFlags(numNodes);
-#if 0
-        // comment out with the same reason in build
-#pragma omp parallel for
-        for (Ti i = 0; i < numNodes; ++i)
-            refitFlags[i] = 0;
-#endif
-
-  {
-#if defined(_OPENMP)
-#pragma omp parallel for
-#endif
-    for (Ti nid = 0; nid < numLeaves; ++nid) {
-      auto idx = leafIndices[nid];
-      sortedBvs[idx] = getBv(auxIndices[idx]);
-
-      auto par = parents[idx];
-      while (par != -1) {
-        Ti old{0};
-        if (refitFlags[par].compare_exchange_strong(old, (Ti)1,
-                                                    std::memory_order_acquire))
-          break;
-        auto lc = par + 1;
-        auto rc = levels[lc] == 0 ? lc + 1 : auxIndices[lc];
-        // merge box
-        const auto &leftBox = sortedBvs[lc];
-        const auto &rightBox = sortedBvs[rc];
-        Box bv{};
-        for (int d = 0; d != 3; ++d) {
-          bv.first[d] = leftBox.first[d] < rightBox.first[d]
-                            ? leftBox.first[d]
-                            : rightBox.first[d];
-          bv.second[d] = leftBox.second[d] > rightBox.second[d]
-                             ? leftBox.second[d]
-                             : rightBox.second[d];
-        }
-        sortedBvs[par] = bv;
-        atomic_thread_fence(std::memory_order_release);
-        par = parents[par];
-      }
-    }
-  }
+  if (eleCategory == element_e::tet)
+    refit_nodes<element_e::tet>(*this, *prim);
+  else if (eleCategory == element_e::tri)
+    refit_nodes<element_e::tri>(*this, *prim);
+  else if (eleCategory == element_e::line)
+    refit_nodes<element_e::line>(*this, *prim);
+  else if (eleCategory == element_e::point)
+    refit_nodes<element_e::point>(*this, *prim);
 }
 
 /// nearest primitive
@@ -566,58 +439,18 @@ typename LBvh::TV LBvh::find_nearest(TV const &pos, Ti &id, float &dist,
   if (!prim)
     throw std::runtime_error(
         "the primitive object referenced by lbvh not available anymore");
-  const auto &refpos = prim->attr<vec3f>("pos");
+  const vec3f *refpos = prim->attr<vec3f>("pos").data();
 
-  const Ti numNodes = sortedBvs.size();
-  Ti node = 0;
   TV ws{0.f, 0.f, 0.f};
   TV wsTmp{0.f, 0.f, 0.f};
-  while (node != -1 && node != numNodes) {
-    Ti level = levels[node];
-    // level and node are always in sync
-    for (; level; --level, ++node)
-      if (auto d = distance(sortedBvs[node], pos); d > dist)
-        break;
-    // leaf node check
-    if (level == 0) {
-      const auto eid = auxIndices[node];
-      float d = std::numeric_limits<float>::max();
-      if constexpr (et == element_e::point)
-        d = dist_pp(refpos[prim->points[eid]], pos, wsTmp);
-      else if constexpr (et == element_e::line) {
-        auto line = prim->lines[eid];
-        d = dist_pe(pos, refpos[line[0]], refpos[line[1]], wsTmp);
-      } else if constexpr (et == element_e::tri) {
-        auto tri = prim->tris[eid];
-        d = dist_pt(pos, refpos[tri[0]], refpos[tri[1]], refpos[tri[2]], wsTmp);
-      } else if constexpr (et == element_e::tet) {
-        auto tet = prim->quads[eid];
-        if (auto dd = dist_pt(pos, refpos[tet[0]], refpos[tet[1]],
-                              refpos[tet[2]], wsTmp);
-            dd < d)
-          d = dd;
-        if (auto dd = dist_pt(pos, refpos[tet[1]], refpos[tet[3]],
-                              refpos[tet[2]], wsTmp);
-            dd < d)
-          d = dd;
-        if (auto dd = dist_pt(pos, refpos[tet[0]], refpos[tet[3]],
-                              refpos[tet[2]], wsTmp);
-            dd < d)
-          d = dd;
-        if (auto dd = dist_pt(pos, refpos[tet[0]], refpos[tet[2]],
-                              refpos[tet[3]], wsTmp);
-            dd < d)
-          d = dd;
-      }
-      if (d < dist) {
-        id = eid;
-        dist = d;
-        ws = wsTmp;
-      }
-      node++;
-    } else // separate at internal nodes
-      node = auxIndices[node];
-  }
+  iter_nearest(pos, [&] { return dist; }, [&](Ti eid) {
+    float d = element_dist<et>(*prim, refpos, eid, pos, wsTmp);
+    if (d < dist) {
+      id = eid;
+      dist = d;
+      ws = wsTmp;
+    }
+  });
   return ws;
 }
 
@@ -645,6 +478,21 @@ typename LBvh::TV LBvh::find_nearest(TV const &pos, Ti &id, float &dist) const {
     return find_nearest(pos, id, dist, element_c<element_e::point>);
 }
 
+void LBvh::find_nearest_batch(const TV *pos, std::size_t n, Ti *ids,
+                              float *dists, TV *ws) const {
+  std::shared_ptr<const PrimitiveObject> prim = primPtr.lock();
+  if (!prim)
+    throw std::runtime_error(
+        "the primitive object referenced by lbvh not available anymore");
+  if (eleCategory == element_e::tet)
+    nearest_batch<element_e::tet>(*this, *prim, pos, n, ids, dists, ws);
+  else if (eleCategory == element_e::tri)
+    nearest_batch<element_e::tri>(*this, *prim, pos, n, ids, dists, ws);
+  else if (eleCategory == element_e::line)
+    nearest_batch<element_e::line>(*this, *prim, pos, n, ids, dists, ws);
+  else // if (eleCategory == element_e::point)
+    nearest_batch<element_e::point>(*this, *prim, pos, n, ids, dists, ws);
+}
 
 template <LBvh::element_e et>
 typename LBvh::TV LBvh::find_nearest_with_uv(TV const &pos, TV const &uv, Ti &id, float &dist,
@@ -660,19 +508,9 @@ typename LBvh::TV LBvh::find_nearest_with_uv(TV const &pos, TV const &uv, Ti &id
   // [uv] property existence is guaranteed
   refUvs = prim->verts.attr<zeno::vec3f>("uv").data();
 
-  const Ti numNodes = sortedBvs.size();
-  Ti node = 0;
   TV ws{0.f, 0.f, 0.f};
   TV wsTmp{0.f, 0.f, 0.f}, wsUvTmp{};
-  while (node != -1 && node != numNodes) {
-    Ti level = levels[node];
-    // level and node are always in sync
-    for (; level; --level, ++node)
-      if (auto d = distance(sortedBvs[node], pos); d > dist + distEps)
-        break;
-    // leaf node check
-    if (level == 0) {
-      const auto eid = auxIndices[node];
+  iter_nearest(pos, [&] { return dist + distEps; }, [&](Ti eid) {
       float d = std::numeric_limits<float>::max();
       zeno::vec3f refUv{0, 0, 0};
 
@@ -729,10 +567,7 @@ typename LBvh::TV LBvh::find_nearest_with_uv(TV const &pos, TV const &uv, Ti &id
         uvDist2 = newUvDist2;
       }
 #endif
-      node++;
-    } else // separate at internal nodes
-      node = auxIndices[node];
-  }
+  });
   return ws;
 }
 
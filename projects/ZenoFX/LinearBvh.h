@@ -7,13 +7,21 @@
 #include <zeno/zeno.h>
 #include <exception>
 #include <stdexcept>
+#include <limits>
 #include "SpatialUtils.hpp"
 #if defined(_OPENMP)
 #include <omp.h>
 #endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ZENO_LBVH_SSE 1
+#endif
 
 namespace zeno {
 
+// 4-wide bvh over the points, lines, tris or tets of a primitive. the topology
+// comes from a morton ordering of the element centers and is laid out level by
+// level, so that both build and refit run one parallel pass per level.
 struct LBvh : IObjectClone<LBvh> {
   enum element_e { point = 0, line, tri, tet, unknown };
   template <element_e et>
@@ -24,12 +32,24 @@ struct LBvh : IObjectClone<LBvh> {
   using Box = std::pair<TV, TV>;
   using Ti = int;
   using Tu = std::make_unsigned_t<Ti>;
-  using BvFunc = std::function<Box(Ti)>;
+
+  // child boxes are stored as SoA so that a point is tested against all four
+  // at once. child[k] >= 0 is an inner node, otherwise ~child[k] is the
+  // element id; unused slots are emptyChild with an inverted box.
+  struct alignas(64) Node {
+    float lower[3][4];
+    float upper[3][4];
+    Ti child[4];
+  };
+  static constexpr Ti emptyChild = std::numeric_limits<Ti>::min();
+  // binary morton splits use up at most 63 code bits plus log2(n) halvings of
+  // duplicate codes, so the 4-wide tree is at most 48 levels deep
+  static constexpr int maxStackSize = 256;
 
   std::weak_ptr<const PrimitiveObject> primPtr;
-  BvFunc getBv;
-  std::vector<Box> sortedBvs;
-  std::vector<Ti> auxIndices, levels, parents, leafIndices;
+  std::vector<Node> nodes;
+  std::vector<Ti> levelOffsets; // nodes of depth d are [levelOffsets[d], levelOffsets[d + 1])
+  Ti numLeaves{0};
   float thickness{0};
   std::string radiusAttr{""};
   element_e eleCategory{element_e::point}; // element category
@@ -49,16 +69,15 @@ struct LBvh : IObjectClone<LBvh> {
     build(prim, thickness, radiusAttr, t);
   }
 
-  std::size_t getNumLeaves() const noexcept { return leafIndices.size(); }
-  std::size_t getNumNodes() const noexcept { return getNumLeaves() * 2 - 1; }
-  BvFunc getBvFunc(const std::shared_ptr<PrimitiveObject> &prim) const;
+  std::size_t getNumLeaves() const noexcept { return numLeaves; }
+  std::size_t getNumNodes() const noexcept { return nodes.size(); }
 
   template <element_e et>
   void build(const std::shared_ptr<PrimitiveObject> &prim, float thickness, std::string radiusAttr, element_t<et>);
 
   void build(const std::shared_ptr<PrimitiveObject> &prim, float thickness, std::string radiusAttr);
 
-
+  /// recompute the boxes after the positions changed, keeping the topology
   void refit();
 
   static bool intersect(const Box &box, const TV &p) noexcept {
@@ -94,18 +113,112 @@ struct LBvh : IObjectClone<LBvh> {
   }
   static float distance(const TV &x, const Box &bv) { return distance(bv, x); }
 
+  /// bit k set when pos lies in child box k grown by radius
+  static int overlap_mask(const Node &n, const TV &pos, float radius) noexcept {
+#if ZENO_LBVH_SSE
+    __m128 r = _mm_set1_ps(radius);
+    __m128 m = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int d = 0; d != 3; ++d) {
+      __m128 p = _mm_set1_ps(pos[d]);
+      m = _mm_and_ps(m, _mm_cmple_ps(_mm_sub_ps(_mm_load_ps(n.lower[d]), r), p));
+      m = _mm_and_ps(m, _mm_cmple_ps(p, _mm_add_ps(_mm_load_ps(n.upper[d]), r)));
+    }
+    return _mm_movemask_ps(m);
+#else
+    int mask = 0;
+    for (int k = 0; k != 4; ++k) {
+      bool in = true;
+      for (int d = 0; d != 3; ++d)
+        in = in && !(pos[d] < n.lower[d][k] - radius || pos[d] > n.upper[d][k] + radius);
+      mask |= (int)in << k;
+    }
+    return mask;
+#endif
+  }
+
+  /// squared distances from pos to the four child boxes, 0 inside
+  static void box_dist2(const Node &n, const TV &pos, float d2[4]) noexcept {
+#if ZENO_LBVH_SSE
+    __m128 zero = _mm_setzero_ps();
+    __m128 acc = zero;
+    for (int d = 0; d != 3; ++d) {
+      __m128 p = _mm_set1_ps(pos[d]);
+      __m128 t = _mm_max_ps(_mm_sub_ps(_mm_load_ps(n.lower[d]), p),
+                            _mm_sub_ps(p, _mm_load_ps(n.upper[d])));
+      t = _mm_max_ps(t, zero);
+      acc = _mm_add_ps(acc, _mm_mul_ps(t, t));
+    }
+    _mm_storeu_ps(d2, acc);
+#else
+    for (int k = 0; k != 4; ++k) {
+      float acc = 0;
+      for (int d = 0; d != 3; ++d) {
+        float t = std::max(std::max(n.lower[d][k] - pos[d], pos[d] - n.upper[d][k]), 0.f);
+        acc += t * t;
+      }
+      d2[k] = acc;
+    }
+#endif
+  }
+
+  /// visits the elements nearest-box first, skipping subtrees farther away
+  /// than bound() (re-read after every leaf(eid) call)
+  template <class Bound, class Leaf>
+  void iter_nearest(TV const &pos, Bound &&bound, Leaf &&leaf) const {
+    if (nodes.empty())
+      return;
+    struct Entry {
+      Ti node;
+      float d2;
+    };
+    Entry stack[maxStackSize];
+    int top = 0;
+    stack[top++] = {0, 0.f};
+    while (top) {
+      Entry e = stack[--top];
+      float b = bound();
+      if (e.d2 > b * b)
+        continue;
+      if (e.node < 0) {
+        leaf(~e.node);
+        continue;
+      }
+      const Node &n = nodes[e.node];
+      float d2[4];
+      box_dist2(n, pos, d2);
+      // push the farthest first so that the nearest child is visited next
+      Entry cs[4];
+      int nc = 0;
+      for (int k = 0; k != 4; ++k) {
+        if (n.child[k] == emptyChild || d2[k] > b * b)
+          continue;
+        Entry c{n.child[k], d2[k]};
+        int j = nc++;
+        for (; j > 0 && cs[j - 1].d2 < c.d2; --j)
+          cs[j] = cs[j - 1];
+        cs[j] = c;
+      }
+      for (int j = 0; j != nc; ++j)
+        stack[top++] = cs[j];
+    }
+  }
 
   /// closest bounding box
   template <element_e et>
   TV find_nearest(TV const &pos, Ti &id, float &dist, element_t<et>) const;
   TV find_nearest(TV const &pos, Ti &id, float &dist) const;
 
+  /// find_nearest for n points at once; queries are grouped in morton order
+  /// and each one starts from the previous answer, which makes the bound tight
+  /// from the first node on. ids/dists/ws may be null when not needed.
+  void find_nearest_batch(const TV *pos, std::size_t n, Ti *ids, float *dists, TV *ws) const;
+
   template <element_e et>
   TV find_nearest_with_uv(TV const &pos, TV const &uv, Ti &id, float &dist, float &uvDist, float distEps, element_t<et>) const;
   TV find_nearest_with_uv(TV const &pos, TV const &uv, Ti &id, float &dist, float &uvDist, float distEps = std::numeric_limits<float>::epsilon() * 4) const;
 
   template <typename SameGroupPred, element_e et = element_e::tri>
-  TV find_nearest_within_group(TV const &pos, Ti &id, float &dist, SameGroupPred &&pred, 
+  TV find_nearest_within_group(TV const &pos, Ti &id, float &dist, SameGroupPred &&pred,
                         element_t<et> = {}) const {
   std::shared_ptr<const PrimitiveObject> prim = primPtr.lock();
   if (!prim)
@@ -113,19 +226,9 @@ struct LBvh : IObjectClone<LBvh> {
         "the primitive object referenced by lbvh not available anymore");
   const auto &refpos = prim->attr<vec3f>("pos");
 
-  const Ti numNodes = sortedBvs.size();
-  Ti node = 0;
   TV ws{0.f, 0.f, 0.f};
   TV wsTmp{0.f, 0.f, 0.f};
-  while (node != -1 && node != numNodes) {
-    Ti level = levels[node];
-    // level and node are always in sync
-    for (; level; --level, ++node)
-      if (auto d = distance(sortedBvs[node], pos); d > dist)
-        break;
-    // leaf node check
-    if (level == 0) {
-      const auto eid = auxIndices[node];
+  iter_nearest(pos, [&] { return dist; }, [&](Ti eid) {
       float d = std::numeric_limits<float>::max();
       if constexpr (et == element_e::point) {
         auto pt = prim->points[eid];
@@ -165,10 +268,7 @@ struct LBvh : IObjectClone<LBvh> {
         dist = d;
         ws = wsTmp;
       }
-      node++;
-    } else // separate at internal nodes
-      node = auxIndices[node];
-  }
+  });
   return ws;
 }
 
@@ -176,52 +276,28 @@ struct LBvh : IObjectClone<LBvh> {
   vec3f retrievePrimitiveCenter(Ti eid, const TV &w) const;
 
   template <class F> void iter_neighbors(TV const &pos, F &&f) const {
-    if (auto numLeaves = getNumLeaves(); numLeaves <= 2) {
-      for (Ti i = 0; i != numLeaves; ++i) {
-        if (intersect(sortedBvs[i], pos))
-          f(auxIndices[i]);
-      }
-      return;
-    }
-    const Ti numNodes = sortedBvs.size();
-    Ti node = 0;
-    while (node != -1 && node != numNodes) {
-      Ti level = levels[node];
-      // level and node are always in sync
-      for (; level; --level, ++node)
-        if (!intersect(sortedBvs[node], pos))
-          break;
-      // leaf node check
-      if (level == 0) {
-        if (intersect(sortedBvs[node], pos))
-          f(auxIndices[node]);
-        node++;
-      } else // separate at internal nodes
-        node = auxIndices[node];
-    }
+    iter_neighbors_radius(pos, 0.f, std::forward<F>(f));
   }
 
-   template <class F> void iter_neighbors_radius(TV const &pos, const float &radius, F &&f) const {
-    if (auto numLeaves = getNumLeaves(); numLeaves <= 2) {
-      for (Ti i = 0; i != numLeaves; ++i) {
-        if (intersect_radius(sortedBvs[i], pos, radius))
-          f(auxIndices[i]);
-      }
+  /// calls f(eid) for every element whose box, grown by radius, contains pos,
+  /// in morton order of the elements
+  template <class F> void iter_neighbors_radius(TV const &pos, const float &radius, F &&f) const {
+    if (nodes.empty())
       return;
-    }
-    const Ti numNodes = sortedBvs.size();
-    Ti node = 0;
-    while (node != -1 && node != numNodes) {
-      Ti level = levels[node];
-      for (; level; --level, ++node)
-        if (!intersect_radius(sortedBvs[node], pos, radius))
-          break;
-      if (level == 0) {
-        if (intersect_radius(sortedBvs[node], pos, radius))
-          f(auxIndices[node]);
-        node++;
-      } else
-        node = auxIndices[node];
+    Ti stack[maxStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+      Ti node = stack[--top];
+      if (node < 0) {
+        f(~node);
+        continue;
+      }
+      const Node &n = nodes[node];
+      int mask = overlap_mask(n, pos, radius);
+      for (int k = 3; k >= 0; --k)
+        if (mask >> k & 1)
+          stack[top++] = n.child[k];
     }
   }
 
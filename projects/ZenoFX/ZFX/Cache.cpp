@@ -0,0 +1,48 @@
+#include <zfx/cache.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cstdio>
+
+namespace zfx {
+
+static std::filesystem::path cache_file(std::string const &dir, uint64_t hash, char const *ext) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+    return std::filesystem::u8path(dir) / (name + std::string(ext));
+}
+
+bool disk_cache_load(std::string const &dir, uint64_t hash, char const *ext, std::string &blob) {
+    std::ifstream fin(cache_file(dir, hash, ext), std::ios::binary);
+    if (!fin)
+        return false;
+    std::ostringstream ss;
+    ss << fin.rdbuf();
+    blob = ss.str();
+    return !blob.empty();
+}
+
+void disk_cache_store(std::string const &dir, uint64_t hash, char const *ext, std::string const &blob) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::u8path(dir), ec);
+    auto path = cache_file(dir, hash, ext);
+    auto tmppath = path;
+    tmppath += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream fout(tmppath, std::ios::binary);
+        if (!fout)
+            return;
+        fout.write(blob.data(), blob.size());
+        if (!fout) {
+            fout.close();
+            std::filesystem::remove(tmppath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmppath, path, ec);
+    if (ec)
+        std::filesystem::remove(tmppath, ec);
+}
+
+}
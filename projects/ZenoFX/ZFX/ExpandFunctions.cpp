@@ -185,6 +185,17 @@ struct ExpandFunctions : Visitor<ExpandFunctions> {
             
             return ir->emplace_back<VectorComposeStmt>(3, retargs);;
 
+        } else if (name == "noise" || name == "snoise") {
+            // noise(p) and noise(x, y, z) both call out with three scalars
+            std::vector<Stm> comps;
+            for (auto const &arg: args) {
+                auto x = make_stm(arg);
+                for (int d = 0; d < x->dim; d++) {
+                    comps.push_back(x[d]);
+                }
+            }
+            return stm_func(name, comps);
+
         } else if (name == "all") {
             ERROR_IF(args.size() != 1);
             auto x = make_stm(args[0]);
@@ -161,6 +161,17 @@ struct TypeCheck : Visitor<TypeCheck> {
             }
             stmt->dim = 3;
 
+        } else if (contains({"noise", "snoise"}, name)) {
+            int argdim = 0;
+            for (auto const &arg: stmt->args) {
+                argdim += arg->dim;
+            }
+            if (argdim != 3) {
+                error("function `%s` expects a 3-D position, got %d components",
+                    name.c_str(), argdim);
+            }
+            stmt->dim = 1;
+
         } else if (contains({"applyAffine"}, name)) {
             if (stmt->args.size() != 5) {
                 error("function `%s` takes exactly 5 arguments", name.c_str());
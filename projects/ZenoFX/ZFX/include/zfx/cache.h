@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+namespace zfx {
+
+// bump when the compiler passes or the machine code layout change, so that
+// stale on-disk entries are ignored
+inline constexpr int cache_version = 2;
+
+inline uint64_t hash_string(std::string const &s, uint64_t h = 14695981039346656037ull) {
+    for (unsigned char c: s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// thread-safe LRU map from source text to compiled objects, entries are
+// looked up by hash and verified against the full key
+template <class T>
+struct LRUCache {
+    std::size_t max_entries = 256;
+
+    std::shared_ptr<T const> find(uint64_t hash, std::string const &key) {
+        std::lock_guard lck(mtx);
+        auto it = index.find(hash);
+        if (it == index.end() || it->second->key != key)
+            return nullptr;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->value;
+    }
+
+    std::shared_ptr<T const> insert(uint64_t hash, std::string key, std::shared_ptr<T const> value) {
+        std::lock_guard lck(mtx);
+        if (auto it = index.find(hash); it != index.end()) {
+            if (it->second->key == key)
+                return it->second->value;   // someone else compiled it meanwhile
+            entries.erase(it->second);      // hash collision, newest wins
+            index.erase(it);
+        }
+        entries.push_front({hash, std::move(key), value});
+        index.emplace(hash, entries.begin());
+        while (entries.size() > std::max<std::size_t>(max_entries, 1)) {
+            index.erase(entries.back().hash);
+            entries.pop_back();
+        }
+        return value;
+    }
+
+    std::size_t size() const {
+        std::lock_guard lck(mtx);
+        return entries.size();
+    }
+
+    void clear() {
+        std::lock_guard lck(mtx);
+        index.clear();
+        entries.clear();
+    }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::string key;
+        std::shared_ptr<T const> value;
+    };
+
+    mutable std::mutex mtx;
+    std::list<Entry> entries;   // most recently used first
+    std::unordered_map<uint64_t, typename std::list<Entry>::iterator> index;
+};
+
+struct BlobWriter {
+    std::string out;
+
+    template <class T>
+    void pod(T const &t) {
+        out.append((char const *)&t, sizeof(T));
+    }
+
+    void bytes(void const *p, std::size_t n) {
+        pod((uint64_t)n);
+        out.append((char const *)p, n);
+    }
+
+    void str(std::string const &s) {
+        bytes(s.data(), s.size());
+    }
+};
+
+struct BlobReader {
+    char const *p;
+    char const *end;
+
+    explicit BlobReader(std::string const &s) : p(s.data()), end(s.data() + s.size()) {}
+
+    template <class T>
+    bool pod(T &t) {
+        if ((std::size_t)(end - p) < sizeof(T))
+            return false;
+        std::memcpy(&t, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool str(std::string &s) {
+        uint64_t n;
+        if (!pod(n) || (uint64_t)(end - p) < n)
+            return false;
+        s.assign(p, n);
+        p += n;
+        return true;
+    }
+};
+
+// blobs are stored as <dir>/<hash><ext>, writes go through a temporary file
+// and a rename so that concurrent processes never see partial entries
+bool disk_cache_load(std::string const &dir, uint64_t hash, char const *ext, std::string &blob);
+void disk_cache_store(std::string const &dir, uint64_t hash, char const *ext, std::string const &blob);
+
+}
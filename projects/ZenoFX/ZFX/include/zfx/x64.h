@@ -4,20 +4,25 @@
 #include <cstring>
 #include <string>
 #include <map>
+#include <zfx/cache.h>
 
 namespace zfx::x64 {
 
 struct Executable {
     uint8_t *mem = nullptr;
     size_t memsize = 0;
+    std::shared_ptr<uint8_t> pages;     // owns mem, shared by clones
+    int nconsts = 0;
+    int nlocals = 0;
     float consts[1024];
     void **functable = nullptr;
 
-    static constexpr size_t SimdWidth = 4;
+    static constexpr size_t MaxSimdWidth = 8;
+    size_t SimdWidth = 4;   // 8 when assembled for ymm registers
 
     struct Context {
         Executable *exec;
-        float locals[SimdWidth * 256];
+        float locals[MaxSimdWidth * 256];
 
         void execute() {
             auto entry = (void(*)(void *, void *, void *))exec->mem;
@@ -25,10 +30,25 @@ struct Executable {
         }
 
         float *channel(int chid) {
-            return locals + SimdWidth * chid;
+            return locals + exec->SimdWidth * chid;
         }
     };
 
+    // symbol i of element n lives at chs[i].base[chs[i].stride * n]
+    struct Channel {
+        float *base;
+        size_t stride;
+    };
+
+    // runs elements [begin, end) reading and writing the channels in place,
+    // safe to call concurrently on disjoint ranges
+    void execute_strided
+        ( Channel const *chs
+        , size_t nchs
+        , size_t begin
+        , size_t end
+        ) const;
+
     inline float &parameter(int parid) {
         return consts[parid];
     }
@@ -41,23 +61,24 @@ struct Executable {
     Executable(Executable const &) = delete;
     ~Executable();
 
+    // shares the machine code, but has its own copy of the parameters
+    std::unique_ptr<Executable> clone() const;
+
+    // simd_width is 4 or 8, anything else picks the widest supported one
     static std::unique_ptr<Executable> assemble
         ( std::string const &lines
+        , int simd_width = 0
         );
 };
 
+// safe to share between threads, every assemble() returns a private clone of
+// the cached executable so that callers can set parameters independently
 struct Assembler {
-    std::map<std::string, std::unique_ptr<Executable>> cache;
+    LRUCache<Executable> cache;
+    std::string cache_dir;  // also keep machine code on disk here, unless empty
+    int simd_width = 0;     // 4 or 8, anything else picks the widest supported one
 
-    Executable *assemble(std::string const &lines) {
-        if (auto it = cache.find(lines); it != cache.end()) {
-            return it->second.get();
-        }
-        auto prog = Executable::assemble(lines);
-        auto raw_ptr = prog.get();
-        cache[lines] = std::move(prog);
-        return raw_ptr;
-    }
+    std::unique_ptr<Executable> assemble(std::string const &lines);
 };
 
 }
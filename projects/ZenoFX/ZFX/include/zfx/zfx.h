@@ -7,6 +7,7 @@
 #include <memory>
 #include <tuple>
 #include <map>
+#include <zfx/cache.h>
 
 namespace zfx {
 
@@ -68,6 +69,12 @@ struct Options {
         os << '|' << reassign_channels;
         os << '|' << save_math_registers;
         os << '|' << arch_maxregs;
+        os << '|' << demote_math_funcs;
+        os << '|' << detect_new_symbols;
+        os << '|' << reassign_parameters;
+        os << '|' << merge_identical;
+        os << '|' << kill_unreachable;
+        os << '|' << constant_fold;
     }
 };
 
@@ -116,42 +123,15 @@ struct Program {
     }
 };
 
+// safe to share between threads, programs are immutable once compiled
 struct Compiler {
-    std::map<std::string, std::unique_ptr<Program>> cache;
+    LRUCache<Program> cache;
+    std::string cache_dir;  // also keep programs on disk here, unless empty
 
-    Program *compile
+    std::shared_ptr<Program const> compile
         ( std::string const &code
         , Options const &options
-        ) {
-        std::ostringstream ss;
-        ss << code << "<EOF>";
-        options.dump(ss);
-        auto key = ss.str();
-
-        auto it = cache.find(key);
-        if (it != cache.end()) {
-            return it->second.get();
-        }
-
-        auto 
-            [ assembly
-            , symbols
-            , params
-            , newsyms
-            ] = compile_to_assembly
-            ( code
-            , options
-            );
-        auto prog = std::make_unique<Program>();
-        prog->assembly = assembly;
-        prog->symbols = symbols;
-        prog->params = params;
-        prog->newsyms = newsyms;
-
-        auto raw_ptr = prog.get();
-        cache[key] = std::move(prog);
-        return raw_ptr;
-    }
+        );
 };
 
 }
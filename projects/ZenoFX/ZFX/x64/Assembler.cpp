@@ -5,7 +5,14 @@
 #include <zfx/x64.h>
 #include <algorithm>
 #include <sstream>
+#include <cstring>
+#include <vector>
 #include <map>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 namespace zfx::x64 {
 
@@ -15,17 +22,25 @@ namespace zfx::x64 {
     } \
 } while (0)
 
+static void **get_functable(int width);
+static void load_code(Executable *exec, uint8_t const *code, size_t size);
+
 struct ImplAssembler {
     int simdkind = simdtype::xmmps;
+    int width = 4;
 
     std::unique_ptr<SIMDBuilder> builder = std::make_unique<SIMDBuilder>();
     std::unique_ptr<Executable> exec = std::make_unique<Executable>();
-    static inline std::unique_ptr<FuncTable> functable;
 
     int nconsts = 0;
     int nlocals = 0;
     //int nglobals = 0;
 
+    explicit ImplAssembler(int width) : width(width) {
+        if (width == 8)
+            simdkind = simdtype::ymmps;
+    }
+
     static float parse_float(std::string const &expr) {
         float value = 0.0f;
         if (std::istringstream(expr) >> value)
@@ -50,6 +65,7 @@ struct ImplAssembler {
                 auto id = from_string<int>(linesep[1]);
                 auto expr = linesep[2];
                 exec->consts[id] = parse_float(expr);
+                nconsts = std::max(nconsts, id + 1);
 
             } else if (cmd == "ldp") {
                 // rsi points to an array of constants
@@ -296,6 +312,8 @@ struct ImplAssembler {
                     builder->addRegularMoveOp(opreg::a1, opreg::rsp);
                     int id = it - FuncTable::funcnames.begin();
                     int offset = id * sizeof(void *);
+                    if (width > 4)  // all live registers are spilled around calls
+                        builder->addAvxZeroUpper();
 #if defined(_WIN32)
                     builder->addAdjStackTop(-64);
 #endif
@@ -309,6 +327,43 @@ struct ImplAssembler {
                     builder->addPopReg(opreg::a1);
                     builder->addPopReg(opreg::a2);
                     builder->addPopReg(opreg::a3);
+                } else if (linesep.size() == 5) {
+                    // three arguments are passed as one array of 3 * width floats
+                    auto dst = from_string<int>(linesep[1]);
+                    auto x = from_string<int>(linesep[2]);
+                    auto y = from_string<int>(linesep[3]);
+                    auto z = from_string<int>(linesep[4]);
+                    builder->addPushReg(opreg::a3);
+                    builder->addPushReg(opreg::a2);
+                    builder->addPushReg(opreg::a1);
+                    int size = SIMDBuilder::sizeOfType(simdkind);
+                    builder->addAdjStackTop(-size);
+                    builder->addAvxMemoryOp(simdkind, opcode::storeu,
+                        z, opreg::rsp);
+                    builder->addAdjStackTop(-size);
+                    builder->addAvxMemoryOp(simdkind, opcode::storeu,
+                        y, opreg::rsp);
+                    builder->addAdjStackTop(-size);
+                    builder->addAvxMemoryOp(simdkind, opcode::storeu,
+                        x, opreg::rsp);
+                    builder->addRegularMoveOp(opreg::a1, opreg::rsp);
+                    int id = it - FuncTable::funcnames.begin();
+                    int offset = id * sizeof(void *);
+                    if (width > 4)  // all live registers are spilled around calls
+                        builder->addAvxZeroUpper();
+#if defined(_WIN32)
+                    builder->addAdjStackTop(-64);
+#endif
+                    builder->addCallOp({opreg::a3, memflag::reg_imm8, offset});
+#if defined(_WIN32)
+                    builder->addAdjStackTop(64);
+#endif
+                    builder->addAvxMemoryOp(simdkind, opcode::loadu,
+                        dst, opreg::rsp);
+                    builder->addAdjStackTop(size * 3);
+                    builder->addPopReg(opreg::a1);
+                    builder->addPopReg(opreg::a2);
+                    builder->addPopReg(opreg::a3);
                 } else {
                     auto dst = from_string<int>(linesep[1]);
                     auto lhs = from_string<int>(linesep[2]);
@@ -327,6 +382,8 @@ struct ImplAssembler {
                     builder->addRegularMoveOp(opreg::a1, opreg::rsp);
                     int id = it - FuncTable::funcnames.begin();
                     int offset = id * sizeof(void *);
+                    if (width > 4)  // all live registers are spilled around calls
+                        builder->addAvxZeroUpper();
 #if defined(_WIN32)
                     builder->addAdjStackTop(-64);
 #endif
@@ -347,6 +404,8 @@ struct ImplAssembler {
             }
         }
 
+        if (width > 4)
+            builder->addAvxZeroUpper();
         builder->addReturn();
         auto const &insts = builder->getResult();
 
@@ -364,31 +423,208 @@ struct ImplAssembler {
         }
 #endif
 
-        if (!functable)
-            functable = std::make_unique<FuncTable>();
-        exec->functable = functable->funcptrs.data();
-        exec->memsize = (insts.size() + 4095) / 4096 * 4096;
-        exec->mem = (uint8_t *)exec_page_allocate(exec->memsize);
-        for (int i = 0; i < insts.size(); i++) {
-            exec->mem[i] = insts[i];
-        }
-        exec_page_mark_executable(exec->mem, exec->memsize);
+        exec->SimdWidth = width;
+        exec->nconsts = nconsts;
+        exec->nlocals = nlocals;
+        exec->functable = get_functable(width);
+        load_code(exec.get(), insts.data(), insts.size());
     }
 };
 
+static void **get_functable(int width) {
+    static FuncTable functable4(4), functable8(8);
+    return width == 8 ? functable8.funcptrs.data() : functable4.funcptrs.data();
+}
+
+// every program needs AVX for the VEX encodings already, 8 lanes just need
+// the OS to also preserve the upper halves of ymm registers
+static int detect_simd_width() {
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    unsigned ecx = info[2];
+#else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 4;
+#endif
+    bool osxsave = ecx & (1u << 27), avx = ecx & (1u << 28);
+    if (!osxsave || !avx)
+        return 4;
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned xlo, xhi;
+    __asm__ volatile ("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+    unsigned long long xcr0 = xlo | (unsigned long long)xhi << 32;
+#endif
+    return (xcr0 & 6) == 6 ? 8 : 4;
+#else
+    return 4;
+#endif
+}
+
+static int resolve_simd_width(int width) {
+    static int detected = detect_simd_width();
+    if (width == 4 || width == 8)
+        return std::min(width, detected);
+    return detected;
+}
+
+static void load_code(Executable *exec, uint8_t const *code, size_t size) {
+    auto memsize = (size + 4095) / 4096 * 4096;
+    auto mem = (uint8_t *)exec_page_allocate(memsize);
+    std::memcpy(mem, code, size);
+    exec_page_mark_executable(mem, memsize);
+    exec->mem = mem;
+    exec->memsize = memsize;
+    exec->pages = std::shared_ptr<uint8_t>(mem, [memsize] (uint8_t *p) {
+        exec_page_free(p, memsize);
+    });
+}
+
 std::unique_ptr<Executable> Executable::assemble
     ( std::string const &lines
+    , int simd_width
     ) {
-    ImplAssembler a;
+    ImplAssembler a(resolve_simd_width(simd_width));
     a.parse(lines);
     return std::move(a.exec);
 }
 
-Executable::~Executable() {
-    if (mem) {
-        exec_page_free(mem, memsize);
-        mem = nullptr;
-        memsize = 0;
+std::unique_ptr<Executable> Executable::clone() const {
+    auto exec = std::make_unique<Executable>();
+    exec->mem = mem;
+    exec->memsize = memsize;
+    exec->pages = pages;
+    exec->SimdWidth = SimdWidth;
+    exec->nconsts = nconsts;
+    exec->nlocals = nlocals;
+    exec->functable = functable;
+    std::memcpy(exec->consts, consts, sizeof(consts));
+    return exec;
+}
+
+Executable::~Executable() = default;
+
+// the code only reaches the function table and constants through registers,
+// so it can be reloaded at any address, as long as the table layout matches
+static std::string cache_abi(int width) {
+    std::string abi = "x64/" + std::to_string(width);
+    for (auto const &name: FuncTable::funcnames)
+        abi += '/' + name;
+    return abi;
+}
+
+static std::string dump_executable(std::string const &lines, Executable const &exec, size_t codesize) {
+    BlobWriter w;
+    w.pod((int32_t)cache_version);
+    w.str(cache_abi(exec.SimdWidth));
+    w.str(lines);
+    w.pod((int32_t)exec.nlocals);
+    w.pod((int32_t)exec.nconsts);
+    w.bytes(exec.consts, exec.nconsts * sizeof(float));
+    w.bytes(exec.mem, codesize);
+    return std::move(w.out);
+}
+
+static std::unique_ptr<Executable> load_executable(std::string const &lines, int width, std::string const &blob) {
+    BlobReader r(blob);
+    int32_t version, nlocals, nconsts;
+    std::string abi, savedlines, consts, code;
+    if (!r.pod(version) || version != cache_version || !r.str(abi) || abi != cache_abi(width)
+        || !r.str(savedlines) || savedlines != lines || !r.pod(nlocals)
+        || nlocals < 0 || nlocals > 256 || !r.pod(nconsts)
+        || nconsts < 0 || nconsts > 1024 || !r.str(consts)
+        || consts.size() != nconsts * sizeof(float) || !r.str(code) || code.empty())
+        return nullptr;
+    auto exec = std::make_unique<Executable>();
+    exec->SimdWidth = width;
+    exec->nlocals = nlocals;
+    exec->nconsts = nconsts;
+    std::memcpy(exec->consts, consts.data(), consts.size());
+    exec->functable = get_functable(width);
+    load_code(exec.get(), (uint8_t const *)code.data(), code.size());
+    return exec;
+}
+
+std::unique_ptr<Executable> Assembler::assemble(std::string const &lines) {
+    int width = resolve_simd_width(simd_width);
+    auto hash = hash_string(lines, width);
+    auto key = std::to_string(width) + '\n' + lines;
+    if (auto exec = cache.find(hash, key))
+        return exec->clone();
+
+    std::string blob;
+    if (!cache_dir.empty() && disk_cache_load(cache_dir, hash, ".zfxexe", blob)) {
+        if (auto exec = load_executable(lines, width, blob))
+            return cache.insert(hash, std::move(key), std::move(exec))->clone();
+    }
+
+    ImplAssembler a(width);
+    a.parse(lines);
+    if (!cache_dir.empty()) {
+        auto codesize = a.builder->getResult().size();
+        disk_cache_store(cache_dir, hash, ".zfxexe", dump_executable(lines, *a.exec, codesize));
+    }
+    return cache.insert(hash, std::move(key), std::move(a.exec))->clone();
+}
+
+void Executable::execute_strided
+    ( Channel const *chs
+    , size_t nchs
+    , size_t begin
+    , size_t end
+    ) const {
+    // channels are copied a block of chunks at a time, each channel in one
+    // sequential pass, and the kernel then runs over the block in place
+    size_t w = SimdWidth;
+    size_t nslots = std::max<size_t>(nlocals, nchs);
+    size_t nchunks = std::max<size_t>(1, 8192 / (nslots * w));
+    std::vector<float> buf(nchunks * nslots * w);
+    auto entry = (void(*)(void *, void *, void *))mem;
+
+    for (size_t base = begin; base < end; base += nchunks * w) {
+        size_t n = std::min(nchunks * w, end - base);
+        size_t nfull = n / w, nused = (n + w - 1) / w;
+        for (size_t j = 0; j < nchs; j++) {
+            size_t stride = chs[j].stride;
+            float const *src = chs[j].base + stride * base;
+            for (size_t c = 0; c < nfull; c++) {
+                float *dst = buf.data() + (c * nslots + j) * w;
+                if (stride == 1) {
+                    std::memcpy(dst, src + c * w, w * sizeof(float));
+                } else {
+                    for (size_t k = 0; k < w; k++)
+                        dst[k] = src[stride * (c * w + k)];
+                }
+            }
+            if (nfull < nused) {
+                // pad the last chunk with copies of the last element
+                float *dst = buf.data() + (nfull * nslots + j) * w;
+                for (size_t k = 0; k < w; k++)
+                    dst[k] = src[stride * std::min(nfull * w + k, n - 1)];
+            }
+        }
+
+        for (size_t c = 0; c < nused; c++)
+            entry(buf.data() + c * nslots * w, (void *)consts, (void *)functable);
+
+        for (size_t j = 0; j < nchs; j++) {
+            size_t stride = chs[j].stride;
+            float *dst = chs[j].base + stride * base;
+            for (size_t c = 0; c < nused; c++) {
+                float const *src = buf.data() + (c * nslots + j) * w;
+                size_t nk = std::min(w, n - c * w);
+                if (stride == 1) {
+                    std::memcpy(dst + c * w, src, nk * sizeof(float));
+                } else {
+                    for (size_t k = 0; k < nk; k++)
+                        dst[stride * (c * w + k)] = src[k];
+                }
+            }
+        }
     }
 }
 
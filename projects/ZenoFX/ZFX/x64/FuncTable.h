@@ -4,6 +4,7 @@
 #include "vectorclass/vectorclass.h"
 #include "vectorclass/vectormath_trig.h"
 #include "vectorclass/vectormath_exp.h"
+#include <zeno/utils/noise.h>
 #include <vector>
 #include <string>
 #include <cmath>
@@ -29,6 +30,9 @@ DEF_FN2(pow)
 static void func_fb2i(float *a) { vcl::Vec4f x; x.load(a); x = vcl::fb2i(x); x.store(a); }
 static void func_ib2f(float *a) { vcl::Vec4f x; x.load(a); x = vcl::ib2f(x); x.store(a); }
 static void func_fmod(float *a, float *b) { vcl::Vec4f x, y; x.load(a); y.load(b); x = x - vcl::floor(x / y) * y; x.store(a); }
+// a holds x[0..3], y[0..3], z[0..3]; results go to x
+static void func_noise(float *a) { zeno::noisePerlin(4, zeno::NoisePoints(a, a + 4, a + 8), zeno::NoiseResults(a)); }
+static void func_snoise(float *a) { zeno::noiseSimplex(4, zeno::NoisePoints(a, a + 4, a + 8), zeno::NoiseResults(a)); }
 #undef DEF_FN1
 #undef DEF_FN2
 
@@ -51,15 +55,65 @@ DEF_FN1(ib2f)
 DEF_FN2(atan2)
 DEF_FN2(pow)
 DEF_FN2(fmod)
+DEF_FN1(noise)
+DEF_FN1(snoise)
 #undef DEF_FN1
 #undef DEF_FN2
     };
 
+    // the 8-wide variants run the 4-wide ones on each half, so that results
+    // don't depend on the SIMD width the program was assembled for
+#define DEF_FN1(name) static void func8_##name(float *a) { func_##name(a); func_##name(a + 4); }
+#define DEF_FN2(name) static void func8_##name(float *a, float *b) { func_##name(a, b); func_##name(a + 4, b + 4); }
+DEF_FN1(sin)
+DEF_FN1(cos)
+DEF_FN1(tan)
+DEF_FN1(asin)
+DEF_FN1(acos)
+DEF_FN1(atan)
+DEF_FN1(exp)
+DEF_FN1(log)
+DEF_FN1(floor)
+DEF_FN1(round)
+DEF_FN1(ceil)
+DEF_FN1(fb2i)
+DEF_FN1(ib2f)
+DEF_FN2(atan2)
+DEF_FN2(pow)
+DEF_FN2(fmod)
+#undef DEF_FN1
+#undef DEF_FN2
+static void func8_noise(float *a) { zeno::noisePerlin(8, zeno::NoisePoints(a, a + 8, a + 16), zeno::NoiseResults(a)); }
+static void func8_snoise(float *a) { zeno::noiseSimplex(8, zeno::NoisePoints(a, a + 8, a + 16), zeno::NoiseResults(a)); }
+
     std::vector<void *> funcptrs;
 
-    FuncTable() {
+    explicit FuncTable(int width = 4) {
         // we have to assign funcptrs at runtime to prevent dll relocation
-        for (int i = 0; i < funcnames.size(); i++) {
+        if (width == 8) {
+#define DEF_FN1(name) funcptrs.push_back((void *)func8_##name);
+#define DEF_FN2(name) DEF_FN1(name)
+DEF_FN1(sin)
+DEF_FN1(cos)
+DEF_FN1(tan)
+DEF_FN1(asin)
+DEF_FN1(acos)
+DEF_FN1(atan)
+DEF_FN1(exp)
+DEF_FN1(log)
+DEF_FN1(floor)
+DEF_FN1(round)
+DEF_FN1(ceil)
+DEF_FN1(fb2i)
+DEF_FN1(ib2f)
+DEF_FN2(atan2)
+DEF_FN2(pow)
+DEF_FN2(fmod)
+DEF_FN1(noise)
+DEF_FN1(snoise)
+#undef DEF_FN1
+#undef DEF_FN2
+        } else {
 #define DEF_FN1(name) funcptrs.push_back((void *)func_##name);
 #define DEF_FN2(name) DEF_FN1(name)
 DEF_FN1(sin)
@@ -78,6 +132,8 @@ DEF_FN1(ib2f)
 DEF_FN2(atan2)
 DEF_FN2(pow)
 DEF_FN2(fmod)
+DEF_FN1(noise)
+DEF_FN1(snoise)
 #undef DEF_FN1
 #undef DEF_FN2
         }
@@ -268,7 +268,7 @@ struct SIMDBuilder {   // requires AVX2
     }
 
     void addAvxMoveOp(int type, int dst, int src) {
-        addAvxBinaryOp(opcode::loadu, opcode::mov, dst, opreg::mm0, src);
+        addAvxBinaryOp(type, opcode::mov, dst, opreg::mm0, src);
     }
 
     void addJumpOp(int off) {
@@ -295,6 +295,12 @@ struct SIMDBuilder {   // requires AVX2
         res.push_back(0x58 | reg & 0x7);
     }
 
+    void addAvxZeroUpper() {
+        res.push_back(0xc5);
+        res.push_back(0xf8);
+        res.push_back(0x77);
+    }
+
     void addReturn() {
         res.push_back(0xc3);
     }
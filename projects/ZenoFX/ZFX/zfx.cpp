@@ -272,4 +272,92 @@ std::tuple
         };
 }
 
+static void write_pairs(BlobWriter &w, std::vector<std::pair<std::string, int>> const &v) {
+    w.pod((uint64_t)v.size());
+    for (auto const &[name, dim]: v) {
+        w.str(name);
+        w.pod((int32_t)dim);
+    }
+}
+
+static bool read_pairs(BlobReader &r, std::vector<std::pair<std::string, int>> &v) {
+    uint64_t n;
+    if (!r.pod(n))
+        return false;
+    for (uint64_t i = 0; i < n; i++) {
+        std::string name;
+        int32_t dim;
+        if (!r.str(name) || !r.pod(dim))
+            return false;
+        v.emplace_back(std::move(name), dim);
+    }
+    return true;
+}
+
+static std::string dump_program(std::string const &key, Program const &prog) {
+    BlobWriter w;
+    w.pod((int32_t)cache_version);
+    w.str(key);
+    w.str(prog.assembly);
+    write_pairs(w, prog.symbols);
+    write_pairs(w, prog.params);
+    write_pairs(w, {prog.newsyms.begin(), prog.newsyms.end()});
+    return std::move(w.out);
+}
+
+static std::shared_ptr<Program> load_program(std::string const &key, std::string const &blob) {
+    BlobReader r(blob);
+    int32_t version;
+    std::string savedkey;
+    if (!r.pod(version) || version != cache_version || !r.str(savedkey) || savedkey != key)
+        return nullptr;
+    auto prog = std::make_shared<Program>();
+    std::vector<std::pair<std::string, int>> newsyms;
+    if (!r.str(prog->assembly) || !read_pairs(r, prog->symbols)
+        || !read_pairs(r, prog->params) || !read_pairs(r, newsyms))
+        return nullptr;
+    prog->newsyms.insert(newsyms.begin(), newsyms.end());
+    return prog;
+}
+
+std::shared_ptr<Program const> Compiler::compile
+    ( std::string const &code
+    , Options const &options
+    ) {
+    std::ostringstream ss;
+    ss << code << "<EOF>";
+    options.dump(ss);
+    auto key = ss.str();
+    auto hash = hash_string(key);
+
+    if (auto prog = cache.find(hash, key))
+        return prog;
+
+    std::string blob;
+    if (!cache_dir.empty() && disk_cache_load(cache_dir, hash, ".zfxprog", blob)) {
+        if (auto prog = load_program(key, blob))
+            return cache.insert(hash, std::move(key), std::move(prog));
+    }
+
+    // compile outside of the lock, racing threads just do the same work twice
+    auto
+        [ assembly
+        , symbols
+        , params
+        , newsyms
+        ] = compile_to_assembly
+        ( code
+        , options
+        );
+    auto prog = std::make_shared<Program>();
+    prog->assembly = std::move(assembly);
+    prog->symbols = std::move(symbols);
+    prog->params = std::move(params);
+    prog->newsyms = std::move(newsyms);
+
+    if (!cache_dir.empty())
+        disk_cache_store(cache_dir, hash, ".zfxprog", dump_program(key, *prog));
+    return cache.insert(hash, std::move(key), std::move(prog));
+}
+
 }
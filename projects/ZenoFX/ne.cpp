@@ -9,6 +9,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include <vector>
 #include <cctype>
@@ -18,8 +19,8 @@ namespace zeno {
     std::string preApplyRefs(const std::string& code, Graph* pGraph);
 
 namespace {
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 static void numeric_eval (zfx::x64::Executable *exec,
                          std::vector<float> &chs) {
@@ -175,7 +176,7 @@ struct NumericEval : zeno::INode {
         assert(name[0] == '@');
     }
 
-    numeric_eval(exec, chs);
+    numeric_eval(exec.get(), chs);
 
     std::vector<float> resex(chs.size());
     for (int i = 0; i < chs.size(); i++) {
@@ -6,6 +6,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 
@@ -16,8 +17,8 @@ namespace zeno {
 namespace {
     using namespace zeno;
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 static void numeric_wrangle
     ( zfx::x64::Executable *exec
@@ -169,7 +170,7 @@ struct NumericWrangle : zeno::INode {
             assert(name[0] == '@');
         }
 
-        numeric_wrangle(exec, chs);
+        numeric_wrangle(exec.get(), chs);
 
         for (int i = 0; i < chs.size(); i++) {
             auto [name, dimid] = prog->symbols[i];
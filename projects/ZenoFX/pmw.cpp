@@ -7,6 +7,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 
@@ -15,8 +16,8 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 struct Buffer {
     float *base = nullptr;
@@ -218,11 +219,11 @@ struct ParticlesMaskedWrangle : zeno::INode {
         std::string maskAttr = get_input2<std::string>("maskAttr");
         if(prim->attr_is<float>(maskAttr)){
             auto &maskarr = prim->attr<float>(maskAttr);
-            vectors_wrangle(exec, chs, maskarr.data());
+            vectors_wrangle(exec.get(), chs, maskarr.data());
         }
         else if(prim->attr_is<int>(maskAttr)){
             auto &maskarr = prim->attr<int>(maskAttr);
-            vectors_wrangle(exec, chs, maskarr.data());
+            vectors_wrangle(exec.get(), chs, maskarr.data());
         }
         else{
             throw std::runtime_error("mask type not supported");
@@ -9,6 +9,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 #include <cmath>
@@ -20,8 +21,8 @@
 
 namespace zeno {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 struct Buffer {
   float *base = nullptr;
@@ -315,13 +316,17 @@ struct QueryNearestPrimitive : zeno::INode {
 
       std::vector<KVPair> kvs(prim->size());
       std::vector<Ti> ids(prim->size(), -1);
+      std::vector<float> ds(prim->size());
+      std::vector<zeno::vec3f> wss(prim->size());
+      lbvh->find_nearest_batch(prim->verts.data(), prim->size(), ids.data(),
+                               ds.data(), wss.data());
 #if defined(_OPENMP)
-#pragma omp parallel for schedule(guided, 4)
+#pragma omp parallel for
 #endif
       for (Ti i = 0; i < prim->size(); ++i) {
-        kvs[i].dist = std::numeric_limits<float>::max();
+        kvs[i].dist = ds[i];
         kvs[i].pid = i;
-        kvs[i].w = lbvh->find_nearest(prim->verts[i], ids[i], kvs[i].dist);
+        kvs[i].w = wss[i];
         // record info as attribs
         bvhids[i] = ids[i];
         dists[i] = kvs[i].dist;
@@ -547,10 +552,10 @@ struct RematchBestPrimitiveUV : zeno::INode {
       if (!(prim->verts.has_attr("uv") && prim->polys.size() > 1))
         throw std::runtime_error("the input primitive is not a loop-based surface mesh with vertex uv!");
 
-      const auto &pos = prim->verts.values;
+      const auto &pos = prim->verts.values.get();
       auto &uvs = prim->attr<vec3f>("uv");
-      const auto &polys = prim->polys.values;
-      const auto &loops = prim->loops.values;
+      const auto &polys = prim->polys.values.get();
+      const auto &loops = prim->loops.values.get();
 
       /// @note in spatial distance
       // auto threshold = get_input2<float>("threshold");
@@ -559,7 +564,7 @@ struct RematchBestPrimitiveUV : zeno::INode {
       if (!bvhPrim->verts.has_attr("uv"))
         throw std::runtime_error("missing vertex property [uv] in the bvh-associated prim!");
       const auto &refUvs = bvhPrim->verts.attr<zeno::vec3f>("uv");
-      const auto &refTris = bvhPrim->tris.values;
+      const auto &refTris = bvhPrim->tris.values.get();
 
 #if 1
       std::vector<vec3f> targetVertUvs(pos.size());
@@ -941,7 +946,7 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
       chs2[i] = iob;
     }
 
-    bvh_vectors_wrangle(exec, chs, chs2, prim->attr<zeno::vec3f>("pos"),
+    bvh_vectors_wrangle(exec.get(), chs, chs2, prim->attr<zeno::vec3f>("pos"),
                         primNei->attr<zeno::vec3f>("pos"), get_input2<bool>("is_box"),
                         lbvh.get()->thickness * lbvh.get()->thickness, lbvh.get());
 
@@ -1167,7 +1172,7 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
       chs2[i] = iob;
     }
 
-    sorted_bvh_vectors_wrangle(exec, chs, chs2, prim->attr<zeno::vec3f>("pos"),
+    sorted_bvh_vectors_wrangle(exec.get(), chs, chs2, prim->attr<zeno::vec3f>("pos"),
                         primNei->attr<zeno::vec3f>("pos"), get_input2<bool>("is_box"),
                         lbvh.get()->thickness * lbvh.get()->thickness, get_input2<int>("limit"), lbvh.get());
 
@@ -1400,7 +1405,7 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
     }
     std::string maskAttr = get_input2<std::string>("maskAttr");
     const auto &mask = maskAttr == "" ? std::vector<float>(prim->verts.size(), 1.0f) : prim->attr<float>(maskAttr);
-    bvh_vectors_wrangle_radius_two(exec, chs, chs2, mask.data(), prim.get(), prim->attr<zeno::vec3f>("pos"), radiusAttr,
+    bvh_vectors_wrangle_radius_two(exec.get(), chs, chs2, mask.data(), prim.get(), prim->attr<zeno::vec3f>("pos"), radiusAttr,
                         primNei->attr<zeno::vec3f>("pos"), primNei.get(), 
                         get_input2<bool>("is_box"),
                         lbvh.get()->thickness, lbvh.get());
@@ -7,6 +7,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 #include <cmath>
@@ -20,8 +21,8 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 struct Buffer {
     float *base = nullptr;
@@ -30,109 +31,272 @@ struct Buffer {
     int which = 0;
 };
 
+// sorts (key, id) pairs by key with a parallel LSD radix sort, stable so that
+// ids stay ascending within equal keys
+static void radix_sort_pairs(std::vector<uint64_t> &keys, std::vector<int> &ids) {
+    size_t n = keys.size();
+    uint64_t diff = 0;
+    for (size_t i = 1; i < n; i++)
+        diff |= keys[i] ^ keys[0];
+    int nbits = 0;
+    while (nbits < 64 && (diff >> nbits))
+        nbits++;
+
+    std::vector<uint64_t> keys2(n);
+    std::vector<int> ids2(n);
+#if defined(_OPENMP)
+    int nthreads = omp_get_max_threads();
+#else
+    int nthreads = 1;
+#endif
+    std::vector<size_t> hist(nthreads * 256);
+    for (int shift = 0; shift < nbits; shift += 8) {
+        std::fill(hist.begin(), hist.end(), 0);
+        #pragma omp parallel num_threads(nthreads)
+        {
+#if defined(_OPENMP)
+            int tid = omp_get_thread_num();
+            int nt = omp_get_num_threads();
+#else
+            int tid = 0, nt = 1;
+#endif
+            size_t beg = n * tid / nt, end = n * (tid + 1) / nt;
+            size_t *h = hist.data() + tid * 256;
+            for (size_t i = beg; i < end; i++)
+                h[keys[i] >> shift & 255]++;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                size_t sum = 0;
+                for (int d = 0; d < 256; d++) {
+                    for (int t = 0; t < nt; t++) {
+                        size_t c = hist[t * 256 + d];
+                        hist[t * 256 + d] = sum;
+                        sum += c;
+                    }
+                }
+            }
+            for (size_t i = beg; i < end; i++) {
+                size_t o = h[keys[i] >> shift & 255]++;
+                keys2[o] = keys[i];
+                ids2[o] = ids[i];
+            }
+        }
+        keys.swap(keys2);
+        ids.swap(ids2);
+    }
+}
+
+// neighbor search grid with cells of size radius, stored in CSR form: point ids
+// sorted by cell in (z, y, x) order, keeping only the occupied cells. rows of
+// cells are found through an open-addressing table, and the three cells of a
+// row around a point are then one contiguous run of ids. it doesn't reference
+// the positions, so a grid can be kept and rebuilt incrementally next frame.
 struct HashGrid : zeno::IObject {
     float inv_dx;
     float radius;
     float radius_sqr;
     float radius_sqr_min;
-    std::vector<zeno::vec3f> const &refpos;
 
-    std::vector<std::vector<int>> table;
+    struct Row {
+        uint64_t key;
+        int begin = 0, end = 0;     // range in cellKeys, empty slot if equal
+    };
 
-//#define DILEI
-#define XUBEN
+    std::vector<uint64_t> pointKeys;    // cell key of every point
+    std::vector<uint64_t> cellKeys;     // ascending
+    std::vector<int> cellStart;         // cellKeys.size() + 1 offsets into ids
+    std::vector<int> ids;               // ascending within each cell
+    std::vector<Row> rows;              // power of two sized
 
-    int hash(int x, int y, int z) {
-#ifdef XUBEN
-        return (x%gridRes[0]+gridRes[0])%gridRes[0] + ((y%gridRes[1]+gridRes[1])%gridRes[1]) * gridRes[0] + ((z%gridRes[2]+gridRes[2])%gridRes[2]) * gridRes[0] * gridRes[1];
-#else
-        return ((73856093 * x) ^ (19349663 * y) ^ (83492791 * z)) % table.size();
-#endif
-    }
-
-#ifdef XUBEN
-    zeno::vec3f pMin, pMax;
-    zeno::vec3i gridRes;
-#endif
-
-    HashGrid(std::vector<zeno::vec3f> const &refpos_,
-            float radius_, float radius_min)
-        : refpos(refpos_) {
+    static constexpr int kBits = 21;
+    static constexpr int kBias = 1 << (kBits - 1);
+    static constexpr int kMax = (1 << kBits) - 1;
 
+    HashGrid(float radius_, float radius_min) {
         radius = radius_;
         radius_sqr = radius * radius;
         radius_sqr_min = radius_min < 0.f ? -1.f : radius_min * radius_min;
-#ifdef DILEI
-        inv_dx = 0.5f / radius;
-#else
         inv_dx = 1.0f / radius;
-#endif
+    }
+
+    HashGrid(std::vector<zeno::vec3f> const &refpos,
+            float radius_, float radius_min)
+        : HashGrid(radius_, radius_min) {
+        build(refpos);
+    }
 
-#ifdef XUBEN
-        pMin = refpos[0];
-        pMax = refpos[0];
-        for (int i = 1; i < refpos.size(); i++) {
-            auto coor = refpos[i];
-            pMin = zeno::min(pMin, coor);
-            pMax = zeno::max(pMax, coor);
+    // far outliers are clamped into the border cells, which keeps every
+    // pair of points within radius in the same or adjacent cells
+    zeno::vec3i cell_of(zeno::vec3f const &pos) const {
+        zeno::vec3i c;
+        for (int d = 0; d < 3; d++) {
+            float f = std::floor(pos[d] * inv_dx) + (float)kBias;
+            c[d] = f >= 0.f ? f <= (float)kMax ? (int)f : kMax : 0;   // NaN goes to 0 too
         }
-        pMin -= radius;
-        pMax += radius;
-        gridRes = zeno::toint(zeno::floor((pMax - pMin) * inv_dx)) + 1;
+        return c;
+    }
 
-        dbg_printf("grid res: %dx%dx%d\n", gridRes[0], gridRes[1], gridRes[2]);
-        table.clear();
-        table.resize(gridRes[0] * gridRes[1] * gridRes[2]);
-#else
-        int table_size = refpos.size() / 8;
-        dbg_printf("table size: %d\n", table_size);
-        table.clear();
-        table.resize(table_size);
-#endif
+    static uint64_t key_of(zeno::vec3i const &c) {
+        return (uint64_t)c[2] << (2 * kBits) | (uint64_t)c[1] << kBits | (uint64_t)c[0];
+    }
 
-        for (int i = 0; i < refpos.size(); i++) {
-#ifdef XUBEN
-            auto coor = zeno::toint(zeno::floor((refpos[i] - pMin) * inv_dx));
-#else
-            auto coor = zeno::toint(zeno::floor(refpos[i] * inv_dx));
-#endif
-            auto key = hash(coor[0], coor[1], coor[2]);
-            table[key].push_back(i);
+    static size_t slot_of(uint64_t rowkey, size_t mask) {
+        return (rowkey * 0x9e3779b97f4a7c15ull >> 24) & mask;
+    }
+
+    void compute_keys(std::vector<zeno::vec3f> const &pos, std::vector<uint64_t> &keys) const {
+        keys.resize(pos.size());
+        #pragma omp parallel for
+        for (intptr_t i = 0; i < (intptr_t)pos.size(); i++) {
+            keys[i] = key_of(cell_of(pos[i]));
+        }
+    }
+
+    void build(std::vector<zeno::vec3f> const &pos) {
+        compute_keys(pos, pointKeys);
+        size_t n = pos.size();
+
+        // sort by cell index within the bounding box of the occupied cells,
+        // which has the same order as the keys but far fewer bits to sort
+        zeno::vec3i cmin(kMax), cmax(0);
+        for (size_t i = 0; i < n; i++) {
+            for (int d = 0; d < 3; d++) {
+                int c = pointKeys[i] >> (d * kBits) & kMax;
+                cmin[d] = std::min(cmin[d], c);
+                cmax[d] = std::max(cmax[d], c);
+            }
+        }
+        uint64_t nx = cmax[0] - cmin[0] + 1, ny = cmax[1] - cmin[1] + 1;
+        std::vector<uint64_t> keys(n);
+        ids.resize(n);
+        #pragma omp parallel for
+        for (intptr_t i = 0; i < (intptr_t)n; i++) {
+            uint64_t k = pointKeys[i];
+            uint64_t x = (k & kMax) - cmin[0];
+            uint64_t y = (k >> kBits & kMax) - cmin[1];
+            uint64_t z = (k >> (2 * kBits)) - cmin[2];
+            keys[i] = (z * ny + y) * nx + x;
+            ids[i] = (int)i;
+        }
+        radix_sort_pairs(keys, ids);
+
+        cellKeys.clear();
+        cellStart.clear();
+        for (size_t i = 0; i < n; i++) {
+            if (i == 0 || keys[i] != keys[i - 1]) {
+                cellKeys.push_back(pointKeys[ids[i]]);
+                cellStart.push_back((int)i);
+            }
+        }
+        cellStart.push_back((int)n);
+        build_rows();
+    }
+
+    // moves the points that changed cells since `prev`, leaving every other
+    // id where it was; returns false if too many moved to be worth it
+    bool rebuild(HashGrid const &prev, std::vector<zeno::vec3f> const &pos) {
+        if (prev.pointKeys.size() != pos.size() || prev.inv_dx != inv_dx)
+            return false;
+        compute_keys(pos, pointKeys);
+        std::vector<std::pair<uint64_t, int>> movers;
+        for (size_t i = 0; i < pos.size(); i++) {
+            if (pointKeys[i] != prev.pointKeys[i])
+                movers.emplace_back(pointKeys[i], (int)i);
+        }
+        if (movers.size() > pos.size() / 8)
+            return false;
+        std::sort(movers.begin(), movers.end());
+
+        cellKeys.clear();
+        cellStart.clear();
+        ids.clear();
+        ids.reserve(pos.size());
+        size_t nprev = prev.cellKeys.size(), ci = 0, mi = 0;
+        while (ci < nprev || mi < movers.size()) {
+            uint64_t key = ci < nprev ? prev.cellKeys[ci] : movers[mi].first;
+            if (mi < movers.size())
+                key = std::min(key, movers[mi].first);
+            size_t start = ids.size();
+            int const *it = nullptr, *end = nullptr;
+            if (ci < nprev && prev.cellKeys[ci] == key) {
+                it = prev.ids.data() + prev.cellStart[ci];
+                end = prev.ids.data() + prev.cellStart[ci + 1];
+                ci++;
+            }
+            // merge the ids staying in this cell with the ones moving into it
+            while (it != end || (mi < movers.size() && movers[mi].first == key)) {
+                bool arriving = mi < movers.size() && movers[mi].first == key;
+                if (it != end && pointKeys[*it] != key) {
+                    ++it;
+                } else if (it != end && !(arriving && movers[mi].second < *it)) {
+                    ids.push_back(*it++);
+                } else {
+                    ids.push_back(movers[mi++].second);
+                }
+            }
+            if (ids.size() != start) {
+                cellKeys.push_back(key);
+                cellStart.push_back((int)start);
+            }
+        }
+        cellStart.push_back((int)ids.size());
+        build_rows();
+        return true;
+    }
+
+    void build_rows() {
+        size_t nrows = 0;
+        for (size_t ci = 0; ci < cellKeys.size(); ci++) {
+            if (ci == 0 || cellKeys[ci] >> kBits != cellKeys[ci - 1] >> kBits)
+                nrows++;
+        }
+        size_t cap = 16;
+        while (cap < nrows * 2)
+            cap *= 2;
+        rows.assign(cap, Row{});
+        size_t mask = cap - 1;
+        for (size_t ci = 0; ci < cellKeys.size();) {
+            uint64_t rowkey = cellKeys[ci] >> kBits;
+            size_t cj = ci + 1;
+            while (cj < cellKeys.size() && cellKeys[cj] >> kBits == rowkey)
+                cj++;
+            size_t s = slot_of(rowkey, mask);
+            while (rows[s].begin != rows[s].end)
+                s = (s + 1) & mask;
+            rows[s] = {rowkey, (int)ci, (int)cj};
+            ci = cj;
+        }
+    }
+
+    Row const &find_row(uint64_t rowkey) const {
+        size_t mask = rows.size() - 1;
+        for (size_t s = slot_of(rowkey, mask);; s = (s + 1) & mask) {
+            auto const &row = rows[s];
+            if (row.begin == row.end || row.key == rowkey)
+                return row;
         }
     }
 
     template <class F>
-    void iter_neighbors(zeno::vec3f const &pos, F const &f) {
-#ifdef XUBEN
-#ifdef DILEI
-        auto coor = zeno::toint(zeno::floor((pos - pMin) * inv_dx - 0.5f));
-#else
-        auto coor = zeno::toint(zeno::floor((pos - pMin) * inv_dx));
-#endif
-#else
-#ifdef DILEI
-        auto coor = zeno::toint(zeno::floor(pos * inv_dx - 0.5f));
-#else
-        auto coor = zeno::toint(zeno::floor(pos * inv_dx));
-#endif
-#endif
-#ifdef DILEI
-        for (int dz = 0; dz < 2; dz++) {
-            for (int dy = 0; dy < 2; dy++) {
-                for (int dx = 0; dx < 2; dx++) {
-#else
+    void iter_neighbors(zeno::vec3f const &pos, F const &f) const {
+        auto coor = cell_of(pos);
+        uint64_t xlo = std::max(coor[0] - 1, 0), xhi = std::min(coor[0] + 1, kMax);
         for (int dz = -1; dz < 2; dz++) {
             for (int dy = -1; dy < 2; dy++) {
-                for (int dx = -1; dx < 2; dx++) {
-#endif
-                    int key = hash(coor[0] + dx, coor[1] + dy, coor[2] + dz);
-                    for (int pid: table[key]) {
-                        //auto dist = refpos[pid] - pos;
-                        //auto dis2 = zeno::dot(dist, dist);
-                        //if (dis2 <= radius_sqr && dis2 > radius_sqr_min) {
-                            f(pid);
-                        //}
-                    }
+                int y = coor[1] + dy, z = coor[2] + dz;
+                if (y < 0 || z < 0 || y > kMax || z > kMax)
+                    continue;
+                uint64_t rowkey = (uint64_t)z << kBits | (uint64_t)y;
+                auto const &row = find_row(rowkey);
+                if (row.begin == row.end)
+                    continue;
+                auto kbeg = cellKeys.begin() + row.begin, kend = cellKeys.begin() + row.end;
+                auto lo = std::lower_bound(kbeg, kend, rowkey << kBits | xlo);
+                auto hi = std::upper_bound(lo, kend, rowkey << kBits | xhi);
+                // cells x-1, x, x+1 are adjacent, so are their ids
+                for (int j = cellStart[lo - cellKeys.begin()]; j < cellStart[hi - cellKeys.begin()]; j++) {
+                    f(ids[j]);
                 }
             }
         }
@@ -144,13 +308,18 @@ static void vectors_wrangle
     , std::vector<Buffer> const &chs
     , std::vector<Buffer> const &chs2
     , std::vector<zeno::vec3f> const &pos
-    , HashGrid *hashgrid
+    , HashGrid const *hashgrid
     ) {
     if (chs.size() == 0)
         return;
 
+    // visit the points in cell order when the grid was built over them,
+    // so that consecutive queries touch the same cells
+    bool sorted = hashgrid->ids.size() == pos.size();
+
     #pragma omp parallel for
-    for (int i = 0; i < pos.size(); i++) {
+    for (int n = 0; n < pos.size(); n++) {
+        int i = sorted ? hashgrid->ids[n] : n;
         auto ctx = exec->make_context();
         for (int k = 0; k < chs.size(); k++) {
             if (!chs[k].which)
@@ -171,13 +340,19 @@ static void vectors_wrangle
 }
 
 struct ParticlesBuildHashGrid : zeno::INode {
+    std::shared_ptr<HashGrid> last;
+
     virtual void apply() override {
         auto primNei = get_input<zeno::PrimitiveObject>("primNei");
         float radius = get_input<zeno::NumericObject>("radius")->get<float>();
         float radiusMin = has_input("radiusMin") ?
             get_input<zeno::NumericObject>("radiusMin")->get<float>() : -1.f;
-        auto hashgrid = std::make_shared<HashGrid>(
-                primNei->attr<zeno::vec3f>("pos"), radius, radiusMin);
+        auto const &pos = primNei->attr<zeno::vec3f>("pos");
+        auto hashgrid = std::make_shared<HashGrid>(radius, radiusMin);
+        // usually only a few particles cross cells from one frame to the next
+        if (!last || !hashgrid->rebuild(*last, pos))
+            hashgrid->build(pos);
+        last = hashgrid;
         set_output("hashGrid", std::move(hashgrid));
     }
 };
@@ -390,7 +565,7 @@ struct ParticlesNeighborWrangle : zeno::INode {
             chs2[i] = iob;
         }
 
-        vectors_wrangle(exec, chs, chs2, prim->attr<zeno::vec3f>("pos"),
+        vectors_wrangle(exec.get(), chs, chs2, prim->attr<zeno::vec3f>("pos"),
                 hashgrid.get());
 
         set_output("prim", std::move(prim));
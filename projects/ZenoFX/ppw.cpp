@@ -7,6 +7,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 
@@ -15,8 +16,8 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 struct Buffer {
     float *base = nullptr;
@@ -260,7 +261,7 @@ struct ParticleParticleWrangle : zeno::INode {
             chs2[i] = iob;
         }
 
-        vectors_wrangle(exec, chs, chs2, prim->attr<zeno::vec3f>("pos"), primNei->attr<zeno::vec3f>("pos"));
+        vectors_wrangle(exec.get(), chs, chs2, prim->attr<zeno::vec3f>("pos"), primNei->attr<zeno::vec3f>("pos"));
 
         set_output("prim", std::move(prim));
     }
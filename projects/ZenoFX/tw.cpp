@@ -8,6 +8,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 
@@ -16,8 +17,8 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 struct Buffer {
     float *base = nullptr;
@@ -36,28 +37,16 @@ static void vectors_wrangle
         size = std::min(chs[i].count, size);
     }
 
-    #pragma omp parallel for
-    for (int i = 0; i < size - exec->SimdWidth + 1; i += exec->SimdWidth) {
-        auto ctx = exec->make_context();
-        for (int j = 0; j < chs.size(); j++) {
-            for (int k = 0; k < exec->SimdWidth; k++)
-                ctx.channel(j)[k] = chs[j].base[chs[j].stride * (i + k)];
-        }
-        ctx.execute();
-        for (int j = 0; j < chs.size(); j++) {
-            for (int k = 0; k < exec->SimdWidth; k++)
-                 chs[j].base[chs[j].stride * (i + k)] = ctx.channel(j)[k];
-        }
+    std::vector<zfx::x64::Executable::Channel> views(chs.size());
+    for (int j = 0; j < chs.size(); j++) {
+        views[j] = {chs[j].base, chs[j].stride};
     }
-    for (int i = size / exec->SimdWidth * exec->SimdWidth; i < size; i++) {
-        auto ctx = exec->make_context();
-        for (int j = 0; j < chs.size(); j++) {
-            ctx.channel(j)[0] = chs[j].base[chs[j].stride * i];
-        }
-        ctx.execute();
-        for (int j = 0; j < chs.size(); j++) {
-            chs[j].base[chs[j].stride * i] = ctx.channel(j)[0];
-        }
+
+    constexpr size_t block = 4096;
+    #pragma omp parallel for
+    for (intptr_t i = 0; i < (intptr_t)size; i += block) {
+        exec->execute_strided(views.data(), views.size(),
+            i, std::min(size, (size_t)i + block));
     }
 }
 
@@ -266,7 +255,7 @@ struct TrianglesWrangle : zeno::INode {
 		//}
             chs[i] = iob;
         }
-        vectors_wrangle(exec, chs);
+        vectors_wrangle(exec.get(), chs);
     }
 };
 
@@ -10,6 +10,7 @@
 #include <zeno/VDBGrid.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "zfxcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 #include <zeno/StringObject.h>
@@ -20,8 +21,8 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
+static auto &compiler = zfxCompiler();
+static auto &assembler = zfxAssembler();
 
 template <class GridPtr>
 void vdb_wrangle(zfx::x64::Executable *exec, GridPtr &grid, bool modifyActive, bool changeBackground, bool hasPos) {
@@ -231,9 +232,9 @@ struct VDBWrangle : zeno::INode {
         auto changeBackground = has_input("ChangeBackground") ?
             (get_input<zeno::StringObject>("ChangeBackground")->get())=="true" : false;
         if (auto p = std::dynamic_pointer_cast<zeno::VDBFloatGrid>(grid); p)
-            vdb_wrangle(exec, p->m_grid, modifyActive, changeBackground, hasPos);
+            vdb_wrangle(exec.get(), p->m_grid, modifyActive, changeBackground, hasPos);
         else if (auto p = std::dynamic_pointer_cast<zeno::VDBFloat3Grid>(grid); p)
-            vdb_wrangle(exec, p->m_grid, modifyActive, changeBackground, hasPos);
+            vdb_wrangle(exec.get(), p->m_grid, modifyActive, changeBackground, hasPos);
 
         set_output("grid", std::move(grid));
     }
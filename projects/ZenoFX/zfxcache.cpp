@@ -0,0 +1,39 @@
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include "zfxcache.h"
+
+namespace zeno {
+
+namespace {
+
+struct ZfxCache {
+    ZfxCompiler compiler;
+    ZfxAssembler assembler;
+
+    ZfxCache() {
+        std::size_t size = envconfig::getInt("ZFX_CACHE_SIZE", 256);
+        std::string dir = envconfig::getStr("ZFX_CACHE_DIR");
+        compiler.impl.cache.max_entries = assembler.impl.cache.max_entries = size;
+        compiler.impl.cache_dir = assembler.impl.cache_dir = dir;
+        assembler.impl.simd_width = envconfig::getInt("ZFX_SIMD_WIDTH");
+        if (!dir.empty())
+            log_debug("zfx programs are cached in {}", dir);
+    }
+
+    static ZfxCache &get() {
+        static ZfxCache instance;
+        return instance;
+    }
+};
+
+}
+
+ZfxCompiler &zfxCompiler() {
+    return ZfxCache::get().compiler;
+}
+
+ZfxAssembler &zfxAssembler() {
+    return ZfxCache::get().assembler;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <zfx/zfx.h>
+#include <zfx/x64.h>
+#include <zeno/extra/Profiler.h>
+#include <utility>
+
+namespace zeno {
+
+// compile() / assemble() forward to the shared zfx objects and show up as
+// "zfx" events in the profiler trace
+struct ZfxCompiler {
+    zfx::Compiler impl;
+
+    template <class ...Args>
+    auto compile(Args &&...args) {
+        Profiler::Scope _prof(Profiler::Category::Zfx, "zfx compile");
+        return impl.compile(std::forward<Args>(args)...);
+    }
+};
+
+struct ZfxAssembler {
+    zfx::x64::Assembler impl;
+
+    template <class ...Args>
+    auto assemble(Args &&...args) {
+        Profiler::Scope _prof(Profiler::Category::Zfx, "zfx assemble");
+        return impl.assemble(std::forward<Args>(args)...);
+    }
+};
+
+// process-wide ZFX program cache shared by all wrangle nodes,
+// bounded by ZENO_ZFX_CACHE_SIZE entries (default 256), and persisted
+// to ZENO_ZFX_CACHE_DIR across runs when that is set; programs use the
+// widest SIMD the CPU supports unless ZENO_ZFX_SIMD_WIDTH is 4 or 8
+ZfxCompiler &zfxCompiler();
+ZfxAssembler &zfxAssembler();
+
+}
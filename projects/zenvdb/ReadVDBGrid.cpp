@@ -47,6 +47,10 @@ static std::shared_ptr<VDBGrid> readGenericVDBGrid(const std::string &fn) {
 
 
 struct CacheVDBGrid : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     int m_framecounter = 0;
 
     virtual void preApply() override {
@@ -137,14 +137,23 @@ struct ProgramRunData {
             }
             if (g_state == kQuiting) return;
             session->globalState->frameEnd();
-            if (bZenCache)
+            if (bZenCache) {
                 session->globalComm->dumpFrameCache(frame);
+                session->globalComm->takeDumpError(*session->globalStatus);
+            }
             session->globalComm->finishFrame();
             if (zenoApp->getMainWindow())
                 zenoApp->getMainWindow()->updateViewport(QString::fromStdString("finishFrame"));
             zeno::log_debug("end frame {}", frame);
             if (chkfail()) return;
         }
+        if (bZenCache) {
+            // frames still being written only become completed once on disk
+            session->globalComm->flushFrameCache();
+            session->globalComm->takeDumpError(*session->globalStatus);
+            if (zenoApp->getMainWindow())
+                zenoApp->getMainWindow()->updateViewport(QString::fromStdString("finishFrame"));
+        }
         if (session->globalStatus->failed()) {
             reportStatus(*session->globalStatus);
         }
@@ -11,18 +11,29 @@
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/extra/EventCallbacks.h>
+#include <zeno/extra/Profiler.h>
 #include <zeno/extra/assetDir.h>
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/zeno.h>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <vector>
+#ifdef __linux__
+#include <sys/uio.h>
+#include <cerrno>
+#endif
 #ifdef ZENO_IPC_USE_TCP
 #include <QTcpServer>
 #include <QtWidgets>
 #include <QTcpSocket>
 #endif
 #include <zeno/utils/scope_exit.h>
+#include <zeno/utils/envconfig.h>
 #include "corelaunch.h"
 #include "viewdecode.h"
+#include "shmring.h"
 #include "settings/zsettings.h"
 #include <zeno/funcs/ParseObjectFromUi.h>
 #include "startup/zstartup.h"
@@ -39,6 +50,9 @@ static FILE *ourfp;
 static char ourbuf[1 << 20]; // 1MB
 #endif
 
+// smaller payloads aren't worth a ring slot
+static constexpr size_t kShmMinPacket = 64 << 10;
+
 struct Header { // sync with viewdecode.cpp
     size_t total_size;
     size_t info_size;
@@ -51,7 +65,69 @@ struct Header { // sync with viewdecode.cpp
     }
 };
 
+static ShmRing shmRing;
+
+static void write_all(const char *head, size_t headlen, const char *buf, size_t len) {
+#ifdef ZENO_IPC_USE_TCP
+    clientSocket->write(head, headlen);
+    if (len)
+        clientSocket->write(buf, len);
+    while (clientSocket->bytesToWrite() > 0) {
+        clientSocket->waitForBytesWritten();
+    }
+#elif defined(__linux__)
+    // log lines share the same stream, flush them out before bypassing stdio
+    std::cout.flush();
+    fflush(ourfp);
+    int fd = fileno(ourfp);
+    struct iovec iov[2] = {{(void *)head, headlen}, {(void *)buf, len}};
+    struct iovec *piov = iov;
+    int niov = len ? 2 : 1;
+    while (niov) {
+        ssize_t n = writev(fd, piov, niov);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            zeno::log_error("runner failed to write packet: {}", std::strerror(errno));
+            return;
+        }
+        while (niov && (size_t)n >= piov->iov_len) {
+            n -= piov->iov_len;
+            piov++;
+            niov--;
+        }
+        if (niov) {
+            piov->iov_base = (char *)piov->iov_base + n;
+            piov->iov_len -= n;
+        }
+    }
+#else
+    fwrite(head, 1, headlen, ourfp);
+    if (len)
+        fwrite(buf, 1, len, ourfp);
+    fflush(ourfp);
+#endif
+}
+
 static void send_packet(std::string_view info, const char *buf, size_t len) {
+    zeno::Profiler::Scope _prof(zeno::Profiler::Category::IPC, info);
+    std::string shminfo;
+    if (shmRing.valid() && !info.empty() && info.back() == '}') {
+        shminfo.reserve(info.size() + 80);
+        shminfo.append(info.data(), info.size() - 1);
+        size_t offset = 0;
+        char *dst = nullptr;
+        if (len >= kShmMinPacket && (dst = shmRing.acquire(len, offset, 1000))) {
+            std::memcpy(dst, buf, len);
+            std::atomic_thread_fence(std::memory_order_release);
+            shminfo += ",\"shm\":[" + std::to_string(offset) + "," + std::to_string(len) + "]";
+            len = 0;
+        }
+        // lets the editor free payloads of earlier packets it failed to consume
+        shminfo += ",\"shmEnd\":" + std::to_string(shmRing.head()) + "}";
+        info = shminfo;
+    }
+
     Header header;
     header.total_size = info.size() + len;
     header.info_size = info.size();
@@ -66,23 +142,27 @@ static void send_packet(std::string_view info, const char *buf, size_t len) {
     std::memcpy(headbuffer.data() + 4 + sizeof(Header), info.data(), info.size());
 
     zeno::log_debug("runner tx head-buffer {} data-buffer {}", headbuffer.size(), len);
-#ifdef ZENO_IPC_USE_TCP
-    for (char c: headbuffer) {
-        clientSocket->write(&c, 1);
-    }
-    clientSocket->write(buf, len);
-    while (clientSocket->bytesToWrite() > 0) {
-        clientSocket->waitForBytesWritten();
-    }
-#else
-    for (char c : headbuffer) {
-        fputc(c, ourfp);
-    }
-    for (size_t i = 0; i < len; i++) {
-        fputc(buf[i], ourfp);
+    write_all(headbuffer.data(), headbuffer.size(), buf, len);
+}
+
+// frame cache dumps finish on the writer thread, but the socket belongs to the main
+// thread: the writer only queues what to send, the main thread sends it from here
+static std::mutex dumpedMtx;
+static std::vector<std::function<void()>> dumpedQueue;
+
+static void post_dumped(std::function<void()> f) {
+    std::lock_guard lck(dumpedMtx);
+    dumpedQueue.push_back(std::move(f));
+}
+
+static void drain_dumped() {
+    std::vector<std::function<void()>> queue;
+    {
+        std::lock_guard lck(dumpedMtx);
+        queue.swap(dumpedQueue);
     }
-    fflush(ourfp);
-#endif
+    for (auto const &f : queue)
+        f();
 }
 
 static int runner_start(std::string const &progJson, int sessionid, const LAUNCH_PARAM& param) {
@@ -97,6 +177,7 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     session->globalComm->clearState();
     session->globalStatus->clearState();
     auto graph = session->createGraph();
+    zeno::Profiler::clear();
 
     //$ZSG value
     zeno::setConfigVariable("ZSG", param.zsgPath.toStdString());
@@ -116,6 +197,9 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     }
 
     auto onfail = [&] {
+        session->globalComm->flushFrameCache();
+        drain_dumped();
+        session->globalComm->takeDumpError(*session->globalStatus);
         auto statJson = session->globalStatus->toJson();
         send_packet("{\"action\":\"reportStatus\"}", statJson.data(), statJson.size());
         return 1;
@@ -129,6 +213,11 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
 
     std::vector<char> buffer;
 
+    if (size_t shmsize = zeno::envconfig::getUint64("IPC_SHM_MB", 256) << 20; shmsize && shmRing.create(shmsize)) {
+        send_packet("{\"action\":\"shmRing\",\"key\":\"" + shmRing.name()
+                    + "|" + std::to_string(shmRing.capacity()) + "\"}", "", 0);
+    }
+
     session->globalComm->initFrameRange(graph->beginFrameNumber, graph->endFrameNumber);
     send_packet("{\"action\":\"frameRange\",\"key\":\""
                 + std::to_string(graph->beginFrameNumber)
@@ -228,6 +317,7 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
                 graph->applyNodesToExec();
             }, *session->globalStatus);
             session->globalState->substepEnd();
+            drain_dumped();
             if (session->globalStatus->failed())
                 return onfail();
         }
@@ -237,13 +327,28 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
 
         send_packet("{\"action\":\"newFrame\",\"key\":\"" + std::to_string(frame) +"\"}", "", 0);
 
+        if (zeno::Profiler::enabled()) {
+            // per-node totals since the start of this run, the editor logs the heaviest ones
+            auto summary = zeno::Profiler::summaryJson();
+            send_packet("{\"action\":\"profile\",\"key\":\"" + std::to_string(frame) + "\"}",
+                        summary.data(), summary.size());
+        }
+
         if (param.enableCache) {
             //construct cache lock.
             std::string sLockFile = param.cacheDir.toStdString() + "/" + zeno::iotags::sZencache_lockfile_prefix + std::to_string(frame) + ".lock";
-            QLockFile lckFile(QString::fromStdString(sLockFile));
-            bool ret = lckFile.tryLock();
-            //dump cache to disk.
-            session->globalComm->dumpFrameCache(frame, param.applyLightAndCameraOnly, param.applyMaterialOnly);
+            auto lckFile = std::make_shared<QLockFile>(QString::fromStdString(sLockFile));
+            bool ret = lckFile->tryLock();
+            //dump cache to disk in the background, the ui may only load this frame after finishFrame.
+            session->globalComm->dumpFrameCache(frame, param.applyLightAndCameraOnly, param.applyMaterialOnly, [lckFile, frame] {
+                post_dumped([lckFile, frame] {
+                    lckFile->unlock();
+                    send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
+                });
+            });
+            drain_dumped();
+            if (session->globalComm->takeDumpError(*session->globalStatus))
+                return onfail();
         } else {
             auto const& viewObjs = session->globalComm->getViewObjects();
             zeno::log_debug("runner got {} view objects", viewObjs.size());
@@ -253,13 +358,17 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
                         buffer.data(), buffer.size());
                 buffer.clear();
             }
+            send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
         }
 
-        send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
-
         if (session->globalStatus->failed())
             return onfail();
     }
+    session->globalComm->flushFrameCache();
+    drain_dumped();
+    if (session->globalComm->takeDumpError(*session->globalStatus))
+        return onfail();
+    zeno::Profiler::writeTrace();
     return 0;
 }
 
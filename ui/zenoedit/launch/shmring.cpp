@@ -0,0 +1,168 @@
+#ifdef ZENO_MULTIPROCESS
+#include "shmring.h"
+#include <zeno/utils/log.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct ShmRing::Control {
+    size_t magicnum;
+    size_t capacity;
+    std::atomic<size_t> head;      // monotonic byte offsets, written by the runner
+    std::atomic<size_t> tail;      // written by the editor
+    std::atomic<int> attached;
+};
+
+static constexpr size_t kMagic = 271828182;
+static constexpr size_t kCtrlSize = 4096;
+
+ShmRing::~ShmRing() {
+    close();
+}
+
+#ifdef __linux__
+static void *mapShm(std::string const &name, size_t size, bool create) {
+    int fd = shm_open(name.c_str(), create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+    if (create && ftruncate(fd, size) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        if (create)
+            shm_unlink(name.c_str());
+        return nullptr;
+    }
+    return p;
+}
+#endif
+
+bool ShmRing::create(size_t capacity) {
+#ifdef __linux__
+    close();
+    m_name = "/zeno_ipc_" + std::to_string(getpid());
+    shm_unlink(m_name.c_str());  // left over by a crashed runner with a recycled pid
+    void *p = mapShm(m_name, kCtrlSize + capacity, true);
+    if (!p) {
+        zeno::log_warn("failed to create shared memory ring {}", m_name);
+        m_name.clear();
+        return false;
+    }
+    m_ctrl = new (p) Control;
+    m_ctrl->magicnum = kMagic;
+    m_ctrl->capacity = capacity;
+    m_ctrl->head.store(0, std::memory_order_relaxed);
+    m_ctrl->tail.store(0, std::memory_order_relaxed);
+    m_ctrl->attached.store(0, std::memory_order_release);
+    m_base = (char *)p + kCtrlSize;
+    m_capacity = capacity;
+    m_owner = true;
+    m_unlinked = false;
+    return true;
+#else
+    return false;
+#endif
+}
+
+char *ShmRing::acquire(size_t len, size_t &offset, int timeoutMs) {
+    if (!m_owner || !m_base || !len || len > m_capacity)
+        return nullptr;
+    if (!m_ctrl->attached.load(std::memory_order_acquire))
+        return nullptr;
+#ifdef __linux__
+    if (!m_unlinked) {
+        // the editor holds its own mapping now, no need to keep the name around
+        shm_unlink(m_name.c_str());
+        m_unlinked = true;
+    }
+#endif
+
+    size_t head = m_ctrl->head.load(std::memory_order_relaxed);
+    size_t pos = head % m_capacity;
+    if (pos + len > m_capacity)
+        head += m_capacity - pos;  // payloads are contiguous, skip the tail end
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (head + len - m_ctrl->tail.load(std::memory_order_acquire) > m_capacity) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return nullptr;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    offset = head;
+    m_ctrl->head.store(head + len, std::memory_order_relaxed);
+    return m_base + head % m_capacity;
+}
+
+size_t ShmRing::head() const {
+    return m_ctrl ? m_ctrl->head.load(std::memory_order_relaxed) : 0;
+}
+
+bool ShmRing::attach(std::string const &name, size_t capacity) {
+#ifdef __linux__
+    close();
+    void *p = mapShm(name, kCtrlSize + capacity, false);
+    if (!p) {
+        zeno::log_warn("failed to attach shared memory ring {}", name);
+        return false;
+    }
+    auto ctrl = (Control *)p;
+    if (ctrl->magicnum != kMagic || ctrl->capacity != capacity) {
+        zeno::log_warn("shared memory ring {} has bad header", name);
+        munmap(p, kCtrlSize + capacity);
+        return false;
+    }
+    m_ctrl = ctrl;
+    m_base = (char *)p + kCtrlSize;
+    m_capacity = capacity;
+    m_name = name;
+    m_owner = false;
+    m_ctrl->attached.store(1, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *ShmRing::data(size_t offset, size_t len) const {
+    if (!m_base || len > m_capacity)
+        return nullptr;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    size_t pos = offset % m_capacity;
+    if (pos + len > m_capacity)
+        return nullptr;
+    return m_base + pos;
+}
+
+void ShmRing::release(size_t end) {
+    // the editor is the only writer of tail
+    if (m_ctrl && end > m_ctrl->tail.load(std::memory_order_relaxed))
+        m_ctrl->tail.store(end, std::memory_order_release);
+}
+
+void ShmRing::close() {
+#ifdef __linux__
+    if (m_ctrl) {
+        if (m_owner && !m_unlinked)
+            shm_unlink(m_name.c_str());
+        munmap(m_ctrl, kCtrlSize + m_capacity);
+    }
+#endif
+    m_ctrl = nullptr;
+    m_base = nullptr;
+    m_capacity = 0;
+    m_name.clear();
+    m_owner = false;
+    m_unlinked = false;
+}
+#endif
@@ -0,0 +1,64 @@
+#ifndef __ZENO_SHMRING_H__
+#define __ZENO_SHMRING_H__
+
+#ifdef ZENO_MULTIPROCESS
+#include <cstddef>
+#include <string>
+
+// shared memory ring buffer carrying bulk packet payloads from runner to editor (linux only),
+// the pipe / tcp stream then only transfers the small header with the ring offset of the data.
+//
+// the runner is the only producer, the editor the only consumer: it hands back space by
+// advancing the shared tail once a packet has been processed, so no back channel is needed.
+// every packet also carries the ring head at the time it was sent (shmEnd): packets arrive
+// in order, so once the editor is done with it, successful or not, everything before that
+// is free too. a payload whose packet got lost or failed to decode can't pin the tail.
+struct ShmRing {
+    ShmRing() = default;
+    ~ShmRing();
+
+    ShmRing(ShmRing const &) = delete;
+    ShmRing &operator=(ShmRing const &) = delete;
+
+    // runner side
+    bool create(size_t capacity);
+    // reserve len contiguous bytes, fails if the editor hasn't attached yet,
+    // or if there is still no room after timeoutMs
+    char *acquire(size_t len, size_t &offset, int timeoutMs);
+    // end of the last reserved payload
+    size_t head() const;
+
+    // editor side
+    bool attach(std::string const &name, size_t capacity);
+    const char *data(size_t offset, size_t len) const;
+    // hand back everything before end, never moves the tail backwards
+    void release(size_t end);
+
+    void close();
+
+    bool valid() const {
+        return m_base != nullptr;
+    }
+
+    std::string const &name() const {
+        return m_name;
+    }
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+private:
+    struct Control;
+
+    Control *m_ctrl = nullptr;
+    char *m_base = nullptr;
+    size_t m_capacity = 0;
+    std::string m_name;
+    bool m_owner = false;
+    bool m_unlinked = false;
+};
+
+#endif
+
+#endif
@@ -4,6 +4,7 @@
 #include <zenomodel/include/graphsmanagment.h>
 #include "zenomainwindow.h"
 #include <zeno/utils/log.h>
+#include <zeno/utils/scope_exit.h>
 #include <zeno/types/UserData.h>
 #include <zeno/core/Session.h>
 #include <zeno/extra/GlobalState.h>
@@ -22,6 +23,7 @@
 #include "launch/corelaunch.h"
 #include "settings/zsettings.h"
 #include "launch/ztcpserver.h"
+#include "launch/shmring.h"
 
 namespace {
 
@@ -44,15 +46,19 @@ struct PacketProc {
     std::string fcPath = {};
     int fcMax = 0;
 
+    ShmRing shmRing;
+
     void onStart() {
         globalCommNeedClean = 1;
         globalCommNeedNewFrame = 0;
+        shmRing.close();
         zeno::getSession().globalState->clearState();
         zeno::getSession().globalStatus->clearState();
         zeno::getSession().globalState->working = true;
     }
 
     void onFinish() {
+        shmRing.close();
         clearGlobalIfNeeded();
         zeno::getSession().globalState->working = false;
     }
@@ -164,6 +170,14 @@ struct PacketProc {
                 pModel->updateSocketDefl(ident, { socket, "", val }, subgIdx, false);
             }
 
+        } else if (action == "shmRing") {
+            auto pos = objKey.rfind('|');
+            if (pos == std::string::npos)
+                return false;
+            size_t capacity = std::stoull(objKey.substr(pos + 1));
+            // if this fails the runner just keeps sending payloads inline
+            return shmRing.attach(objKey.substr(0, pos), capacity);
+
         } else if (action == "frameRange") {
             auto pos = objKey.find(':');
             if (pos != std::string::npos) {
@@ -190,6 +204,20 @@ struct PacketProc {
                                                       QString::fromStdString(stat->error->message));
             }
 
+        } else if (action == "profile") {
+            rapidjson::Document doc;
+            doc.Parse(buf, len);
+            if (!doc.IsObject() || !doc.HasMember("nodes") || !doc["nodes"].IsArray())
+                return false;
+            auto const &nodes = doc["nodes"].GetArray();
+            std::string msg;
+            for (rapidjson::SizeType i = 0; i < nodes.Size() && i < 5; i++) {
+                auto const &node = nodes[i];
+                msg += zeno::format("\n  {} ms, {} runs: {}", std::int64_t(node["wall_us"].GetDouble() * 1e-3),
+                                    node["count"].GetUint64(), node["name"].GetString());
+            }
+            zeno::log_info("profile after frame {}, heaviest nodes:{}", objKey, msg);
+
         } else {
             zeno::log_warn("unknown packet action type {}", action);
             return false;
@@ -213,6 +241,16 @@ struct PacketProc {
         }
         auto root = doc.GetObject();
 
+        // whatever happens to this packet, the payloads sent before it are done with
+        size_t shmEnd = 0;
+        if (auto it = root.FindMember("shmEnd"); it != root.MemberEnd() && it->value.IsUint64()) {
+            shmEnd = it->value.GetUint64();
+        }
+        zeno::scope_exit release([&] {
+            if (shmEnd)
+                shmRing.release(shmEnd);
+        });
+
         
         std::string action;
         if (auto it = root.FindMember("action"); it != root.MemberEnd() && it->value.IsString()) {
@@ -230,6 +268,24 @@ struct PacketProc {
         const char *data = buf + header.info_size;
         size_t size = header.total_size - header.info_size;
 
+        if (auto it = root.FindMember("shm"); it != root.MemberEnd() && it->value.IsArray()) {
+            // the payload was left in the shared memory ring, decode it in place
+            auto arr = it->value.GetArray();
+            if (arr.Size() != 2 || !arr[0].IsUint64() || !arr[1].IsUint64()) {
+                zeno::log_warn("bad 'shm' entry in packet");
+                return false;
+            }
+            size_t offset = arr[0].GetUint64();
+            size = arr[1].GetUint64();
+            data = shmRing.data(offset, size);
+            if (!data) {
+                zeno::log_warn("packet refers to unavailable shared memory");
+                return false;
+            }
+            zeno::log_debug("decoder got action=[{}] key=[{}] size={} (shm)", action, objKey, size);
+            return processPacket(action, objKey, data, size);
+        }
+
         zeno::log_debug("decoder got action=[{}] key=[{}] size={}", action, objKey, size);
 
         return processPacket(action, objKey, data, size);
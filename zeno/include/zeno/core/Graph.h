@@ -17,10 +17,13 @@ namespace zeno {
 struct Session;
 struct SubgraphNode;
 struct DirtyChecker;
+struct GraphScheduler;
+struct OutputReleaser;
 struct INode;
 
 struct Context {
     std::set<std::string> visited;
+    int depth = 0;  // > 0 inside bodies re-run by a ContextManagedNode
 
     inline void mergeVisited(Context const &other) {
         visited.insert(other.visited.begin(), other.visited.end());
@@ -47,6 +50,12 @@ struct Graph : std::enable_shared_from_this<Graph> {
     std::unique_ptr<Context> ctx;
     std::unique_ptr<DirtyChecker> dirtyChecker;
 
+    bool parallelApply = false;
+    GraphScheduler *scheduler = nullptr;  // only set while applyNodes runs in parallel
+
+    bool releaseOutputs = false;
+    OutputReleaser *releaser = nullptr;  // only set while applyNodes releases outputs
+
     ZENO_API Graph();
     ZENO_API ~Graph();
 
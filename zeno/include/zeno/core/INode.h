@@ -60,6 +60,14 @@ public:
 
     ZENO_API virtual void preApply();
 
+    // false for nodes that pull inputs lazily or touch shared graph state in preApply,
+    // GraphScheduler will neither run them concurrently nor pre-evaluate their inputs
+    ZENO_API virtual bool isSchedulable() const;
+
+    // false for nodes with side effects or hidden state, NodeMemo won't reuse their results;
+    // by default also false for file writers (writepath sockets) and for seed inputs of -1
+    ZENO_API virtual bool isMemoizable() const;
+
     ZENO_API Graph *getThisGraph() const;
     ZENO_API Session *getThisSession() const;
     ZENO_API GlobalState *getGlobalState() const;
@@ -68,6 +76,10 @@ public:
     ZENO_API zany get_input(std::string const &id) const;
     ZENO_API void set_output(std::string const &id, zany obj);
 
+    // the input object itself when this node holds the only reference to it (it was
+    // the last use, see OutputReleaser), a clone otherwise: safe to modify in place
+    ZENO_API zany take_input(std::string const &id);
+
     ZENO_API bool has_keyframe(std::string const &id) const;
     ZENO_API zany get_keyframe(std::string const &id) const;
 
@@ -80,6 +92,12 @@ public:
         return safe_dynamic_cast<T>(std::move(obj), "input socket `" + id + "` of node `" + myname + "`");
     }
 
+    template <class T>
+    std::shared_ptr<T> take_input(std::string const &id) {
+        auto obj = take_input(id);
+        return safe_dynamic_cast<T>(std::move(obj), "input socket `" + id + "` of node `" + myname + "`");
+    }
+
     template <class T>
     bool has_input(std::string const &id) const {
         if (!has_input(id)) return false;
@@ -25,6 +25,9 @@ struct IObject {
 
     ZENO_API virtual std::shared_ptr<IObject> clone() const;
     ZENO_API virtual std::shared_ptr<IObject> move_clone();
+    // clone that may share buffers with this object until either side first writes
+    // to them, for copies the graph makes itself (Clone node, caches), defaults to clone()
+    ZENO_API virtual std::shared_ptr<IObject> shared_clone() const;
     ZENO_API virtual bool assign(IObject const *other);
     ZENO_API virtual bool move_assign(IObject *other);
     ZENO_API virtual std::string method_node(std::string const &op);
@@ -34,6 +37,7 @@ struct IObject {
     virtual ~IObject() = default;
     virtual std::shared_ptr<IObject> clone() const { return nullptr; }
     virtual std::shared_ptr<IObject> move_clone() { return nullptr; }
+    virtual std::shared_ptr<IObject> shared_clone() const { return clone(); }
     virtual bool assign(IObject const *other) { return false; }
     virtual bool move_assign(IObject *other) { return false; }
     ZENO_API virtual std::string method_node(std::string name) { return {}; }
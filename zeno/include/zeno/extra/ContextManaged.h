@@ -12,6 +12,10 @@ struct ContextManagedNode : INode {
     std::unique_ptr<Context> m_ctx = nullptr;
     bool bNewContext = false;
 
+    bool isSchedulable() const override {
+        return false;  // swaps graph->ctx
+    }
+
     void push_context() {
         assert(!m_ctx);
         m_ctx = std::move(graph->ctx);
@@ -24,6 +28,7 @@ struct ContextManagedNode : INode {
             graph->ctx = std::make_unique<Context>();
             bNewContext = true;
         }
+        graph->ctx->depth++;
     }
 
     std::unique_ptr<Context> pop_context() {
@@ -7,17 +7,21 @@
 #include <zeno/types/UserData.h>
 #include <set>
 #include <string>
+#include <mutex>
 
 namespace zeno {
 
 struct DirtyChecker {
     std::set<std::string> dirts;
+    mutable std::mutex mtx;  // nodes run by GraphScheduler taint each other concurrently
 
     void taintThisNode(std::string ident) {
+        std::lock_guard lck(mtx);
         dirts.insert(std::move(ident));
     }
 
     bool amIDirty(std::string const &ident) const {
+        std::lock_guard lck(mtx);
         return dirts.find(ident) != dirts.end();
     }
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <set>
+
+namespace zeno {
+
+// background stage running frame cache dumps in submission order, so that the
+// simulation of frame N+1 can overlap with encoding and writing frame N.
+// push() blocks while maxDepth jobs are pending, which is the backpressure.
+struct FrameCacheWriter {
+    struct Stats {
+        std::size_t framesQueued = 0;
+        std::size_t framesWritten = 0;
+        std::size_t bytesWritten = 0;
+        std::size_t maxDepthSeen = 0;
+        double stallSeconds = 0;    // time push() spent waiting for a free slot
+        double writeSeconds = 0;    // time spent in jobs
+    };
+
+    ZENO_API explicit FrameCacheWriter(std::size_t maxDepth);
+    ZENO_API ~FrameCacheWriter();
+
+    FrameCacheWriter(FrameCacheWriter const &) = delete;
+    FrameCacheWriter &operator=(FrameCacheWriter const &) = delete;
+
+    // job returns the number of bytes it wrote
+    ZENO_API void push(int frameid, std::function<std::size_t()> job);
+    ZENO_API bool isPending(int frameid) const;
+    ZENO_API void wait(int frameid);
+    ZENO_API void flush();
+    ZENO_API Stats stats() const;
+
+private:
+    struct Job {
+        int frameid;
+        std::function<std::size_t()> func;
+    };
+
+    std::size_t const m_maxDepth;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;
+    std::multiset<int> m_pending;   // queued or running
+    Stats m_stats;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void worker();
+};
+
+}
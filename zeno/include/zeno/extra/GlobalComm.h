@@ -9,9 +9,14 @@
 #include <map>
 #include <set>
 #include <functional>
+#include <exception>
 
 namespace zeno {
 
+struct ZenCacheReader;
+struct FrameCacheWriter;
+struct GlobalStatus;
+
 struct GlobalComm {
     using ViewObjects = PolymorphicMap<std::map<std::string, std::shared_ptr<IObject>>>;
 
@@ -24,6 +29,9 @@ struct GlobalComm {
     struct FrameData {
         ViewObjects view_objects;
         FRAME_STATE frame_state = FRAME_UNFINISH;
+        std::vector<std::shared_ptr<ZenCacheReader>> caches;  // lazily decoded into view_objects
+        bool dumping = false;         // cache write still in flight, completion is deferred
+        bool finishPending = false;
     };
     std::vector<FrameData> m_frames;
     int m_maxPlayFrame = 0;
@@ -36,11 +44,25 @@ struct GlobalComm {
     std::string cacheFramePath;
     std::string objTmpCachePath;
 
+    std::unique_ptr<FrameCacheWriter> m_writer;  // null for synchronous dumps
+    std::exception_ptr m_dumpError;              // first failed dump, see takeDumpError
+
+    ZENO_API GlobalComm();
+    ZENO_API ~GlobalComm();
+
     ZENO_API void frameCache(std::string const &path, int gcmax);
     ZENO_API void initFrameRange(int beg, int end);
     ZENO_API void newFrame();
     ZENO_API void finishFrame();
-    ZENO_API void dumpFrameCache(int frameid, bool cacheLightCameraOnly = false, bool cacheMaterialOnly = false);
+    // hands the frame to the background writer (ZENO_CACHE_WRITE_DEPTH pending frames at most, 0 for
+    // writing inline), the frame only becomes FRAME_COMPLETED once its files are durable on disk.
+    // onDumped is called from the writer thread after that, also when writing failed: the frame is
+    // then FRAME_BROKEN and the error is kept for takeDumpError
+    ZENO_API void dumpFrameCache(int frameid, bool cacheLightCameraOnly = false, bool cacheMaterialOnly = false,
+                                 std::function<void()> onDumped = {});
+    // moves the error of a failed dump into status, returns false if there was none
+    ZENO_API bool takeDumpError(GlobalStatus &status);
+    ZENO_API void flushFrameCache();
     ZENO_API void addViewObject(std::string const &key, std::shared_ptr<IObject> object);
     ZENO_API int maxPlayFrames();
     ZENO_API int numOfFinishedFrame();
@@ -50,9 +72,12 @@ struct GlobalComm {
     ZENO_API void clearFrameState();
     ZENO_API ViewObjects const *getViewObjects(const int frameid);
     ZENO_API ViewObjects const &getViewObjects();
+    // objects of a frame loaded from zencache are only decoded if isNeeded(key) says so,
+    // the others are passed to cb as nullptr, meaning the caller already holds them
     ZENO_API bool load_objects(const int frameid, 
                 const std::function<bool(std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs)>& cb,
-                bool& isFrameValid);
+                bool& isFrameValid,
+                const std::function<bool(std::string const &key)>& isNeeded = {});
     ZENO_API void clear_objects(const std::function<void()>& cb);
     ZENO_API bool isFrameCompleted(int frameid) const;
     ZENO_API FRAME_STATE getFrameState(int frameid) const;
@@ -61,9 +86,11 @@ struct GlobalComm {
     ZENO_API std::string cachePath();
     ZENO_API bool removeCache(int frame);
     ZENO_API void removeCachePath();
-    static void toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName = "");
+    static std::size_t toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName = "");
     static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, std::string fileName = "");
+    static bool openCaches(std::string cachedir, int frameid, std::vector<std::shared_ptr<ZenCacheReader>>& caches, std::string fileName = "");
 private:
+    bool _loadFrameCaches(const int frameid);
     ViewObjects const *_getViewObjects(const int frameid);
 };
 
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <exception>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <set>
+
+namespace zeno {
+
+struct Graph;
+struct INode;
+
+// dependency-driven parallel evaluation, enabled by Graph::parallelApply (ZENO_PARALLEL_APPLY=1)
+//
+// nodes reachable from the targets through schedulable nodes only (see INode::isSchedulable)
+// are run on ThreadPool::global() as soon as all their inputBounds are done; everything
+// else (control flow, caches, portals...) is left to the serial Graph::applyNode walk that
+// follows, which sees the pre-run nodes as already visited.
+struct GraphScheduler {
+    Graph *const graph;
+
+    ZENO_API explicit GraphScheduler(Graph *graph);
+    ZENO_API ~GraphScheduler();
+
+    GraphScheduler(GraphScheduler const &) = delete;
+    GraphScheduler &operator=(GraphScheduler const &) = delete;
+
+    ZENO_API void applyNodes(std::set<std::string> const &ids);
+    ZENO_API bool applyNode(std::string const &id);
+
+private:
+    struct Task {
+        std::string id;
+        std::vector<std::size_t> consumers;   // takes an output of this node
+        std::vector<std::size_t> successors;  // consumers plus the ones serialized after it
+        std::atomic<std::size_t> deps{0};
+    };
+
+    std::map<std::string, bool> m_eligible;
+    std::vector<std::unique_ptr<Task>> m_tasks;
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;  // signaled when a node leaves m_running
+    std::map<std::string, std::thread::id> m_running;
+    std::exception_ptr m_exception;
+    std::atomic<std::size_t> m_inflight{0};
+
+    bool collect(std::string const &id);
+    void taintDirty(std::vector<std::size_t> const &order);
+    void launch(std::size_t index);
+    void run(std::size_t index);
+};
+
+}
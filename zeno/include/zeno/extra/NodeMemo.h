@@ -0,0 +1,67 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/core/IObject.h>
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+struct INode;
+
+// in-memory LRU of node results keyed by a content hash of their resolved inputs,
+// enabled by ZENO_NODE_MEMO=<capacity in MB>
+//
+// the key covers the node class, every input (literal params, keyframe / formula
+// evaluated values and a content fingerprint of upstream objects) and, for nodes
+// seen reading GlobalState during apply(), the frame/substep state as well.
+// results are stored and handed out as clones, so nodes mutating their inputs
+// in place can never corrupt a cached entry. a hit also compares the fingerprint
+// of every input, so only a collision on all of them returns a wrong result.
+//
+// nodes with side effects or nondeterminism are skipped, see INode::isMemoizable.
+struct NodeMemo {
+    std::size_t capacity = 0;  // in bytes, 0 disables memoization
+
+    using Fingerprints = std::vector<std::pair<std::string, std::uint64_t>>;
+
+    struct Stats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    ZENO_API NodeMemo();
+    ZENO_API ~NodeMemo();
+
+    NodeMemo(NodeMemo const &) = delete;
+    NodeMemo &operator=(NodeMemo const &) = delete;
+
+    bool enabled() const {
+        return capacity != 0;
+    }
+
+    // run applyFn unless a previous result for the same inputs can be restored into node->outputs
+    ZENO_API void apply(INode *node, std::function<void()> const &applyFn);
+    ZENO_API void clear();
+    ZENO_API Stats stats() const;
+
+    // called by INode::getGlobalState, marks the running node as frame-dependent
+    ZENO_API static void markStateRead();
+
+    // 64-bit content fingerprint, returns false for objects that can't be hashed
+    ZENO_API static bool fingerprint(IObject const *obj, std::uint64_t &hash);
+
+    // rough in-memory size of an object, counting attribute arrays and list/dict elements
+    ZENO_API static std::size_t objectSize(IObject const *obj);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/core/IObject.h>
+#include <string>
+#include <mutex>
+#include <map>
+#include <set>
+
+namespace zeno {
+
+struct Graph;
+struct INode;
+
+// last-use release of node outputs, enabled by Graph::releaseOutputs (ZENO_RELEASE_OUTPUTS=1)
+//
+// every output socket gets a count of the inputBounds in the graph that read it. the
+// last consumer to require it takes the reference over from the producer, and consumers
+// drop their bound inputs once applied, so intermediate objects die as soon as nothing
+// downstream needs them and the last consumer may modify them in place (see
+// INode::take_input). outputs of the applyNodes targets, of temp-cached nodes and of
+// non-schedulable nodes are never released, and nothing is counted inside bodies that a
+// ContextManagedNode (loops, branches, functions) may evaluate again.
+struct OutputReleaser {
+    Graph *const graph;
+
+    ZENO_API OutputReleaser(Graph *graph, std::set<std::string> const &ids);
+    ZENO_API ~OutputReleaser();
+
+    OutputReleaser(OutputReleaser const &) = delete;
+    OutputReleaser &operator=(OutputReleaser const &) = delete;
+
+    // called by INode::requireInput, returns what consumer->inputs[ds] should hold
+    ZENO_API zany acquire(INode *consumer, std::string const &ds,
+                          std::string const &sn, std::string const &ss);
+    // called by INode::preApply once the node was applied
+    ZENO_API void release(INode *node);
+
+private:
+    using Socket = std::pair<std::string, std::string>;
+
+    std::mutex m_mtx;
+    std::map<Socket, std::size_t> m_uses;
+    std::set<std::string> m_pinned;
+    std::set<Socket> m_taken;  // (consumer, ds) already acquired in this pass
+    std::size_t m_released = 0;
+
+    bool nested() const;
+    void dropOutput(INode *node, std::string const &ss);
+};
+
+}
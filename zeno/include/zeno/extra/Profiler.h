@@ -0,0 +1,65 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <string_view>
+#include <cstdint>
+#include <string>
+
+namespace zeno {
+
+struct INode;
+
+// process-wide event recorder, off unless $ZENO_PROFILE is set or setEnabled(true)
+// is called; with $ZENO_PROFILE=<path> a Chrome trace is written there at exit.
+//
+// every thread appends to its own event blocks, which no other thread writes, so
+// recording never takes a lock. scopes on one thread nest, and the trace shows
+// them as a hierarchy per thread (open it in chrome://tracing or ui.perfetto.dev).
+struct Profiler {
+    enum class Category : std::uint8_t {
+        Node,   // INode::preApply, one per node evaluation
+        Cache,  // frame / temp cache reads and writes
+        Zfx,    // ZFX compile and assemble
+        IPC,    // runner -> editor packets
+        Other,
+    };
+
+    // records [construction, destruction) as one event, a no-op when disabled
+    struct Scope {
+        ZENO_API Scope(Category cat, std::string_view name);
+        ZENO_API ~Scope();
+
+        Scope(Scope const &) = delete;
+        Scope &operator=(Scope const &) = delete;
+
+        // node scopes also measure process CPU time, heap growth and output size
+        ZENO_API explicit Scope(INode *node);
+
+    private:
+        INode *m_node = nullptr;
+        Category m_cat{};
+        bool m_active = false;
+        std::string_view m_name;
+        std::int64_t m_beg = 0;
+        std::int64_t m_cpuBeg = 0;
+        std::int64_t m_heapBeg = 0;
+    };
+
+    ZENO_API static bool enabled();
+    ZENO_API static void setEnabled(bool on);
+
+    // drop everything recorded so far, freeing all but the last event block of each thread
+    ZENO_API static void clear();
+
+    // Chrome trace event format ("X" events, one track per thread)
+    ZENO_API static std::string traceJson();
+
+    // {"nodes":[{"name","count","wall_us","cpu_us","heap_bytes","output_bytes"}...]},
+    // sorted by wall time, heaviest first
+    ZENO_API static std::string summaryJson();
+
+    // write traceJson() to path, or to $ZENO_PROFILE if path is empty
+    ZENO_API static bool writeTrace(std::string const &path = {});
+};
+
+}
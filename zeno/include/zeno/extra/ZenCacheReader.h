@@ -0,0 +1,46 @@
+#pragma once
+
+#include <zeno/core/IObject.h>
+#include <zeno/utils/MappedFile.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+// lazy reader of a *.zencache file written by GlobalComm::toDisk,
+// open() maps the file and parses the key/offset table only, objects are decoded
+// straight from the mapped pages the first time they are asked for.
+struct ZenCacheReader {
+    ZENO_API ZenCacheReader();
+    ZENO_API ~ZenCacheReader();
+
+    ZenCacheReader(ZenCacheReader const &) = delete;
+    ZenCacheReader &operator=(ZenCacheReader const &) = delete;
+
+    ZENO_API bool open(std::filesystem::path const &path);
+
+    std::size_t size() const {
+        return m_keys.size();
+    }
+
+    std::string const &key(std::size_t i) const {
+        return m_keys[i];
+    }
+
+    bool isDecoded(std::size_t i) const {
+        return m_objs[i] != nullptr;
+    }
+
+    ZENO_API std::shared_ptr<IObject> get(std::size_t i);
+
+private:
+    MappedFile m_file;
+    std::vector<std::string> m_keys;
+    std::vector<std::size_t> m_poses;
+    std::vector<std::shared_ptr<IObject>> m_objs;
+    char const *m_body = nullptr;
+};
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zeno {
+
+// connectivity of the faces of a primitive, in compressed (CSR) tables.
+// faces are numbered tris first, then quads, then polys; lines only take part
+// in the vertex-vertex table
+struct PrimTopology {
+    // hash of the face arrays this was built from, see primTopologyStamp
+    std::uint64_t stamp = 0;
+    int numVerts = 0;
+    int numFaces = 0;
+
+    // half-edges of face f are [faceStart[f], faceStart[f + 1]), in winding order
+    std::vector<int> faceStart;
+    // vertex the half-edge starts from
+    std::vector<int> heVert;
+    std::vector<int> heFace;
+    // opposite half-edge, -1 on boundaries; on non-manifold edges the
+    // smallest matching one
+    std::vector<int> heTwin;
+
+    // half-edges leaving vertex v are vertHalfedges[vertStart[v] .. vertStart[v + 1]),
+    // ascending; vertFaces holds their faces, so faces of v are listed the same way
+    std::vector<int> vertStart;
+    std::vector<int> vertHalfedges;
+    std::vector<int> vertFaces;
+
+    // vertices sharing an edge or a line with v, ascending and unique:
+    // neighVerts[neighStart[v] .. neighStart[v + 1])
+    std::vector<int> neighStart;
+    std::vector<int> neighVerts;
+
+    int numHalfedges() const {
+        return (int)heVert.size();
+    }
+
+    int next(int h) const {
+        int f = heFace[h];
+        return h + 1 == faceStart[f + 1] ? faceStart[f] : h + 1;
+    }
+
+    int prev(int h) const {
+        int f = heFace[h];
+        return h == faceStart[f] ? faceStart[f + 1] - 1 : h - 1;
+    }
+
+    // vertex the half-edge points to
+    int dest(int h) const {
+        return heVert[next(h)];
+    }
+
+    bool isBoundaryVert(int v) const {
+        for (int i = vertStart[v]; i < vertStart[v + 1]; i++) {
+            int h = vertHalfedges[i];
+            if (heTwin[h] == -1 || heTwin[prev(h)] == -1)
+                return true;
+        }
+        return false;
+    }
+};
+
+// hash of the sizes and contents of verts count, lines, tris, quads, loops and polys
+ZENO_API std::uint64_t primTopologyStamp(PrimitiveObject const *prim);
+// builds the tables without touching the cache
+ZENO_API std::shared_ptr<PrimTopology const> primBuildTopology(PrimitiveObject const *prim);
+// cached on the primitive (and shared by its copies), rebuilt when its stamp
+// no longer matches the faces, so nodes editing faces need not invalidate it
+ZENO_API std::shared_ptr<PrimTopology const> primTopology(PrimitiveObject const *prim);
+
+}
@@ -100,7 +100,7 @@ static void deserialize(const std::vector<char> &str, AttrVector<T> &arr)
     auto attrVectorHeader{reinterpret_cast<const AttrVectorHeader *>(buff)};
 
     arr.values.reserve(attrVectorHeader->size);
-    std::copy_n((T *)attrVectorHeader->buff, attrVectorHeader->size, std::back_inserter(arr.values));
+    std::copy_n((T *)attrVectorHeader->buff, attrVectorHeader->size, std::back_inserter(arr.values.mut()));
 
     buff = attrVectorHeader->buff + sizeof(T) * attrVectorHeader->size;
 
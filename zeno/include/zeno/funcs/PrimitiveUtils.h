@@ -40,6 +40,8 @@ ZENO_API void prim_copy_faceset_to_matid(PrimitiveObject* prim);
 ZENO_API void primFilterVerts(PrimitiveObject *prim, std::string tagAttr, int tagValue, bool isInversed = false, std::string revampAttrO = {}, std::string method = "verts", int* aux = nullptr, int aux_size = 0, bool use_aux = false);
 
 ZENO_API void primMarkIsland(PrimitiveObject *prim, std::string tagAttr);
+ZENO_API void primWeld(PrimitiveObject *prim, std::string tagAttr, bool isAverage = false);
+ZENO_API void primWeldByDistance(PrimitiveObject *prim, float distance, bool isAverage = false);
 ZENO_API std::vector<std::shared_ptr<PrimitiveObject>> primUnmergeVerts(PrimitiveObject *prim, std::string tagAttr);
 ZENO_API std::vector<std::shared_ptr<PrimitiveObject>> primUnmergeFaces(PrimitiveObject *prim, std::string tagAttr);
 
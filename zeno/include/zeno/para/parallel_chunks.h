@@ -0,0 +1,72 @@
+#pragma once
+
+#include <zeno/utils/ThreadPool.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace zeno {
+
+// number of threads the para primitives may use, the calling one included
+inline std::size_t get_parallel_threads() {
+    return ThreadPool::global().concurrency();
+}
+
+// 0 restores the default (all threads of ThreadPool::global())
+inline void set_parallel_threads(std::size_t n) {
+    ThreadPool::global().setConcurrency(n);
+}
+
+// split of [0, n) into count chunks of size elements (the last one may be shorter)
+struct chunk_layout {
+    std::size_t n{};
+    std::size_t size{1};
+    std::size_t count{};
+
+    // grain is the chunk size, 0 picks about 4 chunks per thread
+    chunk_layout(std::size_t n_, std::size_t grain = 0) : n(n_) {
+        if (!n) return;
+        if (grain) {
+            size = grain;
+        } else {
+            std::size_t nchunks = get_parallel_threads() * 4;
+            size = nchunks > 4 ? (n + nchunks - 1) / nchunks : n;
+        }
+        count = (n + size - 1) / size;
+    }
+
+    std::size_t begin(std::size_t c) const {
+        return c * size;
+    }
+
+    std::size_t end(std::size_t c) const {
+        return std::min(n, c * size + size);
+    }
+};
+
+// call func(c, begin, end) for every chunk of the layout on ThreadPool::global();
+// the calling thread executes chunks and other pending tasks while waiting, so
+// these calls nest safely inside tasks and other parallel loops
+template <class Func>
+void parallel_chunks(chunk_layout const &layout, Func &&func) {
+    if (layout.count == 1) {
+        func(std::size_t{0}, std::size_t{0}, layout.n);
+        return;
+    }
+    struct Arg {
+        chunk_layout const &layout;
+        Func &func;
+    } arg{layout, func};
+    ThreadPool::global().forEachIndex(layout.count, [] (void *p, std::size_t c) {
+        auto &arg = *static_cast<Arg *>(p);
+        arg.func(c, arg.layout.begin(c), arg.layout.end(c));
+    }, &arg);
+}
+
+template <class Func>
+void parallel_chunks(std::size_t n, std::size_t grain, Func &&func) {
+    parallel_chunks(chunk_layout(n, grain), [&func] (std::size_t, std::size_t b, std::size_t e) {
+        func(b, e);
+    });
+}
+
+}
@@ -1,24 +1,41 @@
 #pragma once
 
-#include <zeno/para/execution.h>
-#include <zeno/para/counter_iterator.h>
+#include <zeno/para/parallel_chunks.h>
 #include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 namespace zeno {
 
+// grain: number of indices per task, 0 picks one from the thread count
 template <class Index, class Func>
-void parallel_for(Index first, Index last, Func func) {
-    std::for_each(ZENO_PAR counter_iterator<Index>(first), counter_iterator<Index>(last), func);
+void parallel_for(Index first, Index last, Func func, std::size_t grain = 0) {
+    if (!(first < last)) return;
+    parallel_chunks(std::size_t(last - first), grain, [&] (std::size_t b, std::size_t e) {
+        for (Index i = first + Index(b), ie = first + Index(e); i != ie; ++i) {
+            func(i);
+        }
+    });
 }
 
 template <class Index, class Func>
-void parallel_for(Index count, Func func) {
-    std::for_each(ZENO_PAR counter_iterator<Index>(Index{}), counter_iterator<Index>(count), func);
+void parallel_for(Index count, Func func, std::size_t grain = 0) {
+    parallel_for(Index{}, count, std::move(func), grain);
 }
 
 template <class It, class Func>
-void parallel_for_each(It first, It last, Func func) {
-    std::for_each(ZENO_PAR_UNSEQ first, last, func);
+void parallel_for_each(It first, It last, Func func, std::size_t grain = 0) {
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                  typename std::iterator_traits<It>::iterator_category>) {
+        if (!(first < last)) return;
+        parallel_chunks(std::size_t(last - first), grain, [&] (std::size_t b, std::size_t e) {
+            for (It it = first + std::ptrdiff_t(b), ie = first + std::ptrdiff_t(e); it != ie; ++it) {
+                func(*it);
+            }
+        });
+    } else {
+        std::for_each(first, last, func);
+    }
 }
 
 }
@@ -1,8 +1,7 @@
 #pragma once
 
-#include <zeno/para/execution.h>
+#include <zeno/para/parallel_chunks.h>
 #include <functional>
-#include <algorithm>
 #include <array>
 
 namespace zeno {
@@ -10,11 +9,11 @@ namespace zeno {
 template <class ...Tasks>
 void parallel_invoke(Tasks &&...tasks) {
     std::array<std::function<void()>, sizeof...(Tasks)> tmp{std::forward<Tasks>(tasks)...};
-    std::for_each(ZENO_PAR tmp.begin(), tmp.end(), [] (auto &&f) { std::move(f)(); });
+    parallel_chunks(tmp.size(), 1, [&] (std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; i++) {
+            std::move(tmp[i])();
+        }
+    });
 }
 
-//inline void parallel_invoke(std::initializer_list<std::function<void()> tasks) {
-    //std::for_each(ZENO_PAR tasks.begin(), tasks.end(), [] (auto &&f) { std::move(f)() });
-//}
-
 }
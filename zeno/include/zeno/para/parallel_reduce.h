@@ -1,25 +1,72 @@
 #pragma once
 
-#include <zeno/para/execution.h>
+#include <zeno/para/parallel_chunks.h>
 #include <zeno/para/counter_iterator.h>
 #include <zeno/utils/type_traits.h>
 #include <zeno/utils/vec.h>
+#include <iterator>
+#include <optional>
+#include <type_traits>
 #include <numeric>
 #include <limits>
+#include <vector>
 #include <tuple>
 
 namespace zeno {
 
+namespace _parallel_reduce_details {
+
+// chunk partials are combined in chunk order, so for a given thread count the
+// result is deterministic even for non-associative (floating point) reductions
+template <class Value, class Reduce, class Get>
+Value reduce_chunks(std::size_t n, Value initVal, Reduce &reduceFn, Get &&get) {
+    chunk_layout layout(n);
+    if (layout.count <= 1) {
+        for (std::size_t i = 0; i < n; i++) {
+            initVal = reduceFn(std::move(initVal), get(i));
+        }
+        return initVal;
+    }
+    std::vector<std::optional<Value>> partial(layout.count);
+    parallel_chunks(layout, [&] (std::size_t c, std::size_t b, std::size_t e) {
+        Value acc(get(b));
+        for (std::size_t i = b + 1; i < e; i++) {
+            acc = reduceFn(std::move(acc), get(i));
+        }
+        partial[c].emplace(std::move(acc));
+    });
+    for (auto &p: partial) {
+        initVal = reduceFn(std::move(initVal), std::move(*p));
+    }
+    return initVal;
+}
+
+template <class It, class Value, class Reduce, class Transform>
+Value transform_reduce(It first, It last, Value initVal, Reduce reduceFn, Transform transformFn) {
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                  typename std::iterator_traits<It>::iterator_category>) {
+        return reduce_chunks(std::size_t(last - first), std::move(initVal), reduceFn, [&] (std::size_t i) {
+            return transformFn(*(first + std::ptrdiff_t(i)));
+        });
+    } else {
+        return std::transform_reduce(first, last, std::move(initVal), reduceFn, transformFn);
+    }
+}
+
+}
+
 template <class Index, class Value, class Reduce, class Transform>
 Value parallel_reduce(Index first, Index last, Value initVal, Reduce reduceFn, Transform transformFn) {
-    return std::transform_reduce(ZENO_PAR counter_iterator<Index>(first), counter_iterator<Index>(last),
-            initVal, reduceFn, transformFn);
+    if (!(first < last)) return initVal;
+    return _parallel_reduce_details::reduce_chunks(std::size_t(last - first), std::move(initVal), reduceFn, [&] (std::size_t i) {
+        return transformFn(first + Index(i));
+    });
 }
 
 template <class It, class Transform = identity>
 auto parallel_reduce_min(It first, It last, Transform transformFn = {}) {
     if (first == last) return std::decay_t<decltype(*first)>();
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, *first, [] (auto &&x, auto &&y) {
+    return _parallel_reduce_details::transform_reduce(first, last, *first, [] (auto &&x, auto &&y) {
         return zeno::min(x, y);
     }, transformFn);
 }
@@ -27,7 +74,7 @@ auto parallel_reduce_min(It first, It last, Transform transformFn = {}) {
 template <class It, class Transform = identity>
 auto parallel_reduce_max(It first, It last, Transform transformFn = {}) {
     if (first == last) return std::decay_t<decltype(*first)>();
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, *first, [] (auto &&x, auto &&y) {
+    return _parallel_reduce_details::transform_reduce(first, last, *first, [] (auto &&x, auto &&y) {
         return zeno::max(x, y);
     }, transformFn);
 }
@@ -35,7 +82,7 @@ auto parallel_reduce_max(It first, It last, Transform transformFn = {}) {
 template <class It, class Transform = identity>
 auto parallel_reduce_minmax(It first, It last, Transform transformFn = {}) {
     if (first == last) return std::make_pair(std::decay_t<decltype(*first)>(), std::decay_t<decltype(*first)>());
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, std::make_pair(*first, *first), [] (auto &&x, auto &&y) {
+    return _parallel_reduce_details::transform_reduce(first, last, std::make_pair(*first, *first), [] (auto &&x, auto &&y) {
         return std::make_pair(zeno::min(x.first, y.first), zeno::max(x.second, y.second));
     }, [transformFn] (auto const &val) {
         return std::make_pair(val, val);
@@ -44,7 +91,7 @@ auto parallel_reduce_minmax(It first, It last, Transform transformFn = {}) {
 
 template <class It, class Transform = identity>
 auto parallel_reduce_sum(It first, It last, Transform transformFn = {}) {
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
+    return _parallel_reduce_details::transform_reduce(first, last, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
         return x + y;
     }, transformFn);
 }
@@ -1,51 +1,146 @@
 #pragma once
 
-#include <zeno/para/execution.h>
+#include <zeno/para/parallel_chunks.h>
 #include <zeno/para/counter_iterator.h>
 #include <zeno/utils/type_traits.h>
 #include <zeno/utils/vec.h>
+#include <iterator>
+#include <optional>
 #include <numeric>
 #include <limits>
+#include <vector>
 #include <tuple>
 
 namespace zeno {
 
+namespace _parallel_scan_details {
+
+// two passes over the chunks: per-chunk totals, then each chunk scans again
+// starting from the (serial) prefix of the totals before it; returns the total
+template <bool Inclusive, class Value, class Reduce, class Get, class Put>
+Value scan_chunks(std::size_t n, Value initVal, Reduce &reduceFn, Get &&get, Put &&put) {
+    chunk_layout layout(n);
+    if (layout.count > 1) {
+        std::vector<std::optional<Value>> offset(layout.count);
+        parallel_chunks(layout, [&] (std::size_t c, std::size_t b, std::size_t e) {
+            Value acc(get(b));
+            for (std::size_t i = b + 1; i < e; i++) {
+                acc = reduceFn(std::move(acc), get(i));
+            }
+            offset[c].emplace(std::move(acc));
+        });
+        for (auto &o: offset) {
+            Value next = reduceFn(initVal, std::move(*o));
+            o.emplace(std::move(initVal));
+            initVal = std::move(next);
+        }
+        parallel_chunks(layout, [&] (std::size_t c, std::size_t b, std::size_t e) {
+            Value acc = std::move(*offset[c]);
+            for (std::size_t i = b; i < e; i++) {
+                if constexpr (Inclusive) {
+                    acc = reduceFn(std::move(acc), get(i));
+                    put(i, acc);
+                } else {
+                    put(i, acc);
+                    acc = reduceFn(std::move(acc), get(i));
+                }
+            }
+        });
+    } else {
+        for (std::size_t i = 0; i < n; i++) {
+            if constexpr (Inclusive) {
+                initVal = reduceFn(std::move(initVal), get(i));
+                put(i, initVal);
+            } else {
+                put(i, initVal);
+                initVal = reduceFn(std::move(initVal), get(i));
+            }
+        }
+    }
+    return initVal;
+}
+
+template <class It>
+inline constexpr bool is_random_access_v = std::is_base_of_v<std::random_access_iterator_tag,
+    typename std::iterator_traits<It>::iterator_category>;
+
+}
+
 template <class Index, class OutputIt, class Value, class Reduce, class Transform>
 OutputIt parallel_inclusive_scan(Index first, Index last, OutputIt dest,
                     Value initVal, Reduce reduceFn, Transform transformFn) {
-    return std::transform_inclusive_scan(ZENO_PAR
-            counter_iterator<Index>(first), counter_iterator<Index>(last),
-            dest, reduceFn, transformFn, initVal);
+    if constexpr (_parallel_scan_details::is_random_access_v<OutputIt>) {
+        if (!(first < last)) return dest;
+        std::size_t n(last - first);
+        _parallel_scan_details::scan_chunks<true>(n, std::move(initVal), reduceFn, [&] (std::size_t i) {
+            return transformFn(first + Index(i));
+        }, [&] (std::size_t i, Value const &val) {
+            *(dest + std::ptrdiff_t(i)) = val;
+        });
+        return dest + std::ptrdiff_t(n);
+    } else {
+        return std::transform_inclusive_scan(
+                counter_iterator<Index>(first), counter_iterator<Index>(last),
+                dest, reduceFn, transformFn, initVal);
+    }
 }
 
 template <class It, class OutputIt, class Transform = identity>
 OutputIt parallel_inclusive_scan_sum(It first, It last, OutputIt dest, Transform transformFn = {}) {
-    return std::transform_inclusive_scan(ZENO_PAR_UNSEQ first, last, dest, [] (auto &&x, auto &&y) {
+    using Value = std::decay_t<decltype(transformFn(*first))>;
+    auto reduceFn = [] (auto &&x, auto &&y) {
         return x + y;
-    }, transformFn, std::decay_t<decltype(transformFn(*first))>());
+    };
+    if constexpr (_parallel_scan_details::is_random_access_v<It> && _parallel_scan_details::is_random_access_v<OutputIt>) {
+        std::size_t n(last - first);
+        _parallel_scan_details::scan_chunks<true>(n, Value(), reduceFn, [&] (std::size_t i) {
+            return transformFn(*(first + std::ptrdiff_t(i)));
+        }, [&] (std::size_t i, Value const &val) {
+            *(dest + std::ptrdiff_t(i)) = val;
+        });
+        return dest + std::ptrdiff_t(n);
+    } else {
+        return std::transform_inclusive_scan(first, last, dest, reduceFn, transformFn, Value());
+    }
 }
 
 template <class Index, class OutputIt, class Value, class Reduce, class Transform>
 Value parallel_exclusive_scan(Index first, Index last, OutputIt dest,
                     Value initVal, Reduce reduceFn, Transform transformFn) {
-    auto endp = std::transform_exclusive_scan(ZENO_PAR
-            counter_iterator<Index>(first), counter_iterator<Index>(last),
-            dest, initVal, reduceFn, transformFn);
-    if (first != last)
-        return reduceFn(*std::prev(endp), transformFn(*std::prev(last)));
-    else
-        return initVal;
+    if (!(first < last)) return initVal;
+    if constexpr (_parallel_scan_details::is_random_access_v<OutputIt>) {
+        return _parallel_scan_details::scan_chunks<false>(std::size_t(last - first), std::move(initVal), reduceFn, [&] (std::size_t i) {
+            return transformFn(first + Index(i));
+        }, [&] (std::size_t i, Value const &val) {
+            *(dest + std::ptrdiff_t(i)) = val;
+        });
+    } else {
+        auto endp = std::transform_exclusive_scan(
+                counter_iterator<Index>(first), counter_iterator<Index>(last),
+                dest, initVal, reduceFn, transformFn);
+        return reduceFn(*std::prev(endp), transformFn(Index(last - 1)));
+    }
 }
 
 template <class It, class OutputIt, class Transform = identity>
 auto parallel_exclusive_scan_sum(It first, It last, OutputIt dest, Transform transformFn = {}) {
-    auto endp = std::transform_exclusive_scan(ZENO_PAR_UNSEQ first, last, dest, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
+    using Value = std::decay_t<decltype(transformFn(*first))>;
+    auto reduceFn = [] (auto &&x, auto &&y) {
         return x + y;
-    }, transformFn);
-    if (first != last)
-        return *std::prev(endp) + transformFn(*std::prev(last));
-    else
-        return std::decay_t<decltype(transformFn(*first))>();
+    };
+    if constexpr (_parallel_scan_details::is_random_access_v<It> && _parallel_scan_details::is_random_access_v<OutputIt>) {
+        return _parallel_scan_details::scan_chunks<false>(std::size_t(last - first), Value(), reduceFn, [&] (std::size_t i) {
+            return transformFn(*(first + std::ptrdiff_t(i)));
+        }, [&] (std::size_t i, Value const &val) {
+            *(dest + std::ptrdiff_t(i)) = val;
+        });
+    } else {
+        auto endp = std::transform_exclusive_scan(first, last, dest, Value(), reduceFn, transformFn);
+        if (first != last)
+            return Value(*std::prev(endp) + transformFn(*std::prev(last)));
+        else
+            return Value();
+    }
 }
 
 }
@@ -1,19 +1,110 @@
 #pragma once
 
-#include <zeno/para/execution.h>
-#include <zeno/para/counter_iterator.h>
+#include <zeno/para/parallel_chunks.h>
+#include <type_traits>
 #include <algorithm>
+#include <iterator>
+#include <vector>
+#include <array>
 
 namespace zeno {
 
+namespace _parallel_sort_details {
+
+// sort one slice per thread, then merge neighbouring slices pairwise, one
+// parallel pass per level; std::inplace_merge keeps equal elements in order,
+// so the result is stable whenever the slices are sorted stably
+template <bool Stable, class It, class Func>
+void merge_sort(It first, It last, Func &func) {
+    std::size_t n(last - first);
+    std::size_t nslices = 1;
+    while (nslices < get_parallel_threads() && n / (nslices * 2) >= 4096) {
+        nslices *= 2;
+    }
+    auto bound = [&] (std::size_t s) {
+        return first + std::ptrdiff_t(n * s / nslices);
+    };
+    auto sortSlice = [&] (It b, It e) {
+        if constexpr (Stable)
+            std::stable_sort(b, e, func);
+        else
+            std::sort(b, e, func);
+    };
+    if (nslices == 1) {
+        sortSlice(first, last);
+        return;
+    }
+    parallel_chunks(nslices, 1, [&] (std::size_t b, std::size_t e) {
+        for (std::size_t s = b; s < e; s++) {
+            sortSlice(bound(s), bound(s + 1));
+        }
+    });
+    for (std::size_t width = 1; width < nslices; width *= 2) {
+        parallel_chunks(nslices / (width * 2), 1, [&] (std::size_t b, std::size_t e) {
+            for (std::size_t s = b * width * 2; s < e * width * 2; s += width * 2) {
+                std::inplace_merge(bound(s), bound(s + width), bound(s + width * 2), func);
+            }
+        });
+    }
+}
+
+}
+
 template <class It, class Func>
 void parallel_sort(It first, It last, Func func) {
-    std::sort(ZENO_PAR_UNSEQ first, last, func);
+    _parallel_sort_details::merge_sort<false>(first, last, func);
 }
 
 template <class It, class Func>
 void parallel_stable_sort(It first, It last, Func func) {
-    std::stable_sort(ZENO_PAR_UNSEQ first, last, func);
+    _parallel_sort_details::merge_sort<true>(first, last, func);
+}
+
+// stable LSD radix sort of unsigned integer keys, permuting values along with
+// them; a byte on which all keys agree costs one counting pass and no scatter
+template <class Key, class Value>
+void parallel_radix_sort_by_key(std::vector<Key> &keys, std::vector<Value> &values) {
+    static_assert(std::is_unsigned_v<Key>);
+    std::size_t n = keys.size();
+    if (n < 2) return;
+    chunk_layout layout(n);
+    std::vector<std::array<std::size_t, 256>> offset(layout.count);
+    std::vector<Key> keysTmp(n);
+    std::vector<Value> valuesTmp(n);
+    for (std::size_t shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+        parallel_chunks(layout, [&] (std::size_t c, std::size_t b, std::size_t e) {
+            auto &cnt = offset[c];
+            cnt.fill(0);
+            for (std::size_t i = b; i < e; i++) {
+                cnt[(keys[i] >> shift) & 255]++;
+            }
+        });
+        // digit-major, chunk-minor: chunk c writes its digit d after the
+        // earlier chunks, which keeps every pass stable
+        bool skip = false;
+        std::size_t base = 0;
+        for (std::size_t d = 0; d < 256; d++) {
+            std::size_t first = base;
+            for (std::size_t c = 0; c < layout.count; c++) {
+                auto cnt = offset[c][d];
+                offset[c][d] = base;
+                base += cnt;
+            }
+            if (base - first == n)
+                skip = true;
+        }
+        if (skip) continue;
+        parallel_chunks(layout, [&] (std::size_t c, std::size_t b, std::size_t e) {
+            auto &off = offset[c];
+            for (std::size_t i = b; i < e; i++) {
+                auto o = off[(keys[i] >> shift) & 255]++;
+                keysTmp[o] = keys[i];
+                valuesTmp[o] = std::move(values[i]);
+            }
+        });
+        keys.swap(keysTmp);
+        values.swap(valuesTmp);
+    }
 }
 
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <zeno/para/execution.h>
+#include <zeno/para/parallel_chunks.h>
 #include <functional>
 #include <algorithm>
 #include <vector>
@@ -19,8 +19,10 @@ struct task_group {
     }
 
     void run() {
-        std::for_each(ZENO_PAR m_tasks.begin(), m_tasks.end(), [&] (auto &&f) {
-            std::move(f)();
+        parallel_chunks(m_tasks.size(), 1, [&] (std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; i++) {
+                std::move(m_tasks[i])();
+            }
         });
     }
 };
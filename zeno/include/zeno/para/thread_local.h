@@ -1,8 +1,5 @@
 #pragma once
 
-#ifdef ZENO_PARALLEL_STL
-
-#include <zeno/para/execution.h>
 #include <thread>
 #include <mutex>
 #include <map>
@@ -73,25 +70,3 @@ for (auto const &pos: poses) {
  */
 
 }
-
-#else
-
-namespace zeno {
-
-template <class Value>
-struct thread_local_storage {
-    using value_type = Value;
-    using reference = Value &;
-
-private:
-    value_type m_val;
-
-public:
-    reference local() {
-        return m_val;
-    }
-};
-
-}
-
-#endif
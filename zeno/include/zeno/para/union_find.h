@@ -0,0 +1,80 @@
+#pragma once
+
+#include <zeno/para/parallel_for.h>
+#include <zeno/para/parallel_scan.h>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace zeno {
+
+// lock-free disjoint sets over [0, n), unite() and find() may be called from
+// many threads at once. a root is always the smallest element of its set, so
+// neither the partition nor the roots depend on the order of the unions
+struct concurrent_union_find {
+    std::unique_ptr<std::atomic<int>[]> m_parent;
+    std::size_t m_size = 0;
+
+    explicit concurrent_union_find(std::size_t n)
+        : m_parent(new std::atomic<int>[n]), m_size(n) {
+        parallel_for(n, [&] (std::size_t i) {
+            m_parent[i].store(int(i), std::memory_order_relaxed);
+        });
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    // parents only ever move to smaller indices, so relaxed ordering is enough
+    // and the path halving may race with other finds and unions harmlessly
+    int find(int i) {
+        int p = m_parent[i].load(std::memory_order_relaxed);
+        while (p != i) {
+            int gp = m_parent[p].load(std::memory_order_relaxed);
+            if (gp != p)
+                m_parent[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            i = gp;
+            p = m_parent[i].load(std::memory_order_relaxed);
+        }
+        return i;
+    }
+
+    void unite(int a, int b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            // a is a root unless another thread linked it meanwhile, then retry
+            int expected = a;
+            if (m_parent[a].compare_exchange_weak(expected, b, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    // once all unions are done: labels[i] = id of the set containing i, ids
+    // are 0, 1, ... in order of the smallest element of each set; returns the
+    // number of sets
+    template <class OutputIt>
+    int compact(OutputIt labels) {
+        if (!m_size) return 0;
+        std::vector<int> root(m_size);
+        parallel_for(m_size, [&] (std::size_t i) {
+            root[i] = find(int(i));
+        });
+        std::vector<int> rank(m_size);
+        int count = parallel_exclusive_scan(std::size_t(0), m_size, rank.begin(), 0, std::plus<int>(), [&] (std::size_t i) {
+            return int(root[i] == int(i));
+        });
+        parallel_for(m_size, [&] (std::size_t i) {
+            *(labels + std::ptrdiff_t(i)) = rank[root[i]];
+        });
+        return count;
+    }
+};
+
+}
@@ -6,6 +6,12 @@
 #include <variant>
 #include <vector>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
 
 namespace zeno {
 
@@ -26,6 +32,315 @@ struct AttrVectorIndex {
     size_t attrDim = 1;
 };
 
+// one copy-on-write object: share() hands out another slot referring to the
+// same object, which is copied on the first mutable access through a slot that
+// is still shared. const accessors never copy. mutable accessors may be called
+// from several threads at once, share() must not race with writers of the slot,
+// and references taken before a share() must not be written through after it.
+template <class T>
+struct CowSlot {
+private:
+    std::shared_ptr<T> m_ptr;              // null for a default-constructed T
+    std::atomic<T const *> m_data;         // what get() returns
+    mutable std::atomic<T *> m_owned;      // m_ptr.get() once known unshared, else null
+
+    static T const &emptyValue() {
+        static const T empty{};
+        return empty;
+    }
+
+    static std::mutex &detachMutex() {
+        static std::mutex mtx;
+        return mtx;
+    }
+
+    T &detach() {
+        std::lock_guard lck(detachMutex());
+        if (auto p = m_owned.load(std::memory_order_acquire))
+            return *p;
+        if (!m_ptr)
+            m_ptr = std::make_shared<T>();
+        else if (m_ptr.use_count() != 1)
+            m_ptr = std::make_shared<T>(std::as_const(*m_ptr));
+        else  // pairs with the release in other owners' decrement
+            std::atomic_thread_fence(std::memory_order_acquire);
+        m_data.store(m_ptr.get(), std::memory_order_release);
+        m_owned.store(m_ptr.get(), std::memory_order_release);
+        return *m_ptr;
+    }
+
+public:
+    CowSlot() noexcept : m_data(&emptyValue()), m_owned(nullptr) {}
+
+    explicit CowSlot(std::shared_ptr<T> ptr) noexcept
+        : m_ptr(std::move(ptr)), m_data(m_ptr.get()), m_owned(m_ptr.get()) {}
+
+    CowSlot(CowSlot const &o)
+        : CowSlot(o.m_ptr ? std::make_shared<T>(o.get()) : nullptr) {
+        if (!m_ptr)
+            m_data.store(&emptyValue(), std::memory_order_relaxed);
+    }
+
+    CowSlot(CowSlot &&o) noexcept
+        : m_ptr(std::move(o.m_ptr))
+        , m_data(o.m_data.load(std::memory_order_relaxed))
+        , m_owned(o.m_owned.load(std::memory_order_relaxed)) {
+        o.m_data.store(&emptyValue(), std::memory_order_relaxed);
+        o.m_owned.store(nullptr, std::memory_order_relaxed);
+    }
+
+    CowSlot &operator=(CowSlot const &o) {
+        if (this != &o)
+            *this = CowSlot(o);
+        return *this;
+    }
+
+    CowSlot &operator=(CowSlot &&o) noexcept {
+        if (this != &o) {
+            m_ptr = std::move(o.m_ptr);
+            m_data.store(o.m_data.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            m_owned.store(o.m_owned.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            o.m_data.store(&emptyValue(), std::memory_order_relaxed);
+            o.m_owned.store(nullptr, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    CowSlot share() const {
+        CowSlot ret;
+        if (m_ptr) {
+            m_owned.store(nullptr, std::memory_order_relaxed);
+            ret.m_ptr = m_ptr;
+            ret.m_data.store(m_ptr.get(), std::memory_order_relaxed);
+        }
+        return ret;
+    }
+
+    T const &get() const {
+        return *m_data.load(std::memory_order_acquire);
+    }
+
+    T &mut() {
+        if (auto p = m_owned.load(std::memory_order_acquire))
+            return *p;
+        return detach();
+    }
+};
+
+// std::vector<T> whose storage is a CowSlot, so AttrVector::share() can share
+// the base array too. mutable members copy it if it is shared, get() and the
+// conversion to a const std::vector never do.
+template <class T>
+struct CowVector {
+    using vector_type = std::vector<T>;
+    using value_type = typename vector_type::value_type;
+    using allocator_type = typename vector_type::allocator_type;
+    using size_type = typename vector_type::size_type;
+    using difference_type = typename vector_type::difference_type;
+    using reference = typename vector_type::reference;
+    using const_reference = typename vector_type::const_reference;
+    using pointer = typename vector_type::pointer;
+    using const_pointer = typename vector_type::const_pointer;
+    using iterator = typename vector_type::iterator;
+    using const_iterator = typename vector_type::const_iterator;
+    using reverse_iterator = typename vector_type::reverse_iterator;
+    using const_reverse_iterator = typename vector_type::const_reverse_iterator;
+
+private:
+    CowSlot<vector_type> m_slot;
+
+    explicit CowVector(CowSlot<vector_type> &&slot) noexcept : m_slot(std::move(slot)) {}
+
+public:
+    CowVector() = default;
+    CowVector(vector_type const &v) : m_slot(std::make_shared<vector_type>(v)) {}
+    CowVector(vector_type &&v) : m_slot(std::make_shared<vector_type>(std::move(v))) {}
+    CowVector(std::initializer_list<T> il) : m_slot(std::make_shared<vector_type>(il)) {}
+    explicit CowVector(size_type n) : m_slot(std::make_shared<vector_type>(n)) {}
+    CowVector(size_type n, T const &val) : m_slot(std::make_shared<vector_type>(n, val)) {}
+
+    CowVector share() const { return CowVector(m_slot.share()); }
+
+    vector_type const &get() const { return m_slot.get(); }
+    vector_type &mut() { return m_slot.mut(); }
+
+    operator vector_type const &() const & { return get(); }
+    operator vector_type &() & { return mut(); }
+    operator vector_type &&() && { return std::move(mut()); }
+
+    CowVector &operator=(vector_type const &v) { return *this = vector_type(v); }
+    CowVector &operator=(vector_type &&v) { m_slot = CowSlot<vector_type>(std::make_shared<vector_type>(std::move(v))); return *this; }
+    CowVector &operator=(std::initializer_list<T> il) { return *this = vector_type(il); }
+
+    size_type size() const { return get().size(); }
+    bool empty() const { return get().empty(); }
+    size_type capacity() const { return get().capacity(); }
+    size_type max_size() const { return get().max_size(); }
+
+    const_reference operator[](size_type i) const { return get()[i]; }
+    reference operator[](size_type i) { return mut()[i]; }
+    const_reference at(size_type i) const { return get().at(i); }
+    reference at(size_type i) { return mut().at(i); }
+    const_reference front() const { return get().front(); }
+    reference front() { return mut().front(); }
+    const_reference back() const { return get().back(); }
+    reference back() { return mut().back(); }
+    const_pointer data() const { return get().data(); }
+    pointer data() { return mut().data(); }
+
+    const_iterator begin() const { return get().begin(); }
+    const_iterator end() const { return get().end(); }
+    const_iterator cbegin() const { return get().cbegin(); }
+    const_iterator cend() const { return get().cend(); }
+    iterator begin() { return mut().begin(); }
+    iterator end() { return mut().end(); }
+    const_reverse_iterator rbegin() const { return get().rbegin(); }
+    const_reverse_iterator rend() const { return get().rend(); }
+    reverse_iterator rbegin() { return mut().rbegin(); }
+    reverse_iterator rend() { return mut().rend(); }
+
+    void push_back(T const &t) { mut().push_back(t); }
+    void push_back(T &&t) { mut().push_back(std::move(t)); }
+    template <class ...Args>
+    reference emplace_back(Args &&...args) { return mut().emplace_back(std::forward<Args>(args)...); }
+    void pop_back() { mut().pop_back(); }
+    template <class ...Args>
+    iterator insert(Args &&...args) { return mut().insert(std::forward<Args>(args)...); }
+    template <class ...Args>
+    iterator emplace(Args &&...args) { return mut().emplace(std::forward<Args>(args)...); }
+    template <class ...Args>
+    iterator erase(Args &&...args) { return mut().erase(std::forward<Args>(args)...); }
+    template <class ...Args>
+    void assign(Args &&...args) { mut().assign(std::forward<Args>(args)...); }
+    void assign(std::initializer_list<T> il) { mut().assign(il); }
+    void resize(size_type n) { mut().resize(n); }
+    void resize(size_type n, T const &val) { mut().resize(n, val); }
+    void reserve(size_type n) { mut().reserve(n); }
+    void shrink_to_fit() { mut().shrink_to_fit(); }
+    void swap(vector_type &v) { mut().swap(v); }
+    void swap(CowVector &o) noexcept { std::swap(m_slot, o.m_slot); }
+
+    void clear() {
+        if (!empty())
+            mut().clear();
+    }
+
+    friend bool operator==(CowVector const &a, CowVector const &b) { return a.get() == b.get(); }
+    friend bool operator!=(CowVector const &a, CowVector const &b) { return a.get() != b.get(); }
+};
+
+// std::map-like container of named attribute arrays, each held in a CowSlot.
+// copying it copies the arrays, share() makes a copy that shares them instead,
+// so cloning a primitive that way costs O(number of attributes). a shared array
+// is copied on the first mutable access to it: non-const at(), operator[] or
+// dereferencing a non-const iterator. arrays a node only reads
+// through const accessors, or never touches, stay shared.
+template <class Variant>
+struct AttrMap {
+    using key_type = std::string;
+    using mapped_type = Variant;
+    using value_type = std::pair<const std::string, Variant>;
+    using size_type = std::size_t;
+
+private:
+    using Storage = std::map<std::string, CowSlot<value_type>>;
+
+    template <bool Const>
+    struct Iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = AttrMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, value_type const &, value_type &>;
+        using pointer = std::conditional_t<Const, value_type const *, value_type *>;
+        using base_iterator = std::conditional_t<Const, typename Storage::const_iterator, typename Storage::iterator>;
+
+        base_iterator it;
+
+        Iterator() = default;
+        Iterator(base_iterator it_) : it(it_) {}
+        template <bool C = Const, class = std::enable_if_t<C>>
+        Iterator(Iterator<false> const &o) : it(o.it) {}
+
+        reference operator*() const {
+            if constexpr (Const)
+                return it->second.get();
+            else
+                return it->second.mut();
+        }
+        pointer operator->() const { return &**this; }
+        Iterator &operator++() { ++it; return *this; }
+        Iterator &operator--() { --it; return *this; }
+        Iterator operator++(int) { auto t = *this; ++it; return t; }
+        Iterator operator--(int) { auto t = *this; --it; return t; }
+        template <bool C>
+        bool operator==(Iterator<C> const &o) const { return it == o.it; }
+        template <bool C>
+        bool operator!=(Iterator<C> const &o) const { return it != o.it; }
+    };
+
+    Storage m_map;
+
+    static CowSlot<value_type> makeSlot(std::string const &key, Variant &&val) {
+        return CowSlot<value_type>(std::make_shared<value_type>(key, std::move(val)));
+    }
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    // a copy that shares every array with this one
+    AttrMap share() const {
+        AttrMap ret;
+        for (auto const &[key, slot] : m_map)
+            ret.m_map.emplace_hint(ret.m_map.end(), key, slot.share());
+        return ret;
+    }
+
+    iterator begin() { return m_map.begin(); }
+    iterator end() { return m_map.end(); }
+    const_iterator begin() const { return m_map.begin(); }
+    const_iterator end() const { return m_map.end(); }
+    const_iterator cbegin() const { return m_map.cbegin(); }
+    const_iterator cend() const { return m_map.cend(); }
+
+    size_type size() const { return m_map.size(); }
+    bool empty() const { return m_map.empty(); }
+    void clear() { m_map.clear(); }
+
+    iterator find(std::string const &key) { return m_map.find(key); }
+    const_iterator find(std::string const &key) const { return m_map.find(key); }
+    size_type count(std::string const &key) const { return m_map.count(key); }
+
+    size_type erase(std::string const &key) { return m_map.erase(key); }
+    iterator erase(const_iterator pos) { return m_map.erase(pos.it); }
+    iterator erase(iterator pos) { return m_map.erase(pos.it); }
+
+    Variant &operator[](std::string const &key) {
+        auto it = m_map.find(key);
+        if (it == m_map.end())
+            it = m_map.emplace(key, makeSlot(key, Variant{})).first;
+        return it->second.mut().second;
+    }
+
+    Variant &at(std::string const &key) { return m_map.at(key).mut().second; }
+    Variant const &at(std::string const &key) const { return m_map.at(key).get().second; }
+
+    // replaces the array, leaving other copies sharing the old one untouched
+    template <class V>
+    std::pair<iterator, bool> insert_or_assign(std::string const &key, V &&val) {
+        auto [it, inserted] = m_map.insert_or_assign(key, makeSlot(key, Variant(std::forward<V>(val))));
+        return {it, inserted};
+    }
+
+    template <class ...Args>
+    std::pair<iterator, bool> emplace(std::string const &key, Args &&...args) {
+        if (auto it = m_map.find(key); it != m_map.end())
+            return {it, false};
+        auto [it, inserted] = m_map.emplace(key, makeSlot(key, Variant(std::forward<Args>(args)...)));
+        return {it, inserted};
+    }
+};
+
 // AttrVector = BaseVector + attrs
 template <class ValT>
 struct AttrVector {
@@ -52,14 +367,23 @@ struct AttrVector {
 
     inline static const std::string kpos = "pos"; 
 
-    BaseVector values;
-    std::map<std::string, AttrVectorVariant> attrs;
+    CowVector<ValT> values;
+    AttrMap<AttrVectorVariant> attrs;
 
     AttrVector() = default;
     AttrVector(std::vector<ValT> const &values_) : values(values_) {}
     AttrVector(std::vector<ValT> &&values_) : values(std::move(values_)) {}
     explicit AttrVector(size_t size) : values(size) {}
 
+    // a copy sharing values and the attribute arrays with this one, each is
+    // copied on its first mutable access, see CowSlot
+    AttrVector share() const {
+        AttrVector ret;
+        ret.values = values.share();
+        ret.attrs = attrs.share();
+        return ret;
+    }
+
     decltype(auto) begin() const {
         return values.begin();
     }
@@ -121,25 +445,25 @@ struct AttrVector {
     }
 
     auto const *operator->() const {
-        return &values;
+        return &values.get();
     }
 
     auto *operator->() {
-        return &values;
+        return &values.mut();
     }
 
     operator auto const &() const {
-        return values;
+        return values.get();
     }
 
     operator auto &() {
-        return values;
+        return values.mut();
     }
 
     template <class Accept = std::variant<vec3f, float>, class F>
     void attr_visit(std::string const &name, F const &f) const {
         if (name == "pos") {
-            f(values);
+            f(values.get());
             return;
         }
         auto it = attrs.find(name);
@@ -157,7 +481,7 @@ struct AttrVector {
     void attr_visit(std::string const &name, F const &f) {
         if constexpr (variant_contains<ValT, Accept>::value) {
             if (name == "pos") {
-                f(values);
+                f(values.mut());
                 return;
             }
         }
@@ -200,7 +524,7 @@ struct AttrVector {
 
     template <class Accept = std::variant<vec3f, float>, class F>
     void forall_attr(F &&f) const {
-        f(kpos, values);
+        f(kpos, values.get());
         for (auto const &[key, arr]: attrs) {
             auto const &k = key;
             std::visit([&] (auto &arr) {
@@ -214,7 +538,7 @@ struct AttrVector {
 
     template <class Accept = std::variant<vec3f, float>, class F>
     void forall_attr(F &&f) {
-        f(kpos, values);
+        f(kpos, values.mut());
         for (auto &[key, arr]: attrs) {
             auto const &k = key;
             std::visit([&] (auto &arr) {
@@ -381,7 +705,7 @@ struct AttrVector {
     template <class T>
     auto &add_attr(std::string const &name) {
         if (!attr_is<T>(name))
-            attrs[name] = std::vector<T>(size());
+            attrs.insert_or_assign(name, std::vector<T>(size()));
         return attr<T>(name);
     }
 
@@ -389,7 +713,7 @@ struct AttrVector {
     template <class T>
     auto &add_attr(std::string const &name, T const &val) {
         if (!attr_is<T>(name))
-            attrs[name] = std::vector<T>(size(), val);
+            attrs.insert_or_assign(name, std::vector<T>(size(), val));
         return attr<T>(name);
     }
 
@@ -406,7 +730,7 @@ struct AttrVector {
             if constexpr (!std::is_same_v<T, ValT>) {
                 throw makeError<TypeError>(typeid(T), typeid(ValT), "type of primitive attribute pos");
             } else {
-                return values;
+                return values.get();
             }
         }
         auto const &arr = attr(name);
@@ -421,7 +745,7 @@ struct AttrVector {
             if constexpr (!std::is_same_v<T, ValT>) {
                 throw makeError<TypeError>(typeid(T), typeid(ValT), "type of primitive attribute pos");
             } else {
-                return values;
+                return values.mut();
             }
         }
         auto &arr = attr(name);
@@ -14,6 +14,8 @@
 namespace zeno {
 
 struct MaterialObject;
+struct PrimTopology;
+struct ConstraintColoring;
 struct InstancingObject;
 /*
     Assuming points {p_i}, 0<=i<n, forms a counterclockwise polygon,
@@ -143,11 +145,38 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     std::shared_ptr<MaterialObject> mtl;
     std::shared_ptr<InstancingObject> inst;
 
+    // adjacency cache, use primTopology() from zeno/funcs/PrimTopology.h
+    mutable std::shared_ptr<PrimTopology const> topologyCache;
+    // constraint colorings of the PBD solvers by constraint kind, never modified
+    // in place, use cachedColoring() from projects/PBD/Utils/constraintColoring.h
+    mutable std::shared_ptr<std::map<std::string, std::shared_ptr<ConstraintColoring const>> const> coloringCache;
+
+    // shares every element and attribute array with this primitive, either
+    // side copies an array on its first mutable access, see CowSlot
+    virtual std::shared_ptr<IObject> shared_clone() const override {
+        auto ret = std::make_shared<PrimitiveObject>();
+        static_cast<IObject &>(*ret) = static_cast<IObject const &>(*this);
+        ret->verts = verts.share();
+        ret->points = points.share();
+        ret->lines = lines.share();
+        ret->tris = tris.share();
+        ret->quads = quads.share();
+        ret->loops = loops.share();
+        ret->polys = polys.share();
+        ret->edges = edges.share();
+        ret->uvs = uvs.share();
+        ret->mtl = mtl;
+        ret->inst = inst;
+        ret->topologyCache = std::atomic_load(&topologyCache);
+        ret->coloringCache = std::atomic_load(&coloringCache);
+        return ret;
+    }
+
     // deprecated:
     template <class Accept = std::variant<vec3f, float>, class F>
     void foreach_attr(F &&f) {
         std::string pos_name = "pos";
-        f(pos_name, verts.values);
+        f(pos_name, verts.values.mut());
         verts.foreach_attr<Accept>(std::move(f));
     }
 
@@ -155,7 +184,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class Accept = std::variant<vec3f, float>, class F>
     void foreach_attr(F &&f) const {
         std::string const pos_name = "pos";
-        f(pos_name, verts.values);
+        f(pos_name, verts.values.get());
         verts.foreach_attr<Accept>(std::move(f));
     }
 
@@ -175,7 +204,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class T>
     auto &add_attr(std::string const &name) {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.mut();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -187,7 +216,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class T>
     auto &add_attr(std::string const &name, T const &value) {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.mut();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -205,7 +234,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class T>
     auto const &attr(std::string const &name) const {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.get();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -217,7 +246,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class T>
     auto &attr(std::string const &name) {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.mut();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -241,7 +270,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class Accept = std::variant<vec3f, float>, class F>
     auto attr_visit(std::string const &name, F const &f) const {
         if (name == "pos") {
-            return f(verts.values);
+            return f(verts.values.get());
         } else {
             return verts.attr_visit<Accept>(name, f);
         }
@@ -251,7 +280,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class Accept = std::variant<vec3f, float>, class F>
     auto attr_visit(std::string const &name, F const &f) {
         if (name == "pos") {
-            return f(verts.values);
+            return f(verts.values.mut());
         } else {
             return verts.attr_visit<Accept>(name, f);
         }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <filesystem>
+#include <cstddef>
+
+namespace zeno {
+
+// read-only memory mapping of a whole file, falls back to reading it into memory
+// on platforms (or files) that can't be mapped
+struct MappedFile {
+    MappedFile() = default;
+    ZENO_API ~MappedFile();
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    ZENO_API bool open(std::filesystem::path const &path);
+    ZENO_API void close();
+
+    char const *data() const {
+        return m_data;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+private:
+    char const *m_data = nullptr;
+    std::size_t m_size = 0;
+    void *m_handle = nullptr;
+    bool m_mapped = false;
+};
+
+}
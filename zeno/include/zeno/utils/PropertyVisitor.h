@@ -2,6 +2,7 @@
 #define ZENO_PROPERTYVISITOR_H
 
 #include "Timer.h"
+#include <zeno/extra/Profiler.h>
 #include <functional>
 #include <map>
 #include <optional>
@@ -355,6 +356,7 @@ namespace zeno {
 #ifdef ZENO_BENCHMARKING
                     Timer _(myname);
 #endif
+                    Profiler::Scope _prof(this);
                     apply();
                 }
 
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <functional>
+#include <cstddef>
+#include <memory>
+
+namespace zeno {
+
+// work-stealing pool: each worker owns a deque (LIFO for itself, FIFO for thieves),
+// tasks submitted from outside go to a shared injection queue.
+// tasks must not throw, catch and forward exceptions yourself.
+struct ThreadPool {
+    using Task = std::function<void()>;
+
+    ZENO_API explicit ThreadPool(std::size_t nthreads = 0);
+    ZENO_API ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    ZENO_API std::size_t size() const;
+    ZENO_API void submit(Task task);
+    ZENO_API bool runOne();
+    ZENO_API bool isWorkerThread() const;
+
+    // upper bound on the threads taking part in one forEachIndex call, the
+    // calling thread included; 0 (default) means size() + 1
+    ZENO_API void setConcurrency(std::size_t n);
+    ZENO_API std::size_t concurrency() const;
+
+    // call body(arg, i) for every i in [0, count) on up to concurrency() threads,
+    // the calling thread being one of them; returns once all calls are done.
+    // the first exception thrown by body is rethrown here, the indices not yet
+    // started when it was thrown are skipped.
+    ZENO_API void forEachIndex(std::size_t count, void (*body)(void *, std::size_t), void *arg);
+
+    // block until pred() holds, executing pending tasks meanwhile so that
+    // waiting from inside a task never deadlocks the pool
+    template <class Pred>
+    void waitUntil(Pred &&pred) {
+        while (!pred()) {
+            if (!runOne())
+                idle();
+        }
+    }
+
+    // sized from $ZENO_NUM_THREADS (total threads, caller included) if set,
+    // otherwise from the hardware concurrency
+    ZENO_API static ThreadPool &global();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+
+    ZENO_API void idle();
+};
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace zeno {
+
+// minimal greedy compressor producing the LZ4 block format (64KB window, 4-byte min match),
+// fast on both ends and good enough on byte-shuffled attribute data
+
+inline std::size_t lz_compress_bound(std::size_t n) {
+    return n + n / 255 + 16;
+}
+
+namespace _lzblock_details {
+
+inline uint32_t read32(unsigned char const *p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline unsigned char *writeLength(unsigned char *op, std::size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+inline unsigned char *writeSequence(unsigned char *op, unsigned char const *lit, std::size_t litlen,
+                                    std::size_t offset, std::size_t mlen) {
+    unsigned char *token = op++;
+    *token = (unsigned char)((litlen >= 15 ? 15 : litlen) << 4);
+    if (litlen >= 15)
+        op = writeLength(op, litlen - 15);
+    std::memcpy(op, lit, litlen);
+    op += litlen;
+    if (!mlen)
+        return op;  // last literals
+    *op++ = (unsigned char)(offset & 0xff);
+    *op++ = (unsigned char)(offset >> 8);
+    mlen -= 4;
+    *token |= (unsigned char)(mlen >= 15 ? 15 : mlen);
+    if (mlen >= 15)
+        op = writeLength(op, mlen - 15);
+    return op;
+}
+
+}
+
+// dst must hold lz_compress_bound(n) bytes, returns the compressed size
+inline std::size_t lz_compress(char const *src_, std::size_t n, char *dst_) {
+    using namespace _lzblock_details;
+    constexpr int kHashLog = 16;
+    constexpr std::size_t kMinLength = 13;     // shorter inputs are stored as literals
+    constexpr std::size_t kLastLiterals = 5;
+    constexpr std::size_t kMatchFindLimit = 12;
+
+    auto src = (unsigned char const *)src_;
+    auto op = (unsigned char *)dst_;
+    auto ip = src, anchor = src;
+    auto iend = src + n;
+    if (n >= kMinLength) {
+        std::vector<uint32_t> table(1 << kHashLog, 0);  // positions + 1, 0 is empty
+        auto mflimit = iend - kMatchFindLimit;
+        auto matchlimit = iend - kLastLiterals;
+        std::size_t misses = 0;
+        while (ip < mflimit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = (seq * 2654435761u) >> (32 - kHashLog);
+            uint32_t ref = table[h];
+            table[h] = (uint32_t)(ip - src) + 1;
+            if (ref && (std::size_t)(ip - src) + 1 - ref <= 65535 && read32(src + ref - 1) == seq) {
+                auto match = src + ref - 1;
+                std::size_t mlen = 4;
+                while (ip + mlen < matchlimit && match[mlen] == ip[mlen])
+                    mlen++;
+                op = writeSequence(op, anchor, ip - anchor, ip - match, mlen);
+                ip += mlen;
+                anchor = ip;
+                misses = 0;
+            } else {
+                // skip faster through incompressible data
+                ip += 1 + (misses++ >> 6);
+            }
+        }
+    }
+    op = writeSequence(op, anchor, iend - anchor, 0, 0);
+    return op - (unsigned char *)dst_;
+}
+
+// returns false on malformed input or if the output isn't exactly n bytes long
+inline bool lz_decompress(char const *src_, std::size_t srclen, char *dst_, std::size_t n) {
+    auto ip = (unsigned char const *)src_;
+    auto iend = ip + srclen;
+    auto op = (unsigned char *)dst_;
+    auto oend = op + n;
+    auto readLength = [&] (std::size_t &len) {
+        unsigned char c;
+        do {
+            if (ip >= iend)
+                return false;
+            c = *ip++;
+            len += c;
+        } while (c == 255);
+        return true;
+    };
+    while (ip < iend) {
+        unsigned char token = *ip++;
+        std::size_t litlen = token >> 4;
+        if (litlen == 15 && !readLength(litlen))
+            return false;
+        if (litlen > (std::size_t)(iend - ip) || litlen > (std::size_t)(oend - op))
+            return false;
+        std::memcpy(op, ip, litlen);
+        ip += litlen;
+        op += litlen;
+        if (ip >= iend)
+            break;  // last literals
+        if (iend - ip < 2)
+            return false;
+        std::size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (!offset || offset > (std::size_t)(op - (unsigned char *)dst_))
+            return false;
+        std::size_t mlen = token & 15;
+        if (mlen == 15 && !readLength(mlen))
+            return false;
+        mlen += 4;
+        if (mlen > (std::size_t)(oend - op))
+            return false;
+        auto match = op - offset;
+        if (offset >= mlen) {
+            std::memcpy(op, match, mlen);
+            op += mlen;
+        } else {
+            while (mlen--)  // overlapping copy repeats the pattern
+                *op++ = *match++;
+        }
+    }
+    return op == oend;
+}
+
+}
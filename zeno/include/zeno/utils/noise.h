@@ -0,0 +1,81 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/utils/vec.h>
+#include <cstddef>
+
+namespace zeno {
+
+// n points whose components are x[i * stride], y[i * stride], z[i * stride];
+// rot rotates a vec3f array to (y, z, x) or (z, x, y), as used for vector noise
+struct NoisePoints {
+    float const *x;
+    float const *y;
+    float const *z;
+    std::size_t stride = 1;
+
+    NoisePoints(float const *x_, float const *y_, float const *z_, std::size_t stride_ = 1)
+        : x(x_), y(y_), z(z_), stride(stride_) {}
+
+    NoisePoints(vec3f const *p, int rot = 0)
+        : x(p->data() + rot % 3), y(p->data() + (rot + 1) % 3), z(p->data() + (rot + 2) % 3), stride(3) {}
+};
+
+// n results out[i * stride], and optionally the analytic gradient grad[i]
+struct NoiseResults {
+    float *out;
+    std::size_t stride = 1;
+    vec3f *grad = nullptr;
+
+    NoiseResults(float *out_, std::size_t stride_ = 1, vec3f *grad_ = nullptr)
+        : out(out_), stride(stride_), grad(grad_) {}
+};
+
+// a fractal sum of noisePerlin, octave i at frequency * lacunarity^i
+// weighted by gain^i
+struct NoiseOctaves {
+    int octaves = 1;
+    float frequency = 1;
+    float lacunarity = 2;
+    float gain = 0.5f;
+};
+
+struct NoiseWorley {
+    vec3f offset{0, 0, 0};  // phase of the feature points
+    float jitter = 1;
+    int distance = 0;       // 0: squared euclidean, 1: chebyshev, 2: manhattan
+    bool f2MinusF1 = false; // else F1
+};
+
+// the scalar and batch versions give identical results; the batches evaluate
+// points in SIMD lanes (picking AVX-512 or AVX2 code at load time where the
+// compiler supports it) and split large n over ThreadPool::global()
+
+// Ken Perlin's improved noise, periodic over 256, in about [-1, 1]
+ZENO_API float noisePerlin(vec3f p, vec3f *grad = nullptr);
+ZENO_API void noisePerlin(std::size_t n, NoisePoints p, NoiseResults r);
+
+// 3D simplex noise in about [-1, 1], 0 at integer coordinates
+ZENO_API float noiseSimplex(vec3f p, vec3f *grad = nullptr);
+ZENO_API void noiseSimplex(std::size_t n, NoisePoints p, NoiseResults r);
+
+// cellular noise, F1 or F2 - F1 distance to the nearest feature points
+ZENO_API float noiseWorley(vec3f p, NoiseWorley const &w);
+ZENO_API void noiseWorley(std::size_t n, NoisePoints p, NoiseResults r, NoiseWorley const &w);
+
+// fBm: sum of gain^i * perlin(p * frequency * lacunarity^i)
+ZENO_API float noiseFbm(vec3f p, NoiseOctaves const &o, vec3f *grad = nullptr);
+ZENO_API void noiseFbm(std::size_t n, NoisePoints p, NoiseResults r, NoiseOctaves const &o);
+
+// Musgrave's hybrid multifractal over the same octaves, each octave is
+// weighted by the (clamped) running product of the previous ones
+ZENO_API float noiseHybrid(vec3f p, NoiseOctaves const &o, float offset);
+ZENO_API void noiseHybrid(std::size_t n, NoisePoints p, NoiseResults r, NoiseOctaves const &o, float offset);
+
+// sin-hashed gradient noise summed over ceil(detail) octaves, each one
+// roughness times weaker, the last fading in with the fraction of detail
+// (PrimPerlinNoise, VDBPerlinNoise)
+ZENO_API float noiseHashPerlin(vec3f p, float roughness, float detail);
+ZENO_API void noiseHashPerlin(std::size_t n, NoisePoints p, NoiseResults r, float roughness, float detail);
+
+}
@@ -12,9 +12,14 @@
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/SubnetNode.h>
 #include <zeno/extra/DirtyChecker.h>
+#include <zeno/extra/GraphScheduler.h>
+#include <zeno/extra/OutputReleaser.h>
+#include <zeno/utils/ThreadPool.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/utils/Error.h>
 #include <zeno/utils/log.h>
 #include <iostream>
+#include <optional>
 
 namespace zeno {
 
@@ -23,9 +28,14 @@ ZENO_API Context::~Context() = default;
 
 ZENO_API Context::Context(Context const &other)
     : visited(other.visited)
+    , depth(other.depth)
+{}
+
+ZENO_API Graph::Graph()
+    : parallelApply(envconfig::getBool("PARALLEL_APPLY"))
+    , releaseOutputs(envconfig::getBool("RELEASE_OUTPUTS"))
 {}
 
-ZENO_API Graph::Graph() = default;
 ZENO_API Graph::~Graph() = default;
 
 ZENO_API zany const &Graph::getNodeOutput(
@@ -80,8 +90,13 @@ ZENO_API void Graph::completeNode(std::string const &id) {
 }
 
 ZENO_API bool Graph::applyNode(std::string const &id) {
+    if (scheduler) {
+        return scheduler->applyNode(id);
+    }
     if (ctx->visited.find(id) != ctx->visited.end()) {
-        return false;
+        // every consumer of a dirty node is dirty, not only the first one to pull it,
+        // this matters for the nodes GraphScheduler already ran before the serial walk
+        return dirtyChecker && dirtyChecker->amIDirty(id);
     }
     ctx->visited.insert(id);
     auto node = safe_at(nodes, id, "node name").get();
@@ -101,6 +116,21 @@ ZENO_API void Graph::applyNodes(std::set<std::string> const &ids) {
         ctx = nullptr;
     }};
 
+    std::optional<OutputReleaser> releaser;
+    if (releaseOutputs && !this->releaser) {
+        releaser.emplace(this, ids);
+        this->releaser = &*releaser;
+    }
+    scope_exit __{[&] {
+        if (releaser)
+            this->releaser = nullptr;
+    }};
+
+    // nested graphs (subnets called from a worker) are left serial
+    if (parallelApply && !ThreadPool::global().isWorkerThread()) {
+        GraphScheduler(this).applyNodes(ids);
+    }
+
     for (auto const &id: ids) {
         applyNode(id);
     }
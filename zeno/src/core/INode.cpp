@@ -7,7 +7,10 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/DirtyChecker.h>
+#include <zeno/extra/NodeMemo.h>
+#include <zeno/extra/OutputReleaser.h>
 #include <zeno/extra/TempNode.h>
+#include <zeno/extra/Profiler.h>
 #include <zeno/utils/Error.h>
 #ifdef ZENO_BENCHMARKING
 #include <zeno/utils/Timer.h>
@@ -34,6 +37,7 @@ ZENO_API Session *INode::getThisSession() const {
 }
 
 ZENO_API GlobalState *INode::getGlobalState() const {
+    NodeMemo::markStateRead();
     return graph->session->globalState.get();
 }
 
@@ -101,7 +105,7 @@ ZENO_API void zeno::INode::writeTmpCaches()
                 log_warn("{} cache to disk failed", myname);
                 return;
             }
-            objs.try_emplace(name, std::move(value->clone()));
+            objs.try_emplace(name, value->shared_clone());
         }
 
     }
@@ -137,13 +141,48 @@ ZENO_API void INode::preApply() {
 #ifdef ZENO_BENCHMARKING
         Timer _(myname);
 #endif
-        apply();
+        Profiler::Scope _prof(this);
+        zeno::getSession().nodeMemo->apply(this, [this] {
+            apply();
+        });
         if (bTmpCache)
             writeTmpCaches();
     }
+    if (graph->releaser)
+        graph->releaser->release(this);
     log_debug("==> leave {}", myname);
 }
 
+ZENO_API bool INode::isSchedulable() const {
+    return true;
+}
+
+ZENO_API bool INode::isMemoizable() const {
+    if (!isSchedulable())
+        return false;
+    if (nodeClass) {
+        // file writers exist for their side effect, a memo hit would skip the write
+        for (auto const &sock: nodeClass->desc->inputs) {
+            if (sock.type == "writepath")
+                return false;
+        }
+        for (auto const &param: nodeClass->desc->params) {
+            if (param.type == "writepath")
+                return false;
+        }
+    }
+    // seed -1 conventionally means a new std::random_device seed on every run
+    for (auto const &[name, obj]: inputs) {
+        if (name.find("seed") == std::string::npos)
+            continue;
+        if (auto num = dynamic_cast<NumericObject const *>(obj.get())) {
+            if (auto seed = std::get_if<int>(&num->value); seed && *seed == -1)
+                return false;
+        }
+    }
+    return true;
+}
+
 ZENO_API bool INode::requireInput(std::string const &ds) {
     auto it = inputBounds.find(ds);
     if (it == inputBounds.end())
@@ -153,8 +192,12 @@ ZENO_API bool INode::requireInput(std::string const &ds) {
         auto &dc = graph->getDirtyChecker();
         dc.taintThisNode(myname);
     }
-    auto ref = graph->getNodeOutput(sn, ss);
-    inputs[ds] = ref;
+    if (graph->releaser) {
+        inputs[ds] = graph->releaser->acquire(this, ds, sn, ss);
+    } else {
+        auto ref = graph->getNodeOutput(sn, ss);
+        inputs[ds] = ref;
+    }
     return true;
 }
 
@@ -201,6 +244,18 @@ ZENO_API zany INode::get_input(std::string const &id) const {
     return safe_at(inputs, id, "input socket of node `" + myname + "`");
 }
 
+ZENO_API zany INode::take_input(std::string const &id) {
+    if (has_keyframe(id) || has_formula(id))
+        return get_input(id);  // evaluated into a fresh object anyway
+    auto it = inputs.find(id);
+    if (it == inputs.end() || !it->second)
+        return get_input(id);
+    auto obj = std::move(it->second);
+    bool unique = obj.use_count() == 1;
+    it->second = obj;
+    return unique ? obj : obj->clone();
+}
+
 ZENO_API zany INode::resolveInput(std::string const& id) {
     if (inputBounds.find(id) != inputBounds.end()) {
         if (requireInput(id))
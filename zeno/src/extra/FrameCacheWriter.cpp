@@ -0,0 +1,97 @@
+#include <zeno/extra/FrameCacheWriter.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+#include <chrono>
+
+namespace zeno {
+
+ZENO_API FrameCacheWriter::FrameCacheWriter(std::size_t maxDepth)
+    : m_maxDepth(std::max<std::size_t>(maxDepth, 1)) {
+    m_thread = std::thread([this] {
+        worker();
+    });
+}
+
+ZENO_API FrameCacheWriter::~FrameCacheWriter() {
+    {
+        std::lock_guard lck(m_mtx);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+ZENO_API void FrameCacheWriter::push(int frameid, std::function<std::size_t()> job) {
+    std::unique_lock lck(m_mtx);
+    if (m_pending.size() >= m_maxDepth) {
+        auto t0 = std::chrono::steady_clock::now();
+        m_cv.wait(lck, [&] {
+            return m_pending.size() < m_maxDepth;
+        });
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        m_stats.stallSeconds += dt.count();
+        log_debug("frame cache writer stalled {:.3f}s before frame {}", dt.count(), frameid);
+    }
+    m_queue.push_back({frameid, std::move(job)});
+    m_pending.insert(frameid);
+    m_stats.framesQueued++;
+    m_stats.maxDepthSeen = std::max(m_stats.maxDepthSeen, m_pending.size());
+    lck.unlock();
+    m_cv.notify_all();
+}
+
+ZENO_API bool FrameCacheWriter::isPending(int frameid) const {
+    std::lock_guard lck(m_mtx);
+    return m_pending.count(frameid) != 0;
+}
+
+ZENO_API void FrameCacheWriter::wait(int frameid) {
+    std::unique_lock lck(m_mtx);
+    m_cv.wait(lck, [&] {
+        return m_pending.count(frameid) == 0;
+    });
+}
+
+ZENO_API void FrameCacheWriter::flush() {
+    std::unique_lock lck(m_mtx);
+    m_cv.wait(lck, [&] {
+        return m_pending.empty();
+    });
+}
+
+ZENO_API FrameCacheWriter::Stats FrameCacheWriter::stats() const {
+    std::lock_guard lck(m_mtx);
+    return m_stats;
+}
+
+void FrameCacheWriter::worker() {
+    std::unique_lock lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [&] {
+            return m_stop || !m_queue.empty();
+        });
+        if (m_queue.empty())
+            break;  // stopped, and everything was written
+        auto job = std::move(m_queue.front());
+        m_queue.pop_front();
+        lck.unlock();
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::size_t bytes = 0;
+        try {
+            bytes = job.func();
+        } catch (std::exception const &e) {
+            log_error("failed to dump frame {} cache: {}", job.frameid, e.what());
+        }
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+        lck.lock();
+        m_pending.erase(m_pending.find(job.frameid));
+        m_stats.framesWritten++;
+        m_stats.bytesWritten += bytes;
+        m_stats.writeSeconds += dt.count();
+        m_cv.notify_all();
+    }
+}
+
+}
@@ -1,5 +1,11 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalState.h>
+#include <zeno/extra/ZenCacheReader.h>
+#include <zeno/extra/FrameCacheWriter.h>
+#include <zeno/extra/Profiler.h>
+#include <zeno/extra/GraphException.h>
+#include <zeno/utils/scope_exit.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/utils/log.h>
 #include <filesystem>
@@ -13,25 +19,60 @@
 #ifdef __linux__
     #include<unistd.h>
     #include <sys/statfs.h>
+#elif defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
 #endif
 #define MIN_DISKSPACE_MB 1024
 
 namespace zeno {
 
-std::vector<std::filesystem::path> cachepath(3);
 std::unordered_set<std::string> lightCameraNodes({
     "CameraEval", "CameraNode", "CihouMayaCameraFov", "ExtractCameraData", "GetAlembicCamera","MakeCamera",
     "LightNode", "BindLight", "ProceduralSky", "HDRSky", "SkyComposer"
     });
 std::set<std::string> matNodeNames = {"ShaderFinalize", "ShaderVolume", "ShaderVolumeHomogeneous"};
 
-void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName) {
-    if (cachedir.empty()) return;
+static bool writeDurably(std::filesystem::path const &path, std::string const &keys, std::vector<size_t> const &poses, std::vector<char> const &buf) {
+    // write aside and rename, so readers either see the old file or the complete new one
+    auto tmppath = path;
+    tmppath += ".tmp";
+    FILE *fp = fopen(tmppath.string().c_str(), "wb");
+    if (!fp) {
+        log_error("can not write zeno cache file {}", tmppath);
+        return false;
+    }
+    bool ok = fwrite(keys.data(), 1, keys.size(), fp) == keys.size()
+        && fwrite(poses.data(), sizeof(size_t), poses.size(), fp) == poses.size()
+        && fwrite(buf.data(), 1, buf.size(), fp) == buf.size()
+        && fflush(fp) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(fp)) == 0;
+#else
+    ok = ok && fsync(fileno(fp)) == 0;
+#endif
+    fclose(fp);
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmppath, path, ec);
+    if (!ok || ec) {
+        log_error("failed to write zeno cache file {}", path);
+        std::filesystem::remove(tmppath, ec);
+        return false;
+    }
+    return true;
+}
+
+size_t GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName) {
+    if (cachedir.empty()) return 0;
+    Profiler::Scope _prof(Profiler::Category::Cache, "cache write");
     std::filesystem::path dir = std::filesystem::u8path(cachedir + "/" + std::to_string(1000000 + frameid).substr(1));
     if (!std::filesystem::exists(dir) && !std::filesystem::create_directories(dir))
     {
         log_critical("can not create path: {}", dir);
     }
+    std::vector<std::filesystem::path> cachepath(3);
     std::vector<std::vector<char>> bufCaches(3);
     std::vector<std::vector<size_t>> poses(3);
     std::vector<std::string> keys(3);
@@ -137,20 +178,19 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
         if (poses[i].size() == 0 && (cacheLightCameraOnly && i != 0 || cacheMaterialOnly && i != 1 || fileName != "" && i != 2))
             continue;
         log_debug("dump cache to disk {}", cachepath[i]);
-        std::ofstream ofs(cachepath[i], std::ios::binary);
-        std::ostreambuf_iterator<char> oit(ofs);
-        std::copy(keys[i].begin(), keys[i].end(), oit);
-        std::copy_n((const char *)poses[i].data(), poses[i].size() * sizeof(size_t), oit);
-        std::copy(bufCaches[i].begin(), bufCaches[i].end(), oit);
+        if (!writeDurably(cachepath[i], keys[i], poses[i], bufCaches[i]))
+            throw makeError("failed to write zeno cache file " + cachepath[i].string());
     }
     objs.clear();
+    return currentFrameSize;
 }
 
-bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, std::string fileName) {
+bool GlobalComm::openCaches(std::string cachedir, int frameid, std::vector<std::shared_ptr<ZenCacheReader>> &caches, std::string fileName) {
+    caches.clear();
     if (cachedir.empty())
         return false;
-    objs.clear();
     auto dir = std::filesystem::u8path(cachedir) / std::to_string(1000000 + frameid).substr(1);
+    std::vector<std::filesystem::path> cachepath(3);
     if (fileName == "")
     {
         cachepath[0] = dir / "lightCameraObj.zencache";
@@ -164,59 +204,43 @@ bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObj
 
     for (auto path : cachepath)
     {
-        if (!std::filesystem::exists(path))
+        if (path.empty() || !std::filesystem::exists(path))
         {
             continue;
         }
         log_debug("load cache from disk {}", path);
 
-        auto szBuffer = std::filesystem::file_size(path);
-        std::vector<char> dat(szBuffer);
-        FILE *fp = fopen(path.string().c_str(), "rb");
-        if (!fp) {
-            log_error("zeno cache file does not exist");
+        auto cache = std::make_shared<ZenCacheReader>();
+        if (!cache->open(path)) {
+            caches.clear();
             return false;
         }
-        size_t ret = fread(&dat[0], 1, szBuffer, fp);
-        assert(ret == szBuffer);
-        fclose(fp);
-        fp = nullptr;
+        caches.push_back(std::move(cache));
+    }
+    return true;
+}
 
-        if (dat.size() <= 8 || std::string(dat.data(), 8) != "ZENCACHE") {
-            log_error("zeno cache file broken (1)");
-            return false;
-        }
-        size_t pos = std::find(dat.begin() + 8, dat.end(), '\a') - dat.begin();
-        if (pos == dat.size()) {
-            log_error("zeno cache file broken (2)");
-            return false;
-        }
-        size_t keyscount = std::stoi(std::string(dat.data() + 8, pos - 8));
-        pos = pos + 1;
-        std::vector<std::string> keys;
-        for (int k = 0; k < keyscount; k++) {
-            size_t newpos = std::find(dat.begin() + pos, dat.end(), '\a') - dat.begin();
-            if (newpos == dat.size()) {
-                log_error("zeno cache file broken (3.{})", k);
-                return false;
-            }
-            keys.emplace_back(dat.data() + pos, newpos - pos);
-            pos = newpos + 1;
-        }
-        std::vector<size_t> poses(keyscount + 1);
-        std::copy_n(dat.data() + pos, (keyscount + 1) * sizeof(size_t), (char *)poses.data());
-        pos += (keyscount + 1) * sizeof(size_t);
-        for (int k = 0; k < keyscount; k++) {
-            if (poses[k] > dat.size() - pos || poses[k + 1] < poses[k]) {
-                log_error("zeno cache file broken (4.{})", k);
-            }
-            const char *p = dat.data() + pos + poses[k];
-            objs.try_emplace(keys[k], decodeObject(p, poses[k + 1] - poses[k]));
+bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, std::string fileName) {
+    Profiler::Scope _prof(Profiler::Category::Cache, "cache read");
+    objs.clear();
+    std::vector<std::shared_ptr<ZenCacheReader>> caches;
+    if (!openCaches(cachedir, frameid, caches, fileName))
+        return false;
+    for (auto const &cache: caches) {
+        for (std::size_t k = 0; k < cache->size(); k++) {
+            objs.try_emplace(cache->key(k), cache->get(k));
         }
     }
     return true;
 }
 
+ZENO_API GlobalComm::GlobalComm() {
+    if (size_t depth = envconfig::getInt("CACHE_WRITE_DEPTH", 2); depth > 0)
+        m_writer = std::make_unique<FrameCacheWriter>(depth);
+}
+
+ZENO_API GlobalComm::~GlobalComm() = default;
+
 ZENO_API void GlobalComm::newFrame() {
     std::lock_guard lck(m_mtx);
     log_debug("GlobalComm::newFrame {}", m_frames.size());
@@ -226,18 +250,91 @@ ZENO_API void GlobalComm::newFrame() {
 ZENO_API void GlobalComm::finishFrame() {
     std::lock_guard lck(m_mtx);
     log_debug("GlobalComm::finishFrame {}", m_maxPlayFrame);
-    if (m_maxPlayFrame >= 0 && m_maxPlayFrame < m_frames.size())
-        m_frames[m_maxPlayFrame].frame_state = FRAME_COMPLETED;
+    if (m_maxPlayFrame >= 0 && m_maxPlayFrame < m_frames.size()) {
+        auto &frame = m_frames[m_maxPlayFrame];
+        if (frame.dumping)
+            frame.finishPending = true;
+        else if (frame.frame_state != FRAME_BROKEN)
+            frame.frame_state = FRAME_COMPLETED;
+    }
     m_maxPlayFrame += 1;
 }
 
-ZENO_API void GlobalComm::dumpFrameCache(int frameid, bool cacheLightCameraOnly, bool cacheMaterialOnly) {
-    std::lock_guard lck(m_mtx);
+ZENO_API void GlobalComm::dumpFrameCache(int frameid, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::function<void()> onDumped) {
+    std::unique_lock lck(m_mtx);
     int frameIdx = frameid - beginFrameNumber;
-    if (frameIdx >= 0 && frameIdx < m_frames.size()) {
-        log_debug("dumping frame {}", frameid);
-        toDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects, cacheLightCameraOnly, cacheMaterialOnly);
+    if (frameIdx < 0 || frameIdx >= m_frames.size()) {
+        lck.unlock();
+        if (onDumped)
+            onDumped();
+        return;
     }
+    log_debug("dumping frame {}", frameid);
+
+    // the writer takes over the objects, they are cleared after dumping anyway
+    auto objs = std::make_shared<ViewObjects>(std::move(m_frames[frameIdx].view_objects));
+    m_frames[frameIdx].view_objects.clear();
+    m_frames[frameIdx].dumping = true;
+    auto frames = &m_frames;
+    std::string cachedir = cacheFramePath;
+    lck.unlock();
+
+    auto job = [=] {
+        std::size_t bytes = 0;
+        std::exception_ptr error;
+        // whoever waits for this frame (the editor, via onDumped) must hear back even if writing failed
+        scope_exit done{[&] {
+            {
+                std::lock_guard lck(m_mtx);
+                if (frameIdx < frames->size() && (*frames)[frameIdx].dumping) {
+                    auto &frame = (*frames)[frameIdx];
+                    frame.dumping = false;
+                    if (error) {
+                        frame.finishPending = false;
+                        frame.frame_state = FRAME_BROKEN;
+                    } else if (frame.finishPending) {
+                        frame.finishPending = false;
+                        frame.frame_state = FRAME_COMPLETED;
+                    }
+                }
+                if (error && !m_dumpError)
+                    m_dumpError = error;
+            }
+            if (onDumped)
+                onDumped();
+        }};
+        try {
+            bytes = toDisk(cachedir, frameid, *objs, cacheLightCameraOnly, cacheMaterialOnly);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        return bytes;
+    };
+    if (m_writer)
+        m_writer->push(frameid, std::move(job));
+    else
+        job();
+}
+
+ZENO_API bool GlobalComm::takeDumpError(GlobalStatus &status) {
+    std::exception_ptr error;
+    {
+        std::lock_guard lck(m_mtx);
+        error = std::exchange(m_dumpError, nullptr);
+    }
+    if (!error)
+        return false;
+    status = GraphException{"dumpFrameCache", error}.evalStatus();
+    return true;
+}
+
+ZENO_API void GlobalComm::flushFrameCache() {
+    if (!m_writer)
+        return;
+    m_writer->flush();
+    auto stat = m_writer->stats();
+    log_debug("frame cache writer: {} frames, {} MB, {:.2f}s writing, {:.2f}s stalled, max depth {}",
+              stat.framesWritten, stat.bytesWritten >> 20, stat.writeSeconds, stat.stallSeconds, stat.maxDepthSeen);
 }
 
 ZENO_API void GlobalComm::addViewObject(std::string const &key, std::shared_ptr<IObject> object) {
@@ -248,7 +345,9 @@ ZENO_API void GlobalComm::addViewObject(std::string const &key, std::shared_ptr<
 }
 
 ZENO_API void GlobalComm::clearState() {
+    flushFrameCache();
     std::lock_guard lck(m_mtx);
+    m_dumpError = nullptr;
     m_frames.clear();
     m_inCacheFrames.clear();
     m_maxPlayFrame = 0;
@@ -258,6 +357,7 @@ ZENO_API void GlobalComm::clearState() {
 
 ZENO_API void GlobalComm::clearFrameState()
 {
+    flushFrameCache();
     std::lock_guard lck(m_mtx);
     m_frames.clear();
     m_inCacheFrames.clear();
@@ -302,16 +402,18 @@ ZENO_API GlobalComm::ViewObjects const *GlobalComm::getViewObjects(const int fra
     return _getViewObjects(frameid);
 }
 
-GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(const int frameid) {
+bool GlobalComm::_loadFrameCaches(const int frameid) {
     int frameIdx = frameid - beginFrameNumber;
     if (frameIdx < 0 || frameIdx >= m_frames.size())
-        return nullptr;
+        return false;
     if (maxCachedFrames != 0) {
         // load back one gc:
         if (!m_inCacheFrames.count(frameid)) {  // notinmem then cacheit
-            bool ret = fromDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects);
+            // only the key tables are read here, objects are decoded on demand
+            m_frames[frameIdx].view_objects.clear();
+            bool ret = openCaches(cacheFramePath, frameid, m_frames[frameIdx].caches);
             if (!ret)
-                return nullptr;
+                return false;
 
             m_inCacheFrames.insert(frameid);
             // and dump one as balance:
@@ -322,6 +424,7 @@ GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(const int frameid) {
                         // so, there is no need to dump.
                         //toDisk(cacheFramePath, i, m_frames[i - beginFrameNumber].view_objects);
                         m_frames[i - beginFrameNumber].view_objects.clear();
+                        m_frames[i - beginFrameNumber].caches.clear();
                         m_inCacheFrames.erase(i);
                         break;
                     }
@@ -329,7 +432,19 @@ GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(const int frameid) {
             }
         }
     }
-    return &m_frames[frameIdx].view_objects;
+    return true;
+}
+
+GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(const int frameid) {
+    if (!_loadFrameCaches(frameid))
+        return nullptr;
+    auto &frame = m_frames[frameid - beginFrameNumber];
+    for (auto const &cache: frame.caches) {
+        for (std::size_t k = 0; k < cache->size(); k++) {
+            frame.view_objects.try_emplace(cache->key(k), cache->get(k));
+        }
+    }
+    return &frame.view_objects;
 }
 
 ZENO_API GlobalComm::ViewObjects const &GlobalComm::getViewObjects() {
@@ -350,7 +465,8 @@ ZENO_API void GlobalComm::clear_objects(const std::function<void()>& callback)
 ZENO_API bool GlobalComm::load_objects(
         const int frameid,
         const std::function<bool(std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs)>& callback,
-        bool& isFrameValid)
+        bool& isFrameValid,
+        const std::function<bool(std::string const &key)>& isNeeded)
 {
     if (!callback)
         return false;
@@ -367,6 +483,24 @@ ZENO_API bool GlobalComm::load_objects(
 
     isFrameValid = true;
     bool inserted = false;
+    if (isNeeded && _loadFrameCaches(frameid) && !m_frames[frame].caches.empty()) {
+        auto &frameData = m_frames[frame];
+        std::map<std::string, std::shared_ptr<zeno::IObject>> objs;
+        for (auto const &cache: frameData.caches) {
+            for (std::size_t k = 0; k < cache->size(); k++) {
+                auto const &key = cache->key(k);
+                if (cache->isDecoded(k) || isNeeded(key)) {
+                    auto obj = cache->get(k);
+                    frameData.view_objects.try_emplace(key, obj);
+                    objs.try_emplace(key, std::move(obj));
+                } else {
+                    objs.try_emplace(key, nullptr);
+                }
+            }
+        }
+        zeno::log_trace("load_objects: {} objects at frame {} (lazy)", objs.size(), frameid);
+        return callback(objs);
+    }
     auto const* viewObjs = _getViewObjects(frameid);
     if (viewObjs) {
         zeno::log_trace("load_objects: {} objects at frame {}", viewObjs->size(), frameid);
@@ -419,6 +553,8 @@ ZENO_API std::string GlobalComm::cachePath()
 
 ZENO_API bool GlobalComm::removeCache(int frame)
 {
+    if (m_writer)
+        m_writer->wait(frame);
     std::lock_guard lck(m_mtx);
     bool hasZencacheOnly = true;
     std::filesystem::path dirToRemove = std::filesystem::u8path(cacheFramePath + "/" + std::to_string(1000000 + frame).substr(1));
@@ -436,6 +572,8 @@ ZENO_API bool GlobalComm::removeCache(int frame)
         if (hasZencacheOnly)
         {
             m_frames[frame - beginFrameNumber].frame_state = FRAME_BROKEN;
+            // unmap before removing, windows refuses to delete mapped files
+            m_frames[frame - beginFrameNumber].caches.clear();
             std::filesystem::remove_all(dirToRemove);
             zeno::log_info("remove dir: {}", dirToRemove);
         }
@@ -450,10 +588,13 @@ ZENO_API bool GlobalComm::removeCache(int frame)
 
 ZENO_API void GlobalComm::removeCachePath()
 {
+    flushFrameCache();
     std::lock_guard lck(m_mtx);
     std::filesystem::path dirToRemove = std::filesystem::u8path(cacheFramePath);
     if (std::filesystem::exists(dirToRemove) && cacheFramePath.find(".") == std::string::npos)
     {
+        for (auto &frame : m_frames)
+            frame.caches.clear();
         std::filesystem::remove_all(dirToRemove);
         zeno::log_info("remove dir: {}", dirToRemove);
     }
@@ -0,0 +1,231 @@
+#include <zeno/extra/GraphScheduler.h>
+#include <zeno/extra/GraphException.h>
+#include <zeno/extra/DirtyChecker.h>
+#include <zeno/core/Graph.h>
+#include <zeno/core/INode.h>
+#include <zeno/utils/ThreadPool.h>
+#include <zeno/utils/scope_exit.h>
+#include <zeno/utils/safe_at.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+
+namespace zeno {
+
+ZENO_API GraphScheduler::GraphScheduler(Graph *graph) : graph(graph) {}
+ZENO_API GraphScheduler::~GraphScheduler() = default;
+
+bool GraphScheduler::collect(std::string const &id) {
+    if (auto it = m_eligible.find(id); it != m_eligible.end())
+        return it->second;
+    m_eligible.emplace(id, false);  // also breaks cycles
+    auto it = graph->nodes.find(id);
+    if (it == graph->nodes.end())
+        return false;  // let the serial walk report the error
+    auto node = it->second.get();
+    if (!node->isSchedulable())
+        return false;  // it pulls its inputs by itself, don't look further
+    bool ok = true;
+    for (auto const &[ds, bound]: node->inputBounds) {
+        // no short-circuit: independent upstream nodes are still worth pre-running
+        if (!collect(bound.first))
+            ok = false;
+    }
+    m_eligible[id] = ok;
+    return ok;
+}
+
+void GraphScheduler::taintDirty(std::vector<std::size_t> const &order) {
+    // the serial walk taints a node when its upstream is dirty, do the same up front
+    // so that preApply sees it before pulling its inputs, the nodes outside of the
+    // schedule get tainted by requireInput from what applyNode returns
+    auto &dc = graph->getDirtyChecker();
+    for (auto i: order) {
+        auto const &task = *m_tasks[i];
+        if (!dc.amIDirty(task.id))
+            continue;
+        for (auto c: task.consumers) {
+            dc.taintThisNode(m_tasks[c]->id);
+        }
+    }
+}
+
+ZENO_API void GraphScheduler::applyNodes(std::set<std::string> const &ids) {
+    for (auto const &id: ids) {
+        collect(id);
+    }
+
+    std::map<std::string, std::size_t> lut;
+    for (auto const &[id, ok]: m_eligible) {
+        if (!ok) continue;
+        lut.emplace(id, m_tasks.size());
+        auto task = std::make_unique<Task>();
+        task->id = id;
+        m_tasks.push_back(std::move(task));
+    }
+    if (m_tasks.empty())
+        return;
+
+    std::vector<std::set<std::size_t>> preds(m_tasks.size());
+    for (std::size_t i = 0; i < m_tasks.size(); i++) {
+        auto node = graph->nodes.at(m_tasks[i]->id).get();
+        for (auto const &[ds, bound]: node->inputBounds) {
+            if (auto it = lut.find(bound.first); it != lut.end())
+                preds[i].insert(it->second);
+        }
+        for (auto d: preds[i]) {
+            m_tasks[d]->consumers.push_back(i);
+        }
+    }
+
+    std::vector<std::size_t> order;
+    {
+        std::vector<std::size_t> indeg(m_tasks.size());
+        for (std::size_t i = 0; i < m_tasks.size(); i++) {
+            indeg[i] = preds[i].size();
+            if (!indeg[i])
+                order.push_back(i);
+        }
+        for (std::size_t k = 0; k < order.size(); k++) {
+            for (auto c: m_tasks[order[k]]->consumers) {
+                if (!--indeg[c])
+                    order.push_back(c);
+            }
+        }
+    }
+
+    // most nodes modify their get_input objects in place and pass them on to their
+    // outputs, so any two nodes that may see the same object must not run at the
+    // same time. an object seen by a node comes from one of its ancestors, and two
+    // nodes with a common ancestor also have a common root: chain the descendants
+    // of each root in topological order (which can't form a cycle), only nodes of
+    // disjoint ancestry still run concurrently
+    {
+        std::vector<std::size_t> rank(m_tasks.size());
+        for (std::size_t k = 0; k < order.size(); k++)
+            rank[order[k]] = k;
+        std::vector<std::size_t> desc;
+        std::vector<char> seen(m_tasks.size());
+        for (auto r: order) {
+            if (!preds[r].empty())
+                break;  // roots come first in order
+            desc.clear();
+            std::fill(seen.begin(), seen.end(), 0);
+            std::vector<std::size_t> stack{r};
+            while (!stack.empty()) {
+                auto i = stack.back();
+                stack.pop_back();
+                for (auto c: m_tasks[i]->consumers) {
+                    if (!seen[c]) {
+                        seen[c] = 1;
+                        desc.push_back(c);
+                        stack.push_back(c);
+                    }
+                }
+            }
+            std::sort(desc.begin(), desc.end(), [&] (auto a, auto b) {
+                return rank[a] < rank[b];
+            });
+            for (std::size_t k = 1; k < desc.size(); k++)
+                preds[desc[k]].insert(desc[k - 1]);
+        }
+    }
+    for (std::size_t i = 0; i < m_tasks.size(); i++) {
+        for (auto d: preds[i]) {
+            m_tasks[d]->successors.push_back(i);
+        }
+        m_tasks[i]->deps.store(preds[i].size(), std::memory_order_relaxed);
+    }
+
+    taintDirty(order);
+    log_debug("{} nodes to exec in parallel", m_tasks.size());
+
+    graph->scheduler = this;
+    scope_exit _{[&] {
+        graph->scheduler = nullptr;
+    }};
+
+    // the roots are order[0..] up to the first node with predecessors, don't read deps
+    // here: workers already decrement them, a node seen at zero would launch twice
+    for (auto i: order) {
+        if (!preds[i].empty())
+            break;
+        launch(i);
+    }
+    ThreadPool::global().waitUntil([&] {
+        return m_inflight.load(std::memory_order_acquire) == 0;
+    });
+
+    if (m_exception)
+        std::rethrow_exception(m_exception);
+}
+
+void GraphScheduler::launch(std::size_t index) {
+    m_inflight.fetch_add(1, std::memory_order_relaxed);
+    ThreadPool::global().submit([this, index] {
+        run(index);
+    });
+}
+
+void GraphScheduler::run(std::size_t index) {
+    auto &task = *m_tasks[index];
+    bool ok;
+    {
+        std::lock_guard lck(m_mtx);
+        ok = !m_exception;
+    }
+    if (ok) {
+        try {
+            applyNode(task.id);
+        } catch (...) {
+            std::lock_guard lck(m_mtx);
+            if (!m_exception)
+                m_exception = std::current_exception();
+            ok = false;
+        }
+    }
+    if (ok) {
+        for (auto c: task.successors) {
+            if (m_tasks[c]->deps.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                launch(c);
+        }
+    }
+    // decrease only after the consumers are launched, so waitUntil can't see zero too early
+    m_inflight.fetch_sub(1, std::memory_order_release);
+}
+
+ZENO_API bool GraphScheduler::applyNode(std::string const &id) {
+    // like Graph::applyNode, tell every caller whether id is dirty
+    auto isDirty = [&] {
+        return graph->dirtyChecker && graph->dirtyChecker->amIDirty(id);
+    };
+    std::unique_lock lck(m_mtx);
+    if (graph->ctx->visited.find(id) != graph->ctx->visited.end()) {
+        auto it = m_running.find(id);
+        if (it != m_running.end() && it->second != std::this_thread::get_id()) {
+            // being run by another thread, e.g. pulled lazily by ref() while also scheduled
+            // block without running other tasks: this thread is in the middle of a node
+            m_cv.wait(lck, [&] {
+                return m_running.find(id) == m_running.end();
+            });
+        }
+        return isDirty();
+    }
+    graph->ctx->visited.insert(id);
+    m_running.emplace(id, std::this_thread::get_id());
+    lck.unlock();
+
+    scope_exit _{[&] {
+        {
+            std::lock_guard lck(m_mtx);
+            m_running.erase(id);
+        }
+        m_cv.notify_all();
+    }};
+    auto node = safe_at(graph->nodes, id, "node name").get();
+    GraphException::translated([&] {
+        node->doApply();
+    }, node->myname);
+    return isDirty();
+}
+
+}
@@ -0,0 +1,370 @@
+#include <zeno/extra/NodeMemo.h>
+#include <zeno/extra/GlobalState.h>
+#include <zeno/core/INode.h>
+#include <zeno/core/Graph.h>
+#include <zeno/core/Session.h>
+#include <zeno/core/Descriptor.h>
+#include <zeno/funcs/ObjectCodec.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/types/DummyObject.h>
+#include <zeno/types/ListObject.h>
+#include <zeno/types/DictObject.h>
+#include <zeno/types/UserData.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include <unordered_map>
+#include <filesystem>
+#include <typeinfo>
+#include <cstring>
+#include <mutex>
+#include <list>
+#include <map>
+
+namespace zeno {
+
+namespace {
+
+struct Hasher {
+    static constexpr std::uint64_t kMul = 0x9e3779b97f4a7c15ull;
+
+    std::uint64_t h = 0xcbf29ce484222325ull;
+
+    static std::uint64_t fmix(std::uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdull;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ull;
+        k ^= k >> 33;
+        return k;
+    }
+
+    void mix(std::uint64_t v) {
+        h = fmix(h ^ (v + kMul + (h << 6) + (h >> 2)));
+    }
+
+    void bytes(void const *data, std::size_t n) {
+        auto p = static_cast<unsigned char const *>(data);
+        mix(n);
+        // four independent lanes to keep the multipliers busy on big arrays
+        std::uint64_t a = h, b = h ^ kMul, c = h + kMul, d = ~h;
+        while (n >= 32) {
+            std::uint64_t w[4];
+            std::memcpy(w, p, 32);
+            a = (a ^ w[0]) * kMul; a ^= a >> 29;
+            b = (b ^ w[1]) * kMul; b ^= b >> 29;
+            c = (c ^ w[2]) * kMul; c ^= c >> 29;
+            d = (d ^ w[3]) * kMul; d ^= d >> 29;
+            p += 32;
+            n -= 32;
+        }
+        mix(a);
+        mix(b);
+        mix(c);
+        mix(d);
+        while (n >= 8) {
+            std::uint64_t w;
+            std::memcpy(&w, p, 8);
+            mix(w);
+            p += 8;
+            n -= 8;
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, p, n);
+        mix(tail);
+    }
+
+    void str(std::string_view s) {
+        bytes(s.data(), s.size());
+    }
+
+    template <class T>
+    void array(std::vector<T> const &arr) {
+        bytes(arr.data(), arr.size() * sizeof(T));
+    }
+};
+
+template <class T>
+void hashAttrVector(Hasher &h, AttrVector<T> const &av) {
+    h.array(av.values.get());
+    h.mix(av.attrs.size());
+    for (auto const &[key, arr]: av.attrs) {
+        h.str(key);
+        h.mix(arr.index());
+        std::visit([&] (auto const &arr) {
+            h.array(arr);
+        }, arr);
+    }
+}
+
+template <class T>
+std::size_t sizeAttrVector(AttrVector<T> const &av) {
+    std::size_t n = av.values.size() * sizeof(T);
+    for (auto const &[key, arr]: av.attrs) {
+        std::visit([&] (auto const &arr) {
+            n += arr.size() * sizeof(arr[0]);
+        }, arr);
+    }
+    return n;
+}
+
+bool hashObject(Hasher &h, IObject const *obj) {
+    if (!obj) {
+        h.mix(0);
+        return true;
+    }
+    h.str(typeid(*obj).name());
+    if (auto p = dynamic_cast<NumericObject const *>(obj)) {
+        h.mix(p->value.index());
+        std::visit([&] (auto const &val) {
+            h.bytes(&val, sizeof(val));
+        }, p->value);
+    } else if (auto p = dynamic_cast<StringObject const *>(obj)) {
+        h.str(p->value);
+    } else if (dynamic_cast<DummyObject const *>(obj)) {
+    } else if (auto p = dynamic_cast<PrimitiveObject const *>(obj)) {
+        hashAttrVector(h, p->verts);
+        hashAttrVector(h, p->points);
+        hashAttrVector(h, p->lines);
+        hashAttrVector(h, p->tris);
+        hashAttrVector(h, p->quads);
+        hashAttrVector(h, p->loops);
+        hashAttrVector(h, p->polys);
+        hashAttrVector(h, p->edges);
+        hashAttrVector(h, p->uvs);
+        if (!hashObject(h, (IObject const *)p->mtl.get()))
+            return false;
+        if (!hashObject(h, (IObject const *)p->inst.get()))
+            return false;
+    } else if (auto p = dynamic_cast<ListObject const *>(obj)) {
+        h.mix(p->arr.size());
+        for (auto const &elm: p->arr) {
+            if (!hashObject(h, elm.get()))
+                return false;
+        }
+    } else if (auto p = dynamic_cast<DictObject const *>(obj)) {
+        h.mix(p->lut.size());
+        for (auto const &[key, elm]: p->lut) {
+            h.str(key);
+            if (!hashObject(h, elm.get()))
+                return false;
+        }
+    } else {
+        // encodeObject also covers the user data
+        std::vector<char> buf;
+        if (!encodeObject(obj, buf))
+            return false;
+        h.bytes(buf.data(), buf.size());
+        return true;
+    }
+    for (auto const &[key, val]: obj->userData()) {
+        h.str(key);
+        if (!hashObject(h, val.get()))
+            return false;
+    }
+    return true;
+}
+
+std::size_t objectSize(IObject const *obj) {
+    std::size_t n = 64;
+    if (auto p = dynamic_cast<PrimitiveObject const *>(obj)) {
+        n += sizeAttrVector(p->verts) + sizeAttrVector(p->points) + sizeAttrVector(p->lines)
+           + sizeAttrVector(p->tris) + sizeAttrVector(p->quads) + sizeAttrVector(p->loops)
+           + sizeAttrVector(p->polys) + sizeAttrVector(p->edges) + sizeAttrVector(p->uvs);
+    } else if (auto p = dynamic_cast<StringObject const *>(obj)) {
+        n += p->value.size();
+    } else if (auto p = dynamic_cast<ListObject const *>(obj)) {
+        for (auto const &elm: p->arr)
+            n += objectSize(elm.get());
+    } else if (auto p = dynamic_cast<DictObject const *>(obj)) {
+        for (auto const &[key, elm]: p->lut)
+            n += key.size() + objectSize(elm.get());
+    }
+    return n;
+}
+
+std::uint64_t globalStateKey(GlobalState const &gs) {
+    Hasher h;
+    h.mix(gs.frameid);
+    h.mix(gs.substepid);
+    h.bytes(&gs.frame_time, sizeof(gs.frame_time));
+    h.bytes(&gs.frame_time_elapsed, sizeof(gs.frame_time_elapsed));
+    h.mix(gs.has_frame_completed);
+    h.mix(gs.has_substep_executed);
+    h.mix(gs.time_step_integrated);
+    return h.h;
+}
+
+thread_local bool tlsStateRead = false;
+
+}
+
+struct NodeMemo::Impl {
+    struct Entry {
+        std::uint64_t key;
+        INodeClass const *nodeClass = nullptr;
+        Fingerprints inputs;
+        std::map<std::string, zany> outputs;
+        bool readsState = false;
+        std::uint64_t stateKey = 0;
+        std::size_t bytes = 0;
+    };
+
+    mutable std::mutex mtx;
+    std::list<Entry> lru;  // front is the most recently used
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> lut;
+    Stats stats;
+
+    void evict(std::size_t capacity) {
+        while (stats.bytes > capacity && !lru.empty()) {
+            auto &back = lru.back();
+            stats.bytes -= back.bytes;
+            lut.erase(back.key);
+            lru.pop_back();
+        }
+        stats.entries = lru.size();
+    }
+};
+
+ZENO_API NodeMemo::NodeMemo() : impl(std::make_unique<Impl>()) {
+    capacity = envconfig::getUint64("NODE_MEMO") << 20;
+}
+
+ZENO_API NodeMemo::~NodeMemo() = default;
+
+ZENO_API void NodeMemo::markStateRead() {
+    tlsStateRead = true;
+}
+
+ZENO_API std::size_t NodeMemo::objectSize(IObject const *obj) {
+    return zeno::objectSize(obj);
+}
+
+ZENO_API bool NodeMemo::fingerprint(IObject const *obj, std::uint64_t &hash) {
+    Hasher h;
+    if (!hashObject(h, obj))
+        return false;
+    hash = h.h;
+    return true;
+}
+
+// the key hashes the per-input fingerprints, which are also kept in the entry and
+// compared on a hit: a collision of the 64-bit key alone can't return a wrong result,
+// only a collision of the fingerprints of every single input (accepted, like any hash)
+static bool makeKey(INode *node, std::uint64_t &key, NodeMemo::Fingerprints &fps) {
+    if (node->bTmpCache || !node->isMemoizable())
+        return false;
+    if (!node->nodeClass || node->nodeClass->desc->outputs.empty())
+        return false;  // sinks exist only for their side effects
+    Hasher h;
+    h.str(typeid(*node).name());
+    h.mix(reinterpret_cast<std::uintptr_t>(node->nodeClass));
+    for (auto const &[name, _]: node->inputs) {
+        // get_input resolves keyframes and formulas for the current frame
+        auto obj = node->get_input(name);
+        Hasher ih;
+        if (!hashObject(ih, obj.get()))
+            return false;
+        // file readers: a path input also stands for the file content
+        if (auto str = dynamic_cast<StringObject const *>(obj.get()); str && !str->value.empty()) {
+            std::error_code ec;
+            auto path = std::filesystem::u8path(str->value);
+            if (std::filesystem::is_regular_file(path, ec)) {
+                auto mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+                ih.mix(static_cast<std::uint64_t>(mtime));
+                ih.mix(std::filesystem::file_size(path, ec));
+            }
+        }
+        h.str(name);
+        h.mix(ih.h);
+        fps.emplace_back(name, ih.h);
+    }
+    key = h.h;
+    return true;
+}
+
+ZENO_API void NodeMemo::apply(INode *node, std::function<void()> const &applyFn) {
+    std::uint64_t key = 0;
+    Fingerprints fps;
+    if (!enabled() || !makeKey(node, key, fps)) {
+        applyFn();
+        return;
+    }
+
+    auto &gs = *node->getThisSession()->globalState;
+    std::map<std::string, zany> hit;
+    bool isHit = false;
+    {
+        std::lock_guard lck(impl->mtx);
+        if (auto it = impl->lut.find(key); it != impl->lut.end()) {
+            auto &ent = *it->second;
+            if (ent.nodeClass == node->nodeClass && ent.inputs == fps
+                && (!ent.readsState || ent.stateKey == globalStateKey(gs))) {
+                impl->lru.splice(impl->lru.begin(), impl->lru, it->second);
+                isHit = true;
+                for (auto const &[name, obj]: ent.outputs) {
+                    hit.emplace(name, obj ? obj->shared_clone() : nullptr);
+                }
+            }
+        }
+        if (isHit)
+            impl->stats.hits++;
+        else
+            impl->stats.misses++;
+    }
+    if (isHit) {
+        for (auto &[name, obj]: hit) {
+            node->set_output(name, std::move(obj));
+        }
+        log_debug("node memo hit for {}", node->myname);
+        return;
+    }
+
+    bool oldStateRead = std::exchange(tlsStateRead, false);
+    applyFn();
+    bool stateRead = tlsStateRead;
+    tlsStateRead = oldStateRead || stateRead;
+
+    Impl::Entry ent;
+    ent.key = key;
+    ent.nodeClass = node->nodeClass;
+    ent.inputs = std::move(fps);
+    ent.readsState = stateRead;
+    ent.stateKey = stateRead ? globalStateKey(gs) : 0;
+    for (auto const &[name, obj]: node->outputs) {
+        auto clone = obj ? obj->shared_clone() : nullptr;
+        if (obj && !clone)
+            return;  // not clonable, don't memoize
+        ent.bytes += clone ? objectSize(clone.get()) : 0;
+        ent.outputs.emplace(name, std::move(clone));
+    }
+    if (ent.bytes > capacity)
+        return;
+
+    std::lock_guard lck(impl->mtx);
+    if (auto it = impl->lut.find(key); it != impl->lut.end()) {
+        impl->stats.bytes -= it->second->bytes;
+        impl->lru.erase(it->second);
+        impl->lut.erase(it);
+    }
+    impl->stats.bytes += ent.bytes;
+    impl->lru.push_front(std::move(ent));
+    impl->lut.emplace(key, impl->lru.begin());
+    impl->evict(capacity);
+}
+
+ZENO_API void NodeMemo::clear() {
+    std::lock_guard lck(impl->mtx);
+    impl->lru.clear();
+    impl->lut.clear();
+    impl->stats.bytes = 0;
+    impl->stats.entries = 0;
+}
+
+ZENO_API NodeMemo::Stats NodeMemo::stats() const {
+    std::lock_guard lck(impl->mtx);
+    return impl->stats;
+}
+
+}
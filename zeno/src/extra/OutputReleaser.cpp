@@ -0,0 +1,68 @@
+#include <zeno/extra/OutputReleaser.h>
+#include <zeno/core/Graph.h>
+#include <zeno/core/INode.h>
+#include <zeno/utils/safe_at.h>
+#include <zeno/utils/log.h>
+
+namespace zeno {
+
+ZENO_API OutputReleaser::OutputReleaser(Graph *graph, std::set<std::string> const &ids)
+    : graph(graph), m_pinned(ids) {
+    // count every consumer in the graph, not only those reachable from ids: nodes pulled
+    // lazily (PortalIn, untaken branches...) then simply keep their producers alive
+    for (auto const &[id, node]: graph->nodes) {
+        if (node->bTmpCache || !node->isSchedulable())
+            m_pinned.insert(id);
+        for (auto const &[ds, bound]: node->inputBounds) {
+            m_uses[bound]++;
+        }
+    }
+}
+
+ZENO_API OutputReleaser::~OutputReleaser() {
+    if (m_released)
+        log_debug("{} outputs released before the end of the pass", m_released);
+}
+
+bool OutputReleaser::nested() const {
+    return graph->ctx && graph->ctx->depth > 0;
+}
+
+ZENO_API zany OutputReleaser::acquire(INode *consumer, std::string const &ds,
+                                      std::string const &sn, std::string const &ss) {
+    std::lock_guard lck(m_mtx);
+    if (nested())
+        return graph->getNodeOutput(sn, ss);
+    if (!m_taken.emplace(consumer->myname, ds).second) {
+        // required twice (e.g. lazily in apply after preApply), the producer may have let go
+        if (auto it = consumer->inputs.find(ds); it != consumer->inputs.end())
+            return it->second;
+        return graph->getNodeOutput(sn, ss);
+    }
+    auto producer = safe_at(graph->nodes, sn, "node name").get();
+    auto uit = m_uses.find({sn, ss});
+    auto oit = producer->outputs.find(ss);
+    if (producer->muted_output || m_pinned.count(sn) || uit == m_uses.end()
+        || oit == producer->outputs.end() || --uit->second != 0)
+        return graph->getNodeOutput(sn, ss);
+    m_released++;
+    return std::move(oit->second);
+}
+
+ZENO_API void OutputReleaser::release(INode *node) {
+    std::lock_guard lck(m_mtx);
+    if (nested() || m_pinned.count(node->myname))
+        return;
+    for (auto const &[ds, bound]: node->inputBounds) {
+        node->inputs.erase(ds);
+    }
+    // nobody is bound to these, e.g. DST or unused extra results
+    for (auto &[ss, obj]: node->outputs) {
+        if (obj && !m_uses.count({node->myname, ss})) {
+            obj.reset();
+            m_released++;
+        }
+    }
+}
+
+}
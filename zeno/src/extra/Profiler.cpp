@@ -0,0 +1,384 @@
+#include <zeno/extra/Profiler.h>
+#include <zeno/extra/NodeMemo.h>
+#include <zeno/core/INode.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include <ctime>
+#include <map>
+#if defined(_WIN32)
+#include <zeno/utils/fuck_win.h>
+#include <windows.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace zeno {
+
+namespace {
+
+struct Event {
+    std::int64_t beg;       // ns since process start
+    std::int64_t end;
+    std::int64_t cpu;       // ns of process CPU time, -1 if not measured
+    std::int64_t heap;      // heap growth in bytes
+    std::int64_t output;    // bytes of node outputs, -1 if not a node
+    Profiler::Category cat;
+    char name[79];          // truncated, NUL-terminated
+};
+
+// events [0, count) are complete, count is published with release ordering
+struct Block {
+    static constexpr std::size_t kSize = 512;
+
+    Event events[kSize];
+    std::atomic<std::size_t> count{0};
+    std::atomic<Block *> next{nullptr};
+};
+
+// owned and written by a single thread, read by whoever exports; the owner only
+// ever writes to its tail block, so clear() may free the blocks before it
+struct ThreadLog {
+    int tid = 0;
+    std::atomic<Block *> head{nullptr};
+    std::atomic<Block *> tail{nullptr};
+    ThreadLog *next = nullptr;
+};
+
+auto const kProcessStart = std::chrono::steady_clock::now();
+
+std::int64_t wallNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - kProcessStart).count();
+}
+
+std::int64_t cpuNow() {
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    auto k = (std::int64_t(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    auto u = (std::int64_t(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return (k + u) * 100;
+#else
+    return std::int64_t(std::clock()) * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+// bytes currently allocated by malloc, 0 where we have no cheap way to ask
+std::int64_t heapNow() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    auto mi = mallinfo2();
+    return std::int64_t(mi.uordblks + mi.hblkhd);
+#elif defined(__GLIBC__)
+    auto mi = mallinfo();
+    return std::int64_t((unsigned)mi.uordblks) + std::int64_t((unsigned)mi.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+std::atomic<bool> g_enabled{envconfig::has("PROFILE")};
+std::atomic<ThreadLog *> g_logs{nullptr};
+std::atomic<int> g_nextTid{0};
+std::atomic<std::int64_t> g_clearedAt{0};
+std::atomic<std::size_t> g_blocks{0};
+std::atomic<bool> g_capWarned{false};
+std::shared_mutex g_exportMutex;    // shared by exporters, exclusive in clear()
+std::size_t const g_maxBlocks = std::max<std::size_t>(1,
+    (std::size_t)envconfig::getInt("PROFILE_MAX_MB", 256) * (1 << 20) / sizeof(Block));
+
+ThreadLog &threadLog() {
+    thread_local ThreadLog *log = [] {
+        auto log = new ThreadLog;   // never freed, exporters may still read it after the thread exits
+        log->tid = g_nextTid.fetch_add(1, std::memory_order_relaxed);
+        log->next = g_logs.load(std::memory_order_relaxed);
+        while (!g_logs.compare_exchange_weak(log->next, log, std::memory_order_release, std::memory_order_relaxed));
+        return log;
+    }();
+    return *log;
+}
+
+Event *allocEvent() {
+    auto &log = threadLog();
+    auto tail = log.tail.load(std::memory_order_relaxed);
+    if (!tail || tail->count.load(std::memory_order_relaxed) == Block::kSize) {
+        if (g_blocks.fetch_add(1, std::memory_order_relaxed) >= g_maxBlocks) {
+            g_blocks.fetch_sub(1, std::memory_order_relaxed);
+            if (!g_capWarned.exchange(true, std::memory_order_relaxed))
+                log_warn("profiler reached $ZENO_PROFILE_MAX_MB, further events are dropped until the next clear");
+            return nullptr;
+        }
+        auto blk = new Block;
+        if (tail)
+            tail->next.store(blk, std::memory_order_release);
+        else
+            log.head.store(blk, std::memory_order_release);
+        log.tail.store(blk, std::memory_order_release);
+        tail = blk;
+    }
+    return &tail->events[tail->count.load(std::memory_order_relaxed)];
+}
+
+void commitEvent() {
+    auto &blk = *threadLog().tail.load(std::memory_order_relaxed);
+    blk.count.store(blk.count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void record(Profiler::Category cat, std::string_view name, std::int64_t beg,
+            std::int64_t cpu, std::int64_t heap, std::int64_t output) {
+    auto ev = allocEvent();
+    if (!ev) return;
+    ev->beg = beg;
+    ev->end = wallNow();
+    ev->cpu = cpu;
+    ev->heap = heap;
+    ev->output = output;
+    ev->cat = cat;
+    auto n = std::min(name.size(), sizeof(ev->name) - 1);
+    std::memcpy(ev->name, name.data(), n);
+    ev->name[n] = 0;
+    commitEvent();
+}
+
+template <class Func>
+void forEachEvent(Func const &func) {
+    std::shared_lock lck(g_exportMutex);
+    auto since = g_clearedAt.load(std::memory_order_relaxed);
+    for (auto log = g_logs.load(std::memory_order_acquire); log; log = log->next) {
+        for (auto blk = log->head.load(std::memory_order_acquire); blk; blk = blk->next.load(std::memory_order_acquire)) {
+            auto n = blk->count.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; i++) {
+                if (blk->events[i].beg >= since)
+                    func(log->tid, blk->events[i]);
+            }
+        }
+    }
+}
+
+const char *categoryName(Profiler::Category cat) {
+    switch (cat) {
+    case Profiler::Category::Node: return "node";
+    case Profiler::Category::Cache: return "cache";
+    case Profiler::Category::Zfx: return "zfx";
+    case Profiler::Category::IPC: return "ipc";
+    default: return "other";
+    }
+}
+
+std::size_t outputBytes(INode *node) {
+    std::size_t n = 0;
+    for (auto const &[key, obj]: node->outputs) {
+        if (obj)
+            n += NodeMemo::objectSize(obj.get());
+    }
+    return n;
+}
+
+struct ExitWriter {
+    ~ExitWriter() {
+        if (envconfig::has("PROFILE"))
+            Profiler::writeTrace();
+    }
+} exitWriter;
+
+}
+
+ZENO_API Profiler::Scope::Scope(Category cat, std::string_view name) {
+    if (!enabled()) return;
+    m_active = true;
+    m_cat = cat;
+    m_name = name;
+    m_beg = wallNow();
+}
+
+ZENO_API Profiler::Scope::Scope(INode *node) {
+    if (!enabled()) return;
+    m_active = true;
+    m_node = node;
+    m_cat = Category::Node;
+    m_name = node->myname;
+    m_heapBeg = heapNow();
+    m_cpuBeg = cpuNow();
+    m_beg = wallNow();
+}
+
+ZENO_API Profiler::Scope::~Scope() {
+    if (!m_active) return;
+    if (m_node) {
+        auto cpu = cpuNow() - m_cpuBeg;
+        auto heap = heapNow() - m_heapBeg;
+        record(m_cat, m_name, m_beg, cpu, heap, (std::int64_t)outputBytes(m_node));
+    } else {
+        record(m_cat, m_name, m_beg, -1, 0, -1);
+    }
+}
+
+ZENO_API bool Profiler::enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+ZENO_API void Profiler::setEnabled(bool on) {
+    g_enabled.store(on, std::memory_order_relaxed);
+}
+
+ZENO_API void Profiler::clear() {
+    std::unique_lock lck(g_exportMutex);
+    // frees every block but the tail, which its owner thread may be appending
+    // to; older events left there are filtered out by their start time instead
+    g_clearedAt.store(wallNow(), std::memory_order_relaxed);
+    for (auto log = g_logs.load(std::memory_order_acquire); log; log = log->next) {
+        auto tail = log->tail.load(std::memory_order_acquire);
+        auto blk = log->head.load(std::memory_order_relaxed);
+        std::size_t freed = 0;
+        while (blk != tail) {
+            auto next = blk->next.load(std::memory_order_acquire);
+            delete blk;
+            blk = next;
+            freed++;
+        }
+        log->head.store(tail, std::memory_order_release);
+        g_blocks.fetch_sub(freed, std::memory_order_relaxed);
+    }
+    g_capWarned.store(false, std::memory_order_relaxed);
+}
+
+ZENO_API std::string Profiler::traceJson() {
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer writer(buf);
+    writer.StartObject();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.Key("traceEvents");
+    writer.StartArray();
+    forEachEvent([&] (int tid, Event const &ev) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(ev.name);
+        writer.Key("cat");
+        writer.String(categoryName(ev.cat));
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Double(ev.beg * 1e-3);
+        writer.Key("dur");
+        writer.Double((ev.end - ev.beg) * 1e-3);
+        writer.Key("pid");
+        writer.Int(1);
+        writer.Key("tid");
+        writer.Int(tid);
+        if (ev.output >= 0) {
+            writer.Key("args");
+            writer.StartObject();
+            writer.Key("cpu_us");
+            writer.Double(ev.cpu * 1e-3);
+            writer.Key("heap_bytes");
+            writer.Int64(ev.heap);
+            writer.Key("output_bytes");
+            writer.Int64(ev.output);
+            writer.EndObject();
+        }
+        writer.EndObject();
+    });
+    writer.EndArray();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetSize()};
+}
+
+ZENO_API std::string Profiler::summaryJson() {
+    struct NodeStat {
+        std::size_t count = 0;
+        std::int64_t wall = 0;
+        std::int64_t cpu = 0;
+        std::int64_t heap = 0;
+        std::int64_t output = 0;
+        std::int64_t lastBeg = -1;
+    };
+    struct CatStat {
+        std::size_t count = 0;
+        std::int64_t wall = 0;
+    };
+    std::map<std::string, NodeStat> nodes;
+    std::map<Category, CatStat> cats;
+    forEachEvent([&] (int tid, Event const &ev) {
+        auto &cs = cats[ev.cat];
+        cs.count++;
+        cs.wall += ev.end - ev.beg;
+        if (ev.cat != Category::Node)
+            return;
+        auto &ns = nodes[ev.name];
+        ns.count++;
+        ns.wall += ev.end - ev.beg;
+        ns.cpu += ev.cpu;
+        ns.heap += ev.heap;
+        if (ev.beg > ns.lastBeg) {
+            ns.lastBeg = ev.beg;
+            ns.output = ev.output;
+        }
+    });
+    std::vector<std::pair<std::string, NodeStat>> sorted(nodes.begin(), nodes.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [] (auto const &lhs, auto const &rhs) {
+        return lhs.second.wall > rhs.second.wall;
+    });
+
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer writer(buf);
+    writer.StartObject();
+    writer.Key("nodes");
+    writer.StartArray();
+    for (auto const &[name, ns]: sorted) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.data(), name.size());
+        writer.Key("count");
+        writer.Uint64(ns.count);
+        writer.Key("wall_us");
+        writer.Double(ns.wall * 1e-3);
+        writer.Key("cpu_us");
+        writer.Double(ns.cpu * 1e-3);
+        writer.Key("heap_bytes");
+        writer.Int64(ns.heap);
+        writer.Key("output_bytes");
+        writer.Int64(ns.output);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.Key("categories");
+    writer.StartObject();
+    for (auto const &[cat, cs]: cats) {
+        writer.Key(categoryName(cat));
+        writer.StartObject();
+        writer.Key("count");
+        writer.Uint64(cs.count);
+        writer.Key("wall_us");
+        writer.Double(cs.wall * 1e-3);
+        writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetSize()};
+}
+
+ZENO_API bool Profiler::writeTrace(std::string const &path) {
+    auto dest = path.empty() ? envconfig::getStr("PROFILE") : path;
+    if (dest.empty())
+        return false;
+    std::ofstream fout(dest, std::ios::binary);
+    if (!fout) {
+        log_error("profiler failed to open {} for writing", dest);
+        return false;
+    }
+    fout << traceJson();
+    return bool(fout);
+}
+
+}
@@ -0,0 +1,78 @@
+#include <zeno/extra/ZenCacheReader.h>
+#include <zeno/extra/Profiler.h>
+#include <zeno/funcs/ObjectCodec.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+#include <cstring>
+
+namespace zeno {
+
+ZENO_API ZenCacheReader::ZenCacheReader() = default;
+ZENO_API ZenCacheReader::~ZenCacheReader() = default;
+
+ZENO_API bool ZenCacheReader::open(std::filesystem::path const &path) {
+    m_keys.clear();
+    m_poses.clear();
+    m_objs.clear();
+    m_body = nullptr;
+    if (!m_file.open(path)) {
+        log_error("cannot open zeno cache file {}", path.string());
+        return false;
+    }
+
+    // layout: "ZENCACHE" <count> \a <key> \a <key> ... \a, then (count+1) size_t offsets, then the body
+    char const *dat = m_file.data();
+    char const *end = dat + m_file.size();
+    if (m_file.size() <= 8 || std::memcmp(dat, "ZENCACHE", 8) != 0) {
+        log_error("zeno cache file broken (1)");
+        return false;
+    }
+    char const *p = std::find(dat + 8, end, '\a');
+    if (p == end) {
+        log_error("zeno cache file broken (2)");
+        return false;
+    }
+    std::size_t keyscount = std::stoull(std::string(dat + 8, p));
+    p++;
+    m_keys.reserve(keyscount);
+    for (std::size_t k = 0; k < keyscount; k++) {
+        char const *q = std::find(p, end, '\a');
+        if (q == end) {
+            log_error("zeno cache file broken (3.{})", k);
+            m_keys.clear();
+            return false;
+        }
+        m_keys.emplace_back(p, q);
+        p = q + 1;
+    }
+    if ((std::size_t)(end - p) < (keyscount + 1) * sizeof(std::size_t)) {
+        log_error("zeno cache file broken (4)");
+        m_keys.clear();
+        return false;
+    }
+    m_poses.resize(keyscount + 1);
+    std::memcpy(m_poses.data(), p, (keyscount + 1) * sizeof(std::size_t));
+    p += (keyscount + 1) * sizeof(std::size_t);
+    std::size_t bodysize = end - p;
+    for (std::size_t k = 0; k < keyscount; k++) {
+        if (m_poses[k + 1] > bodysize || m_poses[k + 1] < m_poses[k]) {
+            log_error("zeno cache file broken (5.{})", k);
+            m_keys.clear();
+            m_poses.clear();
+            return false;
+        }
+    }
+    m_body = p;
+    m_objs.resize(keyscount);
+    return true;
+}
+
+ZENO_API std::shared_ptr<IObject> ZenCacheReader::get(std::size_t i) {
+    if (!m_objs[i]) {
+        Profiler::Scope _prof(Profiler::Category::Cache, "cache decode");
+        m_objs[i] = decodeObject(m_body + m_poses[i], m_poses[i + 1] - m_poses[i]);
+    }
+    return m_objs[i];
+}
+
+}
@@ -2,10 +2,15 @@
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/types/MaterialObject.h>
 #include <zeno/utils/variantswitch.h>
+#include <zeno/utils/ThreadPool.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/lzblock.h>
 #include <zeno/utils/log.h>
 //#include <zeno/utils/zeno_p.h>
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <cmath>
 namespace zeno {
 
 namespace _implObjectCodec {
@@ -30,7 +35,7 @@ void decodeAttrVector(AttrVector<T0> &arr, It &it) {
     std::copy_n(it, sizeof(header), (char *)&header);
     it += sizeof(header);
     arr.values.reserve(header.size);
-    std::copy_n((T0 const *)it, header.size, std::back_inserter(arr.values));
+    std::copy_n((T0 const *)it, header.size, std::back_inserter(arr.values.mut()));
     it += sizeof(T0) * header.size;
 
     for (int a = 0; a < header.nattrs; a++) {
@@ -70,11 +75,277 @@ void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
     });
 }
 
+// codec v2: columnar, each array is byte-shuffled and lz compressed on its own,
+// pos/nrm/clr may additionally be quantized within an absolute error bound.
+// a v2 stream starts with kCodecV2Magic where v1 has the size of verts, so both decode.
+// enabled with ZENO_PRIM_CODEC=lz, and ZENO_PRIM_QUANTIZE=<max abs error> for the lossy mode.
+
+constexpr size_t kCodecV2Magic = 0x32764d4952505aff;  // "\xffZPRIMv2"
+constexpr uint32_t kValuesColumn = 0xffffffff;
+
+enum : uint8_t {
+    kColumnRaw = 0,
+    kColumnShuffleLz = 1,
+};
+
+struct ColumnHeader {
+    uint32_t type;          // index in AttrAcceptAll
+    uint32_t namelen;       // 0 for the base values
+    uint64_t count;
+    uint64_t packedBytes;   // payload following the name
+    uint8_t codec;
+    uint8_t quantized;
+    uint8_t pad[2];
+    float step;             // quantized: value = minval + q * step
+    float minval[4];
+};
+
+struct CodecOptions {
+    bool compress = false;
+    float quantError = 0;
+};
+
+static CodecOptions const &codecOptions() {
+    static CodecOptions opts = [] {
+        CodecOptions opts;
+        opts.compress = envconfig::getStr("PRIM_CODEC") == "lz";
+        if (auto q = envconfig::getCStr("PRIM_QUANTIZE"))
+            opts.quantError = std::max(0.f, std::strtof(q, nullptr));
+        if (opts.quantError > 0)
+            opts.compress = true;  // quantized values only pay off once compressed
+        return opts;
+    }();
+    return opts;
+}
+
+struct Column {
+    ColumnHeader header{};
+    std::string name;
+    char const *data = nullptr;     // encode: source array; decode: packed payload
+    char *dest = nullptr;           // decode: destination array
+    size_t scalars = 0;             // number of 4-byte scalars
+    std::vector<char> packed;       // encode: resulting payload
+    bool ok = true;
+};
+
+static void shuffle4(char const *src, char *dst, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t b = 0; b < 4; b++)
+            dst[b * n + i] = src[i * 4 + b];
+}
+
+static void unshuffle4(char const *src, char *dst, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t b = 0; b < 4; b++)
+            dst[i * 4 + b] = src[b * n + i];
+}
+
+static bool quantizeColumn(Column &col, float err, std::vector<char> &out) {
+    auto vals = (float const *)col.data;
+    size_t n = col.header.count;
+    float lo[3] = {INFINITY, INFINITY, INFINITY}, hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (size_t i = 0; i < n * 3; i++) {
+        float v = vals[i];
+        if (!std::isfinite(v))
+            return false;
+        lo[i % 3] = std::min(lo[i % 3], v);
+        hi[i % 3] = std::max(hi[i % 3], v);
+    }
+    float step = 2 * err * 0.99f;  // leave room for float rounding on decode
+    for (int c = 0; c < 3 && n; c++) {
+        if ((double)(hi[c] - lo[c]) / step >= 4294967295.0)
+            return false;
+    }
+    out.resize(n * 3 * sizeof(uint32_t));
+    auto q = (uint32_t *)out.data();
+    for (size_t i = 0; i < n * 3; i++)
+        q[i] = (uint32_t)std::lround((double)(vals[i] - lo[i % 3]) / step);
+    col.header.quantized = 1;
+    col.header.step = step;
+    for (int c = 0; c < 3; c++)
+        col.header.minval[c] = n ? lo[c] : 0;
+    return true;
+}
+
+static void packColumn(Column &col, CodecOptions const &opts) {
+    size_t bytes = col.scalars * 4;
+    std::vector<char> quant;
+    char const *src = col.data;
+    bool isQuantCandidate = col.header.type == variant_index<AttrAcceptAll, vec3f>::value
+        && (col.name == "pos" || col.name == "nrm" || col.name == "clr");
+    if (opts.quantError > 0 && isQuantCandidate && quantizeColumn(col, opts.quantError, quant))
+        src = quant.data();
+    if (!opts.compress || bytes < 64) {
+        col.header.codec = kColumnRaw;
+        col.packed.assign(src, src + bytes);
+    } else {
+        std::vector<char> shuffled(bytes);
+        shuffle4(src, shuffled.data(), col.scalars);
+        col.packed.resize(lz_compress_bound(bytes));
+        col.packed.resize(lz_compress(shuffled.data(), bytes, col.packed.data()));
+        col.header.codec = kColumnShuffleLz;
+    }
+    col.header.packedBytes = col.packed.size();
+}
+
+static void unpackColumn(Column &col) {
+    size_t bytes = col.scalars * 4;
+    std::vector<char> tmp;
+    char const *src = col.data;
+    if (col.header.codec == kColumnShuffleLz) {
+        std::vector<char> shuffled(bytes);
+        if (!lz_decompress(col.data, col.header.packedBytes, shuffled.data(), bytes)) {
+            col.ok = false;
+            return;
+        }
+        tmp.resize(bytes);
+        unshuffle4(shuffled.data(), tmp.data(), col.scalars);
+        src = tmp.data();
+    } else if (col.header.packedBytes != bytes) {
+        col.ok = false;
+        return;
+    }
+    if (col.header.quantized) {
+        auto q = (uint32_t const *)src;
+        auto out = (float *)col.dest;
+        for (size_t i = 0; i < col.scalars; i++)
+            out[i] = (float)(col.header.minval[i % 3] + (double)q[i] * col.header.step);
+    } else {
+        std::memcpy(col.dest, src, bytes);
+    }
+}
+
+// columns are independent, spread them over the pool when there is enough work
+static void forEachColumn(std::vector<Column> &cols, void (*func)(Column &, CodecOptions const &), CodecOptions const &opts) {
+    size_t total = 0;
+    for (auto const &col: cols)
+        total += col.scalars;
+    if (cols.size() < 2 || total < (1 << 16)) {
+        for (auto &col: cols)
+            func(col, opts);
+        return;
+    }
+    auto &pool = ThreadPool::global();
+    std::atomic<size_t> left{cols.size()};
+    for (auto &col: cols) {
+        pool.submit([&, pcol = &col] {
+            func(*pcol, opts);
+            left.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    pool.waitUntil([&] {
+        return left.load(std::memory_order_acquire) == 0;
+    });
+}
+
+template <class T0>
+void collectColumnsV2(AttrVector<T0> const &arr, std::vector<Column> &cols) {
+    auto &base = cols.emplace_back();
+    base.header.type = variant_index<AttrAcceptAll, T0>::value;
+    base.header.count = arr.size();
+    base.name = std::is_same_v<T0, vec3f> ? "pos" : "";
+    base.data = (char const *)arr.data();
+    base.scalars = arr.size() * sizeof(T0) / 4;
+
+    arr.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
+        using T = std::decay_t<decltype(attr[0])>;
+        auto &col = cols.emplace_back();
+        col.header.type = variant_index<AttrAcceptAll, T>::value;
+        col.header.count = attr.size();
+        col.name = key;
+        col.data = (char const *)attr.data();
+        col.scalars = attr.size() * sizeof(T) / 4;
+    });
 }
 
+template <class T0, class It>
+void writeColumnsV2(AttrVector<T0> const &arr, Column const *&col, It &it) {
+    AttrVectorHeader header;
+    header.size = arr.size();
+    header.nattrs = arr.template num_attrs<AttrAcceptAll>();
+    it = std::copy_n((char const *)&header, sizeof(header), it);
+    for (size_t c = 0; c < header.nattrs + 1; c++, col++) {
+        ColumnHeader h = col->header;
+        h.namelen = c ? col->name.size() : 0;
+        it = std::copy_n((char const *)&h, sizeof(h), it);
+        it = std::copy_n(col->name.data(), h.namelen, it);
+        it = std::copy_n(col->packed.data(), col->packed.size(), it);
+    }
+}
+
+template <class T0>
+void readColumnsV2(AttrVector<T0> &arr, const char *&it, std::vector<Column> &cols) {
+    AttrVectorHeader header;
+    std::memcpy(&header, it, sizeof(header));
+    it += sizeof(header);
+    for (size_t c = 0; c < header.nattrs + 1; c++) {
+        auto &col = cols.emplace_back();
+        std::memcpy(&col.header, it, sizeof(ColumnHeader));
+        it += sizeof(ColumnHeader);
+        col.name.assign(it, col.header.namelen);
+        it += col.header.namelen;
+        col.data = it;
+        it += col.header.packedBytes;
+        size_t n = col.header.count;
+        if (c == 0) {
+            arr.values.resize(n);
+            col.dest = (char *)arr.values.data();
+            col.scalars = n * sizeof(T0) / 4;
+            continue;
+        }
+        index_switch<std::variant_size_v<AttrAcceptAll>>((size_t)col.header.type, [&] (auto type) {
+            using T = std::variant_alternative_t<type.value, AttrAcceptAll>;
+            auto &attr = arr.template add_attr<T>(col.name);
+            attr.resize(n);
+            col.dest = (char *)attr.data();
+            col.scalars = n * sizeof(T) / 4;
+        });
+    }
+}
+
+}
+
+
 std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it);
 std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it) {
     auto obj = std::make_shared<PrimitiveObject>();
+    if (size_t magic; std::memcpy(&magic, it, sizeof(magic)), magic == kCodecV2Magic) {
+        it += sizeof(magic);
+        // all arrays are allocated first, then filled concurrently
+        std::vector<Column> cols;
+        readColumnsV2(obj->verts, it, cols);
+        readColumnsV2(obj->points, it, cols);
+        readColumnsV2(obj->lines, it, cols);
+        readColumnsV2(obj->tris, it, cols);
+        readColumnsV2(obj->quads, it, cols);
+        readColumnsV2(obj->loops, it, cols);
+        readColumnsV2(obj->polys, it, cols);
+        readColumnsV2(obj->edges, it, cols);
+        readColumnsV2(obj->uvs, it, cols);
+        forEachColumn(cols, [] (Column &col, CodecOptions const &) {
+            unpackColumn(col);
+        }, codecOptions());
+        for (auto const &col: cols) {
+            if (!col.ok) {
+                log_error("corrupted primitive column `{}`", col.name);
+                return nullptr;
+            }
+        }
+        obj->verts.update();
+        obj->points.update();
+        obj->lines.update();
+        obj->tris.update();
+        obj->quads.update();
+        obj->loops.update();
+        obj->polys.update();
+        obj->edges.update();
+        obj->uvs.update();
+        if (*it++ == '1') {
+            obj->mtl = std::make_shared<MaterialObject>();
+            obj->mtl->deserialize(it);
+        }
+        return obj;
+    }
     decodeAttrVector(obj->verts, it);
     decodeAttrVector(obj->points, it);
     decodeAttrVector(obj->lines, it);
@@ -93,15 +364,41 @@ std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it) {
 
 bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it);
 bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    encodeAttrVector(obj->verts, it);
-    encodeAttrVector(obj->points, it);
-    encodeAttrVector(obj->lines, it);
-    encodeAttrVector(obj->tris, it);
-    encodeAttrVector(obj->quads, it);
-    encodeAttrVector(obj->loops, it);
-    encodeAttrVector(obj->polys, it);
-    encodeAttrVector(obj->edges, it);
-    encodeAttrVector(obj->uvs, it);
+    auto const &opts = codecOptions();
+    if (opts.compress) {
+        std::vector<Column> cols;
+        collectColumnsV2(obj->verts, cols);
+        collectColumnsV2(obj->points, cols);
+        collectColumnsV2(obj->lines, cols);
+        collectColumnsV2(obj->tris, cols);
+        collectColumnsV2(obj->quads, cols);
+        collectColumnsV2(obj->loops, cols);
+        collectColumnsV2(obj->polys, cols);
+        collectColumnsV2(obj->edges, cols);
+        collectColumnsV2(obj->uvs, cols);
+        forEachColumn(cols, packColumn, opts);
+        it = std::copy_n((char const *)&kCodecV2Magic, sizeof(kCodecV2Magic), it);
+        Column const *col = cols.data();
+        writeColumnsV2(obj->verts, col, it);
+        writeColumnsV2(obj->points, col, it);
+        writeColumnsV2(obj->lines, col, it);
+        writeColumnsV2(obj->tris, col, it);
+        writeColumnsV2(obj->quads, col, it);
+        writeColumnsV2(obj->loops, col, it);
+        writeColumnsV2(obj->polys, col, it);
+        writeColumnsV2(obj->edges, col, it);
+        writeColumnsV2(obj->uvs, col, it);
+    } else {
+        encodeAttrVector(obj->verts, it);
+        encodeAttrVector(obj->points, it);
+        encodeAttrVector(obj->lines, it);
+        encodeAttrVector(obj->tris, it);
+        encodeAttrVector(obj->quads, it);
+        encodeAttrVector(obj->loops, it);
+        encodeAttrVector(obj->polys, it);
+        encodeAttrVector(obj->edges, it);
+        encodeAttrVector(obj->uvs, it);
+    }
     if (obj->mtl) {
         *it++ = '1';
         for (char c: obj->mtl->serialize())
@@ -0,0 +1,220 @@
+#include <zeno/funcs/PrimTopology.h>
+#include <zeno/para/parallel_for.h>
+#include <zeno/para/parallel_chunks.h>
+#include <zeno/para/parallel_scan.h>
+#include <zeno/para/parallel_sort.h>
+#include <zeno/utils/Error.h>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+
+namespace zeno {
+
+namespace {
+
+constexpr std::size_t kStampBlock = 1 << 16;
+
+std::uint64_t hashCombine(std::uint64_t h, std::uint64_t x) {
+    return h ^ (x + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+}
+
+// FNV-1a over the 32-bit words of each block in parallel, blocks combined in order
+template <class T>
+std::uint64_t hashArray(std::vector<T> const &arr) {
+    static_assert(sizeof(T) % sizeof(std::uint32_t) == 0);
+    auto words = reinterpret_cast<std::uint32_t const *>(arr.data());
+    std::size_t n = arr.size() * (sizeof(T) / sizeof(std::uint32_t));
+    std::vector<std::uint64_t> blockHash((n + kStampBlock - 1) / kStampBlock);
+    parallel_for(blockHash.size(), [&] (std::size_t b) {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        for (std::size_t i = b * kStampBlock, ie = std::min(n, i + kStampBlock); i < ie; i++) {
+            h = (h ^ words[i]) * 0x100000001b3ull;
+        }
+        blockHash[b] = h;
+    }, 1);
+    std::uint64_t h = n;
+    for (auto bh: blockHash) {
+        h = hashCombine(h, bh);
+    }
+    return h;
+}
+
+// start[k] = first i with key(i) >= k, for k in [0, nbuckets], keys ascending
+template <class KeyAt>
+void fillStarts(std::vector<int> &start, int nbuckets, std::size_t n, KeyAt const &keyAt) {
+    start.resize(nbuckets + 1);
+    parallel_for(n + 1, [&] (std::size_t i) {
+        int lo = i ? keyAt(i - 1) + 1 : 0;
+        int hi = i < n ? keyAt(i) : nbuckets;
+        for (int k = lo; k <= hi; k++) {
+            start[k] = (int)i;
+        }
+    });
+}
+
+std::shared_ptr<PrimTopology const> buildTopology(PrimitiveObject const *prim, std::uint64_t stamp) {
+    auto topo = std::make_shared<PrimTopology>();
+    topo->stamp = stamp;
+    int nv = (int)prim->verts.size();
+    int nt = (int)prim->tris.size();
+    int nq = (int)prim->quads.size();
+    int nf = nt + nq + (int)prim->polys.size();
+    topo->numVerts = nv;
+    topo->numFaces = nf;
+
+    auto &faceStart = topo->faceStart;
+    faceStart.resize(nf + 1);
+    int nh = parallel_exclusive_scan(0, nf, faceStart.begin(), 0, std::plus<int>(), [&] (int f) {
+        return f < nt ? 3 : f < nt + nq ? 4 : prim->polys[f - nt - nq][1];
+    });
+    faceStart[nf] = nh;
+
+    auto &heVert = topo->heVert;
+    auto &heFace = topo->heFace;
+    heVert.resize(nh);
+    heFace.resize(nh);
+    std::atomic<bool> outOfRange{false};
+    parallel_for(nf, [&] (int f) {
+        int h = faceStart[f];
+        auto corner = [&] (int v) {
+            if ((unsigned)v >= (unsigned)nv)
+                outOfRange.store(true, std::memory_order_relaxed);
+            heVert[h] = v;
+            heFace[h] = f;
+            h++;
+        };
+        if (f < nt) {
+            auto const &ind = prim->tris[f];
+            corner(ind[0]), corner(ind[1]), corner(ind[2]);
+        } else if (f < nt + nq) {
+            auto const &ind = prim->quads[f - nt];
+            corner(ind[0]), corner(ind[1]), corner(ind[2]), corner(ind[3]);
+        } else {
+            auto [start, len] = prim->polys[f - nt - nq];
+            for (int l = start; l < start + len; l++) {
+                corner(prim->loops[l]);
+            }
+        }
+    });
+    if (outOfRange)
+        throw makeError("face refers to a vertex out of range");
+
+    // vertex -> outgoing half-edges: a stable sort by vertex keeps them ascending
+    std::vector<std::uint32_t> keys(heVert.begin(), heVert.end());
+    auto &vertHalfedges = topo->vertHalfedges;
+    vertHalfedges.resize(nh);
+    std::iota(vertHalfedges.begin(), vertHalfedges.end(), 0);
+    parallel_radix_sort_by_key(keys, vertHalfedges);
+    fillStarts(topo->vertStart, nv, keys.size(), [&] (std::size_t i) { return (int)keys[i]; });
+    keys = {};
+
+    auto &vertStart = topo->vertStart;
+    auto &vertFaces = topo->vertFaces;
+    vertFaces.resize(nh);
+    parallel_for(nh, [&] (int i) {
+        vertFaces[i] = heFace[vertHalfedges[i]];
+    });
+
+    auto &heTwin = topo->heTwin;
+    heTwin.resize(nh);
+    parallel_for(nh, [&] (int h) {
+        int a = heVert[h], b = topo->dest(h);
+        int twin = -1;
+        for (int i = vertStart[b]; i < vertStart[b + 1]; i++) {
+            int h2 = vertHalfedges[i];
+            if (h2 != h && topo->dest(h2) == a) {
+                twin = h2;
+                break;
+            }
+        }
+        heTwin[h] = twin;
+    });
+
+    // vertex -> vertex: the ends of the edges around each vertex plus its
+    // lines, sorted and deduplicated per vertex; counted, then filled
+    int nl = (int)prim->lines.size();
+    std::vector<int> lineStart, lineOther;
+    if (nl) {
+        std::vector<std::uint32_t> lineKeys(2 * (std::size_t)nl);
+        lineOther.resize(2 * (std::size_t)nl);
+        parallel_for(nl, [&] (int l) {
+            auto [a, b] = prim->lines[l];
+            if ((unsigned)a >= (unsigned)nv || (unsigned)b >= (unsigned)nv)
+                outOfRange.store(true, std::memory_order_relaxed);
+            lineKeys[2 * l] = a, lineOther[2 * l] = b;
+            lineKeys[2 * l + 1] = b, lineOther[2 * l + 1] = a;
+        });
+        if (outOfRange)
+            throw makeError("line refers to a vertex out of range");
+        parallel_radix_sort_by_key(lineKeys, lineOther);
+        fillStarts(lineStart, nv, lineKeys.size(), [&] (std::size_t i) { return (int)lineKeys[i]; });
+    }
+    auto gather = [&] (int v, std::vector<int> &buf) {
+        buf.clear();
+        for (int i = vertStart[v]; i < vertStart[v + 1]; i++) {
+            int h = vertHalfedges[i];
+            buf.push_back(topo->dest(h));
+            buf.push_back(heVert[topo->prev(h)]);
+        }
+        if (nl) {
+            buf.insert(buf.end(), lineOther.begin() + lineStart[v], lineOther.begin() + lineStart[v + 1]);
+        }
+        std::sort(buf.begin(), buf.end());
+        buf.erase(std::unique(buf.begin(), buf.end()), buf.end());
+        buf.erase(std::remove(buf.begin(), buf.end(), v), buf.end());
+    };
+    std::vector<int> neighCount(nv);
+    parallel_chunks(nv, 0, [&] (std::size_t b, std::size_t e) {
+        std::vector<int> buf;
+        for (int v = (int)b; v < (int)e; v++) {
+            gather(v, buf);
+            neighCount[v] = (int)buf.size();
+        }
+    });
+    auto &neighStart = topo->neighStart;
+    neighStart.resize(nv + 1);
+    neighStart[nv] = parallel_exclusive_scan(0, nv, neighStart.begin(), 0, std::plus<int>(), [&] (int v) {
+        return neighCount[v];
+    });
+    neighCount = {};
+    auto &neighVerts = topo->neighVerts;
+    neighVerts.resize(neighStart[nv]);
+    parallel_chunks(nv, 0, [&] (std::size_t b, std::size_t e) {
+        std::vector<int> buf;
+        for (int v = (int)b; v < (int)e; v++) {
+            gather(v, buf);
+            std::copy(buf.begin(), buf.end(), neighVerts.begin() + neighStart[v]);
+        }
+    });
+
+    return topo;
+}
+
+}
+
+ZENO_API std::uint64_t primTopologyStamp(PrimitiveObject const *prim) {
+    std::uint64_t h = prim->verts.size();
+    h = hashCombine(h, hashArray(prim->lines.values.get()));
+    h = hashCombine(h, hashArray(prim->tris.values.get()));
+    h = hashCombine(h, hashArray(prim->quads.values.get()));
+    h = hashCombine(h, hashArray(prim->loops.values.get()));
+    h = hashCombine(h, hashArray(prim->polys.values.get()));
+    return h;
+}
+
+ZENO_API std::shared_ptr<PrimTopology const> primBuildTopology(PrimitiveObject const *prim) {
+    return buildTopology(prim, primTopologyStamp(prim));
+}
+
+ZENO_API std::shared_ptr<PrimTopology const> primTopology(PrimitiveObject const *prim) {
+    auto stamp = primTopologyStamp(prim);
+    auto topo = std::atomic_load(&prim->topologyCache);
+    if (topo && topo->stamp == stamp)
+        return topo;
+    topo = buildTopology(prim, stamp);
+    std::atomic_store(&prim->topologyCache, topo);
+    return topo;
+}
+
+}
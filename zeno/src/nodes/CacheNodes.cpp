@@ -10,6 +10,10 @@
 namespace zeno {
 
 struct CachedByKey : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     std::map<std::string, std::shared_ptr<IObject>> cache;
 
     virtual void preApply() override {
@@ -38,6 +42,10 @@ ZENDEFNODE(CachedByKey, {
 
 
 struct CachedIf : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     bool m_done = false;
 
     virtual void preApply() override {
@@ -69,6 +77,10 @@ ZENDEFNODE(CachedIf, {
 
 
 struct CachedOnce : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     bool m_done = false;
 
     virtual void preApply() override {
@@ -92,6 +104,10 @@ ZENDEFNODE(CachedOnce, {
 });
 
 struct CacheLastFrameBegin : zeno::INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     std::shared_ptr<IObject> m_lastFrameCache = nullptr;
 
     virtual void apply() override { 
@@ -118,6 +134,10 @@ ZENO_DEFNODE(CacheLastFrameBegin)(
 
 
 struct CacheLastFrameEnd : zeno::INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     CacheLastFrameBegin* m_CacheLastFrameBegin;
 
     virtual void apply() override {
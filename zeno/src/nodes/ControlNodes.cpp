@@ -4,7 +4,11 @@
 #include <zeno/types/DummyObject.h>
 #include <zeno/extra/ContextManaged.h>
 #include <zeno/extra/evaluate_condition.h>
+#include <zeno/extra/ISubgraphNode.h>
+#include <zeno/extra/SubnetNode.h>
+#include <zeno/para/parallel_for.h>
 #include <zeno/utils/safe_at.h>
+#include <zeno/utils/log.h>
 
 namespace zeno {
 
@@ -19,6 +23,10 @@ protected:
     virtual void execute() = 0;
 
 public:
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     void breakThisFor() {
         m_is_break = true;
     }
@@ -32,6 +40,16 @@ public:
         update();
     }
 
+    // number of iterations fixed by execute(), -1 if it depends on the loop body
+    virtual int iterationCount() const {
+        return -1;
+    }
+
+    // the outputs update() would set for iteration i, without advancing the loop
+    virtual std::map<std::string, zany> iterationOutputs(int i) const {
+        return outputs;
+    }
+
     virtual void apply() override final {
         //if (!m_updated)
             //throw makeError("BeginFor and EndFor not enclosed! "
@@ -66,6 +84,18 @@ struct BeginFor : IBeginFor {
         set_output("index", std::move(ret));
         m_index++;
     }
+
+    virtual int iterationCount() const override {
+        return m_count;
+    }
+
+    virtual std::map<std::string, zany> iterationOutputs(int i) const override {
+        auto outs = outputs;
+        auto ret = std::make_shared<zeno::NumericObject>();
+        ret->set(i);
+        outs["index"] = std::move(ret);
+        return outs;
+    }
 };
 
 ZENDEFNODE(BeginFor, {
@@ -76,9 +106,44 @@ ZENDEFNODE(BeginFor, {
 });
 
 
+struct BreakFor : zeno::INode {
+    virtual void apply() override {
+        auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of BreakFor");
+        auto fore = dynamic_cast<IBeginFor *>(graph->nodes.at(sn).get());
+        if (!fore) {
+            throw Exception("BreakFor::FOR must be conn to BeginFor::FOR!\n");
+        }
+        if (!has_input("breaks") || get_input2<bool>("breaks")) {
+            fore->breakThisFor();  // will still keep going the rest of loop body? yes
+        }
+    }
+
+    //virtual void apply() override {}
+};
+
+ZENDEFNODE(BreakFor, {
+    {"FOR", {"bool", "breaks", "1"}},
+    {},
+    {},
+    {"control"},
+});
+
+// holds the values a parallel loop body reads from outside of it
+struct LoopInput : zeno::INode {
+    virtual void apply() override {}
+};
+
 struct EndFor : zeno::ContextManagedNode {
     virtual void post_do_apply() {}
 
+    // the bound inputs of one iteration (but FOR), given in index order by the parallel loop
+    virtual void collect_iteration(std::map<std::string, zany> const &ins) {}
+
+    // why the iterations can't run independently, nullptr if they can
+    virtual const char *serial_reason() const {
+        return nullptr;
+    }
+
     virtual void preApply() override {
         auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of EndFor");
         auto fore = dynamic_cast<IBeginFor *>(graph->nodes.at(sn).get());
@@ -86,6 +151,8 @@ struct EndFor : zeno::ContextManagedNode {
             throw Exception("EndFor::FOR must be conn to BeginFor::FOR!\n");
         }
         graph->applyNode(sn);
+        if (has_input("parallel:") && get_param<bool>("parallel") && parallel_apply(sn, fore))
+            return;
         std::unique_ptr<zeno::Context> old_ctx = nullptr;
         while (fore->checkIsContinue()) {
             fore->doUpdate();
@@ -101,39 +168,194 @@ struct EndFor : zeno::ContextManagedNode {
         }
     }
 
-    virtual void apply() override {}
-};
-
-ZENDEFNODE(EndFor, {
-    {"FOR"},
-    {},
-    {},
-    {"control"},
-});
+    // runs each iteration on its own copy of the loop body, concurrently; returns
+    // false without running anything when the body has to be run serially
+    bool parallel_apply(std::string const &forId, IBeginFor *fore) {
+        auto serial = [&] (std::string const &why) {
+            log_warn("{}: {}, running the loop serially", myname, why);
+            return false;
+        };
+        if (auto why = serial_reason())
+            return serial(why);
+        int count = fore->iterationCount();
+        if (count < 0)
+            return serial("the iteration count depends on the loop body");
+
+        // the body: nodes upstream of us not evaluated yet, they would be re-run every iteration
+        std::set<std::string> body;
+        std::vector<std::string> stack;
+        for (auto const &[ds, bound]: inputBounds)
+            stack.push_back(bound.first);
+        while (!stack.empty()) {
+            auto id = std::move(stack.back());
+            stack.pop_back();
+            if (id == forId || id == myname || graph->ctx->visited.count(id) || !body.insert(id).second)
+                continue;
+            for (auto const &[ds, bound]: safe_at(graph->nodes, id, "node name")->inputBounds)
+                stack.push_back(bound.first);
+        }
 
+        // nodes not depending on the loop are hoisted out and evaluated once, the lazy ones
+        // (non-schedulable) may read state set by the body and are kept in it, which makes
+        // the loop run serially below
+        std::map<std::string, bool> variant;
+        auto isVariant = [&] (auto &&self, std::string const &id) -> bool {
+            if (id == forId)
+                return true;
+            if (!body.count(id))
+                return false;
+            if (auto it = variant.find(id); it != variant.end())
+                return it->second;
+            variant[id] = false;  // also breaks cycles
+            auto node = graph->nodes.at(id).get();
+            bool ret = !node->isSchedulable();
+            for (auto const &[ds, bound]: node->inputBounds)
+                ret = self(self, bound.first) || ret;
+            return variant[id] = ret;
+        };
+        std::set<std::string> hoisted;
+        for (auto const &id: body) {
+            if (!isVariant(isVariant, id))
+                hoisted.insert(id);
+        }
+        for (auto const &id: hoisted)
+            body.erase(id);
+
+        for (auto const &id: body) {
+            auto node = graph->nodes.at(id).get();
+            if (dynamic_cast<BreakFor *>(node))
+                return serial("BreakFor " + id + " in the loop body");
+            if (dynamic_cast<SubnetNode *>(node) || dynamic_cast<ISubgraphNode *>(node))
+                return serial("subgraph " + id + " in the loop body can't be copied");
+            // portals, caches and other lazy nodes look up nodes outside of the copied body
+            // or keep state from one iteration to the next
+            if (!node->isSchedulable())
+                return serial(id + " in the loop body can't run outside of the serial loop");
+            if (!node->isMemoizable())
+                return serial(id + " in the loop body has hidden state or side effects");
+        }
 
-struct BreakFor : zeno::INode {
-    virtual void apply() override {
-        auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of BreakFor");
-        auto fore = dynamic_cast<IBeginFor *>(graph->nodes.at(sn).get());
-        if (!fore) {
-            throw Exception("BreakFor::FOR must be conn to BeginFor::FOR!\n");
+        // everything read from outside is copied for every iteration, as the body may modify
+        // it in place; objects that can't be copied would be shared between threads
+        std::map<std::string, std::set<std::string>> externals;
+        for (auto const &id: body) {
+            for (auto const &[ds, bound]: graph->nodes.at(id)->inputBounds) {
+                if (bound.first != forId && !body.count(bound.first))
+                    externals[bound.first].insert(bound.second);
+            }
         }
-        if (!has_input("breaks") || get_input2<bool>("breaks")) {
-            fore->breakThisFor();  // will still keep going the rest of loop body? yes
+        for (auto const &[ds, bound]: inputBounds) {
+            if (hoisted.count(bound.first))
+                graph->applyNode(bound.first);
         }
+        for (auto const &[id, sockets]: externals) {
+            graph->applyNode(id);
+            for (auto const &ss: sockets) {
+                auto obj = external_output(id, ss);
+                if (obj && !obj->clone())
+                    return serial("input " + id + ":" + ss + " of the loop body can't be copied");
+            }
+        }
+
+        log_debug("{}: running {} iterations of {} nodes in parallel", myname, count, body.size());
+        std::vector<std::map<std::string, zany>> results(count);
+        std::shared_ptr<Graph> lastGraph;
+        parallel_for(count, [&] (int i) {
+            auto g = std::make_shared<Graph>();
+            g->session = graph->session;
+            g->subgraphNode = graph->subgraphNode;
+            g->portalIns = graph->portalIns;
+            g->portals = graph->portals;
+            g->subInputNodes = graph->subInputNodes;
+            g->subOutputNodes = graph->subOutputNodes;
+            g->releaseOutputs = false;
+            g->ctx = std::make_unique<Context>();
+            g->ctx->depth = graph->ctx->depth + 1;
+
+            auto addInput = [&] (std::string const &id, std::map<std::string, zany> outs) {
+                auto node = std::make_unique<LoopInput>();
+                node->graph = g.get();
+                node->myname = id;
+                node->outputs = std::move(outs);
+                g->nodes[id] = std::move(node);
+                g->ctx->visited.insert(id);
+            };
+            auto forOuts = fore->iterationOutputs(i);
+            addInput(forId, forOuts);
+            for (auto const &[id, sockets]: externals) {
+                std::map<std::string, zany> outs;
+                for (auto const &ss: sockets) {
+                    if (auto obj = external_output(id, ss))
+                        outs[ss] = obj->clone();
+                }
+                addInput(id, std::move(outs));
+            }
+            for (auto const &id: body) {
+                auto orig = graph->nodes.at(id).get();
+                auto node = orig->nodeClass->new_instance();
+                node->graph = g.get();
+                node->myname = id;
+                node->nodeClass = orig->nodeClass;
+                node->inputBounds = orig->inputBounds;
+                for (auto const &[ds, obj]: orig->inputs) {
+                    if (!orig->inputBounds.count(ds))
+                        node->inputs[ds] = obj;  // literal values and params
+                }
+                node->kframes = orig->kframes;
+                node->formulas = orig->formulas;
+                node->doComplete();
+                g->nodes[id] = std::move(node);
+            }
+
+            auto &ins = results[i];
+            for (auto const &[ds, bound]: inputBounds) {
+                if (ds == "FOR")
+                    continue;
+                if (body.count(bound.first)) {
+                    g->applyNode(bound.first);
+                    ins[ds] = g->getNodeOutput(bound.first, bound.second);
+                } else if (bound.first == forId) {
+                    ins[ds] = safe_at(forOuts, bound.second, "output socket name of node " + forId);
+                } else {
+                    ins[ds] = graph->getNodeOutput(bound.first, bound.second);
+                }
+            }
+            if (i == count - 1)
+                lastGraph = std::move(g);
+        }, 1);
+
+        for (auto const &ins: results)
+            collect_iteration(ins);
+        if (lastGraph) {
+            // like the serial loop, the nodes of the last iteration stay valid for outside refs
+            for (auto const &id: body) {
+                graph->nodes.at(id)->outputs = std::move(lastGraph->nodes.at(id)->outputs);
+                graph->ctx->visited.insert(id);
+            }
+            fore->outputs = fore->iterationOutputs(count - 1);
+        }
+        return true;
     }
 
-    //virtual void apply() override {}
+    zany external_output(std::string const &id, std::string const &ss) const {
+        auto node = graph->nodes.at(id).get();
+        if (node->muted_output)
+            return node->muted_output;
+        auto it = node->outputs.find(ss);
+        return it != node->outputs.end() ? it->second : nullptr;
+    }
+
+    virtual void apply() override {}
 };
 
-ZENDEFNODE(BreakFor, {
-    {"FOR", {"bool", "breaks", "1"}},
-    {},
+ZENDEFNODE(EndFor, {
+    {"FOR"},
     {},
+    {{"bool", "parallel", "0"}},
     {"control"},
 });
 
+
 struct BeginForEach : IBeginFor {
     int m_index = 0;
     std::shared_ptr<zeno::ListObject> m_list;
@@ -161,6 +383,19 @@ struct BeginForEach : IBeginFor {
         if (m_accumate)
             set_output("accumate", std::move(m_accumate));
     }
+
+    virtual int iterationCount() const override {
+        return m_accumate ? -1 : (int)m_list->arr.size();
+    }
+
+    virtual std::map<std::string, zany> iterationOutputs(int i) const override {
+        auto outs = outputs;
+        auto ret = std::make_shared<zeno::NumericObject>();
+        ret->set(i);
+        outs["index"] = std::move(ret);
+        outs["object"] = m_list->arr[i];
+        return outs;
+    }
 };
 
 ZENDEFNODE(BeginForEach, {
@@ -174,30 +409,35 @@ struct EndForEach : EndFor {
     std::vector<zany> result;
     std::vector<zany> dropped_result;
 
-    virtual void post_do_apply() override {
+    virtual const char *serial_reason() const override {
+        if (inputBounds.count("accumate"))
+            return "accumate carries values from one iteration to the next";
+        return nullptr;
+    }
+
+    virtual void collect_iteration(std::map<std::string, zany> const &ins) override {
         bool accept = true;
-        if (requireInput("accept")) {
-            accept = evaluate_condition(get_input("accept").get());
+        if (auto it = ins.find("accept"); it != ins.end()) {
+            accept = evaluate_condition(it->second.get());
         }
-        if (requireInput("object")) {
-            auto obj = get_input("object");
-            if (accept)
-                result.push_back(std::move(obj));
-            else
-                dropped_result.push_back(std::move(obj));
+        auto &dest = accept ? result : dropped_result;
+        if (auto it = ins.find("object"); it != ins.end()) {
+            dest.push_back(it->second);
         }
-        if (requireInput("list")) {
-            if (accept) {
-                auto listObj = get_input<zeno::ListObject>("list");
-                for(auto obj : listObj->arr)
-                    result.push_back(std::move(obj));
-            }
-            else{
-                auto listObj = get_input<zeno::ListObject>("list");
-                for(auto obj : listObj->arr)
-                    dropped_result.push_back(std::move(obj));
-            }
+        if (auto it = ins.find("list"); it != ins.end()) {
+            auto listObj = safe_dynamic_cast<ListObject>(it->second, "input socket list of EndForEach");
+            for (auto const &obj: listObj->arr)
+                dest.push_back(obj);
         }
+    }
+
+    virtual void post_do_apply() override {
+        std::map<std::string, zany> ins;
+        for (auto const &ds: {"accept", "object", "list"}) {
+            if (requireInput(ds))
+                ins[ds] = get_input(ds);
+        }
+        collect_iteration(ins);
         if (requireInput("accumate")) {
             auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of EndForEach");
             auto fore = dynamic_cast<BeginForEach *>(graph->nodes.at(sn).get());
@@ -243,7 +483,7 @@ struct EndForEach : EndFor {
 ZENDEFNODE(EndForEach, {
     {"object", "list", "accumate", {"bool", "accept", "1"}, "FOR"},
     {"list", "droppedList", "accumate"},
-    {{"bool", "doConcat", "0"}},
+    {{"bool", "doConcat", "0"}, {"bool", "parallel", "0"}},
     {"control"},
 });
 
@@ -323,6 +563,10 @@ ZENDEFNODE(SubstepDt, {
 
 
 struct IfElse : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     virtual void preApply() override {
         requireInput("cond");
         auto cond = get_input("cond");
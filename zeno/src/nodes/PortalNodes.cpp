@@ -9,6 +9,10 @@
 namespace zeno {
 
 struct PortalIn : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     virtual void complete() override {
         auto name = get_param<std::string>("name");
         graph->portalIns[name] = this->myname;
@@ -29,6 +33,10 @@ ZENDEFNODE(PortalIn, {
 });
 
 struct PortalOut : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto name = get_param<std::string>("name");
         auto depnode = zeno::safe_at(graph->portalIns, name, "PortalIn");
@@ -89,7 +97,7 @@ ZENDEFNODE(Stamp, {
 struct Clone : zeno::INode {
     virtual void apply() override {
         auto obj = get_input("object");
-        auto newobj = obj->clone();
+        auto newobj = obj->shared_clone();
         if (!newobj) {
             log_error("requested object doesn't support clone");
             return;
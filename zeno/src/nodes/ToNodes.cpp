@@ -12,6 +12,10 @@ namespace zeno {
 namespace {
 
 struct ToView : zeno::INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     virtual void complete() override {
         log_debug("ToView: {}", myname);
         graph->nodesToExec.insert(myname);
@@ -109,6 +113,10 @@ ZENDEFNODE(HelperMute, {
 });
 
 struct HelperOnce : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     bool m_done = false;
 
     virtual void preApply() override {
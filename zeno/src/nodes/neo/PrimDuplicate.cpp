@@ -131,7 +131,7 @@ ZENO_API std::shared_ptr<PrimitiveObject> primDuplicate(PrimitiveObject *parsPri
     copyattr(prim->verts, meshPrim->verts, parsPrim->verts);
     auto advanceinds = [&] (auto &primAttrs, auto &meshAttrs, auto &parsAttrs, size_t parsVertsSize, size_t meshVertsSize) {
         copyattr(primAttrs, meshAttrs, parsAttrs);
-        tg.add([&] {
+        tg.add([&, parsVertsSize, meshVertsSize] {
             parallel_for((size_t)0, parsVertsSize, [&] (size_t i) {
                 overloaded fixpairadd{
                     [] (auto &x, size_t y) {
@@ -3,60 +3,37 @@
 #include <zeno/funcs/PrimitiveUtils.h>
 #include <zeno/types/StringObject.h>
 #include <zeno/types/NumericObject.h>
-#include <zeno/utils/tuple_hash.h>
-#include <unordered_map>
+#include <zeno/para/parallel_for.h>
+#include <zeno/para/union_find.h>
 
 namespace zeno {
 
 ZENO_API void primMarkIsland(PrimitiveObject *prim, std::string tagAttr) {
     // Oh, I mean, Tesla was a great DJ
     auto &tagVert = prim->add_attr<int>(tagAttr);
-    auto m = tagVert.size();
-    std::vector<int> found(m);
-    for (int i = 0; i < m; i++) {
-        found[i] = i;
-    }
-    auto find = [&] (int i) {
-        while (i != found[i])
-            i = found[i];
-        return i;
-    };
-    for (int i = 0; i < prim->lines.size(); i++) {
+    concurrent_union_find uf(tagVert.size());
+    parallel_for(prim->lines.size(), [&] (size_t i) {
         auto ind = prim->lines[i];
-        int e0 = find(ind[0]);
-        int e1 = find(ind[1]);
-        found[e1] = e0;
-    }
-    for (int i = 0; i < prim->tris.size(); i++) {
+        uf.unite(ind[0], ind[1]);
+    });
+    parallel_for(prim->tris.size(), [&] (size_t i) {
         auto ind = prim->tris[i];
-        int e0 = find(ind[0]);
-        int e1 = find(ind[1]);
-        int e2 = find(ind[2]);
-        found[e1] = e0;
-        found[e2] = e0;
-    }
-    for (int i = 0; i < prim->quads.size(); i++) {
+        uf.unite(ind[0], ind[1]);
+        uf.unite(ind[0], ind[2]);
+    });
+    parallel_for(prim->quads.size(), [&] (size_t i) {
         auto ind = prim->quads[i];
-        int e0 = find(ind[0]);
-        int e1 = find(ind[1]);
-        int e2 = find(ind[2]);
-        int e3 = find(ind[3]);
-        found[e1] = e0;
-        found[e2] = e0;
-        found[e3] = e0;
-    }
-    for (int i = 0; i < prim->polys.size(); i++) {
+        uf.unite(ind[0], ind[1]);
+        uf.unite(ind[0], ind[2]);
+        uf.unite(ind[0], ind[3]);
+    });
+    parallel_for(prim->polys.size(), [&] (size_t i) {
         auto [base, len] = prim->polys[i];
-        if (len <= 1) continue;
-        int e0 = find(prim->loops[base]);
         for (int j = base + 1; j < base + len; j++) {
-            int ej = find(prim->loops[j]);
-            found[ej] = e0;
+            uf.unite(prim->loops[base], prim->loops[j]);
         }
-    }
-    for (int i = 0; i < m; i++) {
-        tagVert[i] = find(i);
-    }
+    });
+    uf.compact(tagVert.begin());
 }
 
 namespace {
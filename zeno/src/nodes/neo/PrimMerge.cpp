@@ -235,7 +235,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                   prim->polys.size())) {
                 auto nverts = prim->verts.size();
                 prim->points.resize(nverts);
-                parallel_for(nverts, [&points = prim->points.values](size_t i) { points[i] = i; });
+                parallel_for(nverts, [&points = prim->points.values.mut()](size_t i) { points[i] = i; });
             }
             ///
             total += prim->verts.size();
@@ -317,7 +317,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->verts.values;
+                        return outprim->verts.values.mut();
                     } else {
                         return outprim->verts.attr<T>(key);
                     }
@@ -328,7 +328,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->verts.values;
+                    auto &outarr = outprim->verts.values.mut();
                     size_t n = std::min(arr.size(), prim->verts.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = arr[i];
@@ -342,7 +342,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->verts.values);
+            core(std::true_type{}, prim->verts.values.mut());
             prim->verts.foreach_attr<AttrAcceptAll>(core);
             if (tag_on_vert && tagAttr.size()) {
                 auto &outarr = outprim->verts.attr<int>(tagAttr);
@@ -361,7 +361,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->points.values;
+                        return outprim->points.values.mut();
                     } else {
                         return outprim->points.attr<T>(key);
                     }
@@ -376,7 +376,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->points.values;
+                    auto &outarr = outprim->points.values.mut();
                     size_t n = std::min(arr.size(), prim->points.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -390,7 +390,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->points.values);
+            core(std::true_type{}, prim->points.values.mut());
             prim->points.foreach_attr<AttrAcceptAll>(core);
 //            if (tagAttr.size()) {
 //                auto &outarr = outprim->points.attr<int>(tagAttr);
@@ -409,7 +409,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->lines.values;
+                        return outprim->lines.values.mut();
                     } else {
                         return outprim->lines.attr<T>(key);
                     }
@@ -424,7 +424,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->lines.values;
+                    auto &outarr = outprim->lines.values.mut();
                     size_t n = std::min(arr.size(), prim->lines.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -438,7 +438,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->lines.values);
+            core(std::true_type{}, prim->lines.values.mut());
             prim->lines.foreach_attr<AttrAcceptAll>(core);
 //            if (tagAttr.size()) {
 //                auto &outarr = outprim->lines.attr<int>(tagAttr);
@@ -457,7 +457,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->tris.values;
+                        return outprim->tris.values.mut();
                     } else {
                         return outprim->tris.attr<T>(key);
                     }
@@ -472,7 +472,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->tris.values;
+                    auto &outarr = outprim->tris.values.mut();
                     size_t n = std::min(arr.size(), prim->tris.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -486,7 +486,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->tris.values);
+            core(std::true_type{}, prim->tris.values.mut());
             prim->tris.foreach_attr<AttrAcceptAll>(core);
             if (tag_on_face && tagAttr.size()) {
                 auto &outarr = outprim->tris.attr<int>(tagAttr);
@@ -505,7 +505,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->quads.values;
+                        return outprim->quads.values.mut();
                     } else {
                         return outprim->quads.attr<T>(key);
                     }
@@ -520,7 +520,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->quads.values;
+                    auto &outarr = outprim->quads.values.mut();
                     size_t n = std::min(arr.size(), prim->quads.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -534,7 +534,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->quads.values);
+            core(std::true_type{}, prim->quads.values.mut());
             prim->quads.foreach_attr<AttrAcceptAll>(core);
 //            if (tagAttr.size()) {
 //                auto &outarr = outprim->quads.attr<int>(tagAttr);
@@ -553,7 +553,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->loops.values;
+                        return outprim->loops.values.mut();
                     } else {
                         return outprim->loops.attr<T>(key);
                     }
@@ -568,7 +568,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->loops.values;
+                    auto &outarr = outprim->loops.values.mut();
                     size_t n = std::min(arr.size(), prim->loops.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -594,7 +594,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->loops.values);
+            core(std::true_type{}, prim->loops.values.mut());
             prim->loops.foreach_attr<AttrAcceptAll>(core);
 //            if (tagAttr.size()) {
 //                auto &outarr = outprim->loops.attr<int>(tagAttr);
@@ -610,7 +610,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
             auto core = [&](auto key, auto const &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->uvs.values;
+                    auto &outarr = outprim->uvs.values.mut();
                     size_t n = std::min(arr.size(), prim->uvs.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = arr[i];
@@ -623,7 +623,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                     }
                 }
             };
-            core(std::true_type{}, prim->uvs.values);
+            core(std::true_type{}, prim->uvs.values.mut());
             prim->uvs.foreach_attr<AttrAcceptAll>(core);
 //            if (tagAttr.size()) {
 //                auto &outarr = outprim->uvs.attr<int>(tagAttr);
@@ -642,7 +642,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
 #if 0
                 auto &outarr = [&] () -> auto & {
                     if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                        return outprim->polys.values;
+                        return outprim->polys.values.mut();
                     } else {
                         return outprim->polys.attr<T>(key);
                     }
@@ -657,7 +657,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->polys.values;
+                    auto &outarr = outprim->polys.values.mut();
                     size_t n = std::min(arr.size(), prim->polys.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = {arr[i][0] + (int)lbase, arr[i][1]};
@@ -671,7 +671,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #endif
             };
-            core(std::true_type{}, prim->polys.values);
+            core(std::true_type{}, prim->polys.values.mut());
             prim->polys.foreach_attr<AttrAcceptAll>(core);
             if (tag_on_face && tagAttr.size()) {
                 auto &outarr = outprim->polys.attr<int>(tagAttr);
@@ -6,11 +6,12 @@
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/arrayindex.h>
 #include <zeno/para/parallel_for.h>
-#include <zeno/utils/perlin.h>
+#include <zeno/utils/noise.h>
 #include <zeno/utils/vec.h>
 #include <zeno/utils/log.h>
 #include <cstring>
 #include <cstdlib>
+#include <vector>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -23,6 +24,7 @@ ZENO_API void primPerlinNoise(PrimitiveObject *prim, std::string inAttr, std::st
             using InT = std::decay_t<decltype(inArr[0])>;
             using OutT = decltype(outTypeId);
             auto &outArr = prim->add_attr<OutT>(outAttr);
+            std::vector<vec3f> pos(inArr.size());
             parallel_for((size_t)0, inArr.size(), [&] (size_t i) {
                 vec3f p;
                 InT inp = inArr[i];
@@ -39,21 +41,20 @@ ZENO_API void primPerlinNoise(PrimitiveObject *prim, std::string inAttr, std::st
                 } else {
                     throw makeError<TypeError>(typeid(vec3f), typeid(InT), "input type");
                 }
-                p = scale * (p - offset);
-                OutT o;
-                if constexpr (std::is_same_v<OutT, float>) {
-                    o = PerlinNoise::perlin(p, roughness, detail);
-                } else if constexpr (std::is_same_v<OutT, vec3f>) {
-                    o = {
-                        PerlinNoise::perlin(vec3f(p[0], p[1], p[2]), roughness, detail),
-                        PerlinNoise::perlin(vec3f(p[1], p[2], p[0]), roughness, detail),
-                        PerlinNoise::perlin(vec3f(p[2], p[0], p[1]), roughness, detail),
-                    };
-                } else {
-                    throw makeError<TypeError>(typeid(vec3f), typeid(OutT), "outType");
-                }
-                o = average + o * strength;
-                outArr[i] = o;
+                pos[i] = scale * (p - offset);
+            });
+            if (pos.empty())
+                return;
+            if constexpr (std::is_same_v<OutT, float>) {
+                noiseHashPerlin(pos.size(), NoisePoints(pos.data()), NoiseResults(outArr.data()), roughness, detail);
+            } else if constexpr (std::is_same_v<OutT, vec3f>) {
+                for (int k = 0; k < 3; k++)
+                    noiseHashPerlin(pos.size(), NoisePoints(pos.data(), k), NoiseResults(outArr[0].data() + k, 3), roughness, detail);
+            } else {
+                throw makeError<TypeError>(typeid(vec3f), typeid(OutT), "outType");
+            }
+            parallel_for((size_t)0, pos.size(), [&] (size_t i) {
+                outArr[i] = average + outArr[i] * strength;
             });
         }, enum_variant<std::variant<float, vec3f>>(array_index_safe({"float", "vec3f"}, outType, "outType")));
     });
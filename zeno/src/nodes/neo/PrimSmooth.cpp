@@ -1,23 +1,64 @@
 #include <zeno/para/parallel_for.h>
-#include <zeno/types/NumericObject.h>
 #include <zeno/types/PrimitiveObject.h>
-#include <zeno/types/PrimitiveUtils.h>
+#include <zeno/funcs/PrimTopology.h>
 #include <zeno/types/StringObject.h>
-#include <zeno/types/CurveObject.h>
-#include <zeno/utils/arrayindex.h>
-#include <zeno/utils/variantswitch.h>
-#include <zeno/extra/TempNode.h>
 #include <zeno/core/INode.h>
 #include <zeno/zeno.h>
-#include <limits>
+#include <vector>
 
 namespace zeno {
 namespace {
 
+// one umbrella step: each vertex moves by factor times the offset to the
+// average of its neighbours; isolated and pinned vertices stay put
+template <class T>
+void smoothStep(PrimTopology const &topo, std::vector<char> const &pinned, std::vector<T> const &src, std::vector<T> &dst, float factor) {
+    parallel_for(topo.numVerts, [&] (int v) {
+        int b = topo.neighStart[v], e = topo.neighStart[v + 1];
+        if (b == e || (!pinned.empty() && pinned[v])) {
+            dst[v] = src[v];
+            return;
+        }
+        T sum = src[topo.neighVerts[b]];
+        for (int i = b + 1; i < e; i++) {
+            sum += src[topo.neighVerts[i]];
+        }
+        dst[v] = src[v] + (sum * (1.0f / float(e - b)) - src[v]) * factor;
+    });
+}
+
 struct PrimSmooth : INode {
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
-        throw makeError("WIP");
+        auto attr = get_input2<std::string>("attr");
+        auto method = get_input2<std::string>("method");
+        auto iterations = get_input2<int>("iterations");
+        auto lambda = get_input2<float>("lambda");
+        auto mu = get_input2<float>("mu");
+        auto pinBoundary = get_input2<bool>("pinBoundary");
+
+        auto topo = primTopology(prim.get());
+        std::vector<char> pinned;
+        if (pinBoundary) {
+            pinned.resize(topo->numVerts);
+            parallel_for(topo->numVerts, [&] (int v) {
+                pinned[v] = topo->isBoundaryVert(v);
+            });
+        }
+
+        // Taubin: a shrinking step of lambda, then an inflating step of mu < -lambda
+        prim->verts.attr_visit(attr, [&] (auto &arr) {
+            auto tmp = arr;
+            for (int it = 0; it < iterations; it++) {
+                smoothStep(*topo, pinned, arr, tmp, lambda);
+                if (method == "taubin") {
+                    smoothStep(*topo, pinned, tmp, arr, mu);
+                } else {
+                    arr.swap(tmp);
+                }
+            }
+        });
+
         set_output("prim", std::move(prim));
     }
 };
@@ -25,6 +66,12 @@ struct PrimSmooth : INode {
 ZENDEFNODE(PrimSmooth, {
     {
     {"PrimitiveObject", "prim"},
+    {"string", "attr", "pos"},
+    {"enum laplacian taubin", "method", "taubin"},
+    {"int", "iterations", "10"},
+    {"float", "lambda", "0.5"},
+    {"float", "mu", "-0.53"},
+    {"bool", "pinBoundary", "0"},
     },
     {
     {"PrimitiveObject", "prim"},
@@ -27,7 +27,7 @@ struct PrimSort : INode {
       set_output("prim", std::move(prim));
     }
     else if (mode == "ByAttribute") {
-        auto &tris = prim->tris.values;
+        auto &tris = prim->tris.values.mut();
         std::vector<size_t> indices(prim->verts.size());
         std::iota(indices.begin(), indices.end(), 0);
         
@@ -3,155 +3,369 @@
 #include <zeno/funcs/PrimitiveUtils.h>
 #include <zeno/types/StringObject.h>
 #include <zeno/types/NumericObject.h>
-#include <unordered_map>
+#include <zeno/para/parallel_for.h>
+#include <zeno/para/parallel_chunks.h>
+#include <zeno/para/parallel_scan.h>
+#include <zeno/para/parallel_sort.h>
+#include <zeno/para/union_find.h>
+#include <zeno/utils/Error.h>
+#include <functional>
 #include <algorithm>
+#include <cstdint>
+#include <cmath>
 
 namespace zeno {
 namespace {
 
 template <class T>
-static void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
-    std::vector<T> newarr(arr.size());
-    for (int i = 0; i < revamp.size(); i++) {
+void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
+    std::vector<T> newarr(revamp.size());
+    parallel_for(revamp.size(), [&] (size_t i) {
         newarr[i] = arr[revamp[i]];
-    }
+    });
     std::swap(arr, newarr);
 }
 
-struct PrimWeld : INode {
-    virtual void apply() override {
-        auto prim = get_input<PrimitiveObject>("prim");
-        auto tagAttr = get_input<StringObject>("tagAttr")->get();
-        auto isAverage = get_input<StringObject>("method")->get() == "average";
+template <class T>
+void revamp_attrvec(AttrVector<T> &vec, std::vector<int> const &revamp) {
+    revamp_vector(vec.values.mut(), revamp);
+    vec.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
+        revamp_vector(arr, revamp);
+    });
+}
 
-        std::unordered_multimap<int, int> lut;
-        auto &tag = prim->verts.attr<int>(tagAttr);
-        for (int i = 0; i < prim->size(); i++) {
-            lut.insert({tag[i], i});
-        }
-        std::vector<int> revamp;
-        std::vector<int> unrevamp(prim->size());
-        revamp.resize(lut.size());
-        int nrevamp = 0;
-        for (auto it = lut.begin(); it != lut.end();) {
-            auto nit = std::find_if(std::next(it), lut.end(), [val = it->first] (auto const &p) {
-                return p.first != val;
-            });
-            auto start = it->second;
+// drop the elements (with their attributes) for which keep(i) is false
+template <class T, class Keep>
+void filter_attrvec(AttrVector<T> &vec, Keep const &keep) {
+    std::vector<uint8_t> flag(vec.size());
+    parallel_for(vec.size(), [&] (size_t i) {
+        flag[i] = keep(i);
+    });
+    std::vector<int> dest(vec.size());
+    int nkeep = parallel_exclusive_scan(size_t(0), vec.size(), dest.begin(), 0, std::plus<int>(), [&] (size_t i) {
+        return int(flag[i]);
+    });
+    if (nkeep == (int)vec.size())
+        return;
+    std::vector<int> revamp(nkeep);
+    parallel_for(vec.size(), [&] (size_t i) {
+        if (flag[i])
+            revamp[dest[i]] = int(i);
+    });
+    revamp_attrvec(vec, revamp);
+}
+
+// vertex order in which every group is contiguous, groups in label order and
+// vertices ascending within a group; start[g] is where group g begins
+void sort_groups(std::vector<int> const &label, int ngroups, std::vector<int> &order, std::vector<int> &start) {
+    size_t n = label.size();
+    std::vector<std::uint32_t> keys(n);
+    order.resize(n);
+    parallel_for(n, [&] (size_t i) {
+        keys[i] = label[i];
+        order[i] = int(i);
+    });
+    parallel_radix_sort_by_key(keys, order);
+    start.resize(ngroups + 1);
+    parallel_for(n, [&] (size_t i) {
+        if (i == 0 || keys[i] != keys[i - 1])
+            start[keys[i]] = int(i);
+    });
+    start[ngroups] = int(n);
+}
+
+// merge every group of vertices into one; groups are numbered by their
+// smallest vertex, whose attributes are kept unless isAverage
+void weld_groups(PrimitiveObject *prim, std::vector<int> const &label, int ngroups, bool isAverage) {
+    int n = (int)prim->verts.size();
+    std::vector<int> order, start;
+    sort_groups(label, ngroups, order, start);
+
+    auto weld = [&] (auto &arr) {
+        using T = std::decay_t<decltype(arr[0])>;
+        std::vector<T> newarr(ngroups);
+        parallel_for((size_t)ngroups, [&] (size_t g) {
+            T val = arr[order[start[g]]];
             if (isAverage) {
-                vec3f average = prim->verts[start];
-                int count = 1;
-                for (++it; it != nit; ++it) {
-                    unrevamp[it->second] = nrevamp;
-                    auto pos = prim->verts[it->second];
-                    average += pos;
-                    ++count;
-                }
-                average *= 1 / (float)count;
-                prim->verts[start] = average;
-            } else {
-                for (; it != nit; ++it) {
-                    //printf("(%d) %d -> %d\n", it->first, it->second, nrevamp);
-                    unrevamp[it->second] = nrevamp;
-                    // unrevamp[old_coor] = new_coor
-                }
+                for (int k = start[g] + 1; k < start[g + 1]; k++)
+                    val += arr[order[k]];
+                val = val / (decay_vec_t<T>)(start[g + 1] - start[g]);
             }
-            revamp[nrevamp] = start;
-            ++nrevamp;
-        }
-        revamp.resize(nrevamp);
-        //primRevampVerts(prim.get(), revamp, &unrevamp);
-
-        revamp_vector(prim->verts.values, revamp);
-        if (isAverage) {
-            prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                using T = std::decay_t<decltype(arr[0])>;
-                std::vector<T> new_arr(nrevamp);
-                for (size_t i = 0; i < arr.size(); i++) {
-                    new_arr[unrevamp[i]] += arr[i] / (T)lut.count(i);
-                }
-                arr = std::move(new_arr);
-            });
-        } else {
-            prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, revamp);
-            });
-        }
+            newarr[g] = val;
+        });
+        arr = std::move(newarr);
+    };
+    weld(prim->verts.values.mut());
+    prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
+        weld(arr);
+    });
 
-        auto repair = [&] (int &x) {
-            //printf("%d -> %d\n", x, unrevamp[x]);
-            if (x >= 0 && x < unrevamp.size())
-                x = unrevamp[x];
-        };
+    auto repair = [&] (int &x) {
+        if (x >= 0 && x < n)
+            x = label[x];
+    };
 
-        for (size_t i = 0; i < prim->points.size(); i++) {
-            auto &ind = prim->points[i];
-            repair(ind);
-        }
+    parallel_for(prim->points.size(), [&] (size_t i) {
+        repair(prim->points[i]);
+    });
 
-        for (size_t i = 0; i < prim->lines.size(); i++) {
-            auto &ind = prim->lines[i];
-            repair(ind[0]);
-            repair(ind[1]);
-        }
-        prim->lines->erase(std::remove_if(prim->lines.begin(), prim->lines.end(), [&] (auto const &ind) {
-            return ind[0] == ind[1];
-        }), prim->lines.end());
-        prim->lines.update();
+    parallel_for(prim->lines.size(), [&] (size_t i) {
+        auto &ind = prim->lines[i];
+        repair(ind[0]);
+        repair(ind[1]);
+    });
+    filter_attrvec(prim->lines, [&] (size_t i) {
+        auto ind = prim->lines[i];
+        return ind[0] != ind[1];
+    });
 
-        for (size_t i = 0; i < prim->tris.size(); i++) {
-            auto &ind = prim->tris[i];
-            repair(ind[0]);
-            repair(ind[1]);
-            repair(ind[2]);
-        }
-        prim->tris->erase(std::remove_if(prim->tris.begin(), prim->tris.end(), [&] (auto const &ind) {
-            return ind[0] == ind[1] || ind[0] == ind[2] || ind[1] == ind[2];
-        }), prim->tris.end());
+    parallel_for(prim->edges.size(), [&] (size_t i) {
+        auto &ind = prim->edges[i];
+        repair(ind[0]);
+        repair(ind[1]);
+    });
+    filter_attrvec(prim->edges, [&] (size_t i) {
+        auto ind = prim->edges[i];
+        return ind[0] != ind[1];
+    });
 
-        for (size_t i = 0; i < prim->quads.size(); i++) {
+    parallel_for(prim->tris.size(), [&] (size_t i) {
+        auto &ind = prim->tris[i];
+        repair(ind[0]);
+        repair(ind[1]);
+        repair(ind[2]);
+    });
+    filter_attrvec(prim->tris, [&] (size_t i) {
+        auto ind = prim->tris[i];
+        return ind[0] != ind[1] && ind[0] != ind[2] && ind[1] != ind[2];
+    });
+
+    if (prim->quads.size()) {
+        // quads that lost one corner become triangles (without face attributes)
+        std::vector<uint8_t> quadlen(prim->quads.size());
+        parallel_for(prim->quads.size(), [&] (size_t i) {
             auto &ind = prim->quads[i];
             repair(ind[0]);
             repair(ind[1]);
             repair(ind[2]);
             repair(ind[3]);
-        }
-        std::vector<uint8_t> ridquad(prim->quads.size());
-        auto ridquadit = ridquad.begin();
-        for (auto ind: prim->quads) {
             auto *bit = std::addressof(ind[0]);
-            auto *eit = bit + 4;
-            auto *mit = std::unique(bit, eit);
-            auto len = mit - bit;
-            //if (len != 4) printf("%d\n", len);
-            if (len == 3)
-                prim->tris.emplace_back(ind[0], ind[1], ind[2]);
-            *ridquadit++ = (len <= 3);
+            auto len = std::unique(bit, bit + 4) - bit;
+            if (len > 1 && bit[0] == bit[len - 1])
+                --len;
+            quadlen[i] = uint8_t(len);
+        });
+        std::vector<int> tridest(prim->quads.size());
+        int ntris = parallel_exclusive_scan(size_t(0), prim->quads.size(), tridest.begin(), 0, std::plus<int>(), [&] (size_t i) {
+            return int(quadlen[i] == 3);
+        });
+        if (ntris) {
+            size_t base = prim->tris.size();
+            prim->tris.resize(base + ntris);
+            parallel_for(prim->quads.size(), [&] (size_t i) {
+                if (quadlen[i] == 3) {
+                    auto ind = prim->quads[i];
+                    prim->tris[base + tridest[i]] = {ind[0], ind[1], ind[2]};
+                }
+            });
+        }
+        filter_attrvec(prim->quads, [&] (size_t i) {
+            return quadlen[i] == 4;
+        });
+    }
+
+    if (prim->polys.size()) {
+        parallel_for(prim->loops.size(), [&] (size_t i) {
+            repair(prim->loops[i]);
+        });
+        // a corner is kept unless it repeats the previous kept one, or the
+        // first one when it is the last
+        auto forEachCorner = [&] (vec2i const &poly, auto const &func) {
+            auto [base, len] = poly;
+            if (len <= 0)
+                return;
+            int last = base + len - 1;
+            while (last > base && prim->loops[last] == prim->loops[base])
+                --last;
+            func(base);
+            for (int j = base + 1; j <= last; j++) {
+                if (prim->loops[j] != prim->loops[j - 1])
+                    func(j);
+            }
+        };
+        std::vector<int> polylen(prim->polys.size());
+        parallel_for(prim->polys.size(), [&] (size_t i) {
+            int len = 0;
+            forEachCorner(prim->polys[i], [&] (int) { ++len; });
+            polylen[i] = len > 2 ? len : 0;
+        });
+        std::vector<int> newbase(prim->polys.size());
+        int nloops = parallel_exclusive_scan(size_t(0), prim->polys.size(), newbase.begin(), 0, std::plus<int>(), [&] (size_t i) {
+            return polylen[i];
+        });
+        std::vector<int> looprevamp(nloops);
+        parallel_for(prim->polys.size(), [&] (size_t i) {
+            if (!polylen[i])
+                return;
+            int k = newbase[i];
+            forEachCorner(prim->polys[i], [&] (int j) { looprevamp[k++] = j; });
+        });
+        revamp_attrvec(prim->loops, looprevamp);
+        parallel_for(prim->polys.size(), [&] (size_t i) {
+            prim->polys[i] = {newbase[i], polylen[i]};
+        });
+        filter_attrvec(prim->polys, [&] (size_t i) {
+            return polylen[i] != 0;
+        });
+    }
+}
+
+}
+
+ZENO_API void primWeld(PrimitiveObject *prim, std::string tagAttr, bool isAverage) {
+    auto const &tag = prim->verts.attr<int>(tagAttr);
+    size_t n = tag.size();
+    std::vector<std::uint32_t> keys(n);
+    std::vector<int> order(n);
+    parallel_for(n, [&] (size_t i) {
+        keys[i] = std::uint32_t(tag[i]) ^ 0x80000000u;
+        order[i] = int(i);
+    });
+    parallel_radix_sort_by_key(keys, order);
+    concurrent_union_find uf(n);
+    parallel_for((size_t)1, n, [&] (size_t i) {
+        if (keys[i] == keys[i - 1])
+            uf.unite(order[i - 1], order[i]);
+    });
+    std::vector<int> label(n);
+    int ngroups = uf.compact(label.begin());
+    weld_groups(prim, label, ngroups, isAverage);
+}
+
+ZENO_API void primWeldByDistance(PrimitiveObject *prim, float distance, bool isAverage) {
+    if (!(distance > 0))
+        throw makeError("weld distance must be positive, got " + std::to_string(distance));
+    size_t n = prim->verts.size();
+    float invDist = 1 / distance;
+    float dist2 = distance * distance;
+
+    // points are bucketed into cells of the weld distance, so a point can only
+    // weld with points of its own and the 26 surrounding cells; cell coords
+    // wrap at 2^21, distant cells sharing a key only cost extra comparisons
+    auto cellOf = [&] (vec3f const &p) {
+        vec3i c;
+        for (int k = 0; k < 3; k++) {
+            float f = std::floor(p[k] * invDist);
+            c[k] = std::abs(f) < 1e9f ? int(f) : 0;  // far-off, inf and nan points share cell 0
+        }
+        return c;
+    };
+    auto keyOf = [] (vec3i const &c) {
+        // biased so that the wrap is far from the origin
+        constexpr std::uint64_t m = (1 << 21) - 1, o = 1 << 20;
+        return (std::uint64_t(c[0] + o) & m) << 42 | (std::uint64_t(c[1] + o) & m) << 21 | (std::uint64_t(c[2] + o) & m);
+    };
+
+    std::vector<std::uint64_t> keys(n);
+    std::vector<int> order(n);
+    parallel_for(n, [&] (size_t i) {
+        keys[i] = keyOf(cellOf(prim->verts[i]));
+        order[i] = int(i);
+    });
+    parallel_radix_sort_by_key(keys, order);
+
+    std::vector<int> cellid(n);
+    int ncells = parallel_exclusive_scan(size_t(0), n, cellid.begin(), 0, std::plus<int>(), [&] (size_t i) {
+        return int(i == 0 || keys[i] != keys[i - 1]);
+    });
+    std::vector<std::uint64_t> cellKeys(ncells);
+    std::vector<int> cellStart(ncells + 1);
+    parallel_for(n, [&] (size_t i) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            cellKeys[cellid[i]] = keys[i];
+            cellStart[cellid[i]] = int(i);
         }
-        prim->tris.update();
-        prim->quads->erase(std::remove_if(prim->quads.begin(), prim->quads.end(), [&] (auto const &ind) {
-            return ridquad[std::addressof(ind) - prim->quads.data()];
-        }), prim->quads.end());
-        prim->quads.update();
-
-        for (size_t i = 0; i < prim->loops.size(); i++) {
-            auto &ind = prim->loops[i];
-            repair(ind);
+    });
+    cellStart[ncells] = int(n);
+
+    std::vector<vec3f> pos(n);
+    parallel_for(n, [&] (size_t i) {
+        pos[i] = prim->verts[order[i]];
+    });
+
+    concurrent_union_find uf(n);
+    auto weldCells = [&] (int c, int nc) {
+        for (int i = cellStart[c]; i < cellStart[c + 1]; i++) {
+            for (int j = nc == c ? i + 1 : cellStart[nc]; j < cellStart[nc + 1]; j++) {
+                if (lengthSquared(pos[j] - pos[i]) <= dist2)
+                    uf.unite(order[i], order[j]);
+            }
         }
-        for (auto &[base, len]: prim->polys) {
-            auto bit = prim->loops.begin() + base;
-            auto eit = prim->loops.begin() + (base + len);
-            auto mit = std::unique(bit, eit);
-            std::fill(mit, eit, 0); // not used anyway... prune later
-            len = mit - bit;
+    };
+    auto weldKeys = [&] (int c, std::size_t first, std::uint64_t hi) {
+        for (std::size_t nc = first; nc < cellKeys.size() && cellKeys[nc] <= hi; nc++)
+            weldCells(c, int(nc));
+    };
+    auto search = [&] (std::uint64_t key) {
+        return std::size_t(std::lower_bound(cellKeys.begin(), cellKeys.end(), key) - cellKeys.begin());
+    };
+    // each pair of neighbouring cells is visited from one side only: the cell
+    // above in z, and the z-columns at (0, 1), (1, -1), (1, 0), (1, 1) in x, y.
+    // along the sorted cells those columns move forward too, so they are
+    // followed with a cursor instead of searched for every cell
+    parallel_chunks((size_t)ncells, 0, [&] (size_t cb, size_t ce) {
+        static const vec3i columns[4] = {{0, 1, 0}, {1, -1, 0}, {1, 0, 0}, {1, 1, 0}};
+        std::size_t cursor[4];
+        std::uint64_t last[4];
+        for (int k = 0; k < 4; k++)
+            last[k] = ~std::uint64_t(0);
+        for (int c = int(cb); c < int(ce); c++) {
+            auto cell = cellOf(pos[cellStart[c]]);
+            weldCells(c, c);
+            auto up = keyOf(cell + vec3i(0, 0, 1));
+            weldKeys(c, up == cellKeys[c] + 1 ? c + 1 : search(up), up);
+            for (int k = 0; k < 4; k++) {
+                auto lo = keyOf(cell + columns[k] - vec3i(0, 0, 1));
+                auto hi = keyOf(cell + columns[k] + vec3i(0, 0, 1));
+                if (lo > hi) {  // z wraps around inside the column
+                    for (int dz = -1; dz <= 1; dz++) {
+                        auto key = keyOf(cell + columns[k] + vec3i(0, 0, dz));
+                        weldKeys(c, search(key), key);
+                    }
+                    continue;
+                }
+                if (lo < last[k] || last[k] == ~std::uint64_t(0)) {
+                    cursor[k] = search(lo);
+                } else {
+                    for (int steps = 0; cursor[k] < cellKeys.size() && cellKeys[cursor[k]] < lo; steps++) {
+                        if (steps == 8) {
+                            cursor[k] = std::size_t(std::lower_bound(cellKeys.begin() + cursor[k], cellKeys.end(), lo) - cellKeys.begin());
+                            break;
+                        }
+                        ++cursor[k];
+                    }
+                }
+                last[k] = lo;
+                weldKeys(c, cursor[k], hi);
+            }
         }
-        prim->polys->erase(std::remove_if(prim->polys.begin(), prim->polys.end(), [&] (auto const &ply) {
-            return ply[1] <= 2;
-        }), prim->polys.end());
-        prim->polys.update();
+    });
+    std::vector<int> label(n);
+    int ngroups = uf.compact(label.begin());
+    weld_groups(prim, label, ngroups, isAverage);
+}
 
-        prim->resize(nrevamp);
+namespace {
 
+struct PrimWeld : INode {
+    virtual void apply() override {
+        auto prim = get_input<PrimitiveObject>("prim");
+        auto isAverage = get_input<StringObject>("method")->get() == "average";
+        if (get_input<StringObject>("weldBy")->get() == "distance") {
+            primWeldByDistance(prim.get(), get_input2<float>("distance"), isAverage);
+        } else {
+            primWeld(prim.get(), get_input<StringObject>("tagAttr")->get(), isAverage);
+        }
         set_output("prim", std::move(prim));
     }
 };
@@ -161,6 +375,8 @@ ZENDEFNODE(PrimWeld, {
     {"PrimitiveObject", "prim"},
     {"string", "tagAttr", "weld"},
     {"enum oneof average", "method", "oneof"},
+    {"enum tag distance", "weldBy", "tag"},
+    {"float", "distance", "0.0001"},
     },
     {
     {"PrimitiveObject", "prim"},
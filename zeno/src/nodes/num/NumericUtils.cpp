@@ -37,6 +37,10 @@ ZENDEFNODE(UnpackNumericVec, {
 
 
 struct NumericRandom : INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto value = std::make_shared<NumericObject>();
         auto dim = get_param<int>("dim");
@@ -75,6 +79,10 @@ ZENDEFNODE(NumericRandom, {
 
 
 struct NumericRandomInt : INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto value = std::make_shared<NumericObject>();
         auto minVal = has_input("min") ?
@@ -97,6 +105,10 @@ ZENDEFNODE(NumericRandomInt, {
 
 
 struct SetRandomSeed : INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto seed = get_input<NumericObject>("seed")->get<int>();
         sfrand(seed);
@@ -117,6 +129,10 @@ ZENDEFNODE(SetRandomSeed, {
 
 
 struct NumericCounter : INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
     int counter = 0;
 
     virtual void apply() override {
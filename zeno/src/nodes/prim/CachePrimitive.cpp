@@ -8,6 +8,10 @@ namespace zeno {
 
 
 struct CachePrimitive : zeno::INode {
+    virtual bool isSchedulable() const override {
+        return false;
+    }
+
     int m_framecounter = 0;
 
     virtual void preApply() override {
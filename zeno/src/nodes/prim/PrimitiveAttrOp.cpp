@@ -93,6 +93,10 @@ ZENDEFNODE(PrimitivePrintAttr,
 
 // deprecated: use PrimitiveRandomAttr instead
 struct PrimitiveRandomizeAttr : INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
   virtual void apply() override {
     auto prim = get_input<PrimitiveObject>("prim");
     auto min = get_param<float>(("min"));
@@ -145,6 +149,10 @@ ZENDEFNODE(PrimitiveRandomizeAttr,
 
 
 struct PrimitiveRandomAttr : INode {
+    virtual bool isMemoizable() const override {
+        return false;
+    }
+
   virtual void apply() override {
     auto prim = has_input("prim") ?
         get_input<PrimitiveObject>("prim") :
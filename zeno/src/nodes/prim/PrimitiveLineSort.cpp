@@ -99,7 +99,7 @@ ZENO_API void primLineSort(PrimitiveObject *prim, bool reversed) {
             }*/
             std::swap(arr, newArr);
         };
-        revampvec(prim->verts.values);
+        revampvec(prim->verts.values.mut());
         prim->verts.foreach_attr([&] (auto const &key, auto &attr) {
             revampvec(attr);
         });
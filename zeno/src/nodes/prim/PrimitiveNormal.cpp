@@ -29,7 +29,7 @@ template <typename DstT, typename SrcT> constexpr auto reinterpret_bits(SrcT &&v
 ZENO_API void primCalcNormal(zeno::PrimitiveObject* prim, float flip, std::string nrmAttr)
 {
     auto &nrm = prim->add_attr<zeno::vec3f>(nrmAttr);
-    auto &pos = prim->verts.values;
+    auto &pos = prim->verts.values.mut();
 
 #if defined(_OPENMP) && defined(__GNUG__)
 #pragma omp parallel for
@@ -159,7 +159,7 @@ struct PrimitiveOrderVertexByNormal : zeno::INode{
     if(prim->tris.has_attr(nrmAttr))
     {
       auto &nrm = prim->tris.attr<zeno::vec3f>(nrmAttr);
-      auto &pos = prim->verts.values;
+      auto &pos = prim->verts.values.mut();
       if(prim->tris.has_attr("uv0"))
       {
         auto &uv0 = prim->tris.attr<zeno::vec3f>("uv0");
@@ -367,7 +367,8 @@ struct PrimitiveTransform : zeno::INode {
         auto pivotPos = get_input2<zeno::vec3f>("pivotPos");
 
         if (std::dynamic_pointer_cast<PrimitiveObject>(iObject)) {
-            iObject = iObject->clone();
+            iObject = nullptr;
+            iObject = take_input("prim");
             transformObj(iObject, matrix, pivotType, pivotPos, translate, rotation, scaling);
         }
         else {
@@ -7,6 +7,7 @@
 #include <zeno/types/UserData.h>
 #include <zeno/types/CurveObject.h>
 #include <zeno/utils/parallel_reduce.h>
+#include <zeno/para/parallel_for.h>
 #include <zeno/types/ListObject.h>
 #include <zeno/utils/log.h>
 #include <random>
@@ -41,6 +42,275 @@ static unsigned int erode_random(float seed, int idx) {
     return s;
 }
 
+// heightfield view of a 2d grid prim (row-major verts, nx and nz in userData);
+// kernels walk it in kTile x kTile blocks, so a 3x3 stencil keeps its rows in cache
+struct HeightField {
+    static constexpr int kTile = 64;
+
+    int nx = 0;
+    int nz = 0;
+    float cellSize = 1.0f;
+
+    explicit HeightField(PrimitiveObject *prim) {
+        auto &ud = prim->userData();
+        if (!ud.has<int>("nx") || !ud.has<int>("nz"))
+            throw makeError("no such UserData named 'nx' and 'nz'");
+        nx = ud.get2<int>("nx");
+        nz = ud.get2<int>("nz");
+        if (nx < 2 || nz < 1 || prim->verts.size() != (size_t)nx * nz)
+            throw makeError("heightfield size doesn't match its nx and nz");
+        cellSize = length(prim->verts[1] - prim->verts[0]);
+    }
+
+    size_t size() const {
+        return (size_t)nx * nz;
+    }
+
+    // float layer of the prim, nullptr if it has none
+    static float *layer(PrimitiveObject *prim, std::string const &name) {
+        return prim->verts.has_attr(name) ? prim->verts.attr<float>(name).data() : nullptr;
+    }
+
+    // func(x0, x1, z0, z1) for every block, blocks run concurrently
+    template <class Func>
+    void forEachTile(Func const &func) const {
+        int tx = (nx + kTile - 1) / kTile;
+        int tz = (nz + kTile - 1) / kTile;
+        parallel_for(tx * tz, [&] (int t) {
+            int x0 = t % tx * kTile, z0 = t / tx * kTile;
+            func(x0, std::min(x0 + kTile, nx), z0, std::min(z0 + kTile, nz));
+        }, 1);
+    }
+};
+
+// the permutation of the 8 update colors used in outer iteration iter
+static void erode_rand_perm(int iterations, int iter, int perm[8]) {
+    std::uniform_real_distribution<float> distr(0.0, 1.0);
+    for (int i = 0; i < 8; i++)
+        perm[i] = i + 1;
+    for (int i = 0; i < 8; i++)
+    {
+        vec2f vec;
+        std::mt19937 mt(iterations * iter * 8 * i + i);
+        vec[0] = distr(mt);
+        vec[1] = distr(mt);
+
+        int idx1 = floor(vec[0] * 8);
+        int idx2 = floor(vec[1] * 8);
+        idx1 = idx1 == 8 ? 7 : idx1;
+        idx2 = idx2 == 8 ? 7 : idx2;
+
+        int temp = perm[idx1];
+        perm[idx1] = perm[idx2];
+        perm[idx2] = temp;
+    }
+}
+
+static void erode_rand_dirs(int iterations, int iter, int dirs[2]) {
+    std::uniform_real_distribution<float> distr(0.0, 1.0);
+    for (int i = 0; i < 2; i++)
+    {
+        std::mt19937 mt(iterations * iter * 2 * i + i);
+        float rand_val = distr(mt);
+        dirs[i] = rand_val > 0.5 ? 1 : -1;
+    }
+}
+
+// one color pass of thermal erosion: every active cell pairs up with its neighbour in
+// the color's direction and the higher cell of the pair sheds material. The pairs of
+// one pass are disjoint, so each cell is written only by itself (out = base + change),
+// reading the snapshot prev_*; out may alias base (in place) or not (ping-pong buffers)
+struct ThermalErosionPass {
+    float const *prev_height = nullptr;
+    float const *prev_debris = nullptr;
+    float const *base_height = nullptr;
+    float const *base_debris = nullptr;
+    float *out_height = nullptr;
+    float *out_debris = nullptr;
+
+    // nullptr reads as 1.0 everywhere
+    float const *erodability_mask = nullptr;
+    float const *removalrate_mask = nullptr;
+    float const *cutangle_mask = nullptr;
+    float const *gridbias_mask = nullptr;
+
+    float seed = 0, gridbias = 0, cut_angle = 0, global_erosionrate = 0;
+    float erosionrate = 0, erodability = 0, removalrate = 0, maxdepth = 0;
+
+    static float mask(float const *m, int idx) {
+        return m ? m[idx] : 1.0f;
+    }
+
+    void run(HeightField const &hf, int color, int iter, int const p_dirs[2], int const x_dirs[2]) const {
+        int nx = hf.nx, nz = hf.nz;
+        int iterseed = iter * 134775813;
+        int dxs[] = { 0, p_dirs[0], 0, p_dirs[0], x_dirs[0], x_dirs[1], x_dirs[0], x_dirs[1] };
+        int dzs[] = { p_dirs[1], 0, p_dirs[1], 0, x_dirs[0],-x_dirs[1], x_dirs[0],-x_dirs[1] };
+        int dx = dxs[color - 1];
+        int dz = dzs[color - 1];
+        auto active = [color] (int id_x, int id_z) {
+            return (((id_z & 1) == 1) && (color == 1))
+                || (((id_x & 1) == 1) && (color == 2))
+                || (((id_z & 1) == 0) && (color == 3))
+                || (((id_x & 1) == 0) && (color == 4))
+                || (((id_x & 1) == 1) && ((color == 5) || (color == 6)))
+                || (((id_x & 1) == 0) && ((color == 7) || (color == 8)));
+        };
+        auto inside = [nx, nz] (int x, int z) {
+            return x >= 0 && x < nx && z >= 0 && z < nz;
+        };
+
+        hf.forEachTile([&] (int x0, int x1, int z0, int z1) {
+            for (int z = z0; z < z1; z++) {
+                for (int x = x0; x < x1; x++) {
+                    int self = Pos2Idx(x, z, nx);
+                    float height = base_height[self];
+                    float debris = base_debris[self];
+
+                    // the pair (id_x, id_z) -> (samplex, samplez) this cell belongs to, if any
+                    int id_x = x, id_z = z;
+                    if (!active(x, z)) {
+                        id_x = x - dx;
+                        id_z = z - dz;
+                    }
+                    int samplex = id_x + dx, samplez = id_z + dz;
+                    if ((dx || dz) && inside(id_x, id_z) && inside(samplex, samplez) && active(id_x, id_z)) {
+                        erode(hf, id_x, id_z, samplex, samplez, dx, dz, color, iterseed, self, height, debris);
+                    }
+                    out_height[self] = height;
+                    out_debris[self] = debris;
+                }
+            }
+        });
+    }
+
+    // changes height and debris of cell self if it is the higher one of its pair
+    void erode(HeightField const &hf, int id_x, int id_z, int samplex, int samplez, int dx, int dz,
+               int color, int iterseed, int self, float &height, float &debris) const {
+        int nx = hf.nx, nz = hf.nz;
+        int clamp_x = nx - 1;
+        int clamp_z = nz - 1;
+        int idx = Pos2Idx(id_x, id_z, nx);
+        int j_idx = Pos2Idx(samplex, samplez, nx);
+
+        float i_debris = prev_debris[idx];
+        float i_height = prev_height[idx];
+        float j_debris = prev_debris[j_idx];
+        float j_height = prev_height[j_idx];
+
+        int cidx, cidz, c_idx, n_idx, dx_check, dz_check;
+        float c_height, c_debris, n_debris, h_diff;
+        if ((j_height - i_height) > 0.0f)
+        {
+            cidx = samplex;
+            cidz = samplez;
+            c_height = j_height;
+            c_debris = j_debris;
+            n_debris = i_debris;
+            c_idx = j_idx;
+            n_idx = idx;
+            dx_check = -dx;
+            dz_check = -dz;
+            h_diff = j_height - i_height;
+        }
+        else
+        {
+            cidx = id_x;
+            cidz = id_z;
+            c_height = i_height;
+            c_debris = i_debris;
+            n_debris = j_debris;
+            c_idx = idx;
+            n_idx = j_idx;
+            dx_check = dx;
+            dz_check = dz;
+            h_diff = i_height - j_height;
+        }
+        if (c_idx != self)
+            return;
+
+        float max_diff = 0.0f;
+        float dir_prob = 0.0f;
+        float c_gridbiasmask = mask(gridbias_mask, c_idx);
+        for (int tmp_dz = -1; tmp_dz <= 1; tmp_dz++)
+        {
+            for (int tmp_dx = -1; tmp_dx <= 1; tmp_dx++)
+            {
+                if (!tmp_dx && !tmp_dz)
+                    continue;
+
+                int tmp_samplex = clamp(cidx + tmp_dx, 0, clamp_x);
+                int tmp_samplez = clamp(cidz + tmp_dz, 0, clamp_z);
+                int tmp_j_idx = Pos2Idx(tmp_samplex, tmp_samplez, nx);
+
+                float n_height = prev_height[tmp_j_idx];
+
+                float tmp_diff = n_height - (c_height);
+
+                float _gridbias = clamp(gridbias * c_gridbiasmask, -1.0f, 1.0f);
+
+                if (tmp_dx && tmp_dz)
+                    tmp_diff *= clamp(1.0f - _gridbias, 0.0f, 1.0f) / 1.4142136f;
+                else
+                    tmp_diff *= clamp(1.0f + _gridbias, 0.0f, 1.0f);
+
+                if (tmp_diff <= 0.0f)
+                {
+                    if ((dx_check == tmp_dx) && (dz_check == tmp_dz))
+                        dir_prob = tmp_diff;
+                    if (tmp_diff < max_diff)
+                        max_diff = tmp_diff;
+                }
+            }
+        }
+        if (max_diff > 0.001f || max_diff < -0.001f)
+            dir_prob = dir_prob / max_diff;
+
+        int cond = 0;
+        if (dir_prob >= 1.0f)
+            cond = 1;
+        else
+        {
+            dir_prob = dir_prob * dir_prob * dir_prob * dir_prob;
+            unsigned int cutoff = (unsigned int)(dir_prob * 4294967295.0);
+            unsigned int randval = erode_random(seed, (idx + nx * nz) * 8 + color + iterseed);
+            cond = randval < cutoff;
+        }
+        if (!cond)
+            return;
+
+        float abs_h_diff = h_diff < 0.0f ? -h_diff : h_diff;
+        float _cut_angle = clamp(cut_angle * mask(cutangle_mask, n_idx), 0.0f, 90.0f);
+        float delta_x = hf.cellSize * (dx && dz ? 1.4142136f : 1.0f);
+        float height_removed = _cut_angle < 90.0f ? tan(_cut_angle * M_PI / 180) * delta_x : 1e10f;
+        float height_diff = abs_h_diff - height_removed;
+        if (height_diff < 0.0f)
+            height_diff = 0.0f;
+        float prob = ((n_debris + c_debris) != 0.0f) ? clamp((height_diff / (n_debris + c_debris)), 0.0f, 1.0f) : 1.0f;
+        unsigned int cutoff = (unsigned int)(prob * 4294967295.0);
+        unsigned int randval = erode_random(seed * 3.14, (idx + nx * nz) * 8 + color + iterseed);
+        int do_erode = randval < cutoff;
+
+        float height_removal_amt = do_erode * clamp(global_erosionrate * erosionrate * erodability * mask(erodability_mask, c_idx), 0.0f, height_diff);
+
+        height -= height_removal_amt;
+
+        float bedrock_density = 1.0f - (removalrate * mask(removalrate_mask, c_idx));
+        if (bedrock_density > 0.0f)
+        {
+            float newdebris = bedrock_density * height_removal_amt;
+            if (n_debris + newdebris > maxdepth)
+            {
+                float rollback = n_debris + newdebris - maxdepth;
+                rollback = min(rollback, newdebris);
+                height += rollback / bedrock_density;
+                newdebris -= rollback;
+            }
+            debris += newdebris;
+        }
+    }
+};
+
 // rain                                             用于子图：Erode_Precipitation
 struct erode_value2cond : INode {
     void apply() override {
@@ -125,27 +395,11 @@ ZENDEFNODE(erode_value2cond,
 
 struct erode_rand_color : INode {
     void apply() override {
-        std::uniform_real_distribution<float> distr(0.0, 1.0);
         auto iterations = get_input<NumericObject>("iterations")->get<int>();
         auto iter       = get_input<NumericObject>("iter")->get<int>();
 
-        int perm[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
-        for (int i = 0; i < 8; i++)
-        {
-            vec2f vec;
-            std::mt19937 mt(iterations * iter * 8 * i + i);
-            vec[0] = distr(mt);
-            vec[1] = distr(mt);
-
-            int idx1 = floor(vec[0] * 8);
-            int idx2 = floor(vec[1] * 8);
-            idx1 = idx1 == 8 ? 7 : idx1;
-            idx2 = idx2 == 8 ? 7 : idx2;
-
-            int temp = perm[idx1];
-            perm[idx1] = perm[idx2];
-            perm[idx2] = temp;
-        }
+        int perm[8];
+        erode_rand_perm(iterations, iter, perm);
 
         auto list = std::make_shared<zeno::ListObject>();
         for (int i = 0; i < 8; i++)
@@ -177,25 +431,11 @@ ZENDEFNODE(erode_rand_color,
 
 struct erode_rand_dir : INode {
     void apply() override {
-
-        std::uniform_real_distribution<float> distr(0.0, 1.0);
         auto iterations = get_input<NumericObject>("iterations")->get<int>();
         auto iter       = get_input<NumericObject>("iter")->get<int>();
 
-        int dirs[] = { -1, -1 };
-        for (int i = 0; i < 2; i++)
-        {
-            std::mt19937 mt(iterations * iter * 2 * i + i);
-            float rand_val = distr(mt);
-            if (rand_val > 0.5)
-            {
-                dirs[i] = 1;
-            }
-            else
-            {
-                dirs[i] = -1;
-            }
-        }
+        int dirs[2];
+        erode_rand_dirs(iterations, iter, dirs);
 
         auto list = std::make_shared<zeno::ListObject>();
         for (int i = 0; i < 2; i++)
@@ -318,203 +558,135 @@ struct erode_tumble_material_erosion : INode {
         // 计算
         ////////////////////////////////////////////////////////////////////////////////////////
 
-#pragma omp parallel for
-        for (int id_z = 0; id_z < nz; id_z++)
-        {
-            for (int id_x = 0; id_x < nx; id_x++)
-            {
-                int iterseed = iter * 134775813;
-                int color = perm[i];
-
-                int is_red = ((id_z & 1) == 1) && (color == 1);
-                int is_green = ((id_x & 1) == 1) && (color == 2);
-                int is_blue = ((id_z & 1) == 0) && (color == 3);
-                int is_yellow = ((id_x & 1) == 0) && (color == 4);
-                int is_x_turn_x = ((id_x & 1) == 1) && ((color == 5) || (color == 6));
-                int is_x_turn_y = ((id_x & 1) == 0) && ((color == 7) || (color == 8));
-                int dxs[] = { 0, p_dirs[0], 0, p_dirs[0], x_dirs[0], x_dirs[1], x_dirs[0], x_dirs[1] };
-                int dzs[] = { p_dirs[1], 0, p_dirs[1], 0, x_dirs[0],-x_dirs[1], x_dirs[0],-x_dirs[1] };
-
-                if (is_red || is_green || is_blue || is_yellow || is_x_turn_x || is_x_turn_y)
-                {
-                    int idx = Pos2Idx(id_x, id_z, nx);
-                    int dx = dxs[color - 1];
-                    int dz = dzs[color - 1];
-                    int bound_x = nx;
-                    int bound_z = nz;
-                    int clamp_x = bound_x - 1;
-                    int clamp_z = bound_z - 1;
-
-                    float i_debris = _temp_debris[idx];
-                    float i_height = _temp_height[idx];
-
-                    int samplex = clamp(id_x + dx, 0, clamp_x);
-                    int samplez = clamp(id_z + dz, 0, clamp_z);
-                    int validsource = (samplex == id_x + dx) && (samplez == id_z + dz);
-                    if (validsource)
-                    {
-                        validsource = validsource || !openborder;
-                        int j_idx = Pos2Idx(samplex, samplez, nx);
-                        float j_debris = validsource ? _temp_debris[j_idx] : 0.0f;
-                        float j_height = _temp_height[j_idx];
-
-                        int cidx = 0;
-                        int cidz = 0;
-
-                        float c_height = 0.0f;
-                        float c_debris = 0.0f;
-                        float n_debris = 0.0f;
-
-                        int c_idx = 0;
-                        int n_idx = 0;
-
-                        int dx_check = 0;
-                        int dz_check = 0;
-
-                        float h_diff = 0.0f;
-
-                        if ((j_height - i_height) > 0.0f)
-                        {
-                            cidx = samplex;
-                            cidz = samplez;
-
-                            c_height = j_height;
-                            c_debris = j_debris;
-                            n_debris = i_debris;
-
-                            c_idx = j_idx;
-                            n_idx = idx;
-
-                            dx_check = -dx;
-                            dz_check = -dz;
-
-                            h_diff = j_height - i_height;
-                        }
-                        else
-                        {
-                            cidx = id_x;
-                            cidz = id_z;
-
-                            c_height = i_height;
-                            c_debris = i_debris;
-                            n_debris = j_debris;
-
-                            c_idx = idx;
-                            n_idx = j_idx;
-
-                            dx_check = dx;
-                            dz_check = dz;
-
-                            h_diff = i_height - j_height;
-                        }
-
-                        float max_diff = 0.0f;
-                        float dir_prob = 0.0f;
-                        float c_gridbiasmask = _gridbiasmask[c_idx];
-                        for (int tmp_dz = -1; tmp_dz <= 1; tmp_dz++)
-                        {
-                            for (int tmp_dx = -1; tmp_dx <= 1; tmp_dx++)
-                            {
-                                if (!tmp_dx && !tmp_dz)
-                                    continue;
-
-                                int tmp_samplex = clamp(cidx + tmp_dx, 0, clamp_x);
-                                int tmp_samplez = clamp(cidz + tmp_dz, 0, clamp_z);
-                                int tmp_validsource = (tmp_samplex == (cidx + tmp_dx)) && (tmp_samplez == (cidz + tmp_dz));
-                                tmp_validsource = tmp_validsource || !openborder;
-                                int tmp_j_idx = Pos2Idx(tmp_samplex, tmp_samplez, nx);
+        ThermalErosionPass pass;
+        pass.prev_height = _temp_height.data();
+        pass.prev_debris = _temp_debris.data();
+        pass.base_height = pass.out_height = _height.data();
+        pass.base_debris = pass.out_debris = _debris.data();
+        pass.erodability_mask = _erodabilitymask.data();
+        pass.removalrate_mask = _removalratemask.data();
+        pass.cutangle_mask = _cutanglemask.data();
+        pass.gridbias_mask = _gridbiasmask.data();
+        pass.seed = seed;
+        pass.gridbias = gridbias;
+        pass.cut_angle = cut_angle;
+        pass.global_erosionrate = global_erosionrate;
+        pass.erosionrate = erosionrate;
+        pass.erodability = erodability;
+        pass.removalrate = removalrate;
+        pass.maxdepth = maxdepth;
+        pass.run(HeightField(terrain.get()), perm[i], iter, p_dirs.data(), x_dirs.data());
 
-                                float n_height = _temp_height[tmp_j_idx];
+        set_output("prim_2DGrid", std::move(terrain));
+    }
+};
+ZENDEFNODE(erode_tumble_material_erosion,
+           {/* inputs: */ {
+                   "prim_2DGrid",
 
-                                float tmp_diff = n_height - (c_height);
+                   {"ListObject", "perm"},
+                   {"ListObject", "p_dirs"},
+                   {"ListObject", "x_dirs"},
 
-                                //float _gridbias = clamp(gridbias, -1.0f, 1.0f);
-                                float _gridbias = clamp(gridbias * c_gridbiasmask, -1.0f, 1.0f);
+                   {"float", "seed", "9676.79"},
+                   {"int", "iterations", "0"},
+                   {"int", "iter", "0"},
+                   {"int", "i", "0"},
 
-                                if (tmp_dx && tmp_dz)
-                                    tmp_diff *= clamp(1.0f - _gridbias, 0.0f, 1.0f) / 1.4142136f;
-                                else
-                                    tmp_diff *= clamp(1.0f + _gridbias, 0.0f, 1.0f);
+                   {"int", "openborder", "0"},
+                   {"float", "maxdepth", "5.0"},
+                   {"float", "global_erosionrate", "1.0"},
+                   {"float", "erosionrate", "0.03"},
 
-                                if (tmp_diff <= 0.0f)
-                                {
-                                    if ((dx_check == tmp_dx) && (dz_check == tmp_dz))
-                                        dir_prob = tmp_diff;
-                                    if (tmp_diff < max_diff)
-                                        max_diff = tmp_diff;
-                                }
-                            }
-                        }
-                        if (max_diff > 0.001f || max_diff < -0.001f)
-                            dir_prob = dir_prob / max_diff;
+                   {"float", "cutangle", "35"},
+                   {"string", "cutangle_mask_layer", "cutangle_mask"},
 
-                        int cond = 0;
-                        if (dir_prob >= 1.0f)
-                            cond = 1;
-                        else
-                        {
-                            dir_prob = dir_prob * dir_prob * dir_prob * dir_prob;
-                            unsigned int cutoff = (unsigned int)(dir_prob * 4294967295.0);
-                            unsigned int randval = erode_random(seed, (idx + nx * nz) * 8 + color + iterseed);
-                            cond = randval < cutoff;
-                        }
+                   {"float", "erodability", "0.4"},
+                   {"string", "erodability_mask_layer", "erodability_mask"},
 
-                        if (cond)
-                        {
-                            float abs_h_diff = h_diff < 0.0f ? -h_diff : h_diff;
-                            //float _cut_angle = clamp(cut_angle, 0.0f, 90.0f);
-                            float _cut_angle = clamp(cut_angle * _cutanglemask[n_idx], 0.0f, 90.0f);
-                            float delta_x = cellSize * (dx && dz ? 1.4142136f : 1.0f);
-                            float height_removed = _cut_angle < 90.0f ? tan(_cut_angle * M_PI / 180) * delta_x : 1e10f;
-                            float height_diff = abs_h_diff - height_removed;
-                            if (height_diff < 0.0f)
-                                height_diff = 0.0f;
-                            float prob = ((n_debris + c_debris) != 0.0f) ? clamp((height_diff / (n_debris + c_debris)), 0.0f, 1.0f) : 1.0f;
-                            unsigned int cutoff = (unsigned int)(prob * 4294967295.0);
-                            unsigned int randval = erode_random(seed * 3.14, (idx + nx * nz) * 8 + color + iterseed);
-                            int do_erode = randval < cutoff;
+                   {"float", "removalrate", "0.7"},
+                   {"string", "removalrate_mask_layer", "removalrate_mask"},
 
-                            float height_removal_amt = do_erode * clamp(global_erosionrate * erosionrate * erodability * _erodabilitymask[c_idx], 0.0f, height_diff);
+                   {"float", "gridbias", "0.0"},
+                   {"string", "gridbias_mask_layer", "gridbias_mask"},
+               },
+               /* outputs: */
+               {
+                   "prim_2DGrid",
+               },
+               /* params: */
+               {
 
-                            _height[c_idx] -= height_removal_amt;
+               },
+               /* category: */
+               {
+                   "erode",
+               }});
 
-                            //float bedrock_density = 1.0f - (removalrate);
-                            float bedrock_density = 1.0f - (removalrate * _removalratemask[c_idx]);
-                            if (bedrock_density > 0.0f)
-                            {
-                                float newdebris = bedrock_density * height_removal_amt;
-                                if (n_debris + newdebris > maxdepth)
-                                {
-                                    float rollback = n_debris + newdebris - maxdepth;
-                                    rollback = min(rollback, newdebris);
-                                    _height[c_idx] += rollback / bedrock_density;
-                                    newdebris -= rollback;
-                                }
-                                _debris[c_idx] += newdebris;
-                            }
-                        }
-                    }
-                }
+// the whole Erode_Thermal subgraph in one node: iterations x 8 color passes of
+// erode_tumble_material_erosion, ping-ponging between the layers and one scratch
+// buffer each instead of round-tripping _height/_temp_height through the graph
+struct erode_thermal : INode {
+    void apply() override {
+        auto terrain = get_input<PrimitiveObject>("prim_2DGrid");
+        HeightField hf(terrain.get());
+
+        auto height_name = get_input2<std::string>("height_layer");
+        auto debris_name = get_input2<std::string>("debris_layer");
+        if (!terrain->verts.has_attr(height_name))
+            throw makeError("no such data layer named '" + height_name + "'");
+        if (!terrain->verts.has_attr(debris_name))
+            terrain->verts.add_attr<float>(debris_name, 0.0f);
+        auto &height = terrain->verts.attr<float>(height_name);
+        auto &debris = terrain->verts.attr<float>(debris_name);
+
+        ThermalErosionPass pass;
+        pass.erodability_mask = HeightField::layer(terrain.get(), get_input2<std::string>("erodability_mask_layer"));
+        pass.removalrate_mask = HeightField::layer(terrain.get(), get_input2<std::string>("removalrate_mask_layer"));
+        pass.cutangle_mask = HeightField::layer(terrain.get(), get_input2<std::string>("cutangle_mask_layer"));
+        pass.gridbias_mask = HeightField::layer(terrain.get(), get_input2<std::string>("gridbias_mask_layer"));
+        pass.seed = get_input2<float>("seed");
+        pass.gridbias = get_input2<float>("gridbias");
+        pass.cut_angle = get_input2<float>("cutangle");
+        pass.global_erosionrate = get_input2<float>("global_erosionrate");
+        pass.erosionrate = get_input2<float>("erosionrate");
+        pass.erodability = get_input2<float>("erodability");
+        pass.removalrate = get_input2<float>("removalrate");
+        pass.maxdepth = get_input2<float>("maxdepth");
+        auto iterations = get_input2<int>("iterations");
+
+        // every pass reads the result of the previous one and writes all cells of the other buffer
+        std::vector<float> height_swap(hf.size()), debris_swap(hf.size());
+        std::vector<float> *cur_h = &height, *cur_d = &debris;
+        std::vector<float> *next_h = &height_swap, *next_d = &debris_swap;
+        for (int iter = 1; iter <= iterations; iter++) {
+            int perm[8], p_dirs[2], x_dirs[2];
+            erode_rand_perm(iterations, iter, perm);
+            erode_rand_dirs(iterations, iter, p_dirs);
+            erode_rand_dirs(iterations * 10, iter, x_dirs);
+            for (int i = 0; i < 8; i++) {
+                pass.prev_height = pass.base_height = cur_h->data();
+                pass.prev_debris = pass.base_debris = cur_d->data();
+                pass.out_height = next_h->data();
+                pass.out_debris = next_d->data();
+                pass.run(hf, perm[i], iter, p_dirs, x_dirs);
+                std::swap(cur_h, next_h);
+                std::swap(cur_d, next_d);
             }
         }
-
+        // 8 passes per iteration, so the result always ends up in the layers themselves
         set_output("prim_2DGrid", std::move(terrain));
     }
 };
-ZENDEFNODE(erode_tumble_material_erosion,
+ZENDEFNODE(erode_thermal,
            {/* inputs: */ {
                    "prim_2DGrid",
-
-                   {"ListObject", "perm"},
-                   {"ListObject", "p_dirs"},
-                   {"ListObject", "x_dirs"},
+                   {"string", "height_layer", "height"},
+                   {"string", "debris_layer", "debris"},
 
                    {"float", "seed", "9676.79"},
-                   {"int", "iterations", "0"},
-                   {"int", "iter", "0"},
-                   {"int", "i", "0"},
+                   {"int", "iterations", "10"},
 
-                   {"int", "openborder", "0"},
                    {"float", "maxdepth", "5.0"},
                    {"float", "global_erosionrate", "1.0"},
                    {"float", "erosionrate", "0.03"},
@@ -6,6 +6,7 @@
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/types/UserData.h>
 #include <zeno/utils/log.h>
+#include <zeno/utils/noise.h>
 #include <glm/gtx/quaternion.hpp>
 #include <cmath>
 #include <random>
@@ -22,113 +23,28 @@ namespace
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Perlin Noise
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-const int noise_permutation[] = {
-    151,160,137,91,90,15,
-    131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
-    190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
-    88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
-    77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
-    102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196,
-    135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123,
-    5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
-    223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9,
-    129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
-    251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
-    49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
-    138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180,
-    151,160,137,91,90,15,
-    131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
-    190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
-    88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
-    77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
-    102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196,
-    135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123,
-    5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
-    223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9,
-    129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
-    251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
-    49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
-    138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180,
-};
-
-float noise_fade(float t) {
-    // Fade function as defined by Ken Perlin.  This eases coordinate values
-    // so that they will ease towards integral values.  This ends up smoothing
-    // the final output.
-    return t * t * t * (t * (t * 6 - 15) + 10);         // 6t^5 - 15t^4 + 10t^3
-}
-
-int noise_inc(int num) {
-    return num + 1;
-}
 
-float noise_grad(int hash, float x, float y, float z) {
-    switch (hash & 0xF) {
-    case 0x0: return  x + y;
-    case 0x1: return -x + y;
-    case 0x2: return  x - y;
-    case 0x3: return -x - y;
-    case 0x4: return  x + z;
-    case 0x5: return -x + z;
-    case 0x6: return  x - z;
-    case 0x7: return -x - z;
-    case 0x8: return  y + z;
-    case 0x9: return -y + z;
-    case 0xA: return  y - z;
-    case 0xB: return -y - z;
-    case 0xC: return  y + x;
-    case 0xD: return -y + z;
-    case 0xE: return  y - x;
-    case 0xF: return -y - z;
-    default: return 0;
+// writes noise(n, points, results) at pos into arr; each component of a vec3f
+// attribute gets the noise at rotated coordinates, or the same value if !rotate
+template <class Arr, class Noise>
+void noise_to_attr(Arr &arr, vec3f const *pos, Noise const &noise, bool rotate = true) {
+    using T = std::decay_t<decltype(arr[0])>;
+    std::size_t n = arr.size();
+    if (!n)
+        return;
+    if constexpr (std::is_same_v<T, vec3f>) {
+        for (int k = 0; k < 3; k++)
+            noise(n, NoisePoints(pos, rotate ? k : 0), NoiseResults(arr[0].data() + k, 3));
+    } else if constexpr (std::is_same_v<T, float>) {
+        noise(n, NoisePoints(pos), NoiseResults(arr.data()));
+    } else {
+        std::vector<float> tmp(n);
+        noise(n, NoisePoints(pos), NoiseResults(tmp.data()));
+        for (std::size_t i = 0; i < n; i++)
+            arr[i] = tmp[i];
     }
 }
 
-float noise_perlin(float x, float y, float z)
-{
-    x = fract(x / 256.f) * 256.f;
-    y = fract(y / 256.f) * 256.f;
-    z = fract(z / 256.f) * 256.f;
-
-    int xi = (int)x & 255;          // Calculate the "unit cube" that the point asked will be located in
-    int yi = (int)y & 255;          // The left bound is ( |_x_|,|_y_|,|_z_| ) and the right bound is that
-    int zi = (int)z & 255;          // plus 1.  Next we calculate the location (from 0.0 to 1.0) in that cube.
-
-    float xf = x - (int)x;
-    float yf = y - (int)y;
-    float zf = z - (int)z;
-
-    float u = noise_fade(xf);
-    float v = noise_fade(yf);
-    float w = noise_fade(zf);
-
-    int aaa = noise_permutation[noise_permutation[noise_permutation[xi] + yi] + zi];
-    int aba = noise_permutation[noise_permutation[noise_permutation[xi] + noise_inc(yi)] + zi];
-    int aab = noise_permutation[noise_permutation[noise_permutation[xi] + yi] + noise_inc(zi)];
-    int abb = noise_permutation[noise_permutation[noise_permutation[xi] + noise_inc(yi)] + noise_inc(zi)];
-    int baa = noise_permutation[noise_permutation[noise_permutation[noise_inc(xi)] + yi] + zi];
-    int bba = noise_permutation[noise_permutation[noise_permutation[noise_inc(xi)] + noise_inc(yi)] + zi];
-    int bab = noise_permutation[noise_permutation[noise_permutation[noise_inc(xi)] + yi] + noise_inc(zi)];
-    int bbb = noise_permutation[noise_permutation[noise_permutation[noise_inc(xi)] + noise_inc(yi)] + noise_inc(zi)];
-
-    float x1 = mix(noise_grad(aaa, xf, yf, zf),
-        noise_grad(baa, xf - 1, yf, zf),
-        u);
-    float x2 = mix(noise_grad(aba, xf, yf - 1, zf),
-        noise_grad(bba, xf - 1, yf - 1, zf),
-        u);
-    float y1 = mix(x1, x2, v);
-    x1 = mix(noise_grad(aab, xf, yf, zf - 1),
-        noise_grad(bab, xf - 1, yf, zf - 1),
-        u);
-    x2 = mix(noise_grad(abb, xf, yf - 1, zf - 1),
-        noise_grad(bbb, xf - 1, yf - 1, zf - 1),
-        u);
-    float y2 = mix(x1, x2, v);
-
-    return mix(y1, y2, w);
-}
-
 struct erode_noise_perlin : INode {
     void apply() override {
         auto terrain = get_input<PrimitiveObject>("prim_2DGrid");
@@ -149,22 +65,10 @@ struct erode_noise_perlin : INode {
 
 
         terrain->attr_visit(attrName, [&](auto& arr) {
-#pragma omp parallel for
-            for (int i = 0; i < arr.size(); i++)
-            {
-                if constexpr (is_decay_same_v<decltype(arr[i]), vec3f>)
-                {
-                    float x = noise_perlin(vec3fAttr[i][0], vec3fAttr[i][1], vec3fAttr[i][2]);
-                    float y = noise_perlin(vec3fAttr[i][1], vec3fAttr[i][2], vec3fAttr[i][0]);
-                    float z = noise_perlin(vec3fAttr[i][2], vec3fAttr[i][0], vec3fAttr[i][1]);
-                    arr[i] = vec3f(x, y, z);
-                }
-                else
-                {
-                    arr[i] = noise_perlin(vec3fAttr[i][0], vec3fAttr[i][1], vec3fAttr[i][2]);
-                }
-            }
+            noise_to_attr(arr, vec3fAttr.data(), [] (std::size_t n, NoisePoints p, NoiseResults r) {
+                noisePerlin(n, p, r);
             });
+        });
 
         set_output("prim_2DGrid", get_input("prim_2DGrid"));
     }
@@ -186,342 +90,6 @@ ZENDEFNODE(erode_noise_perlin,
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Simplex Noise
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-int noise_fastfloor(double x) {
-    return x > 0 ? (int)x : (int)x - 1;
-}
-
-const int noise_simplex[][4] = {
-    {0,1,2,3},{0,1,3,2},{0,0,0,0},{0,2,3,1},{0,0,0,0},{0,0,0,0},{0,0,0,0},{1,2,3,0},
-    {0,2,1,3},{0,0,0,0},{0,3,1,2},{0,3,2,1},{0,0,0,0},{0,0,0,0},{0,0,0,0},{1,3,2,0},
-    {0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},
-    {1,2,0,3},{0,0,0,0},{1,3,0,2},{0,0,0,0},{0,0,0,0},{0,0,0,0},{2,3,0,1},{2,3,1,0},
-    {1,0,2,3},{1,0,3,2},{0,0,0,0},{0,0,0,0},{0,0,0,0},{2,0,3,1},{0,0,0,0},{2,1,3,0},
-    {0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},
-    {2,0,1,3},{0,0,0,0},{0,0,0,0},{0,0,0,0},{3,0,1,2},{3,0,2,1},{0,0,0,0},{3,1,2,0},
-    {2,1,0,3},{0,0,0,0},{0,0,0,0},{0,0,0,0},{3,1,0,2},{0,0,0,0},{3,2,0,1},{3,2,1,0}
-};
-
-float noise_sGrad3(int hash, float x, float y, float z) {
-    switch (hash & 0xF) {
-    case 0x0: return  x + y;
-    case 0x1: return -x + y;
-    case 0x2: return  x - y;
-    case 0x3: return -x - y;
-    case 0x4: return  x + z;
-    case 0x5: return -x + z;
-    case 0x6: return  x - z;
-    case 0x7: return -x - z;
-    case 0x8: return  y + z;
-    case 0x9: return -y + z;
-    case 0xA: return  y - z;
-    case 0xB: return -y - z;
-    case 0xC: return  y + x;
-    case 0xD: return -y + z;
-    case 0xE: return  y - x;
-    case 0xF: return -y - z;
-    default: return 0;
-    }
-}
-
-float noise_sGrad4(int hash, float x, float y, float z, float w) {
-    switch (hash & 0x1F) {
-    case 0x00: return  y + z + w;
-    case 0x01: return  y + z - w;
-    case 0x02: return  y - z + w;
-    case 0x03: return  y - z - w;
-    case 0x04: return -y + z + w;
-    case 0x05: return -y + z - w;
-    case 0x06: return -y - z + w;
-    case 0x07: return -y - z - w;
-
-    case 0x08: return  x + z + w;
-    case 0x09: return  x + z - w;
-    case 0x0A: return  x - z + w;
-    case 0x0B: return  x - z - w;
-    case 0x0C: return -x + z + w;
-    case 0x0D: return -x + z - w;
-    case 0x0E: return -x - z + w;
-    case 0x0F: return -x - z - w;
-
-    case 0x10: return  x + y + w;
-    case 0x11: return  x + y - w;
-    case 0x12: return  x - y + w;
-    case 0x13: return  x - y - w;
-    case 0x14: return -x + y + w;
-    case 0x15: return -x + y - w;
-    case 0x16: return -x - y + w;
-    case 0x17: return -x - y - w;
-
-    case 0x18: return  x + y + z;
-    case 0x19: return  x + y - z;
-    case 0x1A: return  x - y + z;
-    case 0x1B: return  x - y - z;
-    case 0x1C: return -x + y + z;
-    case 0x1D: return -x + y - z;
-    case 0x1E: return -x - y + z;
-    case 0x1F: return -x - y - z;
-    default: return 0;
-    }
-}
-
-// 3D Perlin simplex noise
-// @param[in] x float coordinate
-// @param[in] y float coordinate
-// @param[in] z float coordinate
-// @return Noise value in the range[-1; 1], value of 0 on all integer coordinates.
-float noise_simplexNoise3(float x, float y, float z) {
-    float n0, n1, n2, n3; // Noise contributions from the four corners
-
-    // Skewing/Unskewing factors for 3D
-    static const float F3 = 1.0f / 3.0f;
-    static const float G3 = 1.0f / 6.0f;
-
-    // Skew the input space to determine which simplex cell we're in
-    float s = (x + y + z) * F3; // Very nice and simple skew factor for 3D
-    int i = noise_fastfloor(x + double(s));
-    int j = noise_fastfloor(y + double(s));
-    int k = noise_fastfloor(z + double(s));
-    float t = (float)(i + j + k) * G3;
-    float X0 = (float)i - t; // Unskew the cell origin back to (x,y,z) space
-    float Y0 = (float)j - t;
-    float Z0 = (float)k - t;
-    float x0 = x - X0; // The x,y,z distances from the cell origin
-    float y0 = y - Y0;
-    float z0 = z - Z0;
-
-    // For the 3D case, the simplex shape is a slightly irregular tetrahedron.
-    // Determine which simplex we are in.
-    int i1, j1, k1; // Offsets for second corner of simplex in (i,j,k) coords
-    int i2, j2, k2; // Offsets for third corner of simplex in (i,j,k) coords
-    if (x0 >= y0) {
-        if (y0 >= z0) {
-            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; // X Y Z order
-        }
-        else if (x0 >= z0) {
-            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; // X Z Y order
-        }
-        else {
-            i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; // Z X Y order
-        }
-    }
-    else { // x0<y0
-        if (y0 < z0) {
-            i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; // Z Y X order
-        }
-        else if (x0 < z0) {
-            i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; // Y Z X order
-        }
-        else {
-            i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; // Y X Z order
-        }
-    }
-
-    // A step of (1,0,0) in (i,j,k) means a step of (1-c,-c,-c) in (x,y,z),
-    // a step of (0,1,0) in (i,j,k) means a step of (-c,1-c,-c) in (x,y,z), and
-    // a step of (0,0,1) in (i,j,k) means a step of (-c,-c,1-c) in (x,y,z), where
-    // c = 1/6.
-    float x1 = x0 - (float)i1 + G3; // Offsets for second corner in (x,y,z) coords
-    float y1 = y0 - (float)j1 + G3;
-    float z1 = z0 - (float)k1 + G3;
-    float x2 = x0 - (float)i2 + 2.0f * G3; // Offsets for third corner in (x,y,z) coords
-    float y2 = y0 - (float)j2 + 2.0f * G3;
-    float z2 = z0 - (float)k2 + 2.0f * G3;
-    float x3 = x0 - 1.0f + 3.0f * G3; // Offsets for last corner in (x,y,z) coords
-    float y3 = y0 - 1.0f + 3.0f * G3;
-    float z3 = z0 - 1.0f + 3.0f * G3;
-
-    // Wrap the integer indices at 256, to avoid indexing permutation[] out of bounds
-    int ii = i & 0xff;
-    int jj = j & 0xff;
-    int kk = k & 0xff;
-
-    // Work out the hashed gradient indices of the four simplex corners
-    int gi0 = noise_permutation[ii + noise_permutation[jj + noise_permutation[kk]]];
-    int gi1 = noise_permutation[ii + i1 + noise_permutation[jj + j1 + noise_permutation[kk + k1]]];
-    int gi2 = noise_permutation[ii + i2 + noise_permutation[jj + j2 + noise_permutation[kk + k2]]];
-    int gi3 = noise_permutation[ii + 1 + noise_permutation[jj + 1 + noise_permutation[kk + 1]]];
-
-    // Calculate the contribution from the four corners
-    float t0 = 0.6f - x0 * x0 - y0 * y0 - z0 * z0;
-    //    float t0 = 0.5f - x0*x0 - y0*y0 - z0*z0;
-    if (t0 < 0) {
-        n0 = 0.0;
-    }
-    else {
-        t0 *= t0;
-        n0 = t0 * t0 * noise_sGrad3(gi0, x0, y0, z0);
-    }
-    float t1 = 0.6f - x1 * x1 - y1 * y1 - z1 * z1;
-    //    float t1 = 0.5f - x1*x1 - y1*y1 - z1*z1;
-    if (t1 < 0) {
-        n1 = 0.0;
-    }
-    else {
-        t1 *= t1;
-        n1 = t1 * t1 * noise_sGrad3(gi1, x1, y1, z1);
-    }
-    float t2 = 0.6f - x2 * x2 - y2 * y2 - z2 * z2;
-    //    float t2 = 0.5f - x2*x2 - y2*y2 - z2*z2;
-    if (t2 < 0) {
-        n2 = 0.0;
-    }
-    else {
-        t2 *= t2;
-        n2 = t2 * t2 * noise_sGrad3(gi2, x2, y2, z2);
-    }
-    float t3 = 0.6f - x3 * x3 - y3 * y3 - z3 * z3;
-    //    float t3 = 0.5f - x3*x3 - y3*y3 - z3*z3;
-    if (t3 < 0) {
-        n3 = 0.0;
-    }
-    else {
-        t3 *= t3;
-        n3 = t3 * t3 * noise_sGrad3(gi3, x3, y3, z3);
-    }
-    // Add contributions from each corner to get the final noise value.
-    // The result is scaled to stay just inside [-1,1]
-    return 32.0f * (n0 + n1 + n2 + n3);
-}
-
-// 4D Perlin simplex noise
-// @param[in] x float coordinate
-// @param[in] y float coordinate
-// @param[in] z float coordinate
-// @param[in] w float coordinate
-// @return Noise value in the range[-1; 1], value of 0 on all integer coordinates.
-float noise_simplexNoise4(float x, float y, float z, float w) {
-
-    float n0, n1, n2, n3, n4;   // Noise contributions from the five corners
-
-    static const float F4 = 0.309016994f;   // F4 = (sqrt(5) - 1) / 4
-    static const float G4 = 0.138196601f;   // G4 = (5 - sqrt(5)) / 20
-
-    // Skew the (x,y,z,w) space to determine which cell of 24 simplices we're in
-    float s = (x + y + z + w) * F4; // Factor for 4D skewing
-    float xs = x + s;
-    float ys = y + s;
-    float zs = z + s;
-    float ws = w + s;
-    int i = noise_fastfloor(xs);
-    int j = noise_fastfloor(ys);
-    int k = noise_fastfloor(zs);
-    int l = noise_fastfloor(ws);
-
-    float t = (float)(i + j + k + l) * G4; // Factor for 4D unskewing
-    float X0 = (float)i - t; // Unskew the cell origin back to (x,y,z,w) space
-    float Y0 = (float)j - t;
-    float Z0 = (float)k - t;
-    float W0 = (float)l - t;
-
-    float x0 = x - X0;  // The x,y,z,w distances from the cell origin
-    float y0 = y - Y0;
-    float z0 = z - Z0;
-    float w0 = w - W0;
-
-    // For the 4D case, the simplex is a 4D shape I won't even try to describe.
-    // To find out which of the 24 possible simplices we're in, we need to
-    // determine the magnitude ordering of x0, y0, z0 and w0.
-    // The method below is a good way of finding the ordering of x,y,z,w and
-    // then find the correct traversal order for the simplex we're in.
-    // First, six pair-wise comparisons are performed between each possible pair
-    // of the four coordinates, and the results are used to add up binary bits
-    // for an integer index.
-    int c1 = (x0 > y0) ? 32 : 0;
-    int c2 = (x0 > z0) ? 16 : 0;
-    int c3 = (y0 > z0) ? 8 : 0;
-    int c4 = (x0 > w0) ? 4 : 0;
-    int c5 = (y0 > w0) ? 2 : 0;
-    int c6 = (z0 > w0) ? 1 : 0;
-    int c = c1 + c2 + c3 + c4 + c5 + c6;
-
-    int i1, j1, k1, l1; // The integer offsets for the second simplex corner
-    int i2, j2, k2, l2; // The integer offsets for the third simplex corner
-    int i3, j3, k3, l3; // The integer offsets for the fourth simplex corner
-
-    // simplex[c] is a 4-vector with the numbers 0, 1, 2 and 3 in some order.
-    // Many values of c will never occur, since e.g. x>y>z>w makes x<z, y<w and x<w
-    // impossible. Only the 24 indices which have non-zero entries make any sense.
-    // We use a thresholding to set the coordinates in turn from the largest magnitude.
-    // The number 3 in the "simplex" array is at the position of the largest coordinate.
-    i1 = noise_simplex[c][0] >= 3 ? 1 : 0;
-    j1 = noise_simplex[c][1] >= 3 ? 1 : 0;
-    k1 = noise_simplex[c][2] >= 3 ? 1 : 0;
-    l1 = noise_simplex[c][3] >= 3 ? 1 : 0;
-    // The number 2 in the "simplex" array is at the second largest coordinate.
-    i2 = noise_simplex[c][0] >= 2 ? 1 : 0;
-    j2 = noise_simplex[c][1] >= 2 ? 1 : 0;
-    k2 = noise_simplex[c][2] >= 2 ? 1 : 0;
-    l2 = noise_simplex[c][3] >= 2 ? 1 : 0;
-    // The number 1 in the "simplex" array is at the second smallest coordinate.
-    i3 = noise_simplex[c][0] >= 1 ? 1 : 0;
-    j3 = noise_simplex[c][1] >= 1 ? 1 : 0;
-    k3 = noise_simplex[c][2] >= 1 ? 1 : 0;
-    l3 = noise_simplex[c][3] >= 1 ? 1 : 0;
-    // The fifth corner has all coordinate offsets = 1, so no need to look that up.
-
-    float x1 = x0 - (float)i1 + G4; // Offsets for second corner in (x,y,z,w) coords
-    float y1 = y0 - (float)j1 + G4;
-    float z1 = z0 - (float)k1 + G4;
-    float w1 = w0 - (float)l1 + G4;
-    float x2 = x0 - (float)i2 + 2.0f * G4; // Offsets for third corner in (x,y,z,w) coords
-    float y2 = y0 - (float)j2 + 2.0f * G4;
-    float z2 = z0 - (float)k2 + 2.0f * G4;
-    float w2 = w0 - (float)l2 + 2.0f * G4;
-    float x3 = x0 - (float)i3 + 3.0f * G4; // Offsets for fourth corner in (x,y,z,w) coords
-    float y3 = y0 - (float)j3 + 3.0f * G4;
-    float z3 = z0 - (float)k3 + 3.0f * G4;
-    float w3 = w0 - (float)l3 + 3.0f * G4;
-    float x4 = x0 - 1.0f + 4.0f * G4; // Offsets for last corner in (x,y,z,w) coords
-    float y4 = y0 - 1.0f + 4.0f * G4;
-    float z4 = z0 - 1.0f + 4.0f * G4;
-    float w4 = w0 - 1.0f + 4.0f * G4;
-
-    // Wrap the integer indices at 256, to avoid indexing permutation[] out of bounds
-    int ii = i & 0xff;
-    int jj = j & 0xff;
-    int kk = k & 0xff;
-    int ll = l & 0xff;
-
-    // Calculate the contribution from the five corners
-    float t0 = 0.6f - x0 * x0 - y0 * y0 - z0 * z0 - w0 * w0;
-    if (t0 < 0.0) n0 = 0.0;
-    else {
-        t0 *= t0;
-        n0 = t0 * t0 * noise_sGrad4(noise_permutation[ii + noise_permutation[jj + noise_permutation[kk + noise_permutation[ll]]]], x0, y0, z0, w0);
-    }
-
-    float t1 = 0.6f - x1 * x1 - y1 * y1 - z1 * z1 - w1 * w1;
-    if (t1 < 0.0) n1 = 0.0;
-    else {
-        t1 *= t1;
-        n1 = t1 * t1 * noise_sGrad4(noise_permutation[ii + i1 + noise_permutation[jj + j1 + noise_permutation[kk + k1 + noise_permutation[ll + l1]]]], x1, y1, z1, w1);
-    }
-
-    float t2 = 0.6f - x2 * x2 - y2 * y2 - z2 * z2 - w2 * w2;
-    if (t2 < 0.0) n2 = 0.0;
-    else {
-        t2 *= t2;
-        n2 = t2 * t2 * noise_sGrad4(noise_permutation[ii + i2 + noise_permutation[jj + j2 + noise_permutation[kk + k2 + noise_permutation[ll + l2]]]], x2, y2, z2, w2);
-    }
-
-    float t3 = 0.6f - x3 * x3 - y3 * y3 - z3 * z3 - w3 * w3;
-    if (t3 < 0.0) n3 = 0.0;
-    else {
-        t3 *= t3;
-        n3 = t3 * t3 * noise_sGrad4(noise_permutation[ii + i3 + noise_permutation[jj + j3 + noise_permutation[kk + k3 + noise_permutation[ll + l3]]]], x3, y3, z3, w3);
-    }
-
-    float t4 = 0.6f - x4 * x4 - y4 * y4 - z4 * z4 - w4 * w4;
-    if (t4 < 0.0) n4 = 0.0;
-    else {
-        t4 *= t4;
-        n4 = t4 * t4 * noise_sGrad4(noise_permutation[ii + 1 + noise_permutation[jj + 1 + noise_permutation[kk + 1 + noise_permutation[ll + 1]]]], x4, y4, z4, w4);
-    }
-
-    // Sum up and scale the result to cover the range [-1,1]
-    return 27.0f * (n0 + n1 + n2 + n3 + n4);
-}
-
 //
 // #define snoise(P) (2*noise(P) - 1) // noise() function in RenderMan shading language has range [0,1]
 // float DistNoise(point Pt, float distortion)
@@ -548,21 +116,10 @@ struct erode_noise_simplex : INode {
         auto& pos = terrain->verts.attr<zeno::vec3f>(posLikeAttrName);
 
         terrain->attr_visit(attrName, [&](auto& arr) {
-#pragma omp parallel for
-            for (int i = 0; i < arr.size(); i++)
-            {
-                if constexpr (is_decay_same_v<decltype(arr[i]), vec3f>) {
-                    float x = noise_simplexNoise3(pos[i][0], pos[i][1], pos[i][2]);
-                    float y = noise_simplexNoise3(pos[i][1], pos[i][2], pos[i][0]);
-                    float z = noise_simplexNoise3(pos[i][2], pos[i][0], pos[i][1]);
-                    arr[i] = vec3f(x, y, z);
-                }
-                else
-                {
-                    arr[i] = noise_simplexNoise3(pos[i][0], pos[i][1], pos[i][2]);
-                }
-            }
+            noise_to_attr(arr, pos.data(), [] (std::size_t n, NoisePoints p, NoiseResults r) {
+                noiseSimplex(n, p, r);
             });
+        });
 
         set_output("prim_2DGrid", get_input("prim_2DGrid"));
     }
@@ -1372,71 +929,12 @@ ZENDEFNODE(Noise_gabor_2d, {/* inputs: */ {
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Worley Noise
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-glm::vec3 noise_random3(glm::vec3 p) {
-    glm::vec3 val = sin(glm::vec3(dot(p, glm::vec3(127.1, 311.7, 74.7)),
-        dot(p, glm::vec3(269.5, 183.3, 246.1)),
-        dot(p, glm::vec3(113.5, 271.9, 124.6))));
-    val *= 43758.5453123;
-    return fract(val);
-}
-
-float noise_mydistance(glm::vec3 a, glm::vec3 b, int t) {
-    if (t == 0) {
-        float d = length(a - b);
-        return d*d;
-    }
-    else if (t == 1) {
-        float xx = abs(a.x - b.x);
-        float yy = abs(a.y - b.y);
-        float zz = abs(a.z - b.z);
-        return max(max(xx, yy), zz);
-    }
-    else {
-        float xx = abs(a.x - b.x);
-        float yy = abs(a.y - b.y);
-        float zz = abs(a.z - b.z);
-        return xx + yy + zz;
-    }
-}
-
-float noise_WorleyNoise3(float px, float py, float pz, int fType, int distType, float offsetX, float offsetY, float offsetZ, float jitter = 1) {
-    glm::vec3 pos = glm::vec3(px, py, pz);
-    glm::vec3 offset = glm::vec3(offsetX, offsetY, offsetZ);
-    glm::vec3 i_pos = floor(pos);
-    glm::vec3 f_pos = fract(pos);
-
-    float f1 = 9e9;
-    float f2 = f1;
-
-    for (int z = -1; z <= 1; z++) {
-        for (int y = -1; y <= 1; y++) {
-            for (int x = -1; x <= 1; x++) {
-                glm::vec3 neighbor = glm::vec3(float(x), float(y), float(z));
-                glm::vec3 point = noise_random3(i_pos + neighbor);
-                point = (float)0.5 + (float)0.5 * sin(offset + (float)6.2831 * point);
-                point = point * jitter;
-                glm::vec3 featurePoint = neighbor + point; 
-
-                float dist = noise_mydistance(featurePoint, f_pos, distType);
-                if (dist < f1) {
-                    f2 = f1; f1 = dist;
-                }
-                else if (dist < f2) {
-                    f2 = dist;
-                }
-            }
-        }
-    }
-
-    if (fType == 0) {
-        return f1;
-    }
-    else {
-        return f2 - f1;
+struct erode_noise_worley : INode {
+    virtual bool isMemoizable() const override {
+        // a missing seed means a random offset on every run
+        return has_input("seed") && INode::isMemoizable();
     }
-}
 
-struct erode_noise_worley : INode {
     void apply() override {
         auto terrain = get_input<PrimitiveObject>("prim_2DGrid");
         auto posLikeAttrName = get_input<StringObject>("posLikeAttrName")->get();
@@ -1475,23 +973,16 @@ struct erode_noise_worley : INode {
             else if (attrType == "float") terrain->add_attr<float>(attrName);
         }
 
+        NoiseWorley worley;
+        worley.offset = offset;
+        worley.jitter = jitter;
+        worley.distance = distType;
+        worley.f2MinusF1 = fType == 1;
         terrain->attr_visit(attrName, [&](auto& arr) {
-#pragma omp parallel for
-            for (int i = 0; i < arr.size(); i++)
-            {
-                if constexpr (is_decay_same_v<decltype(arr[i]), vec3f>)
-                {
-                    float x = noise_WorleyNoise3(pos[i][0], pos[i][1], pos[i][2], fType, distType, offset[0], offset[1], offset[2], jitter);
-                    float y = noise_WorleyNoise3(pos[i][1], pos[i][2], pos[i][0], fType, distType, offset[0], offset[1], offset[2], jitter);
-                    float z = noise_WorleyNoise3(pos[i][2], pos[i][0], pos[i][1], fType, distType, offset[0], offset[1], offset[2], jitter);
-                    arr[i] = vec3f(x, y, z);
-                }
-                else
-                {
-                    arr[i] = noise_WorleyNoise3(pos[i][0], pos[i][1], pos[i][2], fType, distType, offset[0], offset[1], offset[2], jitter);
-                }
-            }
+            noise_to_attr(arr, pos.data(), [&] (std::size_t n, NoisePoints p, NoiseResults r) {
+                noiseWorley(n, p, r, worley);
             });
+        });
 
         set_output("prim_2DGrid", get_input("prim_2DGrid"));
     }
@@ -1517,38 +1008,6 @@ ZENDEFNODE(erode_noise_worley,
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // fractal
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-double noise_hybridMultifractal_v1(vec3f point, double H, double lacunarity, double octaves, double offset, double scale, double persistence)
-{
-    double frequency = 1.0;
-    double amplitude = 1.0;
-
-    double x = point[0];
-    double y = point[1];
-    double z = point[2];
-    x *= scale;
-    y *= scale;
-    z *= scale;
-
-    double result = noise_perlin(x, y, z) + offset;
-    double weight = result;
-
-    frequency *= lacunarity;
-    amplitude *= persistence;
-
-    for (int i = 1; i < octaves; i++) {
-        if (weight > 1.0)
-            weight = 1.0;
-
-        double signal = (noise_perlin(x * frequency, y * frequency, z * frequency) + offset) * pow(amplitude, -H);
-        result += weight * signal;
-        weight *= signal;
-
-        frequency *= lacunarity;
-        amplitude *= persistence;
-    }
-    return result;
-}
-
 struct erode_hybridMultifractal_v1 : INode {
     void apply() override {
         auto terrain = get_input<PrimitiveObject>("prim_2DGrid");
@@ -1569,21 +1028,16 @@ struct erode_hybridMultifractal_v1 : INode {
             else if (attrType == "float") terrain->add_attr<float>(attrName);
         }
 
+        NoiseOctaves octs;
+        octs.octaves = std::max(1, (int)std::ceil(octaves));
+        octs.frequency = scale;
+        octs.lacunarity = lacunarity;
+        octs.gain = std::pow(persistence, -H);
         terrain->attr_visit(attrName, [&](auto& arr) {
-#pragma omp parallel for
-            for (int i = 0; i < arr.size(); i++)
-            {
-                if constexpr (is_decay_same_v<decltype(arr[i]), vec3f>)
-                {
-                    float x = noise_hybridMultifractal_v1(pos[i], H, lacunarity, octaves, offset, scale, persistence);
-                    arr[i] = vec3f(x, x, x);
-                }
-                else
-                {
-                    arr[i] = noise_hybridMultifractal_v1(pos[i], H, lacunarity, octaves, offset, scale, persistence);
-                }
-            }
-            });
+            noise_to_attr(arr, pos.data(), [&] (std::size_t n, NoisePoints p, NoiseResults r) {
+                noiseHybrid(n, p, r, octs, offset);
+            }, false);
+        });
 
         set_output("prim_2DGrid", get_input("prim_2DGrid"));
     }
@@ -1606,34 +1060,6 @@ ZENDEFNODE(erode_hybridMultifractal_v1,
             "erode",
         } });
 
-double noise_hybridMultifractal_v2(vec3f point, double H, double lacunarity, double octaves, double offset, double scale)
-{
-    double x = point[0];
-    double y = point[1];
-    double z = point[2];
-    x *= scale;
-    y *= scale;
-    z *= scale;
-
-    double result = 0;
-    double weight = 1;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        if (weight > 1.0)
-            weight = 1.0;
-
-        double signal = (noise_perlin(x, y, z) + offset) * pow(lacunarity, -H * i);
-        result += weight * signal;
-        weight *= signal;
-        x *= lacunarity;
-        y *= lacunarity;
-        z *= lacunarity;
-    }
-
-    return result;
-}
-
 struct erode_hybridMultifractal_v2 : INode {
     void apply() override {
         auto terrain = get_input<PrimitiveObject>("prim_2DGrid");
@@ -1654,19 +1080,16 @@ struct erode_hybridMultifractal_v2 : INode {
             else if (attrType == "float") terrain->add_attr<float>(attrName);
         }
 
+        NoiseOctaves octs;
+        octs.octaves = std::max(0, (int)std::ceil(octaves));
+        octs.frequency = scale;
+        octs.lacunarity = lacunarity;
+        octs.gain = std::pow(lacunarity, -H);
         terrain->attr_visit(attrName, [&](auto& arr) {
-#pragma omp parallel for
-            for (int i = 0; i < arr.size(); i++)
-            {
-                if constexpr (is_decay_same_v<decltype(arr[i]), vec3f>) {
-                    float x = noise_hybridMultifractal_v2(pos[i], H, lacunarity, octaves, offset, scale);// , persistence);
-                    arr[i] = vec3f(x, x, x);
-                }
-                else {
-                    arr[i] = noise_hybridMultifractal_v2(pos[i], H, lacunarity, octaves, offset, scale);// , persistence);
-                }
-            }
-            });
+            noise_to_attr(arr, pos.data(), [&] (std::size_t n, NoisePoints p, NoiseResults r) {
+                noiseHybrid(n, p, r, octs, offset);
+            }, false);
+        });
 
         set_output("prim_2DGrid", get_input("prim_2DGrid"));
     }
@@ -1690,33 +1113,6 @@ ZENDEFNODE(erode_hybridMultifractal_v2,
         } });
 
 // blue print subnet
-double noise_hybridMultifractal_v3(vec3f point, double H, double lacunarity, double octaves, double offset, double scale, double persistence)
-{
-    double x = point[0];
-    double y = point[1];
-    double z = point[2];
-    x *= scale;
-    y *= scale;
-    z *= scale;
-
-    double result = 0;
-    double weight = 1;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        if (weight > 1.0)
-            weight = 1.0;
-
-        double signal = (noise_perlin(x, y, z) + offset) * pow(persistence, -H * i);
-        result += weight * signal;
-        weight *= signal;
-        x *= lacunarity;
-        y *= lacunarity;
-        z *= lacunarity;
-    }
-    return result;
-}
-
 struct erode_hybridMultifractal_v3 : INode {
     void apply() override {
         auto terrain = get_input<PrimitiveObject>("prim_2DGrid");
@@ -1737,18 +1133,16 @@ struct erode_hybridMultifractal_v3 : INode {
             else if (attrType == "float") terrain->add_attr<float>(attrName);
         }
 
+        NoiseOctaves octs;
+        octs.octaves = std::max(0, (int)std::ceil(octaves));
+        octs.frequency = scale;
+        octs.lacunarity = lacunarity;
+        octs.gain = std::pow(persistence, -H);
         terrain->attr_visit(attrName, [&](auto& arr) {
-#pragma omp parallel for
-            for (int i = 0; i < arr.size(); i++) {
-                if constexpr (is_decay_same_v<decltype(arr[i]), vec3f>) {
-                    float x = noise_hybridMultifractal_v3(pos[i], H, lacunarity, octaves, offset, scale, persistence);
-                    arr[i] = vec3f(x, x, x);
-                }
-                else {
-                    arr[i] = noise_hybridMultifractal_v3(pos[i], H, lacunarity, octaves, offset, scale, persistence);
-                }
-            }
-            });
+            noise_to_attr(arr, pos.data(), [&] (std::size_t n, NoisePoints p, NoiseResults r) {
+                noiseHybrid(n, p, r, octs, offset);
+            }, false);
+        });
 
         set_output("prim_2DGrid", get_input("prim_2DGrid"));
     }
@@ -1777,17 +1171,12 @@ ZENDEFNODE(erode_hybridMultifractal_v3,
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 float noise_fbm(vec3f pos, float H, float lacunarity, float frequence, float amplitude, int Octaves)
 {
-    //float G = exp2(-H);    // float G = 0.5;
-    float t = 0.0;
-    for (int i = 0; i < Octaves; i++)
-    {
-        amplitude = pow(lacunarity, -H * i);
-        t += amplitude * noise_perlin(frequence * pos[0], frequence * pos[1], frequence * pos[2]);
-        //frequence *= 2.0;
-        frequence *= lacunarity;
-        //amplitude *= G;
-    }
-    return t;
+    NoiseOctaves octs;
+    octs.octaves = Octaves;
+    octs.frequency = frequence;
+    octs.lacunarity = lacunarity;
+    octs.gain = std::pow(lacunarity, -H);
+    return noiseFbm(pos, octs);
 }
 
 float noise_domainWarpingV1(vec3f pos, float H, float frequence, float amplitude, int numOctaves)
@@ -0,0 +1,95 @@
+#include <zeno/utils/MappedFile.h>
+#include <zeno/utils/log.h>
+#include <cstdio>
+#ifdef _WIN32
+#include <zeno/utils/fuck_win.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace zeno {
+
+ZENO_API MappedFile::~MappedFile() {
+    close();
+}
+
+ZENO_API bool MappedFile::open(std::filesystem::path const &path) {
+    close();
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    if (size == 0)
+        return true;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping) {
+            if (void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) {
+                m_data = (char const *)p;
+                m_size = size;
+                m_handle = mapping;
+                m_mapped = true;
+                return true;
+            }
+            CloseHandle(mapping);
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p != MAP_FAILED) {
+            m_data = (char const *)p;
+            m_size = size;
+            m_mapped = true;
+            return true;
+        }
+    }
+#endif
+
+    log_debug("cannot map {}, reading it instead", path.string());
+    FILE *fp = fopen(path.string().c_str(), "rb");
+    if (!fp)
+        return false;
+    auto buf = new char[size];
+    bool ok = fread(buf, 1, size, fp) == size;
+    fclose(fp);
+    if (!ok) {
+        delete[] buf;
+        return false;
+    }
+    m_data = buf;
+    m_size = size;
+    return true;
+}
+
+ZENO_API void MappedFile::close() {
+    if (m_data) {
+        if (m_mapped) {
+#ifdef _WIN32
+            UnmapViewOfFile(m_data);
+            CloseHandle((HANDLE)m_handle);
+#else
+            munmap((void *)m_data, m_size);
+#endif
+        } else {
+            delete[] m_data;
+        }
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_handle = nullptr;
+    m_mapped = false;
+}
+
+}
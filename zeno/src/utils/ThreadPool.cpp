@@ -0,0 +1,254 @@
+#include <zeno/utils/ThreadPool.h>
+#include <zeno/utils/envconfig.h>
+#include <condition_variable>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <deque>
+#include <exception>
+
+namespace zeno {
+
+struct ThreadPool::Impl {
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex injectMtx;
+    std::deque<Task> injected;
+
+    std::mutex sleepMtx;
+    std::condition_variable sleepCv;
+    std::atomic<std::size_t> queued{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<std::size_t> maxConcurrency{0};
+
+    static thread_local Impl *tlsPool;
+    static thread_local std::size_t tlsIndex;
+
+    bool popInjected(Task &task) {
+        std::lock_guard lck(injectMtx);
+        if (injected.empty())
+            return false;
+        task = std::move(injected.front());
+        injected.pop_front();
+        return true;
+    }
+
+    bool popOwn(std::size_t index, Task &task) {
+        auto &w = *workers[index];
+        std::lock_guard lck(w.mtx);
+        if (w.tasks.empty())
+            return false;
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(std::size_t from, Task &task) {
+        auto n = workers.size();
+        for (std::size_t i = 1; i <= n; i++) {
+            auto &w = *workers[(from + i) % n];
+            std::lock_guard lck(w.mtx);
+            if (!w.tasks.empty()) {
+                task = std::move(w.tasks.front());
+                w.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool pop(Task &task) {
+        bool ok;
+        if (tlsPool == this) {
+            ok = popOwn(tlsIndex, task) || popInjected(task) || steal(tlsIndex, task);
+        } else {
+            ok = popInjected(task) || steal(0, task);
+        }
+        if (ok)
+            queued.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    void push(Task task) {
+        if (tlsPool == this) {
+            auto &w = *workers[tlsIndex];
+            std::lock_guard lck(w.mtx);
+            w.tasks.push_back(std::move(task));
+        } else {
+            std::lock_guard lck(injectMtx);
+            injected.push_back(std::move(task));
+        }
+        queued.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lck(sleepMtx);
+        }
+        sleepCv.notify_one();
+    }
+
+    void workerMain(std::size_t index) {
+        tlsPool = this;
+        tlsIndex = index;
+        Task task;
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (pop(task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock lck(sleepMtx);
+            sleepCv.wait(lck, [&] {
+                return stopping.load(std::memory_order_acquire)
+                    || queued.load(std::memory_order_relaxed) != 0;
+            });
+        }
+        tlsPool = nullptr;
+    }
+};
+
+thread_local ThreadPool::Impl *ThreadPool::Impl::tlsPool = nullptr;
+thread_local std::size_t ThreadPool::Impl::tlsIndex = 0;
+
+ZENO_API ThreadPool::ThreadPool(std::size_t nthreads) : impl(std::make_unique<Impl>()) {
+    if (!nthreads) {
+        // the thread calling waitUntil also executes tasks, so leave one core for it
+        nthreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        nthreads = std::max<std::size_t>(1, nthreads);
+    }
+    for (std::size_t i = 0; i < nthreads; i++) {
+        impl->workers.push_back(std::make_unique<Impl::Worker>());
+    }
+    for (std::size_t i = 0; i < nthreads; i++) {
+        impl->threads.emplace_back([this, i] { impl->workerMain(i); });
+    }
+}
+
+ZENO_API ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lck(impl->sleepMtx);
+        impl->stopping.store(true, std::memory_order_release);
+    }
+    impl->sleepCv.notify_all();
+    for (auto &t: impl->threads) {
+        t.join();
+    }
+}
+
+ZENO_API std::size_t ThreadPool::size() const {
+    return impl->threads.size();
+}
+
+ZENO_API void ThreadPool::submit(Task task) {
+    impl->push(std::move(task));
+}
+
+ZENO_API bool ThreadPool::runOne() {
+    Task task;
+    if (!impl->pop(task))
+        return false;
+    task();
+    return true;
+}
+
+ZENO_API bool ThreadPool::isWorkerThread() const {
+    return Impl::tlsPool == impl.get();
+}
+
+ZENO_API void ThreadPool::setConcurrency(std::size_t n) {
+    impl->maxConcurrency.store(n, std::memory_order_relaxed);
+}
+
+ZENO_API std::size_t ThreadPool::concurrency() const {
+    auto n = impl->maxConcurrency.load(std::memory_order_relaxed);
+    return n ? std::min(n, size() + 1) : size() + 1;
+}
+
+namespace {
+
+struct ForEachIndexState {
+    std::size_t count;
+    void (*body)(void *, std::size_t);
+    void *arg;
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> helpersDone{0};
+    std::atomic<bool> failed{false};
+    std::mutex excMtx;
+    std::exception_ptr exc;
+
+    // indices are claimed one at a time, so a slow index never holds up the others
+    void work() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            auto i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count)
+                break;
+            try {
+                body(arg, i);
+            } catch (...) {
+                std::lock_guard lck(excMtx);
+                if (!exc)
+                    exc = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}
+
+ZENO_API void ThreadPool::forEachIndex(std::size_t count, void (*body)(void *, std::size_t), void *arg) {
+    if (!count)
+        return;
+    auto nhelpers = std::min(count, concurrency()) - 1;
+    if (!nhelpers) {
+        for (std::size_t i = 0; i < count; i++)
+            body(arg, i);
+        return;
+    }
+    ForEachIndexState st;
+    st.count = count;
+    st.body = body;
+    st.arg = arg;
+    for (std::size_t h = 0; h < nhelpers; h++) {
+        submit([&st] {
+            st.work();
+            st.helpersDone.fetch_add(1, std::memory_order_release);
+        });
+    }
+    st.work();
+    // helpers reference st, so wait for all of them, even those that found no index left
+    waitUntil([&] {
+        return st.helpersDone.load(std::memory_order_acquire) == nhelpers;
+    });
+    if (st.exc)
+        std::rethrow_exception(st.exc);
+}
+
+ZENO_API void ThreadPool::idle() {
+    std::unique_lock lck(impl->sleepMtx);
+    impl->sleepCv.wait_for(lck, std::chrono::milliseconds(1), [&] {
+        return impl->queued.load(std::memory_order_relaxed) != 0;
+    });
+}
+
+ZENO_API ThreadPool &ThreadPool::global() {
+    static ThreadPool &pool = [] () -> ThreadPool & {
+        // $ZENO_NUM_THREADS counts the calling thread too, which runs tasks while waiting
+        auto n = envconfig::getInt("NUM_THREADS");
+        static ThreadPool pool(n > 1 ? n - 1 : 0);
+        if (n == 1)
+            pool.setConcurrency(1);
+        return pool;
+    }();
+    return pool;
+}
+
+}
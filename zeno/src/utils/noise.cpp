@@ -0,0 +1,510 @@
+#include <zeno/utils/noise.h>
+#include <zeno/utils/compile_opts.h>
+#include <zeno/para/parallel_chunks.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// every kernel below is written one point per loop iteration, with selects in
+// place of branches, so that the block loops vectorize. with GCC on x86-64 the
+// block kernels are built once per instruction set and dispatched when libzeno
+// is loaded. CMake builds this file with -ffp-contract=off, so that the clones
+// (and the scalar versions) round identically, and -fno-trapping-math, without
+// which GCC won't vectorize floor().
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define ZENO_NOISE_LANES ZENO_GNUC_ATTRIBUTE(target_clones("avx512f", "avx2", "default"))
+#else
+#define ZENO_NOISE_LANES
+#endif
+
+namespace zeno {
+
+namespace {
+
+constexpr int kBlock = 64;
+
+const int kPerm[512] = {
+    151,160,137,91,90,15,
+    131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+    190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
+    88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
+    77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
+    102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196,
+    135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123,
+    5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
+    223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9,
+    129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
+    251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
+    49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
+    138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180,
+    151,160,137,91,90,15,
+    131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+    190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
+    88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
+    77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
+    102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196,
+    135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123,
+    5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
+    223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9,
+    129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
+    251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
+    49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
+    138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180,
+};
+
+ZENO_FORCEINLINE float lerp(float a, float b, float t) {
+    return a * (1 - t) + b * t;
+}
+
+ZENO_FORCEINLINE float fade(float t) {
+    return t * t * t * (t * (t * 6 - 15) + 10);
+}
+
+ZENO_FORCEINLINE float fadeDeriv(float t) {
+    return 30 * t * t * (t * (t - 2) + 1);
+}
+
+// dot of one of the 16 gradient directions with (x, y, z), i.e. +-u +-v where
+// u is x or y and v is one of the other axes
+ZENO_FORCEINLINE float gradDot(int h, float x, float y, float z) {
+    h &= 15;
+    float u = h < 8 ? x : y;
+    float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+ZENO_FORCEINLINE vec3f gradVec(int h) {
+    h &= 15;
+    float su = (h & 1) ? -1.f : 1.f;
+    float sv = (h & 2) ? -1.f : 1.f;
+    bool vy = h < 4;
+    bool vx = h == 12 || h == 14;
+    return {(h < 8 ? su : 0.f) + (vx ? sv : 0.f),
+            (h < 8 ? 0.f : su) + (vy ? sv : 0.f),
+            vx || vy ? 0.f : sv};
+}
+
+ZENO_FORCEINLINE vec3f lerp3(vec3f const &a, vec3f const &b, float t) {
+    return {lerp(a[0], b[0], t), lerp(a[1], b[1], t), lerp(a[2], b[2], t)};
+}
+
+template <bool Grad>
+ZENO_FORCEINLINE float perlinLane(float x, float y, float z, vec3f &grad) {
+    x = (x / 256.f - std::floor(x / 256.f)) * 256.f;
+    y = (y / 256.f - std::floor(y / 256.f)) * 256.f;
+    z = (z / 256.f - std::floor(z / 256.f)) * 256.f;
+    int xi = (int)x & 255;
+    int yi = (int)y & 255;
+    int zi = (int)z & 255;
+    float xf = x - (int)x;
+    float yf = y - (int)y;
+    float zf = z - (int)z;
+    float u = fade(xf);
+    float v = fade(yf);
+    float w = fade(zf);
+
+    int a = kPerm[xi], b = kPerm[xi + 1];
+    int aa = kPerm[a + yi], ab = kPerm[a + yi + 1];
+    int ba = kPerm[b + yi], bb = kPerm[b + yi + 1];
+    int aaa = kPerm[aa + zi], aab = kPerm[aa + zi + 1];
+    int aba = kPerm[ab + zi], abb = kPerm[ab + zi + 1];
+    int baa = kPerm[ba + zi], bab = kPerm[ba + zi + 1];
+    int bba = kPerm[bb + zi], bbb = kPerm[bb + zi + 1];
+
+    float n000 = gradDot(aaa, xf, yf, zf);
+    float n100 = gradDot(baa, xf - 1, yf, zf);
+    float n010 = gradDot(aba, xf, yf - 1, zf);
+    float n110 = gradDot(bba, xf - 1, yf - 1, zf);
+    float n001 = gradDot(aab, xf, yf, zf - 1);
+    float n101 = gradDot(bab, xf - 1, yf, zf - 1);
+    float n011 = gradDot(abb, xf, yf - 1, zf - 1);
+    float n111 = gradDot(bbb, xf - 1, yf - 1, zf - 1);
+
+    if constexpr (Grad) {
+        // d/dp of the trilinear blend: the blended corner gradients, plus the
+        // corner values differentiated through the fade curves
+        vec3f g = lerp3(
+            lerp3(lerp3(gradVec(aaa), gradVec(baa), u), lerp3(gradVec(aba), gradVec(bba), u), v),
+            lerp3(lerp3(gradVec(aab), gradVec(bab), u), lerp3(gradVec(abb), gradVec(bbb), u), v),
+            w);
+        float k1 = n100 - n000;
+        float k2 = n010 - n000;
+        float k3 = n001 - n000;
+        float k4 = n000 - n100 - n010 + n110;
+        float k5 = n000 - n010 - n001 + n011;
+        float k6 = n000 - n100 - n001 + n101;
+        float k7 = -n000 + n100 + n010 - n110 + n001 - n101 - n011 + n111;
+        grad = {g[0] + fadeDeriv(xf) * (k1 + k4 * v + k6 * w + k7 * v * w),
+                g[1] + fadeDeriv(yf) * (k2 + k4 * u + k5 * w + k7 * u * w),
+                g[2] + fadeDeriv(zf) * (k3 + k5 * v + k6 * u + k7 * u * v)};
+    }
+
+    float y1 = lerp(lerp(n000, n100, u), lerp(n010, n110, u), v);
+    float y2 = lerp(lerp(n001, n101, u), lerp(n011, n111, u), v);
+    return lerp(y1, y2, w);
+}
+
+ZENO_FORCEINLINE int fastfloor(double x) {
+    return x > 0 ? (int)x : (int)x - 1;
+}
+
+template <bool Grad>
+ZENO_FORCEINLINE void simplexCorner(float &n, vec3f &grad, int gi, float x, float y, float z) {
+    float t = 0.6f - x * x - y * y - z * z;
+    t = t < 0 ? 0.f : t;
+    float t2 = t * t;
+    float gd = gradDot(gi, x, y, z);
+    n += t2 * t2 * gd;
+    if constexpr (Grad) {
+        vec3f g = gradVec(gi);
+        float c = -8 * t2 * t * gd;
+        grad[0] += t2 * t2 * g[0] + c * x;
+        grad[1] += t2 * t2 * g[1] + c * y;
+        grad[2] += t2 * t2 * g[2] + c * z;
+    }
+}
+
+template <bool Grad>
+ZENO_FORCEINLINE float simplexLane(float x, float y, float z, vec3f &grad) {
+    constexpr float F3 = 1.0f / 3.0f;
+    constexpr float G3 = 1.0f / 6.0f;
+
+    float s = (x + y + z) * F3;
+    int i = fastfloor(x + double(s));
+    int j = fastfloor(y + double(s));
+    int k = fastfloor(z + double(s));
+    float t = (float)(i + j + k) * G3;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+    float z0 = z - ((float)k - t);
+
+    // corners 1 and 2 of the tetrahedron, walking the axes by decreasing offset
+    bool xy = x0 >= y0, yz = y0 >= z0, xz = x0 >= z0;
+    int i1 = xy && xz, j1 = !xy && yz, k1 = 1 - i1 - j1;
+    int i2 = xy || xz, j2 = !xy || yz, k2 = 2 - i2 - j2;
+
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
+    int gi0 = kPerm[ii + kPerm[jj + kPerm[kk]]];
+    int gi1 = kPerm[ii + i1 + kPerm[jj + j1 + kPerm[kk + k1]]];
+    int gi2 = kPerm[ii + i2 + kPerm[jj + j2 + kPerm[kk + k2]]];
+    int gi3 = kPerm[ii + 1 + kPerm[jj + 1 + kPerm[kk + 1]]];
+
+    float n = 0;
+    if constexpr (Grad)
+        grad = {0, 0, 0};
+    simplexCorner<Grad>(n, grad, gi0, x0, y0, z0);
+    simplexCorner<Grad>(n, grad, gi1, x0 - (float)i1 + G3, y0 - (float)j1 + G3, z0 - (float)k1 + G3);
+    simplexCorner<Grad>(n, grad, gi2, x0 - (float)i2 + 2.0f * G3, y0 - (float)j2 + 2.0f * G3, z0 - (float)k2 + 2.0f * G3);
+    simplexCorner<Grad>(n, grad, gi3, x0 - 1.0f + 3.0f * G3, y0 - 1.0f + 3.0f * G3, z0 - 1.0f + 3.0f * G3);
+    if constexpr (Grad)
+        grad = grad * 32.0f;
+    return 32.0f * n;
+}
+
+ZENO_FORCEINLINE float fract(float x) {
+    return x - std::floor(x);
+}
+
+ZENO_FORCEINLINE float worleyLane(float px, float py, float pz, NoiseWorley const &wo) {
+    float ix = std::floor(px), iy = std::floor(py), iz = std::floor(pz);
+    float fx = px - ix, fy = py - iy, fz = pz - iz;
+    float f1 = 9e9f, f2 = 9e9f;
+    for (int z = -1; z <= 1; z++) {
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                float cx = ix + x, cy = iy + y, cz = iz + z;
+                float hx = fract(std::sin(cx * 127.1f + cy * 311.7f + cz * 74.7f) * 43758.5453123f);
+                float hy = fract(std::sin(cx * 269.5f + cy * 183.3f + cz * 246.1f) * 43758.5453123f);
+                float hz = fract(std::sin(cx * 113.5f + cy * 271.9f + cz * 124.6f) * 43758.5453123f);
+                float dx = x + (0.5f + 0.5f * std::sin(wo.offset[0] + 6.2831f * hx)) * wo.jitter - fx;
+                float dy = y + (0.5f + 0.5f * std::sin(wo.offset[1] + 6.2831f * hy)) * wo.jitter - fy;
+                float dz = z + (0.5f + 0.5f * std::sin(wo.offset[2] + 6.2831f * hz)) * wo.jitter - fz;
+                dx = std::abs(dx), dy = std::abs(dy), dz = std::abs(dz);
+                float d = wo.distance == 0 ? dx * dx + dy * dy + dz * dz
+                        : wo.distance == 1 ? std::max(std::max(dx, dy), dz)
+                        : dx + dy + dz;
+                f2 = std::min(f2, std::max(f1, d));
+                f1 = std::min(f1, d);
+            }
+        }
+    }
+    return wo.f2MinusF1 ? f2 - f1 : f1;
+}
+
+ZENO_FORCEINLINE float hashGradDot(float cx, float cy, float cz, float dx, float dy, float dz) {
+    float hx = -1.0f + 2.0f * fract(std::sin(cx * 127.1f + cy * 311.7f + cz * 284.4f) * 43758.5453123f);
+    float hy = -1.0f + 2.0f * fract(std::sin(cx * 269.5f + cy * 183.3f + cz * 162.2f) * 43758.5453123f);
+    float hz = -1.0f + 2.0f * fract(std::sin(cx * 228.3f + cy * 164.9f + cz * 126.0f) * 43758.5453123f);
+    return hx * dx + hy * dy + hz * dz;
+}
+
+ZENO_FORCEINLINE float hashPerlinLane(float x, float y, float z) {
+    float ix = std::floor(x), iy = std::floor(y), iz = std::floor(z);
+    float fx = x - ix, fy = y - iy, fz = z - iz;
+    float u = fx * fx * (3.0f - 2.0f * fx);
+    float v = fy * fy * (3.0f - 2.0f * fy);
+    float w = fz * fz * (3.0f - 2.0f * fz);
+    return 0.08f + 0.8f * lerp(
+        lerp(lerp(hashGradDot(ix, iy, iz, fx, fy, fz),
+                  hashGradDot(ix + 1, iy, iz, fx - 1, fy, fz), u),
+             lerp(hashGradDot(ix, iy + 1, iz, fx, fy - 1, fz),
+                  hashGradDot(ix + 1, iy + 1, iz, fx - 1, fy - 1, fz), u), v),
+        lerp(lerp(hashGradDot(ix, iy, iz + 1, fx, fy, fz - 1),
+                  hashGradDot(ix + 1, iy, iz + 1, fx - 1, fy, fz - 1), u),
+             lerp(hashGradDot(ix, iy + 1, iz + 1, fx, fy - 1, fz - 1),
+                  hashGradDot(ix + 1, iy + 1, iz + 1, fx - 1, fy - 1, fz - 1), u), v),
+        w);
+}
+
+// octave i of an fBm, worked out in double like pow() would
+ZENO_FORCEINLINE float octaveFreq(NoiseOctaves const &o, int i) {
+    return float(o.frequency * std::pow((double)o.lacunarity, i));
+}
+
+ZENO_FORCEINLINE float octaveAmp(NoiseOctaves const &o, int i) {
+    return float(std::pow((double)o.gain, i));
+}
+
+// octaves of noiseHashPerlin, the last one faded by the fraction of detail
+ZENO_FORCEINLINE float detailAmp(float roughness, float detail, int i) {
+    float a = std::pow(roughness, i);
+    return a * (1.f - std::max(0.f, i - (detail - 1)));
+}
+
+struct OctaveTable {
+    std::vector<float> freq, amp;
+
+    explicit OctaveTable(NoiseOctaves const &o) {
+        for (int i = 0; i < o.octaves; i++) {
+            freq.push_back(octaveFreq(o, i));
+            amp.push_back(octaveAmp(o, i));
+        }
+    }
+
+    OctaveTable(float roughness, float detail) {
+        int n = (int)std::ceil(detail);
+        for (int i = 0; i < n; i++) {
+            freq.push_back(float(1 << i));
+            amp.push_back(detailAmp(roughness, detail, i));
+        }
+    }
+
+    int size() const {
+        return (int)freq.size();
+    }
+};
+
+struct Block {
+    float x[kBlock], y[kBlock], z[kBlock];
+    float out[kBlock];
+    float gx[kBlock], gy[kBlock], gz[kBlock];
+};
+
+ZENO_NOISE_LANES void perlinBlock(Block &b, bool grad) {
+    vec3f g;
+    if (grad) {
+        for (int l = 0; l < kBlock; l++) {
+            b.out[l] = perlinLane<true>(b.x[l], b.y[l], b.z[l], g);
+            b.gx[l] = g[0], b.gy[l] = g[1], b.gz[l] = g[2];
+        }
+    } else {
+        for (int l = 0; l < kBlock; l++)
+            b.out[l] = perlinLane<false>(b.x[l], b.y[l], b.z[l], g);
+    }
+}
+
+ZENO_NOISE_LANES void simplexBlock(Block &b, bool grad) {
+    vec3f g;
+    if (grad) {
+        for (int l = 0; l < kBlock; l++) {
+            b.out[l] = simplexLane<true>(b.x[l], b.y[l], b.z[l], g);
+            b.gx[l] = g[0], b.gy[l] = g[1], b.gz[l] = g[2];
+        }
+    } else {
+        for (int l = 0; l < kBlock; l++)
+            b.out[l] = simplexLane<false>(b.x[l], b.y[l], b.z[l], g);
+    }
+}
+
+ZENO_NOISE_LANES void worleyBlock(Block &b, NoiseWorley const &wo) {
+    for (int l = 0; l < kBlock; l++)
+        b.out[l] = worleyLane(b.x[l], b.y[l], b.z[l], wo);
+}
+
+ZENO_NOISE_LANES void fbmBlock(Block &b, OctaveTable const &t, bool grad) {
+    vec3f g;
+    for (int l = 0; l < kBlock; l++)
+        b.out[l] = 0, b.gx[l] = 0, b.gy[l] = 0, b.gz[l] = 0;
+    for (int i = 0; i < t.size(); i++) {
+        float f = t.freq[i], a = t.amp[i];
+        if (grad) {
+            for (int l = 0; l < kBlock; l++) {
+                b.out[l] += a * perlinLane<true>(b.x[l] * f, b.y[l] * f, b.z[l] * f, g);
+                b.gx[l] += a * f * g[0], b.gy[l] += a * f * g[1], b.gz[l] += a * f * g[2];
+            }
+        } else {
+            for (int l = 0; l < kBlock; l++)
+                b.out[l] += a * perlinLane<false>(b.x[l] * f, b.y[l] * f, b.z[l] * f, g);
+        }
+    }
+}
+
+ZENO_NOISE_LANES void hybridBlock(Block &b, OctaveTable const &t, float offset) {
+    vec3f g;
+    float *weight = b.gx;
+    for (int l = 0; l < kBlock; l++)
+        b.out[l] = 0, weight[l] = 1;
+    for (int i = 0; i < t.size(); i++) {
+        float f = t.freq[i], a = t.amp[i];
+        for (int l = 0; l < kBlock; l++) {
+            float signal = (perlinLane<false>(b.x[l] * f, b.y[l] * f, b.z[l] * f, g) + offset) * a;
+            float wt = std::min(weight[l], 1.f);
+            b.out[l] += wt * signal;
+            weight[l] = wt * signal;
+        }
+    }
+}
+
+ZENO_NOISE_LANES void hashPerlinBlock(Block &b, OctaveTable const &t) {
+    for (int l = 0; l < kBlock; l++)
+        b.out[l] = 0;
+    for (int i = 0; i < t.size(); i++) {
+        float f = t.freq[i], a = t.amp[i];
+        for (int l = 0; l < kBlock; l++)
+            b.out[l] += hashPerlinLane(b.x[l] * f, b.y[l] * f, b.z[l] * f) * a;
+    }
+}
+
+// gather the points into blocks of kBlock lanes, run kernel(block), scatter
+// the results; blocks are spread over the thread pool when there are many
+template <class Kernel>
+void forEachBlock(std::size_t n, NoisePoints const &p, NoiseResults const &r, Kernel const &kernel) {
+    auto run = [&] (std::size_t beg, std::size_t end) {
+        Block b;
+        for (std::size_t i0 = beg; i0 < end; i0 += kBlock) {
+            int m = (int)std::min<std::size_t>(kBlock, end - i0);
+            for (int l = 0; l < m; l++) {
+                auto k = (i0 + l) * p.stride;
+                b.x[l] = p.x[k], b.y[l] = p.y[k], b.z[l] = p.z[k];
+            }
+            for (int l = m; l < kBlock; l++)
+                b.x[l] = b.y[l] = b.z[l] = 0;
+            kernel(b);
+            for (int l = 0; l < m; l++)
+                r.out[(i0 + l) * r.stride] = b.out[l];
+            if (r.grad) {
+                for (int l = 0; l < m; l++)
+                    r.grad[i0 + l] = {b.gx[l], b.gy[l], b.gz[l]};
+            }
+        }
+    };
+    constexpr std::size_t kGrain = kBlock * 64;
+    if (n <= kGrain)
+        run(0, n);
+    else
+        parallel_chunks(n, kGrain, run);
+}
+
+
+}
+
+ZENO_API float noisePerlin(vec3f p, vec3f *grad) {
+    vec3f g;
+    if (grad) {
+        float r = perlinLane<true>(p[0], p[1], p[2], g);
+        *grad = g;
+        return r;
+    }
+    return perlinLane<false>(p[0], p[1], p[2], g);
+}
+
+ZENO_API void noisePerlin(std::size_t n, NoisePoints p, NoiseResults r) {
+    bool grad = r.grad;
+    forEachBlock(n, p, r, [&] (Block &b) { perlinBlock(b, grad); });
+}
+
+ZENO_API float noiseSimplex(vec3f p, vec3f *grad) {
+    vec3f g;
+    if (grad) {
+        float r = simplexLane<true>(p[0], p[1], p[2], g);
+        *grad = g;
+        return r;
+    }
+    return simplexLane<false>(p[0], p[1], p[2], g);
+}
+
+ZENO_API void noiseSimplex(std::size_t n, NoisePoints p, NoiseResults r) {
+    bool grad = r.grad;
+    forEachBlock(n, p, r, [&] (Block &b) { simplexBlock(b, grad); });
+}
+
+ZENO_API float noiseWorley(vec3f p, NoiseWorley const &w) {
+    return worleyLane(p[0], p[1], p[2], w);
+}
+
+ZENO_API void noiseWorley(std::size_t n, NoisePoints p, NoiseResults r, NoiseWorley const &w) {
+    r.grad = nullptr;
+    forEachBlock(n, p, r, [&] (Block &b) { worleyBlock(b, w); });
+}
+
+ZENO_API float noiseFbm(vec3f p, NoiseOctaves const &o, vec3f *grad) {
+    float out = 0;
+    vec3f g, gsum{0, 0, 0};
+    for (int i = 0; i < o.octaves; i++) {
+        float f = octaveFreq(o, i), a = octaveAmp(o, i);
+        if (grad) {
+            out += a * perlinLane<true>(p[0] * f, p[1] * f, p[2] * f, g);
+            gsum[0] += a * f * g[0], gsum[1] += a * f * g[1], gsum[2] += a * f * g[2];
+        } else {
+            out += a * perlinLane<false>(p[0] * f, p[1] * f, p[2] * f, g);
+        }
+    }
+    if (grad)
+        *grad = gsum;
+    return out;
+}
+
+ZENO_API void noiseFbm(std::size_t n, NoisePoints p, NoiseResults r, NoiseOctaves const &o) {
+    OctaveTable t(o);
+    bool grad = r.grad;
+    forEachBlock(n, p, r, [&] (Block &b) { fbmBlock(b, t, grad); });
+}
+
+ZENO_API float noiseHybrid(vec3f p, NoiseOctaves const &o, float offset) {
+    float out = 0, weight = 1;
+    vec3f g;
+    for (int i = 0; i < o.octaves; i++) {
+        float f = octaveFreq(o, i);
+        float signal = (perlinLane<false>(p[0] * f, p[1] * f, p[2] * f, g) + offset) * octaveAmp(o, i);
+        float wt = std::min(weight, 1.f);
+        out += wt * signal;
+        weight = wt * signal;
+    }
+    return out;
+}
+
+ZENO_API void noiseHybrid(std::size_t n, NoisePoints p, NoiseResults r, NoiseOctaves const &o, float offset) {
+    OctaveTable t(o);
+    r.grad = nullptr;
+    forEachBlock(n, p, r, [&] (Block &b) { hybridBlock(b, t, offset); });
+}
+
+ZENO_API float noiseHashPerlin(vec3f p, float roughness, float detail) {
+    float out = 0;
+    int n = (int)std::ceil(detail);
+    for (int i = 0; i < n; i++) {
+        float f = float(1 << i);
+        out += hashPerlinLane(p[0] * f, p[1] * f, p[2] * f) * detailAmp(roughness, detail, i);
+    }
+    return out;
+}
+
+ZENO_API void noiseHashPerlin(std::size_t n, NoisePoints p, NoiseResults r, float roughness, float detail) {
+    OctaveTable t(roughness, detail);
+    r.grad = nullptr;
+    forEachBlock(n, p, r, [&] (Block &b) { hashPerlinBlock(b, t); });
+}
+
+}
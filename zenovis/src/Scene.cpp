@@ -107,8 +107,12 @@ bool Scene::loadFrameObjects(int frameid) {
     const auto& cbLoadObjs = [this](std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs) -> bool {
         return this->objectsMan->load_objects(objs);
     };
+    // objects kept from the previous frame (e.g. static ones) don't need to be decoded again
+    const auto& isNeeded = [this](std::string const& key) -> bool {
+        return this->objectsMan->objects.find(key) == this->objectsMan->objects.end();
+    };
     bool isFrameValid = false;
-    bool inserted = zeno::getSession().globalComm->load_objects(frameid, cbLoadObjs, isFrameValid);
+    bool inserted = zeno::getSession().globalComm->load_objects(frameid, cbLoadObjs, isFrameValid, isNeeded);
     if (!isFrameValid)
         return false;
 